@@ -0,0 +1,348 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file
+////////////////////////////////////////////////////////////////////////////////
+/// Copyright (C) 2012-2015, Black Phoenix
+///
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the GNU Lesser General Public License as published by the Free Software
+/// Foundation; either version 2 of the License, or (at your option) any later
+/// version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+/// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+/// details.
+///
+/// You should have received a copy of the GNU Lesser General Public License along with
+/// this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+/// Place - Suite 330, Boston, MA  02111-1307, USA.
+///
+/// Further information about the GNU Lesser General Public License can also be found on
+/// the world wide web at http://www.gnu.org.
+////////////////////////////////////////////////////////////////////////////////
+#include <stdlib.h>
+#include <string.h>
+#include "sim_bench.h"
+#ifdef _WIN32
+#	include <windows.h>
+#	include <psapi.h>
+#else
+#	include <sys/resource.h>
+#endif
+
+//Maximum number of recorded results
+#define SIMC_BENCH_MAX_RESULTS		4096
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Internal data structures
+////////////////////////////////////////////////////////////////////////////////
+typedef struct SIMC_BENCH_GROUP_TAG {
+	SIMC_LOCK_ID lock;					//Protects ready counter
+	volatile int ready;					//Number of threads waiting for start
+	int64_t start;						//Set when all threads may start (atomic)
+	SIMC_BENCH_THREAD threads[SIMC_BENCH_MAX_THREADS];
+} SIMC_BENCH_GROUP;
+
+SIMC_BENCH_OPTIONS SIMC_Bench_Options = { SIMC_BENCH_FORMAT_CSV, 0, 0, 0, 1.0 };
+SIMC_BENCH_RESULT SIMC_Bench_Results[SIMC_BENCH_MAX_RESULTS];
+int SIMC_Bench_ResultCount = 0;
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Parse shared command line option.
+///
+/// Known options are:
+///  - `--csv`, `--json` output format
+///  - `--output=file` write results into a file instead of standard output
+///  - `--filter=text` only run benchmarks which have text in their name
+///  - `--threads=n` largest number of threads in scaling benchmarks
+///  - `--scale=x` multiply number of iterations by x
+///
+/// @returns 1 if option was parsed, 0 if it is not one of the shared options
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_Bench_ParseOption(const char* option) {
+	if (strcmp(option,"--csv") == 0) {
+		SIMC_Bench_Options.format = SIMC_BENCH_FORMAT_CSV;
+	} else if (strcmp(option,"--json") == 0) {
+		SIMC_Bench_Options.format = SIMC_BENCH_FORMAT_JSON;
+	} else if (strncmp(option,"--output=",9) == 0) {
+		SIMC_Bench_Options.output = option+9;
+	} else if (strncmp(option,"--filter=",9) == 0) {
+		SIMC_Bench_Options.filter = option+9;
+	} else if (strncmp(option,"--threads=",10) == 0) {
+		SIMC_Bench_Options.max_threads = atoi(option+10);
+		if (SIMC_Bench_Options.max_threads > SIMC_BENCH_MAX_THREADS) SIMC_Bench_Options.max_threads = SIMC_BENCH_MAX_THREADS;
+	} else if (strncmp(option,"--scale=",8) == 0) {
+		SIMC_Bench_Options.scale = atof(option+8);
+		if (SIMC_Bench_Options.scale <= 0.0) SIMC_Bench_Options.scale = 1.0;
+	} else {
+		return 0;
+	}
+	return 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Print description of shared command line options.
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Bench_PrintUsage(const char* program) {
+	fprintf(stderr,"Usage: %s [options]\n",program);
+	fprintf(stderr,"  --csv, --json      Output format (CSV by default)\n");
+	fprintf(stderr,"  --output=file      Write results into file instead of standard output\n");
+	fprintf(stderr,"  --filter=text      Only run benchmarks which have text in their name\n");
+	fprintf(stderr,"  --threads=n        Largest number of threads (number of processors by default)\n");
+	fprintf(stderr,"  --scale=x          Multiply number of iterations by x\n");
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Check if benchmark with this name must be run.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_Bench_Enabled(const char* name) {
+	if (!SIMC_Bench_Options.filter) return 1;
+	return strstr(name,SIMC_Bench_Options.filter) != 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Number of iterations scaled by command line option.
+////////////////////////////////////////////////////////////////////////////////
+int64_t SIMC_Bench_Iterations(int64_t iterations) {
+	int64_t scaled = (int64_t)(iterations*SIMC_Bench_Options.scale);
+	return (scaled < 1) ? 1 : scaled;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Fill result with rate of operations per second.
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Bench_SetRate(SIMC_BENCH_RESULT* result, const char* name, const char* variant, int threads,
+						int64_t operations, double seconds) {
+	memset(result,0,sizeof(SIMC_BENCH_RESULT));
+	strncpy(result->name,name,sizeof(result->name)-1);
+	if (variant) strncpy(result->variant,variant,sizeof(result->variant)-1);
+	result->threads = threads;
+	result->operations = operations;
+	result->seconds = seconds;
+	result->value = (seconds > 0.0) ? operations/seconds : 0.0;
+	result->unit = "ops/s";
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Compare two latency samples (for qsort).
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_Bench_CompareSamples(const void* a, const void* b) {
+	int64_t x = *((const int64_t*)a);
+	int64_t y = *((const int64_t*)b);
+	return (x > y) - (x < y);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Fill latency percentiles from samples in nanoseconds.
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Bench_SetLatency(SIMC_BENCH_RESULT* result, int64_t* samples, int64_t count) {
+	if (count <= 0) return;
+	qsort(samples,(size_t)count,sizeof(int64_t),SIMC_Bench_CompareSamples);
+	result->p50_ns = (double)samples[count/2];
+	result->p99_ns = (double)samples[(count*99)/100];
+	result->p999_ns = (double)samples[(count*999)/1000];
+	result->max_ns = (double)samples[count-1];
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Add result to the report.
+///
+/// Results are also printed to standard error in human-readable form as they come.
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Bench_Record(SIMC_BENCH_RESULT* result) {
+	double ns_per_op = result->operations ? (result->seconds*1e9)/result->operations : 0.0;
+	fprintf(stderr,"%-28s %-24s %3d thr  %14.1f %-6s %10.1f ns/op",
+		result->name,result->variant,result->threads,result->value,result->unit,ns_per_op);
+	if (result->max_ns > 0.0) {
+		fprintf(stderr,"  p50 %.0f p99 %.0f p99.9 %.0f max %.0f ns",
+			result->p50_ns,result->p99_ns,result->p999_ns,result->max_ns);
+	}
+	fprintf(stderr,"\n");
+
+	if (SIMC_Bench_ResultCount < SIMC_BENCH_MAX_RESULTS) {
+		SIMC_Bench_Results[SIMC_Bench_ResultCount++] = *result;
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Write all results in the selected format.
+///
+/// @returns Zero on success, non-zero if output file could not be written
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_Bench_WriteResults() {
+	FILE* file = stdout;
+	int i;
+	if (SIMC_Bench_Options.output) {
+		file = fopen(SIMC_Bench_Options.output,"w");
+		if (!file) {
+			fprintf(stderr,"Could not write results into %s\n",SIMC_Bench_Options.output);
+			return 1;
+		}
+	}
+
+	if (SIMC_Bench_Options.format == SIMC_BENCH_FORMAT_JSON) {
+		fprintf(file,"[\n");
+	} else {
+		fprintf(file,"name,variant,threads,operations,seconds,ns_per_op,value,unit,p50_ns,p99_ns,p999_ns,max_ns\n");
+	}
+	for (i = 0; i < SIMC_Bench_ResultCount; i++) {
+		SIMC_BENCH_RESULT* result = &SIMC_Bench_Results[i];
+		double ns_per_op = result->operations ? (result->seconds*1e9)/result->operations : 0.0;
+		if (SIMC_Bench_Options.format == SIMC_BENCH_FORMAT_JSON) {
+			fprintf(file,"  {\"name\": \"%s\", \"variant\": \"%s\", \"threads\": %d, \"operations\": %lld, "
+				"\"seconds\": %.9g, \"ns_per_op\": %.6g, \"value\": %.9g, \"unit\": \"%s\", "
+				"\"p50_ns\": %.0f, \"p99_ns\": %.0f, \"p999_ns\": %.0f, \"max_ns\": %.0f}%s\n",
+				result->name,result->variant,result->threads,(long long)result->operations,
+				result->seconds,ns_per_op,result->value,result->unit,
+				result->p50_ns,result->p99_ns,result->p999_ns,result->max_ns,
+				(i < SIMC_Bench_ResultCount-1) ? "," : "");
+		} else {
+			fprintf(file,"%s,%s,%d,%lld,%.9g,%.6g,%.9g,%s,%.0f,%.0f,%.0f,%.0f\n",
+				result->name,result->variant,result->threads,(long long)result->operations,
+				result->seconds,ns_per_op,result->value,result->unit,
+				result->p50_ns,result->p99_ns,result->p999_ns,result->max_ns);
+		}
+	}
+	if (SIMC_Bench_Options.format == SIMC_BENCH_FORMAT_JSON) fprintf(file,"]\n");
+
+	if (file != stdout) fclose(file);
+	return 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Wait until all threads of the group are ready, then run benchmark function.
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Bench_ThreadEntry(SIMC_BENCH_THREAD* thread) {
+	SIMC_BENCH_GROUP* group = thread->group;
+	SIMC_Lock_Enter(group->lock);
+	group->ready++;
+	SIMC_Lock_Leave(group->lock);
+	while (!SIMC_BENCH_ATOMIC_ADD(&group->start,0)) ;
+
+	thread->function(thread);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Run function on several threads started at the same moment.
+///
+/// All threads are created first and spin until every one of them is running, so
+/// thread creation is not included in the measured time.
+///
+/// @returns Time from start until the last thread finished (in seconds)
+////////////////////////////////////////////////////////////////////////////////
+double SIMC_Bench_RunThreads(int count, SIMC_BENCH_THREAD_FUNCTION* function, void* userdata) {
+	SIMC_BENCH_GROUP* group;
+	SIMC_THREAD_ID workers[SIMC_BENCH_MAX_THREADS];
+	int64_t start_time;
+	double seconds;
+	int i;
+	if (count > SIMC_BENCH_MAX_THREADS) count = SIMC_BENCH_MAX_THREADS;
+
+	group = (SIMC_BENCH_GROUP*)malloc(sizeof(SIMC_BENCH_GROUP));
+	memset(group,0,sizeof(SIMC_BENCH_GROUP));
+	group->lock = SIMC_Lock_Create();
+	for (i = 0; i < count; i++) {
+		group->threads[i].index = i;
+		group->threads[i].count = count;
+		group->threads[i].userdata = userdata;
+		group->threads[i].function = function;
+		group->threads[i].random = 0x9E3779B9U*(i+1);
+		group->threads[i].group = group;
+		workers[i] = SIMC_Thread_CreateWithName(SIMC_Bench_ThreadEntry,&group->threads[i],"SIMC_Bench");
+	}
+
+	//Start all threads at once
+	while (1) {
+		int ready;
+		SIMC_Lock_Enter(group->lock);
+		ready = group->ready;
+		SIMC_Lock_Leave(group->lock);
+		if (ready == count) break;
+		SIMC_Thread_Sleep(0.0);
+	}
+	start_time = SIMC_Thread_GetTimeNs();
+	SIMC_BENCH_ATOMIC_ADD(&group->start,1);
+
+	for (i = 0; i < count; i++) {
+		if (workers[i] != SIMC_THREAD_BAD_ID) SIMC_Thread_WaitFor(workers[i]);
+	}
+	seconds = (SIMC_Thread_GetTimeNs() - start_time)*1e-9;
+
+	SIMC_Lock_Destroy(group->lock);
+	free(group);
+	return seconds;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Get next pseudo-random number (xorshift32).
+////////////////////////////////////////////////////////////////////////////////
+uint32_t SIMC_Bench_Random(uint32_t* state) {
+	uint32_t x = *state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+	return x;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Get peak resident set size of the process.
+///
+/// On Linux the high-water mark is read from /proc (so it can be reset between
+/// benchmark cases), otherwise the lifetime peak reported by the system is used.
+////////////////////////////////////////////////////////////////////////////////
+int64_t SIMC_Bench_GetPeakMemory() {
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(),&counters,sizeof(counters))) return 0;
+	return (int64_t)counters.PeakWorkingSetSize;
+#else
+	struct rusage usage;
+	FILE* status = fopen("/proc/self/status","r");
+	if (status) {
+		char line[256];
+		long long kilobytes;
+		while (fgets(line,sizeof(line),status)) {
+			if (sscanf(line,"VmHWM: %lld kB",&kilobytes) == 1) {
+				fclose(status);
+				return kilobytes*1024;
+			}
+		}
+		fclose(status);
+	}
+	if (getrusage(RUSAGE_SELF,&usage) != 0) return 0;
+#ifdef __APPLE__
+	return (int64_t)usage.ru_maxrss;
+#else
+	return (int64_t)usage.ru_maxrss*1024;
+#endif
+#endif
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Reset peak resident set size to current size (Linux only).
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Bench_ResetPeakMemory() {
+#if !defined(_WIN32) && !defined(__APPLE__)
+	FILE* clear_refs = fopen("/proc/self/clear_refs","w");
+	if (clear_refs) {
+		fputs("5",clear_refs);
+		fclose(clear_refs);
+	}
+#endif
+}
@@ -0,0 +1,137 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file
+////////////////////////////////////////////////////////////////////////////////
+/// Copyright (C) 2012-2015, Black Phoenix
+///
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the GNU Lesser General Public License as published by the Free Software
+/// Foundation; either version 2 of the License, or (at your option) any later
+/// version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+/// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+/// details.
+///
+/// You should have received a copy of the GNU Lesser General Public License along with
+/// this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+/// Place - Suite 330, Boston, MA  02111-1307, USA.
+///
+/// Further information about the GNU Lesser General Public License can also be found on
+/// the world wide web at http://www.gnu.org.
+////////////////////////////////////////////////////////////////////////////////
+#ifndef SIM_BENCH_H
+#define SIM_BENCH_H
+#include <stdio.h>
+#ifdef _WIN32
+#	include <windows.h>
+#endif
+#include "sim_core.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+// Write results as comma-separated values
+#define SIMC_BENCH_FORMAT_CSV		0
+// Write results as JSON array
+#define SIMC_BENCH_FORMAT_JSON		1
+
+// Maximum number of worker threads in a benchmark
+#define SIMC_BENCH_MAX_THREADS		256
+
+// Atomically add value to a 64-bit integer (returns old value)
+#ifdef _WIN32
+#	define SIMC_BENCH_ATOMIC_ADD(ptr,value)	InterlockedExchangeAdd64((volatile LONGLONG*)(ptr),(value))
+#else
+#	define SIMC_BENCH_ATOMIC_ADD(ptr,value)	__sync_fetch_and_add((ptr),(value))
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @struct SIMC_BENCH_OPTIONS
+/// @brief Command line options shared by all benchmarks
+////////////////////////////////////////////////////////////////////////////////
+typedef struct SIMC_BENCH_OPTIONS_TAG {
+	int format;							//Output format (SIMC_BENCH_FORMAT_...)
+	const char* output;					//Output file name (null for standard output)
+	const char* filter;					//Only run benchmarks with this substring in name (may be null)
+	int max_threads;					//Largest number of threads in scaling benchmarks
+	double scale;						//Multiplier for number of iterations
+} SIMC_BENCH_OPTIONS;
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @struct SIMC_BENCH_RESULT
+/// @brief Result of one benchmark case
+///
+/// Value is the main measurement in the given unit (for example "ops/s" or "MB/s").
+/// Latency percentiles are zero if latency of single operations was not measured.
+////////////////////////////////////////////////////////////////////////////////
+typedef struct SIMC_BENCH_RESULT_TAG {
+	char name[64];						//Benchmark name
+	char variant[64];					//Benchmark case (may be empty)
+	int threads;						//Number of threads
+	int64_t operations;					//Number of operations measured
+	double seconds;						//Total time
+	double value;						//Main measurement
+	const char* unit;					//Unit of main measurement
+	double p50_ns;						//Median latency of one operation
+	double p99_ns;
+	double p999_ns;
+	double max_ns;
+} SIMC_BENCH_RESULT;
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @struct SIMC_BENCH_THREAD
+/// @brief Worker thread started by SIMC_Bench_RunThreads()
+////////////////////////////////////////////////////////////////////////////////
+typedef struct SIMC_BENCH_THREAD_TAG SIMC_BENCH_THREAD;
+typedef void SIMC_BENCH_THREAD_FUNCTION(SIMC_BENCH_THREAD* thread);
+struct SIMC_BENCH_THREAD_TAG {
+	int index;							//Index of the thread (0..count-1)
+	int count;							//Total number of threads
+	void* userdata;						//Data passed into SIMC_Bench_RunThreads()
+	SIMC_BENCH_THREAD_FUNCTION* function;
+	uint32_t random;					//State of per-thread random number generator
+	struct SIMC_BENCH_GROUP_TAG* group;
+};
+
+
+// Options parsed from command line
+extern SIMC_BENCH_OPTIONS SIMC_Bench_Options;
+
+// Parse shared command line option (returns 0 if option is not known)
+int SIMC_Bench_ParseOption(const char* option);
+// Print description of shared command line options
+void SIMC_Bench_PrintUsage(const char* program);
+// Check if benchmark with this name must be run
+int SIMC_Bench_Enabled(const char* name);
+// Number of iterations scaled by command line option (at least one)
+int64_t SIMC_Bench_Iterations(int64_t iterations);
+
+// Fill result with rate of operations per second
+void SIMC_Bench_SetRate(SIMC_BENCH_RESULT* result, const char* name, const char* variant, int threads,
+						int64_t operations, double seconds);
+// Fill latency percentiles from samples in nanoseconds (samples are sorted)
+void SIMC_Bench_SetLatency(SIMC_BENCH_RESULT* result, int64_t* samples, int64_t count);
+// Add result to the report (also printed to standard error)
+void SIMC_Bench_Record(SIMC_BENCH_RESULT* result);
+// Write all results in the selected format
+int SIMC_Bench_WriteResults();
+
+// Run function on several threads started at the same moment (returns time until all finished, in seconds)
+double SIMC_Bench_RunThreads(int count, SIMC_BENCH_THREAD_FUNCTION* function, void* userdata);
+// Get next pseudo-random number of a thread
+uint32_t SIMC_Bench_Random(uint32_t* state);
+// Get peak resident set size of the process (in bytes, 0 if not known)
+int64_t SIMC_Bench_GetPeakMemory();
+// Reset peak resident set size to current size (if supported by the system)
+void SIMC_Bench_ResetPeakMemory();
+
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,531 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file
+////////////////////////////////////////////////////////////////////////////////
+/// Copyright (C) 2012-2015, Black Phoenix
+///
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the GNU Lesser General Public License as published by the Free Software
+/// Foundation; either version 2 of the License, or (at your option) any later
+/// version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+/// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+/// details.
+///
+/// You should have received a copy of the GNU Lesser General Public License along with
+/// this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+/// Place - Suite 330, Boston, MA  02111-1307, USA.
+///
+/// Further information about the GNU Lesser General Public License can also be found on
+/// the world wide web at http://www.gnu.org.
+////////////////////////////////////////////////////////////////////////////////
+#include <stdlib.h>
+#include <string.h>
+#include "sim_bench.h"
+
+//Size of queue in the queue benchmarks
+#define BENCH_QUEUE_SIZE		1024
+//Number of values protected by the lock in SRW benchmarks
+#define BENCH_SRW_VALUES		16
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Shared benchmark state
+////////////////////////////////////////////////////////////////////////////////
+typedef struct BENCH_QUEUE_STATE_TAG {
+	SIMC_QUEUE* request;				//Main thread to worker
+	SIMC_QUEUE* reply;					//Worker to main thread
+	int64_t count;						//Number of values to pass
+	volatile int error;					//Value arrived out of order
+} BENCH_QUEUE_STATE;
+
+typedef struct BENCH_SRW_STATE_TAG {
+	SIMC_SRW_ID lock;
+	volatile int64_t values[BENCH_SRW_VALUES];
+	int64_t operations;					//Operations per thread
+	uint32_t write_threshold;			//Random numbers below threshold are writes
+} BENCH_SRW_STATE;
+
+typedef struct BENCH_LOCK_STATE_TAG {
+	SIMC_LOCK_ID lock;
+	SIMC_MUTEX mutex;
+	volatile int64_t counter;
+	int64_t operations;					//Operations per thread
+} BENCH_LOCK_STATE;
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Write value into queue, spinning while it is full.
+////////////////////////////////////////////////////////////////////////////////
+void Bench_QueuePush(SIMC_QUEUE* queue, int64_t value) {
+	void* slot;
+	int spins = 0;
+	SIMC_Queue_EnterWrite(queue,&slot);
+	*((int64_t*)slot) = value;
+	while (!SIMC_Queue_LeaveWrite(queue)) {
+		if (++spins > 1000) SIMC_Thread_Sleep(0.0);
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Read value from queue, spinning while it is empty.
+////////////////////////////////////////////////////////////////////////////////
+int64_t Bench_QueuePop(SIMC_QUEUE* queue) {
+	void* slot;
+	int64_t value;
+	int spins = 0;
+	while (!SIMC_Queue_EnterRead(queue,&slot)) {
+		if (++spins > 1000) SIMC_Thread_Sleep(0.0);
+	}
+	value = *((int64_t*)slot);
+	SIMC_Queue_LeaveRead(queue);
+	return value;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Time functions overhead.
+////////////////////////////////////////////////////////////////////////////////
+void Bench_Time() {
+	SIMC_BENCH_RESULT result;
+	int64_t i, n = SIMC_Bench_Iterations(2000000);
+	int64_t start;
+	volatile double sink_double = 0.0;
+	volatile int64_t sink_int = 0;
+	volatile uint64_t sink_ticks = 0;
+
+	start = SIMC_Thread_GetTimeNs();
+	for (i = 0; i < n; i++) sink_double += SIMC_Thread_GetTime();
+	SIMC_Bench_SetRate(&result,"time","SIMC_Thread_GetTime",1,n,(SIMC_Thread_GetTimeNs()-start)*1e-9);
+	SIMC_Bench_Record(&result);
+
+	start = SIMC_Thread_GetTimeNs();
+	for (i = 0; i < n; i++) sink_int += SIMC_Thread_GetTimeNs();
+	SIMC_Bench_SetRate(&result,"time","SIMC_Thread_GetTimeNs",1,n,(SIMC_Thread_GetTimeNs()-start)*1e-9);
+	SIMC_Bench_Record(&result);
+
+	start = SIMC_Thread_GetTimeNs();
+	for (i = 0; i < n; i++) sink_ticks += SIMC_Time_ReadTicks();
+	SIMC_Bench_SetRate(&result,"time","SIMC_Time_ReadTicks",1,n,(SIMC_Thread_GetTimeNs()-start)*1e-9);
+	SIMC_Bench_Record(&result);
+
+	n = SIMC_Bench_Iterations(200000);
+	start = SIMC_Thread_GetTimeNs();
+	for (i = 0; i < n; i++) sink_double += SIMC_Thread_GetMJDTime();
+	SIMC_Bench_SetRate(&result,"time","SIMC_Thread_GetMJDTime",1,n,(SIMC_Thread_GetTimeNs()-start)*1e-9);
+	SIMC_Bench_Record(&result);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Queue consumer which checks order of values.
+////////////////////////////////////////////////////////////////////////////////
+void Bench_QueueConsumer(BENCH_QUEUE_STATE* state) {
+	int64_t i;
+	for (i = 0; i < state->count; i++) {
+		if (Bench_QueuePop(state->request) != i) state->error = 1;
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Queue worker which sends every value back.
+////////////////////////////////////////////////////////////////////////////////
+void Bench_QueueEcho(BENCH_QUEUE_STATE* state) {
+	int64_t i;
+	for (i = 0; i < state->count; i++) {
+		Bench_QueuePush(state->reply,Bench_QueuePop(state->request));
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Queue throughput (one producer, one consumer) and ping-pong latency.
+////////////////////////////////////////////////////////////////////////////////
+void Bench_Queue() {
+	BENCH_QUEUE_STATE state;
+	SIMC_BENCH_RESULT result;
+	SIMC_THREAD_ID worker;
+	int64_t* samples;
+	int64_t i, start;
+
+	SIMC_Queue_Create(&state.request,BENCH_QUEUE_SIZE,sizeof(int64_t));
+	SIMC_Queue_Create(&state.reply,BENCH_QUEUE_SIZE,sizeof(int64_t));
+
+	//Throughput
+	state.count = SIMC_Bench_Iterations(5000000);
+	state.error = 0;
+	worker = SIMC_Thread_CreateWithName(Bench_QueueConsumer,&state,"Bench_QueueConsumer");
+	start = SIMC_Thread_GetTimeNs();
+	for (i = 0; i < state.count; i++) Bench_QueuePush(state.request,i);
+	SIMC_Thread_WaitFor(worker);
+	SIMC_Bench_SetRate(&result,"queue_spsc","throughput",2,state.count,(SIMC_Thread_GetTimeNs()-start)*1e-9);
+	SIMC_Bench_Record(&result);
+	if (state.error) fprintf(stderr,"queue_spsc: values arrived out of order\n");
+
+	//Round-trip latency
+	state.count = SIMC_Bench_Iterations(200000);
+	samples = (int64_t*)malloc(sizeof(int64_t)*(size_t)state.count);
+	worker = SIMC_Thread_CreateWithName(Bench_QueueEcho,&state,"Bench_QueueEcho");
+	start = SIMC_Thread_GetTimeNs();
+	for (i = 0; i < state.count; i++) {
+		int64_t sent = SIMC_Thread_GetTimeNs();
+		Bench_QueuePush(state.request,i);
+		if (Bench_QueuePop(state.reply) != i) state.error = 1;
+		samples[i] = SIMC_Thread_GetTimeNs() - sent;
+	}
+	SIMC_Thread_WaitFor(worker);
+	SIMC_Bench_SetRate(&result,"queue_spsc","ping_pong",2,state.count,(SIMC_Thread_GetTimeNs()-start)*1e-9);
+	SIMC_Bench_SetLatency(&result,samples,state.count);
+	SIMC_Bench_Record(&result);
+	if (state.error) fprintf(stderr,"queue_spsc: ping-pong reply does not match request\n");
+
+	free(samples);
+	SIMC_Queue_Destroy(state.request);
+	SIMC_Queue_Destroy(state.reply);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Mix of reads and writes under a shared SRW lock.
+////////////////////////////////////////////////////////////////////////////////
+void Bench_SRWWorker(SIMC_BENCH_THREAD* thread) {
+	BENCH_SRW_STATE* state = (BENCH_SRW_STATE*)thread->userdata;
+	int64_t i;
+	volatile int64_t sink = 0;
+	for (i = 0; i < state->operations; i++) {
+		if (SIMC_Bench_Random(&thread->random) < state->write_threshold) {
+			SIMC_SRW_EnterWrite(state->lock);
+			state->values[i % BENCH_SRW_VALUES]++;
+			SIMC_SRW_LeaveWrite(state->lock);
+		} else {
+			int j;
+			int64_t sum = 0;
+			SIMC_SRW_EnterRead(state->lock);
+			for (j = 0; j < BENCH_SRW_VALUES; j++) sum += state->values[j];
+			SIMC_SRW_LeaveRead(state->lock);
+			sink += sum;
+		}
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief SRW lock scaling with number of threads and share of writes.
+////////////////////////////////////////////////////////////////////////////////
+void Bench_SRW() {
+	static const int write_percent[] = { 0, 1, 10, 50 };
+	BENCH_SRW_STATE state;
+	SIMC_BENCH_RESULT result;
+	int threads, w;
+
+	memset(&state,0,sizeof(state));
+	state.lock = SIMC_SRW_Create();
+	state.operations = SIMC_Bench_Iterations(500000);
+	for (w = 0; w < (int)(sizeof(write_percent)/sizeof(write_percent[0])); w++) {
+		for (threads = 1; threads <= SIMC_Bench_Options.max_threads; threads *= 2) {
+			char variant[64];
+			double seconds;
+			state.write_threshold = (uint32_t)(4294967295.0*write_percent[w]/100.0);
+			seconds = SIMC_Bench_RunThreads(threads,Bench_SRWWorker,&state);
+
+			snprintf(variant,sizeof(variant),"write_%d%%",write_percent[w]);
+			SIMC_Bench_SetRate(&result,"srw",variant,threads,state.operations*threads,seconds);
+			SIMC_Bench_Record(&result);
+		}
+	}
+	SIMC_SRW_Destroy(state.lock);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Enter and leave a shared lock.
+////////////////////////////////////////////////////////////////////////////////
+void Bench_LockWorker(SIMC_BENCH_THREAD* thread) {
+	BENCH_LOCK_STATE* state = (BENCH_LOCK_STATE*)thread->userdata;
+	int64_t i;
+	for (i = 0; i < state->operations; i++) {
+		SIMC_Lock_Enter(state->lock);
+		state->counter++;
+		SIMC_Lock_Leave(state->lock);
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Lock enter/leave cost, uncontended and contended.
+////////////////////////////////////////////////////////////////////////////////
+void Bench_Lock() {
+	BENCH_LOCK_STATE state;
+	SIMC_BENCH_RESULT result;
+	int64_t i, n, start;
+	int threads;
+
+	state.lock = SIMC_Lock_Create();
+	state.counter = 0;
+
+	//Uncontended
+	n = SIMC_Bench_Iterations(5000000);
+	start = SIMC_Thread_GetTimeNs();
+	for (i = 0; i < n; i++) {
+		SIMC_Lock_Enter(state.lock);
+		state.counter++;
+		SIMC_Lock_Leave(state.lock);
+	}
+	SIMC_Bench_SetRate(&result,"lock","uncontended",1,n,(SIMC_Thread_GetTimeNs()-start)*1e-9);
+	SIMC_Bench_Record(&result);
+
+	//Contended
+	state.operations = SIMC_Bench_Iterations(500000);
+	for (threads = 2; threads <= SIMC_Bench_Options.max_threads; threads *= 2) {
+		double seconds;
+		state.counter = 0;
+		seconds = SIMC_Bench_RunThreads(threads,Bench_LockWorker,&state);
+		SIMC_Bench_SetRate(&result,"lock","contended",threads,state.operations*threads,seconds);
+		SIMC_Bench_Record(&result);
+		if (state.counter != state.operations*threads) fprintf(stderr,"lock: lost updates\n");
+	}
+
+	//Create and destroy
+	n = SIMC_Bench_Iterations(200000);
+	start = SIMC_Thread_GetTimeNs();
+	for (i = 0; i < n; i++) SIMC_Lock_Destroy(SIMC_Lock_Create());
+	SIMC_Bench_SetRate(&result,"lock","create_destroy",1,n,(SIMC_Thread_GetTimeNs()-start)*1e-9);
+	SIMC_Bench_Record(&result);
+
+	SIMC_Lock_Destroy(state.lock);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Enter and leave a shared inline mutex.
+////////////////////////////////////////////////////////////////////////////////
+void Bench_MutexWorker(SIMC_BENCH_THREAD* thread) {
+	BENCH_LOCK_STATE* state = (BENCH_LOCK_STATE*)thread->userdata;
+	int64_t i;
+	for (i = 0; i < state->operations; i++) {
+		SIMC_Mutex_Enter(&state->mutex);
+		state->counter++;
+		SIMC_Mutex_Leave(&state->mutex);
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Inline mutex enter/leave cost, uncontended and contended.
+////////////////////////////////////////////////////////////////////////////////
+void Bench_Mutex() {
+	BENCH_LOCK_STATE state;
+	SIMC_BENCH_RESULT result;
+	int64_t i, n, start;
+	int threads;
+
+	SIMC_Mutex_Initialize(&state.mutex);
+	state.counter = 0;
+
+	//Uncontended
+	n = SIMC_Bench_Iterations(5000000);
+	start = SIMC_Thread_GetTimeNs();
+	for (i = 0; i < n; i++) {
+		SIMC_Mutex_Enter(&state.mutex);
+		state.counter++;
+		SIMC_Mutex_Leave(&state.mutex);
+	}
+	SIMC_Bench_SetRate(&result,"mutex","uncontended",1,n,(SIMC_Thread_GetTimeNs()-start)*1e-9);
+	SIMC_Bench_Record(&result);
+
+	//Uncontended try-enter
+	start = SIMC_Thread_GetTimeNs();
+	for (i = 0; i < n; i++) {
+		if (SIMC_Mutex_TryEnter(&state.mutex)) {
+			state.counter++;
+			SIMC_Mutex_Leave(&state.mutex);
+		}
+	}
+	SIMC_Bench_SetRate(&result,"mutex","try_enter",1,n,(SIMC_Thread_GetTimeNs()-start)*1e-9);
+	SIMC_Bench_Record(&result);
+
+	//Contended
+	state.operations = SIMC_Bench_Iterations(500000);
+	for (threads = 2; threads <= SIMC_Bench_Options.max_threads; threads *= 2) {
+		double seconds;
+		state.counter = 0;
+		seconds = SIMC_Bench_RunThreads(threads,Bench_MutexWorker,&state);
+		SIMC_Bench_SetRate(&result,"mutex","contended",threads,state.operations*threads,seconds);
+		SIMC_Bench_Record(&result);
+		if (state.counter != state.operations*threads) fprintf(stderr,"mutex: lost updates\n");
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Empty thread function.
+////////////////////////////////////////////////////////////////////////////////
+void Bench_EmptyThread(void* userdata) {
+	(void)userdata;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Thread create and join cost.
+////////////////////////////////////////////////////////////////////////////////
+void Bench_Thread() {
+	SIMC_BENCH_RESULT result;
+	int64_t* samples;
+	int64_t i, n = SIMC_Bench_Iterations(2000);
+	int64_t start;
+
+	samples = (int64_t*)malloc(sizeof(int64_t)*(size_t)n);
+	start = SIMC_Thread_GetTimeNs();
+	for (i = 0; i < n; i++) {
+		int64_t created = SIMC_Thread_GetTimeNs();
+		SIMC_Thread_WaitFor(SIMC_Thread_CreateWithName(Bench_EmptyThread,0,"Bench_EmptyThread"));
+		samples[i] = SIMC_Thread_GetTimeNs() - created;
+	}
+	SIMC_Bench_SetRate(&result,"thread","create_join",1,n,(SIMC_Thread_GetTimeNs()-start)*1e-9);
+	SIMC_Bench_SetLatency(&result,samples,n);
+	SIMC_Bench_Record(&result);
+	free(samples);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Linked list append, iterate and remove.
+////////////////////////////////////////////////////////////////////////////////
+void Bench_List() {
+	static const int sizes[] = { 16, 1024, 65536 };
+	SIMC_BENCH_RESULT result;
+	int s, multithreaded;
+
+	for (multithreaded = 0; multithreaded <= 1; multithreaded++) {
+		for (s = 0; s < (int)(sizeof(sizes)/sizeof(sizes[0])); s++) {
+			SIMC_LIST* list;
+			SIMC_LIST_ENTRY* entry;
+			char variant[64];
+			int64_t i, n = sizes[s];
+			int64_t repeats = SIMC_Bench_Iterations(1000000)/n;
+			int64_t r, start, append_time = 0, iterate_time = 0, remove_time = 0;
+			volatile intptr_t sink = 0;
+			if (repeats < 1) repeats = 1;
+
+			for (r = 0; r < repeats; r++) {
+				SIMC_List_Create(&list,multithreaded);
+
+				start = SIMC_Thread_GetTimeNs();
+				for (i = 0; i < n; i++) SIMC_List_Append(list,(void*)(intptr_t)i);
+				append_time += SIMC_Thread_GetTimeNs() - start;
+
+				start = SIMC_Thread_GetTimeNs();
+				entry = SIMC_List_GetFirst(list);
+				while (entry) {
+					sink += (intptr_t)SIMC_List_GetData(list,entry);
+					entry = SIMC_List_GetNext(list,entry);
+				}
+				iterate_time += SIMC_Thread_GetTimeNs() - start;
+
+				start = SIMC_Thread_GetTimeNs();
+				entry = SIMC_List_GetFirst(list);
+				while (entry) {
+					SIMC_List_Remove(list,entry);
+					entry = SIMC_List_GetFirst(list);
+				}
+				remove_time += SIMC_Thread_GetTimeNs() - start;
+
+				SIMC_List_Destroy(list);
+			}
+
+			snprintf(variant,sizeof(variant),"append_%s_%d",multithreaded ? "mt" : "st",sizes[s]);
+			SIMC_Bench_SetRate(&result,"list",variant,1,n*repeats,append_time*1e-9);
+			SIMC_Bench_Record(&result);
+			snprintf(variant,sizeof(variant),"iterate_%s_%d",multithreaded ? "mt" : "st",sizes[s]);
+			SIMC_Bench_SetRate(&result,"list",variant,1,n*repeats,iterate_time*1e-9);
+			SIMC_Bench_Record(&result);
+			snprintf(variant,sizeof(variant),"remove_%s_%d",multithreaded ? "mt" : "st",sizes[s]);
+			SIMC_Bench_SetRate(&result,"list",variant,1,n*repeats,remove_time*1e-9);
+			SIMC_Bench_Record(&result);
+		}
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Storage array add, get and export.
+////////////////////////////////////////////////////////////////////////////////
+void Bench_StorageArray() {
+	static const int sizes[] = { 1024, 65536, 1048576 };
+	SIMC_BENCH_RESULT result;
+	int s;
+
+	for (s = 0; s < (int)(sizeof(sizes)/sizeof(sizes[0])); s++) {
+		SIMC_STORAGEARRAY* arr;
+		char variant[64];
+		int64_t i, n = sizes[s];
+		int64_t repeats = SIMC_Bench_Iterations(2000000)/n;
+		int64_t r, start, add_time = 0, get_time = 0, export_time = 0;
+		uint32_t random = 12345;
+		volatile int64_t sink = 0;
+		if (repeats < 1) repeats = 1;
+
+		for (r = 0; r < repeats; r++) {
+			void* data;
+			SIMC_StorageArray_Create(&arr,sizeof(int64_t)*4);
+
+			start = SIMC_Thread_GetTimeNs();
+			for (i = 0; i < n; i++) *((int64_t*)SIMC_StorageArray_Add(arr)) = i;
+			add_time += SIMC_Thread_GetTimeNs() - start;
+
+			start = SIMC_Thread_GetTimeNs();
+			for (i = 0; i < n; i++) {
+				sink += *((int64_t*)SIMC_StorageArray_Get(arr,(int)(SIMC_Bench_Random(&random) % n)));
+			}
+			get_time += SIMC_Thread_GetTimeNs() - start;
+
+			start = SIMC_Thread_GetTimeNs();
+			data = SIMC_StorageArray_GetAllAndDestroy(arr);
+			export_time += SIMC_Thread_GetTimeNs() - start;
+			SIMC_Free(SIMC_Userdata,data);
+		}
+
+		snprintf(variant,sizeof(variant),"add_%d",sizes[s]);
+		SIMC_Bench_SetRate(&result,"storage_array",variant,1,n*repeats,add_time*1e-9);
+		SIMC_Bench_Record(&result);
+		snprintf(variant,sizeof(variant),"get_random_%d",sizes[s]);
+		SIMC_Bench_SetRate(&result,"storage_array",variant,1,n*repeats,get_time*1e-9);
+		SIMC_Bench_Record(&result);
+		snprintf(variant,sizeof(variant),"export_%d",sizes[s]);
+		SIMC_Bench_SetRate(&result,"storage_array",variant,1,n*repeats,export_time*1e-9);
+		SIMC_Bench_Record(&result);
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Benchmark SIMC primitives and write results as CSV or JSON.
+////////////////////////////////////////////////////////////////////////////////
+int main(int argc, char** argv) {
+	int i;
+	for (i = 1; i < argc; i++) {
+		if (!SIMC_Bench_ParseOption(argv[i])) {
+			SIMC_Bench_PrintUsage(argv[0]);
+			fprintf(stderr,"Benchmarks: time, queue_spsc, srw, lock, mutex, thread, list, storage_array\n");
+			return 1;
+		}
+	}
+	if (SIMC_Bench_Options.max_threads <= 0) SIMC_Bench_Options.max_threads = SIMC_Thread_GetNumProcessors();
+	if (SIMC_Bench_Options.max_threads <= 0) SIMC_Bench_Options.max_threads = 1;
+
+	SIMC_Thread_Initialize();
+	if (SIMC_Bench_Enabled("time")) Bench_Time();
+	if (SIMC_Bench_Enabled("queue_spsc")) Bench_Queue();
+	if (SIMC_Bench_Enabled("srw")) Bench_SRW();
+	if (SIMC_Bench_Enabled("lock")) Bench_Lock();
+	if (SIMC_Bench_Enabled("mutex")) Bench_Mutex();
+	if (SIMC_Bench_Enabled("thread")) Bench_Thread();
+	if (SIMC_Bench_Enabled("list")) Bench_List();
+	if (SIMC_Bench_Enabled("storage_array")) Bench_StorageArray();
+	SIMC_Thread_Deinitialize();
+
+	return SIMC_Bench_WriteResults();
+}
@@ -0,0 +1,406 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file
+////////////////////////////////////////////////////////////////////////////////
+/// Copyright (C) 2012-2015, Black Phoenix
+///
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the GNU Lesser General Public License as published by the Free Software
+/// Foundation; either version 2 of the License, or (at your option) any later
+/// version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+/// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+/// details.
+///
+/// You should have received a copy of the GNU Lesser General Public License along with
+/// this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+/// Place - Suite 330, Boston, MA  02111-1307, USA.
+///
+/// Further information about the GNU Lesser General Public License can also be found on
+/// the world wide web at http://www.gnu.org.
+////////////////////////////////////////////////////////////////////////////////
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include "sim_bench.h"
+#include "sim_xml.h"
+
+//Deepest nesting of generated objects
+#define BENCH_XML_MAX_DEPTH			8
+//Numeric attributes of every generated object
+#define BENCH_XML_ATTRIBUTES		12
+//Largest number of sizes on command line
+#define BENCH_XML_MAX_SIZES			16
+
+//Names of numeric attributes
+static const char* Bench_XML_AttributeNames[BENCH_XML_ATTRIBUTES] = {
+	"x", "y", "z", "vx", "vy", "vz", "mass", "ixx", "iyy", "izz", "q0", "q1"
+};
+//Range of values of numeric attributes
+static const double Bench_XML_AttributeScales[BENCH_XML_ATTRIBUTES] = {
+	1e7, 1e7, 1e7, 1e4, 1e4, 1e4, 1e5, 1e3, 1e3, 1e3, 2.0, 2.0
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Benchmark state
+////////////////////////////////////////////////////////////////////////////////
+typedef struct BENCH_XML_GENERATOR_TAG {
+	FILE* file;
+	int64_t written;					//Bytes written so far
+	int64_t target;						//Size of the file to generate
+	uint32_t random;
+	int64_t objects;					//Number of objects written
+} BENCH_XML_GENERATOR;
+
+typedef struct BENCH_XML_OBJECT_TAG {
+	double values[BENCH_XML_ATTRIBUTES];
+} BENCH_XML_OBJECT;
+
+typedef struct BENCH_XML_ELEMENTS_TAG {
+	SIMC_XML_ELEMENT** elements;
+	int count;
+	int capacity;
+} BENCH_XML_ELEMENTS;
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Random number in range [0..1).
+////////////////////////////////////////////////////////////////////////////////
+double Bench_XML_Random(BENCH_XML_GENERATOR* generator) {
+	return (SIMC_Bench_Random(&generator->random) >> 8)*(1.0/16777216.0);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Write generated object and its children.
+////////////////////////////////////////////////////////////////////////////////
+void Bench_XML_WriteObject(BENCH_XML_GENERATOR* generator, int depth) {
+	static const char* types[] = { "rigid_body", "fuel_tank", "rocket_engine", "wing", "gimbal", "sensor" };
+	FILE* file = generator->file;
+	int i, children;
+
+	//Object with many numeric attributes
+	generator->written += fprintf(file,"%*s<object name=\"object_%lld\" type=\"%s\"",depth+1,"",
+		(long long)generator->objects++,types[SIMC_Bench_Random(&generator->random) % 6]);
+	for (i = 0; i < BENCH_XML_ATTRIBUTES; i++) {
+		generator->written += fprintf(file," %s=\"%.9g\"",Bench_XML_AttributeNames[i],
+			(Bench_XML_Random(generator)-0.5)*Bench_XML_AttributeScales[i]);
+	}
+	generator->written += fprintf(file,">\n");
+
+	//Parameters
+	generator->written += fprintf(file,"%*s<parameter name=\"fuel_mass\">%.6f</parameter>\n",depth+2,"",
+		Bench_XML_Random(generator)*1e4);
+	generator->written += fprintf(file,"%*s<parameter name=\"material\">aluminium_%u</parameter>\n",depth+2,"",
+		SIMC_Bench_Random(&generator->random) % 32);
+
+	//Large text array in every fourth object
+	if ((generator->objects % 4) == 0) {
+		int count = 64 + SIMC_Bench_Random(&generator->random) % 448;
+		generator->written += fprintf(file,"%*s<data name=\"thrust_curve\">",depth+2,"");
+		for (i = 0; i < count; i++) {
+			generator->written += fprintf(file,(i % 8) ? " %.6g" : "\n%.6g",Bench_XML_Random(generator)*1e5);
+		}
+		generator->written += fprintf(file,"</data>\n");
+	}
+
+	//Nested objects (wide near the top, deep below)
+	if (depth < BENCH_XML_MAX_DEPTH) {
+		children = SIMC_Bench_Random(&generator->random) % 4;
+		if (depth < 2) children += 2;
+		for (i = 0; (i < children) && (generator->written < generator->target); i++) {
+			Bench_XML_WriteObject(generator,depth+1);
+		}
+	}
+	generator->written += fprintf(file,"%*s</object>\n",depth+1,"");
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Generate model-like XML file of approximately the given size.
+///
+/// @returns Size of the file in bytes (0 if file could not be written)
+////////////////////////////////////////////////////////////////////////////////
+int64_t Bench_XML_Generate(const char* filename, int64_t size) {
+	BENCH_XML_GENERATOR generator;
+	memset(&generator,0,sizeof(generator));
+	generator.file = fopen(filename,"wb");
+	if (!generator.file) return 0;
+	generator.target = size;
+	generator.random = 0x12345678;
+
+	generator.written += fprintf(generator.file,"<?xml version=\"1.0\"?>\n<EVDS version=\"31\">\n");
+	while (generator.written < generator.target) Bench_XML_WriteObject(&generator,0);
+	generator.written += fprintf(generator.file,"</EVDS>\n");
+	fclose(generator.file);
+	return generator.written;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Read whole file into a null-terminated string.
+////////////////////////////////////////////////////////////////////////////////
+char* Bench_XML_ReadFile(const char* filename) {
+	FILE* file = fopen(filename,"rb");
+	char* data;
+	long size;
+	if (!file) return 0;
+	fseek(file,0,SEEK_END);
+	size = ftell(file);
+	fseek(file,0,SEEK_SET);
+	data = (char*)malloc(size+1);
+	if (data && (fread(data,1,size,file) != (size_t)size)) {
+		free(data);
+		data = 0;
+	}
+	if (data) data[size] = 0;
+	fclose(file);
+	return data;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Collect all object elements nested in the element.
+////////////////////////////////////////////////////////////////////////////////
+void Bench_XML_CollectObjects(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* element, BENCH_XML_ELEMENTS* objects) {
+	SIMC_XML_ELEMENT* nested = 0;
+	while ((SIMC_XML_Iterate(xmldoc,element,&nested,"object") == SIMC_OK) && nested) {
+		if (objects->count == objects->capacity) {
+			objects->capacity = objects->capacity ? objects->capacity*2 : 1024;
+			objects->elements = (SIMC_XML_ELEMENT**)realloc(objects->elements,sizeof(SIMC_XML_ELEMENT*)*objects->capacity);
+		}
+		objects->elements[objects->count++] = nested;
+		Bench_XML_CollectObjects(xmldoc,nested,objects);
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Record loading or saving speed in MB/s.
+////////////////////////////////////////////////////////////////////////////////
+void Bench_XML_RecordSpeed(const char* name, const char* variant, int64_t bytes, int64_t repeats, double seconds) {
+	SIMC_BENCH_RESULT result;
+	SIMC_Bench_SetRate(&result,name,variant,1,repeats,seconds);
+	result.value = (seconds > 0.0) ? (bytes*repeats)/(seconds*1e6) : 0.0;
+	result.unit = "MB/s";
+	SIMC_Bench_Record(&result);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Record peak resident memory since the last reset.
+////////////////////////////////////////////////////////////////////////////////
+void Bench_XML_RecordMemory(const char* variant) {
+	SIMC_BENCH_RESULT result;
+	SIMC_Bench_SetRate(&result,"xml_peak_rss",variant,1,1,0.0);
+	result.value = SIMC_Bench_GetPeakMemory()/1e6;
+	result.unit = "MB";
+	SIMC_Bench_Record(&result);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Open a document in one of the ways being measured.
+////////////////////////////////////////////////////////////////////////////////
+int Bench_XML_Open(int method, const char* filename, const char* string, SIMC_XML_DOCUMENT** xmldoc) {
+	switch (method) {
+		case 0: return SIMC_XML_Open(filename,xmldoc,0,0);
+		case 1: return SIMC_XML_OpenString(string,xmldoc,0,0);
+		default: return SIMC_XML_OpenMapped(filename,xmldoc,0,0);
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Run all measurements on a generated file of the given size.
+////////////////////////////////////////////////////////////////////////////////
+void Bench_XML_Size(int64_t size, int keep) {
+	static const char* methods[] = { "SIMC_XML_Open", "SIMC_XML_OpenString", "SIMC_XML_OpenMapped" };
+	static const SIMC_XML_BINDING_FIELD fields[BENCH_XML_ATTRIBUTES+1] = {
+		{ "x",    SIMC_XML_BIND_DOUBLE, offsetof(BENCH_XML_OBJECT,values[0]),  0 },
+		{ "y",    SIMC_XML_BIND_DOUBLE, offsetof(BENCH_XML_OBJECT,values[1]),  0 },
+		{ "z",    SIMC_XML_BIND_DOUBLE, offsetof(BENCH_XML_OBJECT,values[2]),  0 },
+		{ "vx",   SIMC_XML_BIND_DOUBLE, offsetof(BENCH_XML_OBJECT,values[3]),  0 },
+		{ "vy",   SIMC_XML_BIND_DOUBLE, offsetof(BENCH_XML_OBJECT,values[4]),  0 },
+		{ "vz",   SIMC_XML_BIND_DOUBLE, offsetof(BENCH_XML_OBJECT,values[5]),  0 },
+		{ "mass", SIMC_XML_BIND_DOUBLE, offsetof(BENCH_XML_OBJECT,values[6]),  0 },
+		{ "ixx",  SIMC_XML_BIND_DOUBLE, offsetof(BENCH_XML_OBJECT,values[7]),  0 },
+		{ "iyy",  SIMC_XML_BIND_DOUBLE, offsetof(BENCH_XML_OBJECT,values[8]),  0 },
+		{ "izz",  SIMC_XML_BIND_DOUBLE, offsetof(BENCH_XML_OBJECT,values[9]),  0 },
+		{ "q0",   SIMC_XML_BIND_DOUBLE, offsetof(BENCH_XML_OBJECT,values[10]), 0 },
+		{ "q1",   SIMC_XML_BIND_DOUBLE, offsetof(BENCH_XML_OBJECT,values[11]), 0 },
+		{ 0 }
+	};
+	SIMC_XML_DOCUMENT* xmldoc;
+	SIMC_XML_ELEMENT* root;
+	SIMC_XML_BINDING* binding;
+	SIMC_XML_ATOM atoms[BENCH_XML_ATTRIBUTES];
+	BENCH_XML_ELEMENTS objects;
+	BENCH_XML_OBJECT object;
+	SIMC_BENCH_RESULT result;
+	char filename[256], saved_filename[256], variant[64];
+	char* string;
+	int64_t bytes, repeats, r, start;
+	double sum = 0.0;
+	int i, j, m;
+
+	//Generate input
+	snprintf(filename,sizeof(filename),"simc_bench_xml_%lld.xml",(long long)(size >> 20));
+	snprintf(saved_filename,sizeof(saved_filename),"simc_bench_xml_%lld_saved.xml",(long long)(size >> 20));
+	bytes = Bench_XML_Generate(filename,size);
+	string = bytes ? Bench_XML_ReadFile(filename) : 0;
+	if (!string) {
+		fprintf(stderr,"Could not generate %s\n",filename);
+		return;
+	}
+	repeats = SIMC_Bench_Iterations(256*1024*1024)/bytes;
+	if (repeats < 1) repeats = 1;
+
+	//Loading speed and peak memory
+	for (m = 0; m < 3; m++) {
+		int error = SIMC_OK;
+		snprintf(variant,sizeof(variant),"%s_%lldMB",methods[m],(long long)(size >> 20));
+		SIMC_Bench_ResetPeakMemory();
+		start = SIMC_Thread_GetTimeNs();
+		for (r = 0; r < repeats; r++) {
+			error = Bench_XML_Open(m,filename,string,&xmldoc);
+			if (error) break;
+			SIMC_XML_Close(xmldoc);
+		}
+		if (error) {
+			fprintf(stderr,"%s failed on %s (error %d)\n",methods[m],filename,error);
+			continue;
+		}
+		Bench_XML_RecordSpeed("xml_load",variant,bytes,repeats,(SIMC_Thread_GetTimeNs()-start)*1e-9);
+		Bench_XML_RecordMemory(variant);
+	}
+
+	//Attribute lookups
+	if (SIMC_XML_Open(filename,&xmldoc,0,0) != SIMC_OK) {
+		free(string);
+		return;
+	}
+	memset(&objects,0,sizeof(objects));
+	SIMC_XML_GetRootElement(xmldoc,&root,"EVDS");
+	if (root) Bench_XML_CollectObjects(xmldoc,root,&objects);
+	repeats = SIMC_Bench_Iterations(2000000)/(objects.count+1);
+	if (repeats < 1) repeats = 1;
+
+	snprintf(variant,sizeof(variant),"by_name_%lldMB",(long long)(size >> 20));
+	start = SIMC_Thread_GetTimeNs();
+	for (r = 0; r < repeats; r++) {
+		for (i = 0; i < objects.count; i++) {
+			for (j = 0; j < BENCH_XML_ATTRIBUTES; j++) {
+				double value;
+				SIMC_XML_GetAttributeDouble(xmldoc,objects.elements[i],Bench_XML_AttributeNames[j],&value);
+				sum += value;
+			}
+		}
+	}
+	SIMC_Bench_SetRate(&result,"xml_attribute",variant,1,repeats*objects.count*BENCH_XML_ATTRIBUTES,
+		(SIMC_Thread_GetTimeNs()-start)*1e-9);
+	SIMC_Bench_Record(&result);
+
+	snprintf(variant,sizeof(variant),"by_atom_%lldMB",(long long)(size >> 20));
+	for (j = 0; j < BENCH_XML_ATTRIBUTES; j++) SIMC_XML_GetAtom(xmldoc,Bench_XML_AttributeNames[j],&atoms[j]);
+	start = SIMC_Thread_GetTimeNs();
+	for (r = 0; r < repeats; r++) {
+		for (i = 0; i < objects.count; i++) {
+			for (j = 0; j < BENCH_XML_ATTRIBUTES; j++) {
+				double value;
+				SIMC_XML_GetAttributeDoubleAtom(xmldoc,objects.elements[i],atoms[j],&value);
+				sum += value;
+			}
+		}
+	}
+	SIMC_Bench_SetRate(&result,"xml_attribute",variant,1,repeats*objects.count*BENCH_XML_ATTRIBUTES,
+		(SIMC_Thread_GetTimeNs()-start)*1e-9);
+	SIMC_Bench_Record(&result);
+
+	snprintf(variant,sizeof(variant),"binding_%lldMB",(long long)(size >> 20));
+	SIMC_XML_Binding_Compile(fields,&binding);
+	start = SIMC_Thread_GetTimeNs();
+	for (r = 0; r < repeats; r++) {
+		for (i = 0; i < objects.count; i++) {
+			SIMC_XML_Bind(xmldoc,objects.elements[i],binding,&object);
+			sum += object.values[0];
+		}
+	}
+	SIMC_Bench_SetRate(&result,"xml_attribute",variant,1,repeats*objects.count*BENCH_XML_ATTRIBUTES,
+		(SIMC_Thread_GetTimeNs()-start)*1e-9);
+	SIMC_Bench_Record(&result);
+	SIMC_XML_Binding_Destroy(binding);
+	if (sum == 0.0) fprintf(stderr,"xml_attribute: no values were read\n");
+
+	//Saving speed
+	repeats = SIMC_Bench_Iterations(128*1024*1024)/bytes;
+	if (repeats < 1) repeats = 1;
+
+	snprintf(variant,sizeof(variant),"SIMC_XML_SaveString_%lldMB",(long long)(size >> 20));
+	start = SIMC_Thread_GetTimeNs();
+	for (r = 0; r < repeats; r++) {
+		char* description;
+		if (SIMC_XML_SaveString(xmldoc,&description) != SIMC_OK) break;
+		if (r == 0) bytes = (int64_t)strlen(description);
+		SIMC_Free(SIMC_Userdata,description);
+	}
+	Bench_XML_RecordSpeed("xml_save",variant,bytes,repeats,(SIMC_Thread_GetTimeNs()-start)*1e-9);
+
+	snprintf(variant,sizeof(variant),"SIMC_XML_Save_%lldMB",(long long)(size >> 20));
+	start = SIMC_Thread_GetTimeNs();
+	for (r = 0; r < repeats; r++) {
+		if (SIMC_XML_Save(xmldoc,saved_filename) != SIMC_OK) break;
+	}
+	Bench_XML_RecordSpeed("xml_save",variant,bytes,repeats,(SIMC_Thread_GetTimeNs()-start)*1e-9);
+
+	SIMC_XML_Close(xmldoc);
+	free(objects.elements);
+	free(string);
+	if (!keep) {
+		remove(filename);
+		remove(saved_filename);
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Benchmark XML loading, attribute access and saving on generated files.
+////////////////////////////////////////////////////////////////////////////////
+int main(int argc, char** argv) {
+	int sizes[BENCH_XML_MAX_SIZES] = { 1, 8, 64 };
+	int size_count = 3;
+	int keep = 0;
+	int i;
+
+	for (i = 1; i < argc; i++) {
+		if (SIMC_Bench_ParseOption(argv[i])) continue;
+		if (strncmp(argv[i],"--sizes=",8) == 0) {
+			const char* p = argv[i]+8;
+			size_count = 0;
+			while (*p && (size_count < BENCH_XML_MAX_SIZES)) {
+				sizes[size_count] = atoi(p);
+				if (sizes[size_count] > 0) size_count++;
+				while (*p && (*p != ',')) p++;
+				if (*p == ',') p++;
+			}
+		} else if (strcmp(argv[i],"--keep") == 0) {
+			keep = 1;
+		} else {
+			SIMC_Bench_PrintUsage(argv[0]);
+			fprintf(stderr,"  --sizes=1,8,64     Sizes of generated files in megabytes\n");
+			fprintf(stderr,"  --keep             Do not delete generated files\n");
+			fprintf(stderr,"Benchmarks: xml_load, xml_peak_rss, xml_attribute, xml_save\n");
+			return 1;
+		}
+	}
+
+	SIMC_Thread_Initialize();
+	for (i = 0; i < size_count; i++) {
+		if (SIMC_Bench_Enabled("xml")) Bench_XML_Size((int64_t)sizes[i] << 20,keep);
+	}
+	SIMC_Thread_Deinitialize();
+
+	return SIMC_Bench_WriteResults();
+}
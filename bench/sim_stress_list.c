@@ -0,0 +1,442 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file
+////////////////////////////////////////////////////////////////////////////////
+/// Copyright (C) 2012-2015, Black Phoenix
+///
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the GNU Lesser General Public License as published by the Free Software
+/// Foundation; either version 2 of the License, or (at your option) any later
+/// version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+/// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+/// details.
+///
+/// You should have received a copy of the GNU Lesser General Public License along with
+/// this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+/// Place - Suite 330, Boston, MA  02111-1307, USA.
+///
+/// Further information about the GNU Lesser General Public License can also be found on
+/// the world wide web at http://www.gnu.org.
+////////////////////////////////////////////////////////////////////////////////
+#include <stdlib.h>
+#include <string.h>
+#include "sim_bench.h"
+
+//Marks item which is still in the list
+#define STRESS_LIST_MAGIC			0x5157A11EU
+//Latency samples kept per thread (reservoir sampling beyond that)
+#define STRESS_LIST_MAX_SAMPLES		65536
+//Number of invariant violations printed in full
+#define STRESS_LIST_MAX_REPORTS		16
+
+//Operation types
+#define STRESS_LIST_READ			0
+#define STRESS_LIST_APPEND			1
+#define STRESS_LIST_REMOVE			2
+#define STRESS_LIST_OPERATIONS		3
+
+//Names of operation types
+static const char* Stress_List_OperationNames[STRESS_LIST_OPERATIONS] = { "read", "append", "remove" };
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Stress test state
+////////////////////////////////////////////////////////////////////////////////
+typedef struct STRESS_LIST_ITEM_TAG {
+	uint32_t magic;						//STRESS_LIST_MAGIC while item is in the list
+	int appender;						//Index of thread which appended the item
+	int64_t sequence;					//Sequence number within the appender
+} STRESS_LIST_ITEM;
+
+typedef struct STRESS_LIST_SAMPLES_TAG {
+	int64_t samples[STRESS_LIST_MAX_SAMPLES];
+	int64_t count;						//Samples stored
+	int64_t operations;					//Operations measured
+	int64_t max_ns;						//Slowest operation (may not be among stored samples)
+} STRESS_LIST_SAMPLES;
+
+typedef struct STRESS_LIST_THREAD_TAG {
+	STRESS_LIST_SAMPLES* latency;		//Latency of this threads operation type
+	int64_t* last_sequence;				//Last sequence number seen from every appender
+	int64_t visited;					//Entries visited by a reader
+} STRESS_LIST_THREAD;
+
+typedef struct STRESS_LIST_TAG {
+	SIMC_LIST* list;
+	int readers;
+	int appenders;
+	int removers;
+	int64_t max_size;					//Appenders wait while list is this long
+	int64_t duration_ns;				//Time every thread runs for
+
+	int64_t length;						//Current length of the list (atomic)
+	int64_t appended;					//Items appended in total (atomic)
+	int64_t removed;					//Items removed in total (atomic)
+	int64_t errors;						//Invariant violations (atomic)
+
+	STRESS_LIST_THREAD threads[SIMC_BENCH_MAX_THREADS];
+} STRESS_LIST;
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Report violation of a list invariant.
+////////////////////////////////////////////////////////////////////////////////
+void Stress_List_Error(STRESS_LIST* stress, const char* message, SIMC_LIST_ENTRY* entry) {
+	int64_t errors = SIMC_BENCH_ATOMIC_ADD(&stress->errors,1);
+	if (errors < STRESS_LIST_MAX_REPORTS) {
+		fprintf(stderr,"Invariant violated: %s (entry %p)\n",message,(void*)entry);
+	} else if (errors == STRESS_LIST_MAX_REPORTS) {
+		fprintf(stderr,"Too many invariant violations, further ones are not reported\n");
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Remember latency of one operation.
+///
+/// Once the buffer is full, samples are replaced at random so the stored samples
+/// remain representative for the whole run (reservoir sampling).
+////////////////////////////////////////////////////////////////////////////////
+void Stress_List_AddSample(STRESS_LIST_SAMPLES* latency, uint32_t* random, int64_t time_ns) {
+	if (time_ns > latency->max_ns) latency->max_ns = time_ns;
+	latency->operations++;
+	if (latency->count < STRESS_LIST_MAX_SAMPLES) {
+		latency->samples[latency->count++] = time_ns;
+	} else {
+		int64_t index = (((int64_t)SIMC_Bench_Random(random) << 16) ^ SIMC_Bench_Random(random)) % latency->operations;
+		if (index < STRESS_LIST_MAX_SAMPLES) latency->samples[index] = time_ns;
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Check item stored in the list entry.
+////////////////////////////////////////////////////////////////////////////////
+STRESS_LIST_ITEM* Stress_List_CheckItem(STRESS_LIST* stress, SIMC_LIST_ENTRY* entry) {
+	STRESS_LIST_ITEM* item = (STRESS_LIST_ITEM*)SIMC_List_GetData(stress->list,entry);
+	if (!item) {
+		Stress_List_Error(stress,"entry without data",entry);
+		return 0;
+	}
+	if (item->magic != STRESS_LIST_MAGIC) {
+		Stress_List_Error(stress,"item was removed but is still reachable",entry);
+		return 0;
+	}
+	if ((item->appender < 0) || (item->appender >= stress->appenders)) {
+		Stress_List_Error(stress,"item has corrupted appender index",entry);
+		return 0;
+	}
+	return item;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Walk the whole list in one direction and validate its structure.
+///
+/// Checks that links between neighbours agree with each other, that the walk ends
+/// at the other end of the list, that only live items are reachable, and that
+/// items of every appender appear in the order they were appended.
+///
+/// @returns Number of entries visited
+////////////////////////////////////////////////////////////////////////////////
+int64_t Stress_List_Walk(STRESS_LIST* stress, STRESS_LIST_THREAD* state, int forward) {
+	SIMC_LIST* list = stress->list;
+	SIMC_LIST_ENTRY* entry;
+	SIMC_LIST_ENTRY* previous = 0;
+	int64_t visited = 0;
+	int i;
+
+	for (i = 0; i < stress->appenders; i++) state->last_sequence[i] = forward ? -1 : INT64_MAX;
+
+	entry = forward ? SIMC_List_GetFirst(list) : SIMC_List_GetLast(list);
+	while (entry) {
+		STRESS_LIST_ITEM* item = Stress_List_CheckItem(stress,entry);
+		SIMC_LIST_ENTRY* next = forward ? entry->next : entry->previous;
+		SIMC_LIST_ENTRY* back = forward ? entry->previous : entry->next;
+
+		//Structure
+		if (back != previous) Stress_List_Error(stress,"link to neighbour does not match walk",entry);
+		if (!previous && (entry != (forward ? list->first : list->last))) {
+			Stress_List_Error(stress,"walk did not start at the end of the list",entry);
+		}
+		if (!next && (entry != (forward ? list->last : list->first))) {
+			Stress_List_Error(stress,"walk did not finish at the end of the list",entry);
+		}
+
+		//Order of items from one appender
+		if (item) {
+			int64_t* last = &state->last_sequence[item->appender];
+			if (forward ? (item->sequence <= *last) : (item->sequence >= *last)) {
+				Stress_List_Error(stress,"items of one appender are out of order",entry);
+			}
+			*last = item->sequence;
+		}
+
+		visited++;
+		previous = entry;
+		entry = forward ? SIMC_List_GetNext(list,entry) : SIMC_List_GetPrevious(list,entry);
+	}
+	return visited;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Reader thread: walk the list forward and backward.
+////////////////////////////////////////////////////////////////////////////////
+void Stress_List_Reader(SIMC_BENCH_THREAD* thread, STRESS_LIST* stress, STRESS_LIST_THREAD* state) {
+	int64_t deadline = SIMC_Thread_GetTimeNs() + stress->duration_ns;
+	int64_t start, now = 0;
+
+	while (now < deadline) {
+		start = SIMC_Thread_GetTimeNs();
+		state->visited += Stress_List_Walk(stress,state,SIMC_Bench_Random(&thread->random) & 1);
+		now = SIMC_Thread_GetTimeNs();
+		Stress_List_AddSample(state->latency,&thread->random,now-start);
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Appender thread: append numbered items while list is not too long.
+////////////////////////////////////////////////////////////////////////////////
+void Stress_List_Appender(SIMC_BENCH_THREAD* thread, STRESS_LIST* stress, STRESS_LIST_THREAD* state, int appender) {
+	int64_t deadline = SIMC_Thread_GetTimeNs() + stress->duration_ns;
+	int64_t start, now = 0;
+	int64_t sequence = 0;
+
+	while (now < deadline) {
+		STRESS_LIST_ITEM* item;
+		if (SIMC_BENCH_ATOMIC_ADD(&stress->length,0) >= stress->max_size) {
+			SIMC_Thread_Sleep(0.0);
+			now = SIMC_Thread_GetTimeNs();
+			continue;
+		}
+
+		item = (STRESS_LIST_ITEM*)malloc(sizeof(STRESS_LIST_ITEM));
+		item->magic = STRESS_LIST_MAGIC;
+		item->appender = appender;
+		item->sequence = sequence++;
+
+		start = SIMC_Thread_GetTimeNs();
+		SIMC_List_Append(stress->list,item);
+		now = SIMC_Thread_GetTimeNs();
+		Stress_List_AddSample(state->latency,&thread->random,now-start);
+
+		SIMC_BENCH_ATOMIC_ADD(&stress->length,1);
+		SIMC_BENCH_ATOMIC_ADD(&stress->appended,1);
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Remover thread: remove an item at a random position.
+///
+/// The iterator is advanced a random number of entries from either end and the
+/// entry it stops at is removed, which also terminates the iterator.
+////////////////////////////////////////////////////////////////////////////////
+void Stress_List_Remover(SIMC_BENCH_THREAD* thread, STRESS_LIST* stress, STRESS_LIST_THREAD* state) {
+	int64_t deadline = SIMC_Thread_GetTimeNs() + stress->duration_ns;
+	int64_t start, now = 0;
+
+	while (now < deadline) {
+		SIMC_LIST_ENTRY* entry;
+		STRESS_LIST_ITEM* item;
+		int64_t length = SIMC_BENCH_ATOMIC_ADD(&stress->length,0);
+		int64_t skip;
+		int forward = SIMC_Bench_Random(&thread->random) & 1;
+		if (length == 0) {
+			SIMC_Thread_Sleep(0.0);
+			now = SIMC_Thread_GetTimeNs();
+			continue;
+		}
+		skip = SIMC_Bench_Random(&thread->random) % length;
+
+		start = SIMC_Thread_GetTimeNs();
+		entry = forward ? SIMC_List_GetFirst(stress->list) : SIMC_List_GetLast(stress->list);
+		while (entry && (skip > 0)) {
+			entry = forward ? SIMC_List_GetNext(stress->list,entry) : SIMC_List_GetPrevious(stress->list,entry);
+			skip--;
+		}
+		if (!entry) { //Iterator already finished
+			now = SIMC_Thread_GetTimeNs();
+			continue;
+		}
+
+		item = Stress_List_CheckItem(stress,entry);
+		SIMC_List_Remove(stress->list,entry);
+		now = SIMC_Thread_GetTimeNs();
+		Stress_List_AddSample(state->latency,&thread->random,now-start);
+
+		if (item) {
+			item->magic = 0;
+			free(item);
+		}
+		SIMC_BENCH_ATOMIC_ADD(&stress->length,-1);
+		SIMC_BENCH_ATOMIC_ADD(&stress->removed,1);
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Run the role assigned to the thread by its index.
+////////////////////////////////////////////////////////////////////////////////
+void Stress_List_Thread(SIMC_BENCH_THREAD* thread) {
+	STRESS_LIST* stress = (STRESS_LIST*)thread->userdata;
+	STRESS_LIST_THREAD* state = &stress->threads[thread->index];
+
+	if (thread->index < stress->readers) {
+		Stress_List_Reader(thread,stress,state);
+	} else if (thread->index < stress->readers + stress->appenders) {
+		Stress_List_Appender(thread,stress,state,thread->index - stress->readers);
+	} else {
+		Stress_List_Remover(thread,stress,state);
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Record throughput and latency of one operation type.
+////////////////////////////////////////////////////////////////////////////////
+void Stress_List_Report(STRESS_LIST* stress, int operation, int first, int count, double seconds) {
+	SIMC_BENCH_RESULT result;
+	STRESS_LIST_SAMPLES* latency;
+	char name[64], variant[64];
+	int64_t* samples;
+	int64_t sample_count = 0, operations = 0, max_ns = 0;
+	int i;
+	if (count == 0) return;
+
+	//Merge samples from all threads of this type
+	samples = (int64_t*)malloc(sizeof(int64_t)*STRESS_LIST_MAX_SAMPLES*count);
+	for (i = first; i < first+count; i++) {
+		latency = stress->threads[i].latency;
+		memcpy(samples+sample_count,latency->samples,sizeof(int64_t)*latency->count);
+		sample_count += latency->count;
+		operations += latency->operations;
+		if (latency->max_ns > max_ns) max_ns = latency->max_ns;
+	}
+
+	snprintf(name,sizeof(name),"list_stress_%s",Stress_List_OperationNames[operation]);
+	snprintf(variant,sizeof(variant),"%dr_%da_%dx",stress->readers,stress->appenders,stress->removers);
+	SIMC_Bench_SetRate(&result,name,variant,count,operations,seconds);
+	SIMC_Bench_SetLatency(&result,samples,sample_count);
+	result.max_ns = (double)max_ns;
+	SIMC_Bench_Record(&result);
+	free(samples);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Randomized stress test of SIMC_LIST under concurrent mutation.
+///
+/// Runs reader, appender and remover threads against one multithreaded list for a
+/// fixed time, in the way permitted by the list threading contract (see
+/// SIMC_List_Create()). Readers validate list structure on every walk. Afterwards
+/// the list is validated once more and number of entries is compared with the
+/// number of appended and removed items.
+///
+/// Returns non-zero if any invariant was violated.
+////////////////////////////////////////////////////////////////////////////////
+int main(int argc, char** argv) {
+	STRESS_LIST* stress;
+	SIMC_LIST_ENTRY* entry;
+	double duration = 30.0, seconds;
+	int64_t remaining;
+	int i, count, errors;
+
+	stress = (STRESS_LIST*)malloc(sizeof(STRESS_LIST));
+	memset(stress,0,sizeof(STRESS_LIST));
+	stress->readers = 4;
+	stress->appenders = 2;
+	stress->removers = 1;
+	stress->max_size = 10000;
+
+	for (i = 1; i < argc; i++) {
+		if (SIMC_Bench_ParseOption(argv[i])) continue;
+		if (strncmp(argv[i],"--readers=",10) == 0) {
+			stress->readers = atoi(argv[i]+10);
+		} else if (strncmp(argv[i],"--appenders=",12) == 0) {
+			stress->appenders = atoi(argv[i]+12);
+		} else if (strncmp(argv[i],"--removers=",11) == 0) {
+			stress->removers = atoi(argv[i]+11);
+		} else if (strncmp(argv[i],"--max-size=",11) == 0) {
+			stress->max_size = atoi(argv[i]+11);
+		} else if (strncmp(argv[i],"--duration=",11) == 0) {
+			duration = atof(argv[i]+11);
+		} else {
+			SIMC_Bench_PrintUsage(argv[0]);
+			fprintf(stderr,"  --readers=n        Threads walking the list (4 by default)\n");
+			fprintf(stderr,"  --appenders=n      Threads appending to the list (2 by default)\n");
+			fprintf(stderr,"  --removers=n       Threads removing from the list (1 by default)\n");
+			fprintf(stderr,"  --max-size=n       Largest length of the list (10000 by default)\n");
+			fprintf(stderr,"  --duration=s       Time to run for in seconds (30 by default, multiplied by scale)\n");
+			free(stress);
+			return 1;
+		}
+	}
+	if (stress->readers < 0) stress->readers = 0;
+	if (stress->appenders < 0) stress->appenders = 0;
+	if (stress->removers < 0) stress->removers = 0;
+	if (stress->max_size < 1) stress->max_size = 1;
+	count = stress->readers + stress->appenders + stress->removers;
+	if ((count == 0) || (count > SIMC_BENCH_MAX_THREADS)) {
+		fprintf(stderr,"Total number of threads must be between 1 and %d\n",SIMC_BENCH_MAX_THREADS);
+		free(stress);
+		return 1;
+	}
+	if (stress->removers > 1) {
+		fprintf(stderr,"Warning: SIMC_LIST only permits a single remover, expect failures\n");
+	}
+	stress->duration_ns = (int64_t)(duration*SIMC_Bench_Options.scale*1e9);
+
+	//Per-thread state
+	for (i = 0; i < count; i++) {
+		stress->threads[i].latency = (STRESS_LIST_SAMPLES*)malloc(sizeof(STRESS_LIST_SAMPLES));
+		memset(stress->threads[i].latency,0,sizeof(STRESS_LIST_SAMPLES));
+		stress->threads[i].last_sequence = (int64_t*)malloc(sizeof(int64_t)*(stress->appenders+1));
+	}
+
+	//Run the test
+	SIMC_Thread_Initialize();
+	SIMC_List_Create(&stress->list,1);
+	seconds = SIMC_Bench_RunThreads(count,Stress_List_Thread,stress);
+
+	//Final validation in both directions
+	remaining = stress->appended - stress->removed;
+	if (Stress_List_Walk(stress,&stress->threads[0],1) != remaining) {
+		Stress_List_Error(stress,"number of entries does not match appended minus removed",0);
+	}
+	if (Stress_List_Walk(stress,&stress->threads[0],0) != remaining) {
+		Stress_List_Error(stress,"backward walk visited different number of entries",0);
+	}
+	if (stress->length != remaining) {
+		Stress_List_Error(stress,"length counter does not match appended minus removed",0);
+	}
+
+	Stress_List_Report(stress,STRESS_LIST_READ,0,stress->readers,seconds);
+	Stress_List_Report(stress,STRESS_LIST_APPEND,stress->readers,stress->appenders,seconds);
+	Stress_List_Report(stress,STRESS_LIST_REMOVE,stress->readers+stress->appenders,stress->removers,seconds);
+	errors = (int)stress->errors;
+	fprintf(stderr,"%lld appended, %lld removed, %lld remaining, %d invariant violations\n",
+		(long long)stress->appended,(long long)stress->removed,(long long)remaining,errors);
+
+	//Free items still in the list
+	entry = SIMC_List_GetFirst(stress->list);
+	while (entry) {
+		free(SIMC_List_GetData(stress->list,entry));
+		entry = SIMC_List_GetNext(stress->list,entry);
+	}
+	SIMC_List_Destroy(stress->list);
+	SIMC_Thread_Deinitialize();
+
+	for (i = 0; i < count; i++) {
+		free(stress->threads[i].latency);
+		free(stress->threads[i].last_sequence);
+	}
+	free(stress);
+
+	if (SIMC_Bench_WriteResults()) return 1;
+	return errors ? 2 : 0;
+}
@@ -0,0 +1,203 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file
+////////////////////////////////////////////////////////////////////////////////
+/// Copyright (C) 2012-2015, Black Phoenix
+///
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the GNU Lesser General Public License as published by the Free Software
+/// Foundation; either version 2 of the License, or (at your option) any later
+/// version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+/// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+/// details.
+///
+/// You should have received a copy of the GNU Lesser General Public License along with
+/// this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+/// Place - Suite 330, Boston, MA  02111-1307, USA.
+///
+/// Further information about the GNU Lesser General Public License can also be found on
+/// the world wide web at http://www.gnu.org.
+////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim_core.h"
+#include "sim_xml.h"
+
+//Temporary file used for tests which go through the file reader
+#define TEST_XML_FILENAME			"sim_test_xml.tmp"
+
+//Check condition and report failure
+#define TEST_XML_CHECK(condition, detail) \
+	if (!(condition)) { \
+		fprintf(stderr,"FAILED %s:%d: %s (%s)\n",__FILE__,__LINE__,#condition,detail); \
+		Test_XML_Failures++; \
+	}
+
+//Number of failed checks
+static int Test_XML_Failures = 0;
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Parse document from a string, from a file and through the streaming API.
+/// @returns Error code if all three agree, -1 otherwise
+////////////////////////////////////////////////////////////////////////////////
+int Test_XML_Parse(const char* text) {
+	SIMC_XML_STREAM_CALLBACKS callbacks = { 0 };
+	SIMC_XML_DOCUMENT* doc;
+	FILE* f;
+	int string_result, file_result, stream_result;
+
+	string_result = SIMC_XML_OpenString(text,&doc,0,0);
+	if (string_result == SIMC_OK) SIMC_XML_Close(doc);
+
+	f = fopen(TEST_XML_FILENAME,"wb");
+	if (!f) return -1;
+	fwrite(text,1,strlen(text),f);
+	fclose(f);
+	file_result = SIMC_XML_Open(TEST_XML_FILENAME,&doc,0,0);
+	if (file_result == SIMC_OK) SIMC_XML_Close(doc);
+	remove(TEST_XML_FILENAME);
+
+	stream_result = SIMC_XML_StreamString(text,&callbacks,0);
+
+	if ((string_result != file_result) || (string_result != stream_result)) return -1;
+	return string_result;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Comments and declarations which end within the last few bytes of input.
+////////////////////////////////////////////////////////////////////////////////
+void Test_XML_MarkupAtEnd() {
+	static const char* valid[] = {
+		"<a/><!-- -->",
+		"<a/><!---->",
+		"<a/><!-- x -->",
+		"<a/><!X>",
+		"<a/><!a b>",
+		"<a/><!DOCTYPE>",
+		"<a/><![CDATA[]]>",
+		"<!---->\n<a/>",
+		"<!DOCTYPE a><a/><!---->",
+		0
+	};
+	static const char* invalid[] = {
+		"<a/><!",
+		"<a/><!-",
+		"<a/><!--",
+		"<a/><!-- --",
+		"<a/><![CDATA[",
+		"<a/><!X",
+		0
+	};
+	int i;
+
+	for (i = 0; valid[i]; i++) {
+		TEST_XML_CHECK(Test_XML_Parse(valid[i]) == SIMC_OK,valid[i]);
+	}
+	for (i = 0; invalid[i]; i++) {
+		TEST_XML_CHECK(Test_XML_Parse(invalid[i]) == SIMC_ERROR_SYNTAX,invalid[i]);
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Whitespace characters in attribute values survive writing and reading back.
+////////////////////////////////////////////////////////////////////////////////
+void Test_XML_AttributeWhitespace() {
+	static const char* value = "a\tb\nc\rd  e";
+	SIMC_XML_WRITER* writer;
+	SIMC_XML_DOCUMENT* doc;
+	SIMC_XML_ELEMENT* root;
+	char* description = 0;
+	char* resaved = 0;
+	char* text;
+
+	TEST_XML_CHECK(SIMC_XML_Writer_Create(0,&writer) == SIMC_OK,"writer");
+	SIMC_XML_Writer_BeginElement(writer,"a");
+	SIMC_XML_Writer_Attribute(writer,"v",value);
+	TEST_XML_CHECK(SIMC_XML_Writer_Close(writer,&description) == SIMC_OK,"writer");
+	if (!description) return;
+	TEST_XML_CHECK(strstr(description,"a&#x9;b&#xA;c&#xD;d  e") != 0,description);
+
+	TEST_XML_CHECK(SIMC_XML_OpenString(description,&doc,0,0) == SIMC_OK,description);
+	SIMC_Free(SIMC_Userdata,description);
+	if (SIMC_XML_GetRootElement(doc,&root,"a") == SIMC_OK) {
+		TEST_XML_CHECK((SIMC_XML_GetAttribute(doc,root,"v",&text) == SIMC_OK) && (strcmp(text,value) == 0),"read back");
+	} else {
+		TEST_XML_CHECK(0,"root element");
+	}
+
+	//Save the parsed document again
+	TEST_XML_CHECK(SIMC_XML_SaveString(doc,&resaved) == SIMC_OK,"resave");
+	SIMC_XML_Close(doc);
+	if (!resaved) return;
+	TEST_XML_CHECK(strstr(resaved,"a&#x9;b&#xA;c&#xD;d  e") != 0,resaved);
+	SIMC_Free(SIMC_Userdata,resaved);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Attribute predicates tell a missing attribute apart from an empty one.
+////////////////////////////////////////////////////////////////////////////////
+void Test_XML_QueryEmptyAttribute() {
+	static const struct {
+		const char* path;
+		int count;
+	} queries[] = {
+		{ "e[@a]", 2 },
+		{ "e[@a='']", 1 },
+		{ "e[@a='x']", 1 },
+		{ "e/@a", 2 },
+		{ "e[@b]", 0 },
+		{ "e[@b='']", 0 },
+		{ 0, 0 }
+	};
+	SIMC_XML_DOCUMENT* doc;
+	SIMC_XML_ELEMENT* root;
+	int i;
+
+	if (SIMC_XML_OpenString("<r><e a=\"\"/><e/><e a=\"x\"/></r>",&doc,0,0) != SIMC_OK) {
+		TEST_XML_CHECK(0,"document");
+		return;
+	}
+	SIMC_XML_GetRootElement(doc,&root,"r");
+	for (i = 0; queries[i].path; i++) {
+		SIMC_XML_QUERY* query;
+		int count = -1;
+		if (SIMC_XML_Query_Compile(queries[i].path,&query) != SIMC_OK) {
+			TEST_XML_CHECK(0,queries[i].path);
+			continue;
+		}
+		SIMC_XML_Query_All(doc,root,query,0,0,0,&count);
+		TEST_XML_CHECK(count == queries[i].count,queries[i].path);
+		SIMC_XML_Query_Destroy(query);
+	}
+	SIMC_XML_Close(doc);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Run XML regression tests.
+/// @returns Number of failed checks
+////////////////////////////////////////////////////////////////////////////////
+int main(int argc, char** argv) {
+	if (argc > 1) {
+		fprintf(stderr,"Usage: %s\n",argv[0]);
+		return 1;
+	}
+
+	Test_XML_MarkupAtEnd();
+	Test_XML_AttributeWhitespace();
+	Test_XML_QueryEmptyAttribute();
+
+	if (Test_XML_Failures) {
+		fprintf(stderr,"%d checks failed\n",Test_XML_Failures);
+	} else {
+		fprintf(stderr,"All checks passed\n");
+	}
+	return Test_XML_Failures ? 2 : 0;
+}
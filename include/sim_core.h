@@ -1,264 +1,412 @@
-////////////////////////////////////////////////////////////////////////////////
-/// @file
-///
-/// @brief Simulator Core Functions
-////////////////////////////////////////////////////////////////////////////////
-/// Copyright (C) 2012-2015, Black Phoenix
-///
-/// This program is free software; you can redistribute it and/or modify it under
-/// the terms of the GNU Lesser General Public License as published by the Free Software
-/// Foundation; either version 2 of the License, or (at your option) any later
-/// version.
-///
-/// This program is distributed in the hope that it will be useful, but WITHOUT
-/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
-/// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
-/// details.
-///
-/// You should have received a copy of the GNU Lesser General Public License along with
-/// this program; if not, write to the Free Software Foundation, Inc., 59 Temple
-/// Place - Suite 330, Boston, MA  02111-1307, USA.
-///
-/// Further information about the GNU Lesser General Public License can also be found on
-/// the world wide web at http://www.gnu.org.
-////////////////////////////////////////////////////////////////////////////////
-#ifndef SIM_CORE_H
-#define SIM_CORE_H
-#ifdef __cplusplus
-extern "C" {
-#endif
-
-// Required for size_t
-#include <stdint.h>
-
-
-
-
-////////////////////////////////////////////////////////////////////////////////
-// Some macros and forward declarations
-////////////////////////////////////////////////////////////////////////////////
-#ifndef SIMC_DYNAMIC
-#	define SIMC_API
-#else
-#	ifdef SIMC_LIBRARY
-#		define SIMC_API __declspec(dllexport)
-#	else
-#		define SIMC_API __declspec(dllimport)
-#	endif
-#endif
-
-//Forward structure declarations
-typedef struct SIMC_LIST_ENTRY_TAG SIMC_LIST_ENTRY;
-typedef struct SIMC_LIST_TAG SIMC_LIST;
-typedef struct SIMC_STORAGEARRAY_TAG SIMC_STORAGEARRAY;
-typedef struct SIMC_QUEUE_TAG SIMC_QUEUE;
-
-
-
-
-
-
-
-////////////////////////////////////////////////////////////////////////////////
-/// @defgroup SIMC Simulation Core
-/// @brief Basic constants and callbacks
-///
-/// @{
-////////////////////////////////////////////////////////////////////////////////
-
-// Syntax error reading an XML file
-typedef int SIMC_Callback_XMLSyntaxError(void* userdata, const char* error);
-// Allocate memory
-typedef void* SIMC_Callback_Allocate(void* userdata, size_t size);
-// Free memory
-typedef void SIMC_Callback_Free(void* userdata, void* pointer);
-
-// No error
-#define SIMC_OK								0
-// Internal error
-#define SIMC_ERROR_INTERNAL					1
-// Error opening file (file not found or not accessible)
-#define SIMC_ERROR_FILE						2
-// Syntax error in configuration string/file
-#define SIMC_ERROR_SYNTAX					3
-
-////////////////////////////////////////////////////////////////////////////////
-/// @}
-////////////////////////////////////////////////////////////////////////////////
-
-
-
-
-////////////////////////////////////////////////////////////////////////////////
-/// @defgroup SIMC Simulation Core
-/// @brief Basic set of utility functions shared between simulators
-///
-/// @{
-////////////////////////////////////////////////////////////////////////////////
-
-/// Thread handle
-typedef void* SIMC_THREAD_ID;
-/// Library handle
-typedef void* SIMC_LIBRARY_ID;
-/// Lock (critical section/mutex) handle
-typedef void* SIMC_LOCK_ID;
-/// Event handle
-typedef void* SIMC_EVENT_ID;
-/// SRW lock (slim read/write) handle
-typedef void* SIMC_SRW_ID;
-/// Invalid handle for use with SIMC_LOCK_ID, SIMC_SRW_ID, SIMC_THREAD_ID
-#ifdef PLATFORM64
-#	define SIMC_THREAD_BAD_ID ((void*)0xFFFFFFFF)
-#else
-#	define SIMC_THREAD_BAD_ID ((void*)0xFFFFFFFFFFFFFFFF)
-#endif
-
-
-
-// Set allocation functions (required if SIMC is to be used from DLL)
-void SIMC_SetCallbacks(void* userdata, SIMC_Callback_Allocate* OnAllocate, SIMC_Callback_Free* OnFree);
-
-
-
-
-// Warning: in a multi-threaded environment always call "SIMC_List_Stop" after iterating!
-//  This will prevent stalling (iterating through list may lock its elements against removing).
-//  Next/previous functions unlock the previous entry (so if you are iterating through entire
-//   list, then there is no need for "Stop"... it will accept null pointer though).
-// Get first list entry (starts iterating)
-SIMC_API SIMC_LIST_ENTRY* SIMC_List_GetFirst(SIMC_LIST* list);
-// Get last list entry (starts iterating)
-SIMC_API SIMC_LIST_ENTRY* SIMC_List_GetLast(SIMC_LIST* list);
-// Stop iterating
-SIMC_API void SIMC_List_Stop(SIMC_LIST* list, SIMC_LIST_ENTRY* entry);
-// Get next list entry (stops iterating if returns 0)
-SIMC_API SIMC_LIST_ENTRY* SIMC_List_GetNext(SIMC_LIST* list, SIMC_LIST_ENTRY* entry);
-// Get previous list entry (stops iterating if returns 0)
-SIMC_API SIMC_LIST_ENTRY* SIMC_List_GetPrevious(SIMC_LIST* list, SIMC_LIST_ENTRY* entry);
-// Get data from entry
-SIMC_API void* SIMC_List_GetData(SIMC_LIST* list, SIMC_LIST_ENTRY* entry);
-
-
-
-
-// Write to queue (returns false when queue is full)
-SIMC_API void SIMC_Queue_EnterWrite(SIMC_QUEUE* queue, void** p_value);
-// Stop reading from queue
-SIMC_API int SIMC_Queue_LeaveWrite(SIMC_QUEUE* queue);
-// Read from queue (returns false when no value was read)
-SIMC_API int SIMC_Queue_EnterRead(SIMC_QUEUE* queue, void** p_value);
-// Stop reading from queue
-SIMC_API void SIMC_Queue_LeaveRead(SIMC_QUEUE* queue);
-// Peek into queue (returns false when no value was read)
-SIMC_API int SIMC_Queue_Peek(SIMC_QUEUE* queue, void** p_value);
-// Clear queue
-SIMC_API void SIMC_Queue_Clear(SIMC_QUEUE* queue);
-// Gets approximate information about queue state
-SIMC_API void SIMC_Queue_State(SIMC_QUEUE* queue, int* free_slots, int* used_slots);
-
-
-
-
-// Load a library
-SIMC_API SIMC_LIBRARY_ID SIMC_Library_Load(char* library_name);
-// Unload library
-SIMC_API void SIMC_Library_Unload(SIMC_LIBRARY_ID library);
-// Get pointer to a function
-SIMC_API void* SIMC_Library_GetFunction(SIMC_LIBRARY_ID library, char* function_name);
-
-
-
-
-// Get current time
-SIMC_API double SIMC_Thread_GetTime();
-// Get current MJD time
-SIMC_API double SIMC_Thread_GetMJDTime();
-// Wait specific amount of time
-SIMC_API void SIMC_Thread_Sleep(double time);
-
-#ifndef SIMC_SINGLETHREADED
-// Create thread
-//SIMC_API SIMC_THREAD_ID SIMC_Thread_Create(void* funcPtr, void* userData);
-#define SIMC_Thread_Create(funcPtr, userData) SIMC_Thread_CreateWithName(funcPtr, userData, __FUNCTION__ " (" __FILE__ ")" ) 
-// Create thread with a name (displays the thread name in the debugger, if such feature is available)
-SIMC_API SIMC_THREAD_ID SIMC_Thread_CreateWithName(void* funcPtr, void* userData, char* funcName);
-// Get ID of the currently excuted thread
-SIMC_API SIMC_THREAD_ID SIMC_Thread_GetCurrentID();
-// Get unique ID of the currently executed thread (much faster, returns OS handle/ID)
-SIMC_API SIMC_THREAD_ID SIMC_Thread_GetUniqueID();
-// Wait for thread to complete
-SIMC_API int SIMC_Thread_WaitFor(SIMC_THREAD_ID ID);
-// Stop and kill thread
-SIMC_API void SIMC_Thread_Kill(SIMC_THREAD_ID ID);
-// Get total number of processors
-SIMC_API int SIMC_Thread_GetNumProcessors();
-
-// Create new lock
-SIMC_API SIMC_LOCK_ID SIMC_Lock_Create();
-// Destroy lock
-SIMC_API void SIMC_Lock_Destroy(SIMC_LOCK_ID lockID);
-// Enter lock
-SIMC_API SIMC_LOCK_ID SIMC_Lock_Enter(SIMC_LOCK_ID lockID);
-// Try to enter lock
-//SIMC_API int SIMC_Lock_TryEnter(SIMC_LOCK_ID lockID);
-// Leave lock
-SIMC_API void SIMC_Lock_Leave(SIMC_LOCK_ID lockID);
-// Wait for lock to be left
-SIMC_API void SIMC_Lock_WaitFor(SIMC_LOCK_ID lockID);
-
-// Create a new event
-SIMC_API SIMC_EVENT_ID SIMC_Event_Create(char* eventName);
-// Fire event
-SIMC_API void SIMC_Event_Fire(SIMC_EVENT_ID eventID);
-// Reset event
-SIMC_API void SIMC_Event_Reset(SIMC_EVENT_ID eventID);
-// Wait for event to be fired
-SIMC_API int SIMC_Event_WaitFor(SIMC_EVENT_ID eventID, double time);
-
-// Create new slim read/write lock
-SIMC_API SIMC_SRW_ID SIMC_SRW_Create();
-// Destroy SRW lock
-SIMC_API void SIMC_SRW_Destroy(SIMC_SRW_ID srwID);
-// Enter SRW lock for read operation
-SIMC_API void SIMC_SRW_EnterRead(SIMC_SRW_ID srwID);
-// Leave SRW lock (from read operation)
-SIMC_API void SIMC_SRW_LeaveRead(SIMC_SRW_ID srwID);
-// Enter SRW lock for write operation
-SIMC_API void SIMC_SRW_EnterWrite(SIMC_SRW_ID srwID);
-// Leave SRW lock (from write operation)
-SIMC_API void SIMC_SRW_LeaveWrite(SIMC_SRW_ID srwID);
-#else
-//#define SIMC_Thread_Create()				((void)0)
-#define SIMC_Thread_GetCurrentID(x)			((void)0)
-#define SIMC_Thread_WaitFor(x)				((void)0)
-#define SIMC_Thread_Kill(x)					((void)0)
-#define SIMC_Thread_GetNumProcessors()		((void)0)
-
-//#define SIMC_Lock_Create()				((void)0)
-#define SIMC_Lock_Destroy(x)				((void)0)
-#define SIMC_Lock_Enter(x)					((void)0)
-#define SIMC_Lock_Leave(x)					((void)0)
-#define SIMC_Lock_WaitFor(x)				((void)0)
-
-//#define SIMC_SRW_Create()					((void)0)
-#define SIMC_SRW_Destroy(x)					((void)0)
-#define SIMC_SRW_EnterRead(x)				((void)0)
-#define SIMC_SRW_LeaveRead(x)				((void)0)
-#define SIMC_SRW_EnterWrite(x)				((void)0)
-#define SIMC_SRW_LeaveWrite(x)				((void)0)
-#endif
-////////////////////////////////////////////////////////////////////////////////
-/// @}
-////////////////////////////////////////////////////////////////////////////////
-
-
-//If required, include internal functions
-#ifdef SIMC_LIBRARY
-#	include "sim_internal.h"
-#endif
-
-
-#ifdef __cplusplus
-}
-#endif
-#endif
+////////////////////////////////////////////////////////////////////////////////
+/// @file
+///
+/// @brief Simulator Core Functions
+////////////////////////////////////////////////////////////////////////////////
+/// Copyright (C) 2012-2015, Black Phoenix
+///
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the GNU Lesser General Public License as published by the Free Software
+/// Foundation; either version 2 of the License, or (at your option) any later
+/// version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+/// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+/// details.
+///
+/// You should have received a copy of the GNU Lesser General Public License along with
+/// this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+/// Place - Suite 330, Boston, MA  02111-1307, USA.
+///
+/// Further information about the GNU Lesser General Public License can also be found on
+/// the world wide web at http://www.gnu.org.
+////////////////////////////////////////////////////////////////////////////////
+#ifndef SIM_CORE_H
+#define SIM_CORE_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Required for size_t and fixed-size integer types
+#include <stddef.h>
+#include <stdint.h>
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Some macros and forward declarations
+////////////////////////////////////////////////////////////////////////////////
+#ifndef SIMC_DYNAMIC
+#	define SIMC_API
+#else
+#	ifdef SIMC_LIBRARY
+#		define SIMC_API __declspec(dllexport)
+#	else
+#		define SIMC_API __declspec(dllimport)
+#	endif
+#endif
+
+//Forward structure declarations
+typedef struct SIMC_LIST_ENTRY_TAG SIMC_LIST_ENTRY;
+typedef struct SIMC_LIST_TAG SIMC_LIST;
+typedef struct SIMC_STORAGEARRAY_TAG SIMC_STORAGEARRAY;
+typedef struct SIMC_QUEUE_TAG SIMC_QUEUE;
+typedef struct SIMC_RATELIMITER_TAG SIMC_RATELIMITER;
+
+
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @defgroup SIMC Simulation Core
+/// @brief Basic constants and callbacks
+///
+/// @{
+////////////////////////////////////////////////////////////////////////////////
+
+// Syntax error reading an XML file
+typedef int SIMC_Callback_XMLSyntaxError(void* userdata, const char* error);
+// Allocate memory
+typedef void* SIMC_Callback_Allocate(void* userdata, size_t size);
+// Free memory
+typedef void SIMC_Callback_Free(void* userdata, void* pointer);
+
+// No error
+#define SIMC_OK								0
+// Internal error
+#define SIMC_ERROR_INTERNAL					1
+// Error opening file (file not found or not accessible)
+#define SIMC_ERROR_FILE						2
+// Syntax error in configuration string/file
+#define SIMC_ERROR_SYNTAX					3
+
+// Coordinated Universal Time
+#define SIMC_TIME_UTC						0
+// International Atomic Time
+#define SIMC_TIME_TAI						1
+// Terrestrial Time
+#define SIMC_TIME_TT						2
+
+// Chrome trace-event JSON
+#define SIMC_TRACE_FORMAT_JSON				0
+// Compact binary trace format
+#define SIMC_TRACE_FORMAT_BINARY			1
+
+// Lock (critical section/mutex)
+#define SIMC_LOCK_TYPE_MUTEX				0
+// Slim read/write lock
+#define SIMC_LOCK_TYPE_SRW					1
+
+////////////////////////////////////////////////////////////////////////////////
+/// @}
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @defgroup SIMC Simulation Core
+/// @brief Basic set of utility functions shared between simulators
+///
+/// @{
+////////////////////////////////////////////////////////////////////////////////
+
+/// Thread handle
+typedef void* SIMC_THREAD_ID;
+/// Library handle
+typedef void* SIMC_LIBRARY_ID;
+/// Lock (critical section/mutex) handle
+typedef void* SIMC_LOCK_ID;
+/// Event handle
+typedef void* SIMC_EVENT_ID;
+/// SRW lock (slim read/write) handle
+typedef void* SIMC_SRW_ID;
+/// Inline mutex (a single 32-bit word which may be embedded into other structures, zero is unlocked)
+typedef struct SIMC_MUTEX_TAG {
+	volatile int32_t state;		///< 0: unlocked, 1: locked, 2: locked and other threads may be parked
+} SIMC_MUTEX;
+/// Static initializer for SIMC_MUTEX
+#define SIMC_MUTEX_INIT { 0 }
+/// Invalid handle for use with SIMC_LOCK_ID, SIMC_SRW_ID, SIMC_THREAD_ID
+#ifdef PLATFORM64
+#	define SIMC_THREAD_BAD_ID ((void*)0xFFFFFFFF)
+#else
+#	define SIMC_THREAD_BAD_ID ((void*)0xFFFFFFFFFFFFFFFF)
+#endif
+
+/// Lock contention statistics (accumulated per lock name, all times in nanoseconds)
+typedef struct SIMC_LOCK_STATISTICS_TAG {
+	const char* name;			///< Lock name
+	int type;					///< Lock type (SIMC_LOCK_TYPE_MUTEX or SIMC_LOCK_TYPE_SRW)
+	int instances;				///< Number of locks created with this name
+	int64_t acquisitions;		///< Exclusive acquisitions (lock enter, SRW write)
+	int64_t contended;			///< Exclusive acquisitions which had to wait
+	int64_t wait_total;			///< Total time spent waiting for exclusive ownership
+	int64_t wait_max;			///< Longest wait for exclusive ownership
+	int64_t hold_total;			///< Total time exclusive ownership was held
+	int64_t hold_max;			///< Longest time exclusive ownership was held
+	int64_t read_acquisitions;	///< Shared acquisitions (SRW read)
+	int64_t read_contended;		///< Shared acquisitions which had to wait
+	int64_t read_wait_total;	///< Total time spent waiting for shared ownership
+	int64_t read_wait_max;		///< Longest wait for shared ownership
+} SIMC_LOCK_STATISTICS;
+
+
+
+// Set allocation functions (required if SIMC is to be used from DLL)
+void SIMC_SetCallbacks(void* userdata, SIMC_Callback_Allocate* OnAllocate, SIMC_Callback_Free* OnFree);
+
+
+
+
+// Warning: in a multi-threaded environment always call "SIMC_List_Stop" after iterating!
+//  This will prevent stalling (iterating through list may lock its elements against removing).
+//  Next/previous functions unlock the previous entry (so if you are iterating through entire
+//   list, then there is no need for "Stop"... it will accept null pointer though).
+// Get first list entry (starts iterating)
+SIMC_API SIMC_LIST_ENTRY* SIMC_List_GetFirst(SIMC_LIST* list);
+// Get last list entry (starts iterating)
+SIMC_API SIMC_LIST_ENTRY* SIMC_List_GetLast(SIMC_LIST* list);
+// Stop iterating
+SIMC_API void SIMC_List_Stop(SIMC_LIST* list, SIMC_LIST_ENTRY* entry);
+// Get next list entry (stops iterating if returns 0)
+SIMC_API SIMC_LIST_ENTRY* SIMC_List_GetNext(SIMC_LIST* list, SIMC_LIST_ENTRY* entry);
+// Get previous list entry (stops iterating if returns 0)
+SIMC_API SIMC_LIST_ENTRY* SIMC_List_GetPrevious(SIMC_LIST* list, SIMC_LIST_ENTRY* entry);
+// Get data from entry
+SIMC_API void* SIMC_List_GetData(SIMC_LIST* list, SIMC_LIST_ENTRY* entry);
+
+
+
+
+// Write to queue (returns false when queue is full)
+SIMC_API void SIMC_Queue_EnterWrite(SIMC_QUEUE* queue, void** p_value);
+// Stop reading from queue
+SIMC_API int SIMC_Queue_LeaveWrite(SIMC_QUEUE* queue);
+// Read from queue (returns false when no value was read)
+SIMC_API int SIMC_Queue_EnterRead(SIMC_QUEUE* queue, void** p_value);
+// Stop reading from queue
+SIMC_API void SIMC_Queue_LeaveRead(SIMC_QUEUE* queue);
+// Peek into queue (returns false when no value was read)
+SIMC_API int SIMC_Queue_Peek(SIMC_QUEUE* queue, void** p_value);
+// Clear queue
+SIMC_API void SIMC_Queue_Clear(SIMC_QUEUE* queue);
+// Gets approximate information about queue state
+SIMC_API void SIMC_Queue_State(SIMC_QUEUE* queue, int* free_slots, int* used_slots);
+
+
+
+
+// Enable or disable recording of trace events
+SIMC_API void SIMC_Trace_Enable(int enabled);
+// Set number of events in per-thread trace buffers (for buffers created after this call)
+SIMC_API void SIMC_Trace_SetBufferSize(int events);
+// Set name of the current thread in trace output
+SIMC_API void SIMC_Trace_SetThreadName(const char* name);
+// Begin traced scope (name must be a string constant)
+SIMC_API void SIMC_Trace_Begin(const char* name);
+// End traced scope
+SIMC_API void SIMC_Trace_End(const char* name);
+// Record counter value
+SIMC_API void SIMC_Trace_Counter(const char* name, double value);
+// Record instant event
+SIMC_API void SIMC_Trace_Instant(const char* name);
+// Write recorded events to file and clear trace buffers
+SIMC_API int SIMC_Trace_Flush(const char* filename, int format);
+
+
+
+
+// Bind function references inside library when they are first called (RTLD_LAZY, no effect on Windows)
+#define SIMC_LIBRARY_LOAD_LAZY				1
+// Read library file into the file cache before loading it
+#define SIMC_LIBRARY_LOAD_PREFETCH			2
+
+// Library loaded by SIMC_Library_LoadMany or SIMC_Library_LoadAsync (library is null if it could not be loaded)
+typedef void SIMC_Callback_LibraryLoaded(void* userdata, int index, char* library_name, SIMC_LIBRARY_ID library);
+
+// Load a library
+SIMC_API SIMC_LIBRARY_ID SIMC_Library_Load(char* library_name);
+// Load a library with options (SIMC_LIBRARY_LOAD_...)
+SIMC_API SIMC_LIBRARY_ID SIMC_Library_LoadWithFlags(char* library_name, int flags);
+// Load several libraries in parallel (returns number of libraries loaded)
+SIMC_API int SIMC_Library_LoadMany(char** library_names, int count, SIMC_LIBRARY_ID* libraries, int flags,
+								   SIMC_Callback_LibraryLoaded* callback, void* userdata);
+#ifndef SIMC_SINGLETHREADED
+// Start loading several libraries in the background (wait for returned thread to finish)
+SIMC_API SIMC_THREAD_ID SIMC_Library_LoadAsync(char** library_names, int count, SIMC_LIBRARY_ID* libraries, int flags,
+											   SIMC_Callback_LibraryLoaded* callback, void* userdata);
+#endif
+// Unload library
+SIMC_API void SIMC_Library_Unload(SIMC_LIBRARY_ID library);
+// Get pointer to a function
+SIMC_API void* SIMC_Library_GetFunction(SIMC_LIBRARY_ID library, char* function_name);
+// Get pointers to several functions (returns number of functions found)
+SIMC_API int SIMC_Library_GetFunctions(SIMC_LIBRARY_ID library, char** function_names, void** functions, int count);
+
+
+
+
+// Get current time
+SIMC_API double SIMC_Thread_GetTime();
+// Get current time in nanoseconds (monotonic, for measuring time intervals)
+SIMC_API int64_t SIMC_Thread_GetTimeNs();
+// Get current MJD time (UTC)
+SIMC_API double SIMC_Thread_GetMJDTime();
+// Wait specific amount of time
+SIMC_API void SIMC_Thread_Sleep(double time);
+// Wait until specific time (precise, deadline in SIMC_Thread_GetTimeNs time base)
+SIMC_API void SIMC_Thread_SleepUntilNs(int64_t deadline);
+
+// Create rate limiter for a loop with a fixed period (seconds)
+SIMC_API void SIMC_RateLimiter_Create(SIMC_RATELIMITER** p_limiter, double period);
+// Destroy rate limiter
+SIMC_API void SIMC_RateLimiter_Destroy(SIMC_RATELIMITER* limiter);
+// Wait until start of the next period (returns number of periods skipped due to overrun)
+SIMC_API int SIMC_RateLimiter_Wait(SIMC_RATELIMITER* limiter);
+// Restart schedule from current time
+SIMC_API void SIMC_RateLimiter_Reset(SIMC_RATELIMITER* limiter);
+// Change loop period (takes effect from the next period)
+SIMC_API void SIMC_RateLimiter_SetPeriod(SIMC_RATELIMITER* limiter, double period);
+// Get total number of skipped periods
+SIMC_API int64_t SIMC_RateLimiter_GetMissed(SIMC_RATELIMITER* limiter);
+
+// Read fast timestamp counter (TSC if invariant, otherwise monotonic nanoseconds)
+SIMC_API uint64_t SIMC_Time_ReadTicks();
+// Calibrate timestamp counter against monotonic clock (interval in seconds)
+SIMC_API void SIMC_Time_Calibrate(double interval);
+// Get timestamp counter frequency (ticks per second)
+SIMC_API double SIMC_Time_GetTicksFrequency();
+// Convert timestamp counter value to time (same time base as SIMC_Thread_GetTime)
+SIMC_API double SIMC_Time_TicksToSeconds(uint64_t ticks);
+// Convert timestamp counter value to MJD (same scale as SIMC_Thread_GetMJDTime)
+SIMC_API double SIMC_Time_TicksToMJD(uint64_t ticks);
+
+// Get current MJD split into integer day and fraction of day (scale is one of SIMC_TIME_UTC, SIMC_TIME_TAI, SIMC_TIME_TT)
+SIMC_API void SIMC_Time_GetMJD(int scale, int* day, double* fraction);
+// Get TAI-UTC offset (leap seconds) for the given MJD
+SIMC_API int SIMC_Time_GetLeapSeconds(int mjd);
+// Resynchronize MJD time with system real-time clock
+SIMC_API void SIMC_Time_Synchronize();
+
+#ifndef SIMC_SINGLETHREADED
+// Create thread
+//SIMC_API SIMC_THREAD_ID SIMC_Thread_Create(void* funcPtr, void* userData);
+#ifdef _MSC_VER
+#	define SIMC_Thread_Create(funcPtr, userData) SIMC_Thread_CreateWithName(funcPtr, userData, __FUNCTION__ " (" __FILE__ ")" ) 
+#else
+#	define SIMC_Thread_Create(funcPtr, userData) SIMC_Thread_CreateWithName(funcPtr, userData, (char*)__FILE__ )
+#endif
+// Create thread with a name (displays the thread name in the debugger, if such feature is available)
+SIMC_API SIMC_THREAD_ID SIMC_Thread_CreateWithName(void* funcPtr, void* userData, char* funcName);
+// Get ID of the currently excuted thread
+SIMC_API SIMC_THREAD_ID SIMC_Thread_GetCurrentID();
+// Get unique ID of the currently executed thread (much faster, returns OS handle/ID)
+SIMC_API SIMC_THREAD_ID SIMC_Thread_GetUniqueID();
+// Wait for thread to complete
+SIMC_API int SIMC_Thread_WaitFor(SIMC_THREAD_ID ID);
+// Stop and kill thread
+SIMC_API void SIMC_Thread_Kill(SIMC_THREAD_ID ID);
+// Get total number of processors
+SIMC_API int SIMC_Thread_GetNumProcessors();
+
+// Create new lock
+SIMC_API SIMC_LOCK_ID SIMC_Lock_Create();
+// Create new lock with a name (used for lock contention statistics)
+SIMC_API SIMC_LOCK_ID SIMC_Lock_CreateWithName(const char* name);
+// Destroy lock
+SIMC_API void SIMC_Lock_Destroy(SIMC_LOCK_ID lockID);
+// Enter lock
+SIMC_API SIMC_LOCK_ID SIMC_Lock_Enter(SIMC_LOCK_ID lockID);
+// Try to enter lock (returns 1 if lock was entered)
+SIMC_API int SIMC_Lock_TryEnter(SIMC_LOCK_ID lockID);
+// Leave lock
+SIMC_API void SIMC_Lock_Leave(SIMC_LOCK_ID lockID);
+// Wait for lock to be left
+SIMC_API void SIMC_Lock_WaitFor(SIMC_LOCK_ID lockID);
+// Get lock contention statistics (only with SIMC_LOCK_PROFILING, returns total number of records)
+SIMC_API int SIMC_Lock_GetStatistics(SIMC_LOCK_STATISTICS* stats, int max_count);
+// Reset lock contention statistics
+SIMC_API void SIMC_Lock_ResetStatistics();
+// Write lock contention report into a text file
+SIMC_API int SIMC_Lock_SaveStatistics(const char* filename);
+
+// Initialize inline mutex (same as filling it with zeroes)
+SIMC_API void SIMC_Mutex_Initialize(SIMC_MUTEX* mutex);
+// Enter inline mutex (spins for a short time, then parks the thread)
+SIMC_API void SIMC_Mutex_Enter(SIMC_MUTEX* mutex);
+// Try to enter inline mutex (returns 1 if mutex was entered)
+SIMC_API int SIMC_Mutex_TryEnter(SIMC_MUTEX* mutex);
+// Leave inline mutex
+SIMC_API void SIMC_Mutex_Leave(SIMC_MUTEX* mutex);
+
+// Create a new event
+SIMC_API SIMC_EVENT_ID SIMC_Event_Create(char* eventName);
+// Fire event
+SIMC_API void SIMC_Event_Fire(SIMC_EVENT_ID eventID);
+// Reset event
+SIMC_API void SIMC_Event_Reset(SIMC_EVENT_ID eventID);
+// Wait for event to be fired
+SIMC_API int SIMC_Event_WaitFor(SIMC_EVENT_ID eventID, double time);
+
+// Create new slim read/write lock
+SIMC_API SIMC_SRW_ID SIMC_SRW_Create();
+// Create new slim read/write lock with a name (used for lock contention statistics)
+SIMC_API SIMC_SRW_ID SIMC_SRW_CreateWithName(const char* name);
+// Destroy SRW lock
+SIMC_API void SIMC_SRW_Destroy(SIMC_SRW_ID srwID);
+// Enter SRW lock for read operation
+SIMC_API void SIMC_SRW_EnterRead(SIMC_SRW_ID srwID);
+// Leave SRW lock (from read operation)
+SIMC_API void SIMC_SRW_LeaveRead(SIMC_SRW_ID srwID);
+// Enter SRW lock for write operation
+SIMC_API void SIMC_SRW_EnterWrite(SIMC_SRW_ID srwID);
+// Leave SRW lock (from write operation)
+SIMC_API void SIMC_SRW_LeaveWrite(SIMC_SRW_ID srwID);
+#else
+//#define SIMC_Thread_Create()				((void)0)
+#define SIMC_Thread_GetCurrentID(x)			((void)0)
+#define SIMC_Thread_WaitFor(x)				((void)0)
+#define SIMC_Thread_Kill(x)					((void)0)
+#define SIMC_Thread_GetNumProcessors()		((void)0)
+
+//#define SIMC_Lock_Create()				((void)0)
+#define SIMC_Lock_Destroy(x)				((void)0)
+#define SIMC_Lock_Enter(x)					((void)0)
+#define SIMC_Lock_TryEnter(x)				(1)
+#define SIMC_Lock_Leave(x)					((void)0)
+#define SIMC_Lock_WaitFor(x)				((void)0)
+#define SIMC_Lock_GetStatistics(x,y)		(0)
+#define SIMC_Lock_ResetStatistics()			((void)0)
+
+#define SIMC_Mutex_Initialize(x)			((void)0)
+#define SIMC_Mutex_Enter(x)					((void)0)
+#define SIMC_Mutex_TryEnter(x)				(1)
+#define SIMC_Mutex_Leave(x)					((void)0)
+
+//#define SIMC_SRW_Create()					((void)0)
+#define SIMC_SRW_Destroy(x)					((void)0)
+#define SIMC_SRW_EnterRead(x)				((void)0)
+#define SIMC_SRW_LeaveRead(x)				((void)0)
+#define SIMC_SRW_EnterWrite(x)				((void)0)
+#define SIMC_SRW_LeaveWrite(x)				((void)0)
+#endif
+////////////////////////////////////////////////////////////////////////////////
+/// @}
+////////////////////////////////////////////////////////////////////////////////
+
+
+//If required, include internal functions
+#ifdef SIMC_LIBRARY
+#	include "sim_internal.h"
+#endif
+
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -40,6 +40,13 @@ extern "C" {
 #	define alloca _alloca
 #endif
 
+// Thread-local storage
+#ifdef _MSC_VER
+#	define SIMC_THREAD_LOCAL __declspec(thread)
+#else
+#	define SIMC_THREAD_LOCAL __thread
+#endif
+
 // Required for correct memory allocations when loaded from DLL
 extern SIMC_Callback_Allocate* SIMC_Allocate;
 extern SIMC_Callback_Free* SIMC_Free;
@@ -158,6 +165,25 @@ struct SIMC_QUEUE_TAG {
 
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// @ingroup SIMC_UTILS
+/// @struct SIMC_RATELIMITER
+/// @brief Paces a loop to an absolute schedule
+///
+/// Deadlines are computed from the start of the schedule, so the loop rate does
+/// not drift when individual iterations take varying amounts of time.
+////////////////////////////////////////////////////////////////////////////////
+#ifndef DOXYGEN_INTERNAL_STRUCTS
+struct SIMC_RATELIMITER_TAG {
+	int64_t period;		//Loop period (nanoseconds)
+	int64_t deadline;	//Start of the current period (nanoseconds)
+	int64_t missed;		//Total number of skipped periods
+};
+#endif
+
+
+
+
 ////////////////////////////////////////////////////////////////////////////////
 // Internal API
 ////////////////////////////////////////////////////////////////////////////////
@@ -166,7 +192,29 @@ struct SIMC_QUEUE_TAG {
 void SIMC_Thread_Initialize();
 // Deinitialize threading (free resources)
 void SIMC_Thread_Deinitialize();
+
+#ifdef SIMC_LOCK_PROFILING
+// Native lock implementation (public lock API wraps these and collects statistics)
+SIMC_LOCK_ID SIMC_Lock_Internal_Create();
+void SIMC_Lock_Internal_Destroy(SIMC_LOCK_ID lockID);
+SIMC_LOCK_ID SIMC_Lock_Internal_Enter(SIMC_LOCK_ID lockID);
+int SIMC_Lock_Internal_TryEnter(SIMC_LOCK_ID lockID);
+void SIMC_Lock_Internal_Leave(SIMC_LOCK_ID lockID);
+SIMC_SRW_ID SIMC_SRW_Internal_Create();
+void SIMC_SRW_Internal_Destroy(SIMC_SRW_ID srwID);
+void SIMC_SRW_Internal_EnterRead(SIMC_SRW_ID srwID);
+int SIMC_SRW_Internal_TryEnterRead(SIMC_SRW_ID srwID);
+void SIMC_SRW_Internal_LeaveRead(SIMC_SRW_ID srwID);
+void SIMC_SRW_Internal_EnterWrite(SIMC_SRW_ID srwID);
+int SIMC_SRW_Internal_TryEnterWrite(SIMC_SRW_ID srwID);
+void SIMC_SRW_Internal_LeaveWrite(SIMC_SRW_ID srwID);
 #endif
+#endif
+
+// Read system real-time clock (nanoseconds since Unix epoch, UTC)
+int64_t SIMC_Time_Internal_GetRealtime();
+// Get MJD for a moment of time in SIMC_Thread_GetTimeNs() time base
+void SIMC_Time_Internal_GetMJD(int64_t time, int scale, int* day, double* fraction);
 
 // Create new queue
 void SIMC_Queue_Create(SIMC_QUEUE** p_queue, int size, int element_size);
@@ -198,6 +246,18 @@ SIMC_LIST_ENTRY* SIMC_List_Append(SIMC_LIST* list, void* data);
 // Remove data from the list (very slow and halts every other thread, call only inside iterator)
 void SIMC_List_Remove(SIMC_LIST* list, SIMC_LIST_ENTRY* entry);
 
+// Tracing of SIMC internals (compiled out with SIMC_NO_TRACE)
+extern volatile int SIMC_Trace_Enabled;
+#ifndef SIMC_NO_TRACE
+#	define SIMC_TRACE_BEGIN(name)	do { if (SIMC_Trace_Enabled) SIMC_Trace_Begin(name); } while (0)
+#	define SIMC_TRACE_END(name)		do { if (SIMC_Trace_Enabled) SIMC_Trace_End(name); } while (0)
+#	define SIMC_TRACE_INSTANT(name)	do { if (SIMC_Trace_Enabled) SIMC_Trace_Instant(name); } while (0)
+#else
+#	define SIMC_TRACE_BEGIN(name)	((void)0)
+#	define SIMC_TRACE_END(name)		((void)0)
+#	define SIMC_TRACE_INSTANT(name)	((void)0)
+#endif
+
 #ifndef SIMC_SINGLETHREADED
 void SIMC_List_EnterRead(SIMC_LIST* list);
 void SIMC_List_LeaveRead(SIMC_LIST* list);
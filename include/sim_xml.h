@@ -31,9 +31,24 @@ extern "C" {
 typedef void* SIMC_XML_DOCUMENT;
 typedef void* SIMC_XML_ELEMENT;
 typedef void* SIMC_XML_ATTRIBUTE;
+typedef void* SIMC_XML_WRITER;
+typedef void* SIMC_XML_QUERY;
+typedef void* SIMC_XML_BINDING;
+
+/// String view (not null-terminated in general, points into document memory)
+typedef struct SIMC_XML_STRING_TAG {
+	const char* data;
+	size_t length;
+} SIMC_XML_STRING;
+
+/// Interned name (within one document, equal names have equal pointers)
+typedef const char* SIMC_XML_ATOM;
 
 int SIMC_XML_Open(const char* filename, SIMC_XML_DOCUMENT** xmldoc, SIMC_Callback_XMLSyntaxError* syntaxError, void* userdata);
 int SIMC_XML_OpenString(const char* string, SIMC_XML_DOCUMENT** xmldoc, SIMC_Callback_XMLSyntaxError* syntaxError, void* userdata);
+int SIMC_XML_OpenMapped(const char* filename, SIMC_XML_DOCUMENT** xmldoc, SIMC_Callback_XMLSyntaxError* syntaxError, void* userdata);
+int SIMC_XML_OpenCached(const char* filename, const char* cache_filename, SIMC_XML_DOCUMENT** xmldoc, SIMC_Callback_XMLSyntaxError* syntaxError, void* userdata);
+int SIMC_XML_OpenMany(const char** filenames, int count, SIMC_XML_DOCUMENT** xmldocs, int* results, SIMC_Callback_XMLSyntaxError* syntaxError, void* userdata);
 int SIMC_XML_Close(SIMC_XML_DOCUMENT* xmldoc);
 int SIMC_XML_GetRootElement(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT** xmlelement, const char* name);
 int SIMC_XML_GetElement(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlrootelement, SIMC_XML_ELEMENT** xmlelement, const char* name);
@@ -47,17 +62,118 @@ int SIMC_XML_GetFirstAttribute(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmle
 int SIMC_XML_IterateAttributes(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ATTRIBUTE* xmlattribute, SIMC_XML_ATTRIBUTE** xmlnested_attribute);
 int SIMC_XML_GetAttributeText(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ATTRIBUTE* xmlattribute, char** value);
 int SIMC_XML_GetAttributeName(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ATTRIBUTE* xmlattribute, char** value);
+int SIMC_XML_GetAttributeView(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, const char* name, SIMC_XML_STRING* value);
+int SIMC_XML_GetTextView(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, SIMC_XML_STRING* value);
+int SIMC_XML_GetNameView(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, SIMC_XML_STRING* value);
+int SIMC_XML_GetTextDoubleArray(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, double* values, int max_count, int* count);
+int SIMC_XML_GetTextIntArray(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, int* values, int max_count, int* count);
+
+int SIMC_XML_GetAtom(SIMC_XML_DOCUMENT* xmldoc, const char* name, SIMC_XML_ATOM* atom);
+int SIMC_XML_GetElementAtom(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlrootelement, SIMC_XML_ELEMENT** xmlelement, SIMC_XML_ATOM atom);
+int SIMC_XML_IterateAtom(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, SIMC_XML_ELEMENT** xmlnested_element, SIMC_XML_ATOM atom);
+int SIMC_XML_GetAttributeViewAtom(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, SIMC_XML_ATOM atom, SIMC_XML_STRING* value);
+int SIMC_XML_GetAttributeIntAtom(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, SIMC_XML_ATOM atom, int* value);
+int SIMC_XML_GetAttributeDoubleAtom(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, SIMC_XML_ATOM atom, double* value);
+
+int SIMC_XML_Freeze(SIMC_XML_DOCUMENT* xmldoc);
+int SIMC_XML_GetChildren(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, SIMC_XML_ELEMENT*** xmlchildren, int* count);
+
+int SIMC_XML_Query_Compile(const char* path, SIMC_XML_QUERY** xmlquery);
+int SIMC_XML_Query_Destroy(SIMC_XML_QUERY* xmlquery);
+int SIMC_XML_Query_First(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, SIMC_XML_QUERY* xmlquery, SIMC_XML_ELEMENT** xmlresult, SIMC_XML_STRING* value);
+int SIMC_XML_Query_All(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, SIMC_XML_QUERY* xmlquery, SIMC_XML_ELEMENT** xmlresults, SIMC_XML_STRING* values, int max_count, int* count);
+
+// Field is a double
+#define SIMC_XML_BIND_DOUBLE	0
+// Field is a float
+#define SIMC_XML_BIND_FLOAT		1
+// Field is an int
+#define SIMC_XML_BIND_INT		2
+// Field is a const char* pointing into document memory
+#define SIMC_XML_BIND_STRING	3
+
+/// Structure field filled from an attribute (tables are terminated by an entry with null name)
+typedef struct SIMC_XML_BINDING_FIELD_TAG {
+	const char* name;			//Attribute name
+	int type;					//Type of the field (SIMC_XML_BIND_...)
+	size_t offset;				//Offset of the field in structure (offsetof)
+	const char* default_value;	//Value used when attribute is missing (may be null)
+} SIMC_XML_BINDING_FIELD;
+
+int SIMC_XML_Binding_Compile(const SIMC_XML_BINDING_FIELD* fields, SIMC_XML_BINDING** xmlbinding);
+int SIMC_XML_Binding_Destroy(SIMC_XML_BINDING* xmlbinding);
+int SIMC_XML_Bind(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, SIMC_XML_BINDING* xmlbinding, void* object);
+int SIMC_XML_BindArray(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, const char* name, SIMC_XML_BINDING* xmlbinding,
+					   void* objects, size_t stride, int max_count, int* count);
 
 int SIMC_XML_Create(SIMC_XML_DOCUMENT** xmldoc);
 int SIMC_XML_Save(SIMC_XML_DOCUMENT* xmldoc, const char* filename);
 int SIMC_XML_SaveString(SIMC_XML_DOCUMENT* xmldoc, char** description);
+int SIMC_XML_SaveCache(SIMC_XML_DOCUMENT* xmldoc, const char* source_filename, const char* cache_filename);
 int SIMC_XML_AddRootElement(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT** xmlelement, const char* name);
 int SIMC_XML_AddElement(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlrootelement, SIMC_XML_ELEMENT** xmlelement, const char* name);
 int SIMC_XML_AddAttribute(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, const char* name, const char* value);
 int SIMC_XML_AddAttributeDouble(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, const char* name, double value);
 int SIMC_XML_SetText(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, const char* value);
 
+int SIMC_XML_Writer_Create(const char* filename, SIMC_XML_WRITER** xmlwriter);
+int SIMC_XML_Writer_BeginElement(SIMC_XML_WRITER* xmlwriter, const char* name);
+int SIMC_XML_Writer_Attribute(SIMC_XML_WRITER* xmlwriter, const char* name, const char* value);
+int SIMC_XML_Writer_AttributeDouble(SIMC_XML_WRITER* xmlwriter, const char* name, double value);
+int SIMC_XML_Writer_AttributeInt(SIMC_XML_WRITER* xmlwriter, const char* name, int value);
+int SIMC_XML_Writer_Text(SIMC_XML_WRITER* xmlwriter, const char* text);
+int SIMC_XML_Writer_EndElement(SIMC_XML_WRITER* xmlwriter);
+int SIMC_XML_Writer_Close(SIMC_XML_WRITER* xmlwriter, char** description);
+
+// Start of an element (name is null-terminated)
+typedef int SIMC_Callback_XMLStartElement(void* userdata, const char* name, size_t length);
+// Attribute of the last started element
+typedef int SIMC_Callback_XMLAttribute(void* userdata, const char* name, size_t name_length, const char* value, size_t value_length);
+// Text inside the current element (whitespace condensed, entities decoded)
+typedef int SIMC_Callback_XMLText(void* userdata, const char* text, size_t length);
+// End of an element
+typedef int SIMC_Callback_XMLEndElement(void* userdata, const char* name, size_t length);
+
+/// Callbacks for streaming XML reader (any callback may be null)
+typedef struct SIMC_XML_STREAM_CALLBACKS_TAG {
+	SIMC_Callback_XMLStartElement* OnStartElement;
+	SIMC_Callback_XMLAttribute* OnAttribute;
+	SIMC_Callback_XMLText* OnText;
+	SIMC_Callback_XMLEndElement* OnEndElement;
+	SIMC_Callback_XMLSyntaxError* OnSyntaxError;
+} SIMC_XML_STREAM_CALLBACKS;
+
+int SIMC_XML_Stream(const char* filename, SIMC_XML_STREAM_CALLBACKS* callbacks, void* userdata);
+int SIMC_XML_StreamString(const char* string, SIMC_XML_STREAM_CALLBACKS* callbacks, void* userdata);
+
+// Element in one document paired with an element in the other (see SIMC_XML_Diff for meaning)
+typedef int SIMC_Callback_XMLDiffElement(void* userdata, SIMC_XML_DOCUMENT* old_xmldoc, SIMC_XML_ELEMENT* old_element,
+										 SIMC_XML_DOCUMENT* new_xmldoc, SIMC_XML_ELEMENT* new_element);
+// Value of a matched element changed (old or new value is null if attribute was added or removed)
+typedef int SIMC_Callback_XMLDiffValue(void* userdata, SIMC_XML_ELEMENT* old_element, SIMC_XML_ELEMENT* new_element,
+									   const char* name, const char* old_value, const char* new_value);
+
+/// Callbacks for document comparison (any callback may be null)
+typedef struct SIMC_XML_DIFF_CALLBACKS_TAG {
+	SIMC_Callback_XMLDiffElement* OnElementMatched;
+	SIMC_Callback_XMLDiffElement* OnElementAdded;
+	SIMC_Callback_XMLDiffElement* OnElementRemoved;
+	SIMC_Callback_XMLDiffValue* OnAttributeChanged;
+	SIMC_Callback_XMLDiffValue* OnTextChanged;
+	SIMC_Callback_XMLSyntaxError* OnSyntaxError;
+} SIMC_XML_DIFF_CALLBACKS;
+
+int SIMC_XML_Diff(SIMC_XML_DOCUMENT* old_xmldoc, SIMC_XML_DOCUMENT* new_xmldoc, const char* key_attribute,
+				  SIMC_XML_DIFF_CALLBACKS* callbacks, void* userdata);
+int SIMC_XML_Reload(SIMC_XML_DOCUMENT** xmldoc, const char* filename, const char* key_attribute,
+					SIMC_XML_DIFF_CALLBACKS* callbacks, void* userdata);
+
 #ifdef __cplusplus
 }
 #endif
+
+//If required, include internal functions
+#ifdef SIMC_LIBRARY
+#	include "sim_xml_internal.h"
+#endif
 #endif
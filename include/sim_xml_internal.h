@@ -0,0 +1,267 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file
+///
+/// @brief XML Parsing Core Functions (internal)
+////////////////////////////////////////////////////////////////////////////////
+/// Copyright (C) 2012-2015, Black Phoenix
+///
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the GNU Lesser General Public License as published by the Free Software
+/// Foundation; either version 2 of the License, or (at your option) any later
+/// version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+/// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+/// details.
+///
+/// You should have received a copy of the GNU Lesser General Public License along with
+/// this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+/// Place - Suite 330, Boston, MA  02111-1307, USA.
+///
+/// Further information about the GNU Lesser General Public License can also be found on
+/// the world wide web at http://www.gnu.org.
+////////////////////////////////////////////////////////////////////////////////
+#ifndef SIM_XML_INTERNAL_H
+#define SIM_XML_INTERNAL_H
+#include <stdio.h>
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+// Read next chunk of input (returns number of bytes read, 0 at end of input, negative on error)
+typedef int SIMC_XML_READ_FUNCTION(void* source, char* buffer, int size);
+
+// Document backed by TinyXML
+#define SIMC_XML_BACKEND_TINYXML	0
+// Document parsed in place by SIMC (arena-allocated nodes)
+#define SIMC_XML_BACKEND_NATIVE		1
+
+// Input file is not compressed
+#define SIMC_XML_COMPRESSION_NONE	0
+// Input file is compressed with gzip
+#define SIMC_XML_COMPRESSION_GZIP	1
+// Input file is compressed with Zstandard (not supported)
+#define SIMC_XML_COMPRESSION_ZSTD	2
+
+// Elements with at least this many attributes get an attribute hash index
+#define SIMC_XML_ATTRIBUTE_INDEX_THRESHOLD	8
+
+// Attribute value was not converted to a number
+#define SIMC_XML_NUMBER_UNKNOWN		0
+// Attribute value is a number
+#define SIMC_XML_NUMBER_VALID		1
+// Attribute value is not a number
+#define SIMC_XML_NUMBER_INVALID		2
+
+
+// State of gzip decompressor
+typedef struct SIMC_XML_INFLATE_TAG SIMC_XML_INFLATE;
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @ingroup SIMC_UTILS
+/// @struct SIMC_XML_ARENA
+/// @brief Bump allocator for document nodes
+///
+/// Memory is allocated in large chunks (through SIMC_Allocate) and is only freed
+/// all at once when the document is closed.
+////////////////////////////////////////////////////////////////////////////////
+#ifndef DOXYGEN_INTERNAL_STRUCTS
+typedef struct SIMC_XML_ARENA_TAG {
+	void* chunks;								//List of all chunks (each starts with pointer to previous)
+	char* pos;									//Free space in current chunk
+	char* end;									//End of current chunk
+	size_t chunk_size;							//Size of next chunk
+} SIMC_XML_ARENA;
+#endif
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @ingroup SIMC_UTILS
+/// @struct SIMC_XML_ATOM_TABLE
+/// @brief Table of interned names of a document
+///
+/// Open-addressing hash table. Every distinct element or attribute name is stored
+/// once, so names can be compared by pointer.
+////////////////////////////////////////////////////////////////////////////////
+#ifndef DOXYGEN_INTERNAL_STRUCTS
+typedef struct SIMC_XML_ATOM_ENTRY_TAG {
+	const char* name;							//Interned name (null-terminated, 0 if slot is empty)
+	size_t length;
+	uint32_t hash;
+} SIMC_XML_ATOM_ENTRY;
+
+typedef struct SIMC_XML_ATOM_TABLE_TAG {
+	SIMC_XML_ATOM_ENTRY* entries;
+	size_t capacity;							//Number of slots (power of two)
+	size_t count;								//Number of used slots
+} SIMC_XML_ATOM_TABLE;
+#endif
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @ingroup SIMC_UTILS
+/// @struct SIMC_XML_NATIVE_ATTRIBUTE
+/// @brief Attribute of a natively parsed element
+////////////////////////////////////////////////////////////////////////////////
+#ifndef DOXYGEN_INTERNAL_STRUCTS
+typedef struct SIMC_XML_NATIVE_ATTRIBUTE_TAG {
+	SIMC_XML_STRING name;						//Attribute name (null-terminated)
+	SIMC_XML_STRING value;						//Attribute value (null-terminated)
+	struct SIMC_XML_NATIVE_ATTRIBUTE_TAG* next;	//Next attribute of the same element
+	double number;								//Value as a number (pre-parsed in cached documents)
+	int number_state;							//Is number valid (SIMC_XML_NUMBER_...)
+} SIMC_XML_NATIVE_ATTRIBUTE;
+#endif
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @ingroup SIMC_UTILS
+/// @struct SIMC_XML_NATIVE_ELEMENT
+/// @brief Element of a natively parsed document
+////////////////////////////////////////////////////////////////////////////////
+#ifndef DOXYGEN_INTERNAL_STRUCTS
+typedef struct SIMC_XML_NATIVE_ELEMENT_TAG {
+	SIMC_XML_STRING name;						//Element name (null-terminated)
+	SIMC_XML_STRING text;						//Text before the first nested element (null-terminated)
+	struct SIMC_XML_NATIVE_ELEMENT_TAG* parent;
+	struct SIMC_XML_NATIVE_ELEMENT_TAG* first_child;
+	struct SIMC_XML_NATIVE_ELEMENT_TAG* last_child;
+	struct SIMC_XML_NATIVE_ELEMENT_TAG* next;	//Next sibling
+	SIMC_XML_NATIVE_ATTRIBUTE* first_attribute;
+	SIMC_XML_NATIVE_ATTRIBUTE* last_attribute;
+	SIMC_XML_NATIVE_ATTRIBUTE** attribute_index;//Attributes hashed by atom (only for elements with many attributes)
+	size_t attribute_count;
+	size_t attribute_index_mask;
+	struct SIMC_XML_NATIVE_ELEMENT_TAG** children;//Child elements in order (only in frozen documents)
+	size_t child_count;
+} SIMC_XML_NATIVE_ELEMENT;
+#endif
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @ingroup SIMC_UTILS
+/// @struct SIMC_XML_DOC
+/// @brief XML document (data behind SIMC_XML_DOCUMENT handle)
+////////////////////////////////////////////////////////////////////////////////
+#ifndef DOXYGEN_INTERNAL_STRUCTS
+typedef struct SIMC_XML_DOC_TAG {
+	int backend;								//Document backend
+	void* tinyxml;								//TinyXML document (TinyXML backend only)
+
+	SIMC_XML_NATIVE_ELEMENT root;				//Document node, top-level elements are its children
+	SIMC_XML_ARENA arena;						//Memory for nodes
+	SIMC_XML_ATOM_TABLE atoms;					//Interned names
+	char* data;									//Document text (parsed in place)
+	size_t data_size;
+	void* mapping;								//File mapping handle (if data is a mapped file)
+	int frozen;									//Document is immutable and has a child index
+} SIMC_XML_DOC;
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Internal API
+////////////////////////////////////////////////////////////////////////////////
+// Parse XML from a writable buffer in place, or from a reader through a sliding window (if read is not null)
+int SIMC_XML_Internal_Parse(char* buffer, size_t size, SIMC_XML_READ_FUNCTION* read, void* source,
+							const char* filename, SIMC_XML_STREAM_CALLBACKS* callbacks, void* userdata);
+// Parse XML file through a sliding window (decompressed on the fly if needed)
+int SIMC_XML_Internal_ParseFile(const char* filename, SIMC_XML_STREAM_CALLBACKS* callbacks, void* userdata);
+// Detect compression of a file by its magic bytes (file is rewound)
+int SIMC_XML_Internal_DetectCompression(FILE* file);
+
+// Start decompressing gzip file
+SIMC_XML_INFLATE* SIMC_XML_Inflate_Create(FILE* file);
+// Decompress next chunk of data
+int SIMC_XML_Inflate_Read(void* source, char* buffer, int size);
+// Free decompressor state (file is not closed)
+void SIMC_XML_Inflate_Destroy(SIMC_XML_INFLATE* inflate);
+
+// Get root element of the document (first top-level element)
+SIMC_XML_ELEMENT* SIMC_XML_Internal_GetDocumentElement(SIMC_XML_DOCUMENT* xmldoc);
+// Find attribute by atom (returns 0 if element does not have it, even as an empty attribute)
+int SIMC_XML_Internal_FindAttributeAtom(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, SIMC_XML_ATOM atom, SIMC_XML_STRING* value);
+
+// Allocate memory from arena (aligned to pointer size)
+void* SIMC_XML_Arena_Allocate(SIMC_XML_ARENA* arena, size_t size);
+// Free all memory allocated from arena
+void SIMC_XML_Arena_Destroy(SIMC_XML_ARENA* arena);
+
+// Map file into memory (copy-on-write) as document data
+int SIMC_XML_Native_MapFile(const char* filename, SIMC_XML_DOC* doc);
+// Create empty natively parsed document
+SIMC_XML_DOC* SIMC_XML_Native_Create();
+// Read whole file into document arena as document data
+int SIMC_XML_Native_ReadFile(const char* filename, SIMC_XML_DOC* doc);
+// Read file into memory (or map it if mapped is set) and parse it in place
+int SIMC_XML_Native_OpenFile(const char* filename, int mapped, SIMC_XML_DOC** p_doc, SIMC_Callback_XMLSyntaxError* syntaxError, void* userdata);
+// Copy string into document arena and parse it in place
+int SIMC_XML_Native_OpenString(const char* string, SIMC_XML_DOC** p_doc, SIMC_Callback_XMLSyntaxError* syntaxError, void* userdata);
+// Open file mapped into memory and parse it in place
+int SIMC_XML_Native_OpenMapped(const char* filename, SIMC_XML_DOC** p_doc, SIMC_Callback_XMLSyntaxError* syntaxError, void* userdata);
+// Close natively parsed document
+void SIMC_XML_Native_Close(SIMC_XML_DOC* doc);
+// Copy string into document arena
+const char* SIMC_XML_Native_CopyString(SIMC_XML_DOC* doc, const char* string, size_t length);
+// Append new element to parent (name is copied into arena if copy is set)
+SIMC_XML_NATIVE_ELEMENT* SIMC_XML_Native_NewElement(SIMC_XML_DOC* doc, SIMC_XML_NATIVE_ELEMENT* parent, const char* name, size_t length, int copy);
+// Append new attribute to element (strings are copied into arena if copy is set)
+SIMC_XML_NATIVE_ATTRIBUTE* SIMC_XML_Native_NewAttribute(SIMC_XML_DOC* doc, SIMC_XML_NATIVE_ELEMENT* element,
+														const char* name, size_t name_length, const char* value, size_t value_length, int copy);
+// Set attribute value or add new attribute (strings are copied into arena)
+SIMC_XML_NATIVE_ATTRIBUTE* SIMC_XML_Native_SetAttribute(SIMC_XML_DOC* doc, SIMC_XML_NATIVE_ELEMENT* element,
+														const char* name, const char* value);
+// Set element text (copied into arena)
+int SIMC_XML_Native_SetText(SIMC_XML_DOC* doc, SIMC_XML_NATIVE_ELEMENT* element, const char* text);
+// Build child index and attribute indexes, mark document as immutable
+int SIMC_XML_Native_Freeze(SIMC_XML_DOC* doc);
+// Find first child element with the given name (any element if name is null)
+SIMC_XML_NATIVE_ELEMENT* SIMC_XML_Native_FindElement(SIMC_XML_DOC* doc, SIMC_XML_NATIVE_ELEMENT* first, const char* name);
+// Find first child element with the given interned name
+SIMC_XML_NATIVE_ELEMENT* SIMC_XML_Native_FindElementAtom(SIMC_XML_NATIVE_ELEMENT* first, SIMC_XML_ATOM atom);
+// Find attribute by name
+SIMC_XML_NATIVE_ATTRIBUTE* SIMC_XML_Native_FindAttribute(SIMC_XML_DOC* doc, SIMC_XML_NATIVE_ELEMENT* element, const char* name);
+// Find attribute by interned name
+SIMC_XML_NATIVE_ATTRIBUTE* SIMC_XML_Native_FindAttributeAtom(SIMC_XML_NATIVE_ELEMENT* element, SIMC_XML_ATOM atom);
+// Build attribute hash index for an element with many attributes
+int SIMC_XML_Native_IndexAttributes(SIMC_XML_DOC* doc, SIMC_XML_NATIVE_ELEMENT* element);
+
+// Find interned name (returns null if name was never interned)
+SIMC_XML_ATOM SIMC_XML_Atom_Find(SIMC_XML_ATOM_TABLE* table, const char* name, size_t length);
+// Intern name (name is copied into arena unless it is a stable null-terminated string)
+SIMC_XML_ATOM SIMC_XML_Atom_Intern(SIMC_XML_ATOM_TABLE* table, SIMC_XML_ARENA* arena, const char* name, size_t length, int copy);
+// Free atom table
+void SIMC_XML_Atom_Destroy(SIMC_XML_ATOM_TABLE* table);
+
+// Write natively parsed document through a streaming writer
+int SIMC_XML_Native_Write(SIMC_XML_DOC* doc, SIMC_XML_WRITER* xmlwriter);
+// Get unique name of a temporary file next to the given file
+void SIMC_XML_Internal_TemporaryName(const char* filename, char* buffer, size_t size);
+// Rename temporary file over the given file (temporary file is removed on failure)
+int SIMC_XML_Internal_ReplaceFile(const char* temporary_filename, const char* filename);
+// Format double as the shortest string which reads back exactly (buffer must hold 32 characters)
+int SIMC_XML_Internal_FormatDouble(char* buffer, double value);
+
+// Parse floating point number (returns pointer after the number)
+const char* SIMC_XML_Internal_ParseDouble(const char* p, const char* end, double* value);
+// Parse integer number (returns pointer after the number)
+const char* SIMC_XML_Internal_ParseInt(const char* p, const char* end, int* value);
+// Parse whitespace-separated array of doubles or integers
+int SIMC_XML_Internal_ParseArray(const char* p, const char* end, void* values, int is_double, int max_count, int* count);
+
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -27,22 +27,19 @@
 #include <time.h>
 
 double SIMC_Thread_TimeRes = 0.0; //resolution
+unsigned __int64 SIMC_Thread_TimeFrequency = 0; //counter frequency
 unsigned __int64 SIMC_Thread_Time64 = 0; //initial time
-int SIMC_Thread_TimeInitialized = 0; //initialized
-double EVDS_T0_MJD; //MJD date
-double EVDS_T0_Time; //MJD time for which date is specified
+INIT_ONCE SIMC_Thread_TimeOnce = INIT_ONCE_STATIC_INIT; //one-time initialization
 
-void SIMC_Thread_Internal_TimeInitialize()
+BOOL CALLBACK SIMC_Thread_Internal_TimeInitialize(PINIT_ONCE once, PVOID parameter, PVOID* context)
 {
-	extern double SIMC_Thread_GetTime();
 	unsigned __int64 frequency;
 	if (QueryPerformanceFrequency((LARGE_INTEGER*)&frequency)) {
 		SIMC_Thread_TimeRes = 1.0 / (double)frequency;
-		SIMC_Thread_TimeInitialized = 1;
+		SIMC_Thread_TimeFrequency = frequency;
 		QueryPerformanceCounter((LARGE_INTEGER*)&SIMC_Thread_Time64);
 	}
-	EVDS_T0_MJD = (time(0) / 86400.0) + 2440587.5 - 2400000.5;;
-	EVDS_T0_Time = SIMC_Thread_GetTime();
+	return TRUE;
 }
 
 
@@ -50,15 +47,16 @@ void SIMC_Thread_Internal_TimeInitialize()
 /// @brief Get precise timer value.
 ///
 /// Uses the most precise timer source available on the current system. Maps to
-/// QueryPerfomanceCounter() under Windows, and gettimeofday() under Unix-like
-/// operating systems.
+/// QueryPerfomanceCounter() under Windows, and clock_gettime() with a monotonic
+/// clock under Unix-like operating systems. The timer is not affected by changes
+/// to the wall clock.
 ///
 /// @returns Precise timer value in seconds (double-precision)
 ////////////////////////////////////////////////////////////////////////////////
 double SIMC_Thread_GetTime()
 {
 	unsigned __int64 t_64;
-	if (!SIMC_Thread_TimeInitialized) SIMC_Thread_Internal_TimeInitialize();
+	InitOnceExecuteOnce(&SIMC_Thread_TimeOnce, SIMC_Thread_Internal_TimeInitialize, 0, 0);
 	if (QueryPerformanceCounter((LARGE_INTEGER*)&t_64)) {
 		return (double)(t_64 - SIMC_Thread_Time64)*SIMC_Thread_TimeRes;
 	} else {
@@ -68,57 +66,523 @@ double SIMC_Thread_GetTime()
 
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief Returns current time and date, in mean julian date format
+/// @brief Get precise timer value in integer nanoseconds.
 ///
-/// Uses time(0) and SIMC_Thread_GetTime() calls to calculate precise MJD date.
-/// Absolute offset between date and real date depends on the computer clock.
+/// Same time source as SIMC_Thread_GetTime(), but does not convert the value into
+/// floating point. Should be used for timing hot code paths, where differences
+/// between two timestamps are taken:
+/// ~~~{.c}
+///		int64_t t0 = SIMC_Thread_GetTimeNs();
+///		...
+///		int64_t dt_ns = SIMC_Thread_GetTimeNs() - t0;
+/// ~~~
 ///
-/// @returns Current date and time in MJD, double precision
+/// @returns Precise timer value in nanoseconds
 ////////////////////////////////////////////////////////////////////////////////
-double SIMC_Thread_GetMJDTime() {
-	return (SIMC_Thread_GetTime() - EVDS_T0_Time)/86400.0 + EVDS_T0_MJD;
+int64_t SIMC_Thread_GetTimeNs()
+{
+	unsigned __int64 t_64;
+	InitOnceExecuteOnce(&SIMC_Thread_TimeOnce, SIMC_Thread_Internal_TimeInitialize, 0, 0);
+	if (QueryPerformanceCounter((LARGE_INTEGER*)&t_64)) {
+		t_64 -= SIMC_Thread_Time64;
+		//Split conversion to avoid overflow of the 64-bit intermediate value
+		return (int64_t)((t_64 / SIMC_Thread_TimeFrequency) * 1000000000ULL +
+		                 ((t_64 % SIMC_Thread_TimeFrequency) * 1000000000ULL) / SIMC_Thread_TimeFrequency);
+	} else {
+		return 0;
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Read system real-time clock (UTC) in nanoseconds since Unix epoch.
+////////////////////////////////////////////////////////////////////////////////
+typedef VOID (WINAPI *SIMC_GETSYSTEMTIME_FUNCTION)(LPFILETIME);
+int64_t SIMC_Time_Internal_GetRealtime() {
+	static SIMC_GETSYSTEMTIME_FUNCTION GetSystemTimeFunction = 0;
+	unsigned __int64 t_64;
+
+	//Use precise system time where available (Windows 8 and newer)
+	if (!GetSystemTimeFunction) {
+		GetSystemTimeFunction = (SIMC_GETSYSTEMTIME_FUNCTION)GetProcAddress(
+			GetModuleHandleA("kernel32.dll"), "GetSystemTimePreciseAsFileTime");
+		if (!GetSystemTimeFunction) GetSystemTimeFunction = GetSystemTimeAsFileTime;
+	}
+	GetSystemTimeFunction((LPFILETIME)&t_64);
+
+	//Convert from 100 ns intervals since 1601-01-01
+	return (int64_t)(t_64 - 116444736000000000ULL)*100;
 }
 
 #else
 
-#include <sys/time.h>
+#include <pthread.h>
 #include <time.h>
 
-double SIMC_Thread_TimeRes = 1.0; //resolution
-long long int SIMC_Thread_Time64 = 0; //initial time
-int SIMC_Thread_TimeInitialized = 0; //initialized
-double EVDS_T0_MJD; //MJD date
-double EVDS_T0_Time; //MJD time for which date is specified
+//Use raw hardware clock (not slewed by NTP) instead of the regular monotonic clock
+//#define SIMC_TIME_MONOTONIC_RAW
+
+clockid_t SIMC_Thread_TimeClock = CLOCK_MONOTONIC; //clock source
+int64_t SIMC_Thread_Time64 = 0; //initial time (nanoseconds)
+pthread_once_t SIMC_Thread_TimeOnce = PTHREAD_ONCE_INIT; //one-time initialization
 
 void SIMC_Thread_Internal_TimeInitialize()
 {
-	extern double SIMC_Thread_GetTime();
-	struct timeval  tv;
+	struct timespec ts;
+
+#if defined(SIMC_TIME_MONOTONIC_RAW) && defined(CLOCK_MONOTONIC_RAW)
+	if (clock_gettime(CLOCK_MONOTONIC_RAW, &ts) == 0) {
+		SIMC_Thread_TimeClock = CLOCK_MONOTONIC_RAW;
+	}
+#endif
 
-	SIMC_Thread_TimeRes = 1e-6; //1 usec resolution
+	clock_gettime(SIMC_Thread_TimeClock, &ts);
+	SIMC_Thread_Time64 = (int64_t)ts.tv_sec*(int64_t)1000000000 + (int64_t)ts.tv_nsec;
+}
 
-	gettimeofday(&tv, 0);
-	SIMC_Thread_Time64 = (long long int)tv.tv_sec*(long long int)1000000 + (long long int) tv.tv_usec;
-	SIMC_Thread_TimeInitialized = 1;
+int64_t SIMC_Thread_GetTimeNs()
+{
+	struct timespec ts;
+	pthread_once(&SIMC_Thread_TimeOnce, SIMC_Thread_Internal_TimeInitialize);
 
-	EVDS_T0_MJD = (time(0) / 86400.0) + 2440587.5 - 2400000.5;;
-	EVDS_T0_Time = SIMC_Thread_GetTime();
+	clock_gettime(SIMC_Thread_TimeClock, &ts);
+	return (int64_t)ts.tv_sec*(int64_t)1000000000 + (int64_t)ts.tv_nsec - SIMC_Thread_Time64;
 }
 
 double SIMC_Thread_GetTime()
 {
-	long long int t0;
-	struct timeval  tv;
-	if (!SIMC_Thread_TimeInitialized) SIMC_Thread_Internal_TimeInitialize();
+	return (double)SIMC_Thread_GetTimeNs()*1e-9;
+}
 
-	gettimeofday(&tv, 0);
-	t0 = (long long int)tv.tv_sec*(long long int)1000000 + (long long int) tv.tv_usec;
+int64_t SIMC_Time_Internal_GetRealtime() {
+	struct timespec ts;
+	clock_gettime(CLOCK_REALTIME, &ts);
+	return (int64_t)ts.tv_sec*(int64_t)1000000000 + (int64_t)ts.tv_nsec;
+}
 
-	return (double)(t0 - SIMC_Thread_Time64)*SIMC_Thread_TimeRes;
+#endif
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// MJD time service
+////////////////////////////////////////////////////////////////////////////////
+#ifdef _WIN32
+#	define SIMC_TIME_BARRIER()	MemoryBarrier()
+#else
+#	define SIMC_TIME_BARRIER()	__sync_synchronize()
+#endif
+
+//MJD of the Unix epoch (1970-01-01)
+#define SIMC_TIME_MJD_UNIX_EPOCH	40587
+//Nanoseconds in one day
+#define SIMC_TIME_NS_PER_DAY		86400000000000LL
+//Offset between TT and TAI (nanoseconds)
+#define SIMC_TIME_TT_TAI			32184000000LL
+
+//Leap seconds: TAI-UTC offset starting from the given MJD (UTC). Must be updated when
+//IERS announces a new leap second (see IERS Bulletin C).
+static const int SIMC_Time_LeapSeconds[][2] = {
+	{ 41317, 10 }, { 41499, 11 }, { 41683, 12 }, { 42048, 13 }, { 42413, 14 },
+	{ 42778, 15 }, { 43144, 16 }, { 43509, 17 }, { 43874, 18 }, { 44239, 19 },
+	{ 44786, 20 }, { 45151, 21 }, { 45516, 22 }, { 46247, 23 }, { 47161, 24 },
+	{ 47892, 25 }, { 48257, 26 }, { 48804, 27 }, { 49169, 28 }, { 49534, 29 },
+	{ 50083, 30 }, { 50630, 31 }, { 51179, 32 }, { 53736, 33 }, { 54832, 34 },
+	{ 56109, 35 }, { 57204, 36 }, { 57754, 37 },
+};
+
+//Synchronization between real-time clock and monotonic timer
+volatile unsigned int SIMC_Time_AnchorSequence = 0; //odd while anchor is being updated
+int64_t SIMC_Time_AnchorRealtime = 0; //real-time clock (ns since Unix epoch, UTC)
+int64_t SIMC_Time_AnchorTime = 0; //SIMC_Thread_GetTimeNs() at the same instant
+
+//Lock serializing anchor writers (statically initialized, readers do not take it)
+#ifdef _WIN32
+SRWLOCK SIMC_Time_AnchorLock = SRWLOCK_INIT;
+#	define SIMC_TIME_ANCHOR_LOCK()		AcquireSRWLockExclusive(&SIMC_Time_AnchorLock)
+#	define SIMC_TIME_ANCHOR_UNLOCK()	ReleaseSRWLockExclusive(&SIMC_Time_AnchorLock)
+#else
+pthread_mutex_t SIMC_Time_AnchorLock = PTHREAD_MUTEX_INITIALIZER;
+#	define SIMC_TIME_ANCHOR_LOCK()		pthread_mutex_lock(&SIMC_Time_AnchorLock)
+#	define SIMC_TIME_ANCHOR_UNLOCK()	pthread_mutex_unlock(&SIMC_Time_AnchorLock)
+#endif
+
+#ifdef _WIN32
+INIT_ONCE SIMC_Time_AnchorOnce = INIT_ONCE_STATIC_INIT;
+BOOL CALLBACK SIMC_Time_Internal_AnchorInitialize(PINIT_ONCE once, PVOID parameter, PVOID* context) {
+	SIMC_Time_Synchronize();
+	return TRUE;
+}
+#	define SIMC_TIME_ANCHOR_INITIALIZE() InitOnceExecuteOnce(&SIMC_Time_AnchorOnce, SIMC_Time_Internal_AnchorInitialize, 0, 0)
+#else
+pthread_once_t SIMC_Time_AnchorOnce = PTHREAD_ONCE_INIT;
+#	define SIMC_TIME_ANCHOR_INITIALIZE() pthread_once(&SIMC_Time_AnchorOnce, SIMC_Time_Synchronize)
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Synchronize MJD time service with the system real-time clock.
+///
+/// MJD time is computed from the monotonic timer, relative to the moment when the
+/// real-time clock was last read. This avoids jumps during the simulation when the
+/// system clock is adjusted. The time service is synchronized automatically on
+/// first use, and may be resynchronized later (for example after the system clock
+/// was corrected by NTP).
+///
+/// Several readings of the real-time clock are taken, and the one which was
+/// bracketed by the closest pair of monotonic timer readings is used.
+///
+/// May be called while other threads are reading time or synchronizing it.
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Time_Synchronize() {
+	int64_t best_window = -1;
+	int64_t best_realtime = 0;
+	int64_t best_time = 0;
+	int i;
+
+	for (i = 0; i < 8; i++) {
+		int64_t t0 = SIMC_Thread_GetTimeNs();
+		int64_t realtime = SIMC_Time_Internal_GetRealtime();
+		int64_t t1 = SIMC_Thread_GetTimeNs();
+		if ((best_window < 0) || (t1 - t0 < best_window)) {
+			best_window = t1 - t0;
+			best_realtime = realtime;
+			best_time = t0 + (t1 - t0)/2;
+		}
+	}
+
+	//Publish new anchor (readers retry while sequence number is odd or changes)
+	SIMC_TIME_ANCHOR_LOCK();
+	SIMC_Time_AnchorSequence++;
+	SIMC_TIME_BARRIER();
+	SIMC_Time_AnchorRealtime = best_realtime;
+	SIMC_Time_AnchorTime = best_time;
+	SIMC_TIME_BARRIER();
+	SIMC_Time_AnchorSequence++;
+	SIMC_TIME_ANCHOR_UNLOCK();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Returns TAI-UTC offset (number of leap seconds) for the given date.
+///
+/// Uses the built-in leap second table, which starts in 1972. Earlier dates return
+/// the 1972 offset of 10 seconds.
+///
+/// @param[in] mjd Date in MJD (UTC)
+/// @returns TAI-UTC in seconds
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_Time_GetLeapSeconds(int mjd) {
+	int count = sizeof(SIMC_Time_LeapSeconds)/sizeof(SIMC_Time_LeapSeconds[0]);
+	int i;
+	for (i = count-1; i > 0; i--) {
+		if (mjd >= SIMC_Time_LeapSeconds[i][0]) break;
+	}
+	return SIMC_Time_LeapSeconds[i][1];
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Get MJD date for the moment of time given in SIMC_Thread_GetTimeNs() time base.
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Time_Internal_GetMJD(int64_t time, int scale, int* day, double* fraction) {
+	unsigned int sequence;
+	int64_t realtime;
+	int64_t mjd_day;
+	int64_t ns_of_day;
+
+	//Read consistent anchor
+	SIMC_TIME_ANCHOR_INITIALIZE();
+	do {
+		sequence = SIMC_Time_AnchorSequence;
+		SIMC_TIME_BARRIER();
+		realtime = SIMC_Time_AnchorRealtime + (time - SIMC_Time_AnchorTime);
+		SIMC_TIME_BARRIER();
+	} while ((sequence & 1) || (sequence != SIMC_Time_AnchorSequence));
+
+	//Split UTC into integer day and time of day (real-time clock does not count leap seconds)
+	mjd_day = realtime / SIMC_TIME_NS_PER_DAY;
+	ns_of_day = realtime % SIMC_TIME_NS_PER_DAY;
+	if (ns_of_day < 0) {
+		ns_of_day += SIMC_TIME_NS_PER_DAY;
+		mjd_day--;
+	}
+	mjd_day += SIMC_TIME_MJD_UNIX_EPOCH;
+
+	//Convert to requested time scale
+	if ((scale == SIMC_TIME_TAI) || (scale == SIMC_TIME_TT)) {
+		ns_of_day += (int64_t)SIMC_Time_GetLeapSeconds((int)mjd_day)*1000000000LL;
+		if (scale == SIMC_TIME_TT) ns_of_day += SIMC_TIME_TT_TAI;
+		while (ns_of_day >= SIMC_TIME_NS_PER_DAY) {
+			ns_of_day -= SIMC_TIME_NS_PER_DAY;
+			mjd_day++;
+		}
+	}
+
+	if (day) *day = (int)mjd_day;
+	if (fraction) *fraction = (double)ns_of_day / (double)SIMC_TIME_NS_PER_DAY;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Returns current date and time in MJD, split into day and fraction of day.
+///
+/// Supported time scales:
+///	- SIMC_TIME_UTC: Coordinated Universal Time
+///	- SIMC_TIME_TAI: International Atomic Time (UTC plus leap seconds)
+///	- SIMC_TIME_TT: Terrestrial Time (TAI + 32.184 seconds)
+///
+/// Date is returned as an integer day number and a fraction of the day, which
+/// keeps sub-microsecond precision that would be lost in a single double-precision
+/// MJD value:
+/// ~~~{.c}
+///		int day;
+///		double fraction;
+///		SIMC_Time_GetMJD(SIMC_TIME_TT, &day, &fraction);
+/// ~~~
+///
+/// Time is derived from the monotonic timer, see SIMC_Time_Synchronize(). During
+/// an inserted leap second the UTC time repeats the last second of the day, as
+/// the system real-time clock does.
+///
+/// @param[in] scale Time scale
+/// @param[out] day Integer MJD day number
+/// @param[out] fraction Fraction of the day, between 0.0 and 1.0
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Time_GetMJD(int scale, int* day, double* fraction) {
+	SIMC_Time_Internal_GetMJD(SIMC_Thread_GetTimeNs(), scale, day, fraction);
 }
 
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Returns current time and date, in mean julian date format
+///
+/// Returns UTC time from SIMC_Time_GetMJD() as a single value. Double precision
+/// limits resolution of the result to about a microsecond for present-day dates;
+/// use SIMC_Time_GetMJD() where more precision is required.
+///
+/// @returns Current date and time in MJD, double precision
+////////////////////////////////////////////////////////////////////////////////
 double SIMC_Thread_GetMJDTime() {
-	return (SIMC_Thread_GetTime() - EVDS_T0_Time)/86400.0 + EVDS_T0_MJD;
+	int day;
+	double fraction;
+	SIMC_Time_GetMJD(SIMC_TIME_UTC, &day, &fraction);
+	return (double)day + fraction;
+}
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Fast timestamp counter
+////////////////////////////////////////////////////////////////////////////////
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#	define SIMC_TIME_TSC
+#	ifdef _MSC_VER
+#		include <intrin.h>
+#	else
+#		include <cpuid.h>
+#		include <x86intrin.h>
+#	endif
+#endif
+#if defined(__linux__)
+#	include <stdio.h>
+#	include <string.h>
+#endif
+
+//Tick counter sources
+#define SIMC_TIME_TICKS_UNKNOWN		0
+#define SIMC_TIME_TICKS_TSC			1
+#define SIMC_TIME_TICKS_MONOTONIC	2
+
+//Default calibration interval (seconds)
+#define SIMC_TIME_CALIBRATION_INTERVAL	0.02
+
+volatile int SIMC_Time_TicksSource = SIMC_TIME_TICKS_UNKNOWN; //current tick counter source
+double SIMC_Time_TicksFrequency = 1e9; //ticks per second
+double SIMC_Time_TicksResolution = 1e-9; //seconds per tick
+uint64_t SIMC_Time_Ticks0 = 0; //tick counter value at calibration time
+double SIMC_Time_Ticks0_Time = 0.0; //SIMC_Thread_GetTime() at calibration time
+
+#ifdef _WIN32
+INIT_ONCE SIMC_Time_TicksOnce = INIT_ONCE_STATIC_INIT;
+BOOL CALLBACK SIMC_Time_Internal_TicksInitialize(PINIT_ONCE once, PVOID parameter, PVOID* context) {
+	//Keep calibration if SIMC_Time_Calibrate() was already called explicitly
+	if (SIMC_Time_TicksSource == SIMC_TIME_TICKS_UNKNOWN) SIMC_Time_Calibrate(SIMC_TIME_CALIBRATION_INTERVAL);
+	return TRUE;
 }
+#	define SIMC_TIME_TICKS_INITIALIZE() InitOnceExecuteOnce(&SIMC_Time_TicksOnce, SIMC_Time_Internal_TicksInitialize, 0, 0)
+#else
+pthread_once_t SIMC_Time_TicksOnce = PTHREAD_ONCE_INIT;
+void SIMC_Time_Internal_TicksInitialize() {
+	//Keep calibration if SIMC_Time_Calibrate() was already called explicitly
+	if (SIMC_Time_TicksSource == SIMC_TIME_TICKS_UNKNOWN) SIMC_Time_Calibrate(SIMC_TIME_CALIBRATION_INTERVAL);
+}
+#	define SIMC_TIME_TICKS_INITIALIZE() pthread_once(&SIMC_Time_TicksOnce, SIMC_Time_Internal_TicksInitialize)
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Check if hardware timestamp counter can be used as a time source.
+///
+/// The counter must be invariant (runs at constant rate in all power states and
+/// is synchronized between cores). Under Linux the check additionally requires
+/// the kernel to trust TSC as its own clock source.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_Time_Internal_IsTSCReliable() {
+#ifdef SIMC_TIME_TSC
+	unsigned int regs[4] = { 0 };
 
+	//Check for invariant TSC (CPUID.80000007H:EDX[8])
+#ifdef _MSC_VER
+	__cpuid((int*)regs, 0x80000000);
+	if (regs[0] < 0x80000007) return 0;
+	__cpuid((int*)regs, 0x80000007);
+#else
+	if (__get_cpuid_max(0x80000000, 0) < 0x80000007) return 0;
+	__get_cpuid(0x80000007, &regs[0], &regs[1], &regs[2], &regs[3]);
+#endif
+	if (!(regs[3] & (1 << 8))) return 0;
+
+#ifdef __linux__
+	{
+		char clocksource[64] = { 0 };
+		FILE* f = fopen("/sys/devices/system/clocksource/clocksource0/current_clocksource","r");
+		if (f) {
+			if (!fgets(clocksource, 63, f)) clocksource[0] = 0;
+			fclose(f);
+			if (strncmp(clocksource, "tsc", 3) != 0) return 0;
+		}
+	}
+#endif
+	return 1;
+#else
+	return 0;
 #endif
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Calibrate fast timestamp counter against the monotonic clock.
+///
+/// Called automatically with a short calibration interval on first use of the
+/// timestamp counter, unless it was already called explicitly. May be called again
+/// with a longer interval for more precise conversion of ticks to seconds.
+/// Recalibration must not be done while other threads are converting ticks.
+///
+/// If hardware counter is not available or is not reliable, the tick counter falls
+/// back to SIMC_Thread_GetTimeNs() (one tick is one nanosecond).
+///
+/// @param[in] interval Calibration interval in seconds
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Time_Calibrate(double interval) {
+	//Make sure the time base is initialized
+	SIMC_Thread_GetTimeNs();
+
+#ifdef SIMC_TIME_TSC
+	if (SIMC_Time_Internal_IsTSCReliable()) {
+		int64_t t0_a, t0_b, t1_a, t1_b, end_time;
+		uint64_t tsc0, tsc1;
+		double frequency;
+
+		//Take first bracketed sample (counter value between two clock readings)
+		t0_a = SIMC_Thread_GetTimeNs();
+		tsc0 = __rdtsc();
+		t0_b = SIMC_Thread_GetTimeNs();
+
+		//Busy-wait for the calibration interval
+		end_time = t0_b + (int64_t)(interval*1e9);
+		while (SIMC_Thread_GetTimeNs() < end_time) ;
+
+		//Take second bracketed sample
+		t1_a = SIMC_Thread_GetTimeNs();
+		tsc1 = __rdtsc();
+		t1_b = SIMC_Thread_GetTimeNs();
+
+		//Compute frequency from midpoints of both samples
+		frequency = (double)(tsc1 - tsc0) / (0.5e-9*(double)((t1_a + t1_b) - (t0_a + t0_b)));
+		if ((tsc1 > tsc0) && (frequency > 1e6)) {
+			SIMC_Time_TicksFrequency = frequency;
+			SIMC_Time_TicksResolution = 1.0 / frequency;
+			SIMC_Time_Ticks0 = tsc1;
+			SIMC_Time_Ticks0_Time = 0.5e-9*(double)(t1_a + t1_b);
+			SIMC_Time_TicksSource = SIMC_TIME_TICKS_TSC;
+			return;
+		}
+	}
+#endif
+
+	//Fall back to monotonic clock
+	SIMC_Time_TicksFrequency = 1e9;
+	SIMC_Time_TicksResolution = 1e-9;
+	SIMC_Time_Ticks0 = 0;
+	SIMC_Time_Ticks0_Time = 0.0;
+	SIMC_Time_TicksSource = SIMC_TIME_TICKS_MONOTONIC;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Read fast timestamp counter.
+///
+/// Returns value of the hardware timestamp counter (RDTSC) when an invariant TSC
+/// is available, otherwise returns SIMC_Thread_GetTimeNs(). This is the cheapest
+/// way to timestamp an event; the value can be converted later:
+/// ~~~{.c}
+///		record->ticks = SIMC_Time_ReadTicks();
+///		...
+///		t = SIMC_Time_TicksToSeconds(record->ticks);
+/// ~~~
+///
+/// @returns Timestamp counter value in ticks
+////////////////////////////////////////////////////////////////////////////////
+uint64_t SIMC_Time_ReadTicks() {
+#ifdef SIMC_TIME_TSC
+	if (SIMC_Time_TicksSource == SIMC_TIME_TICKS_TSC) return __rdtsc();
+	if (SIMC_Time_TicksSource == SIMC_TIME_TICKS_UNKNOWN) {
+		SIMC_TIME_TICKS_INITIALIZE();
+		if (SIMC_Time_TicksSource == SIMC_TIME_TICKS_TSC) return __rdtsc();
+	}
+#endif
+	return (uint64_t)SIMC_Thread_GetTimeNs();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Returns frequency of the timestamp counter.
+/// @returns Number of ticks per second
+////////////////////////////////////////////////////////////////////////////////
+double SIMC_Time_GetTicksFrequency() {
+	SIMC_TIME_TICKS_INITIALIZE();
+	return SIMC_Time_TicksFrequency;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Convert timestamp counter value to time in seconds.
+///
+/// Result uses the same time base as SIMC_Thread_GetTime().
+///
+/// @param[in] ticks Timestamp counter value
+/// @returns Time in seconds
+////////////////////////////////////////////////////////////////////////////////
+double SIMC_Time_TicksToSeconds(uint64_t ticks) {
+	SIMC_TIME_TICKS_INITIALIZE();
+	return (double)(int64_t)(ticks - SIMC_Time_Ticks0)*SIMC_Time_TicksResolution + SIMC_Time_Ticks0_Time;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Convert timestamp counter value to MJD date.
+///
+/// Result uses the same scale as SIMC_Thread_GetMJDTime().
+///
+/// @param[in] ticks Timestamp counter value
+/// @returns Date and time in MJD, double precision
+////////////////////////////////////////////////////////////////////////////////
+double SIMC_Time_TicksToMJD(uint64_t ticks) {
+	int day;
+	double fraction;
+	SIMC_Time_Internal_GetMJD((int64_t)(SIMC_Time_TicksToSeconds(ticks)*1e9), SIMC_TIME_UTC, &day, &fraction);
+	return (double)day + fraction;
+}
@@ -21,19 +21,66 @@
 /// the world wide web at http://www.gnu.org.
 ////////////////////////////////////////////////////////////////////////////////
 #include <stdio.h>
+#include <string.h>
 #include "sim_core.h"
 
 #ifdef _WIN32
 #include <windows.h>
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Read library file into the file cache (returns 0 if file was not found).
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_Library_PrefetchFile(char* library_name, const char* suffix) {
+	HANDLE file;
+	DWORD size;
+	char buffer[65536];
+	char full_name[8193];
+
+	snprintf(full_name, 8192, "%s%s.dll", library_name, suffix);
+	full_name[8192] = 0;
+	file = CreateFileA(full_name, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file == INVALID_HANDLE_VALUE) return 0;
+	while (ReadFile(file, buffer, sizeof(buffer), &size, NULL) && (size > 0)) ;
+	CloseHandle(file);
+	return 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Read library file into the file cache, trying names in load order.
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Library_Prefetch(char* library_name) {
+#ifdef PLATFORM64
+	if (SIMC_Library_PrefetchFile(library_name, "d")) return;
+#else
+	if (SIMC_Library_PrefetchFile(library_name, "_32d")) return;
+	if (SIMC_Library_PrefetchFile(library_name, "_32")) return;
+#endif
+	SIMC_Library_PrefetchFile(library_name, "");
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief Load a library
 ////////////////////////////////////////////////////////////////////////////////
 SIMC_LIBRARY_ID SIMC_Library_Load(char* library_name) {
+	return SIMC_Library_LoadWithFlags(library_name, 0);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Load a library with options (SIMC_LIBRARY_LOAD_...)
+///
+/// Imports of a DLL are always bound when it is loaded, so SIMC_LIBRARY_LOAD_LAZY
+/// has no effect on Windows.
+////////////////////////////////////////////////////////////////////////////////
+SIMC_LIBRARY_ID SIMC_Library_LoadWithFlags(char* library_name, int flags) {
 	HMODULE handle;
 	char full_name[8193];
 
+	if (flags & SIMC_LIBRARY_LOAD_PREFETCH) SIMC_Library_Prefetch(library_name);
+
 #ifdef PLATFORM64
 	snprintf(full_name, 8192, "%sd", library_name);
 #else
@@ -71,8 +118,527 @@ void* SIMC_Library_GetFunction(SIMC_LIBRARY_ID library, char* function_name) {
 	return GetProcAddress(library, function_name);
 }
 
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Get pointers to several functions
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_Library_GetFunctions(SIMC_LIBRARY_ID library, char** function_names, void** functions, int count) {
+	int i, resolved = 0;
+	for (i = 0; i < count; i++) {
+		functions[i] = GetProcAddress(library, function_names[i]);
+		if (functions[i]) resolved++;
+	}
+	return resolved;
+}
+
+#else
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dlfcn.h>
+
+//Initial number of slots in symbol cache
+#define SIMC_LIBRARY_CACHE_SIZE		64
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Internal data structures
+////////////////////////////////////////////////////////////////////////////////
+#ifndef DOXYGEN_INTERNAL_STRUCTS
+typedef struct SIMC_LIBRARY_SYMBOL_TAG {
+	char* name;							//Symbol name (0 if slot is empty)
+	uint32_t hash;
+	void* function;						//Resolved address (0 if symbol was not found)
+} SIMC_LIBRARY_SYMBOL;
+
+typedef struct SIMC_LIBRARY_STATE_TAG {
+	void* handle;						//Handle returned by dlopen()
+#ifndef SIMC_SINGLETHREADED
+	SIMC_SRW_ID lock;					//Lock for symbol cache
+#endif
+	SIMC_LIBRARY_SYMBOL* symbols;		//Open-addressing hash table of resolved symbols
+	size_t capacity;					//Number of slots (power of two)
+	size_t count;						//Number of used slots
+} SIMC_LIBRARY_STATE;
+#endif
+
+
+//Suffixes tried in order when loading a library (debug build first)
+#ifdef PLATFORM64
+static const char* SIMC_Library_Suffixes[] = { "d", "", 0 };
+#else
+static const char* SIMC_Library_Suffixes[] = { "_32d", "_32", "", 0 };
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Get file name of library with the given suffix.
+///
+/// Library name is decorated the way shared libraries are named on Linux: "lib"
+/// is prepended to file name and ".so" is appended (unless already present).
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Library_GetFileName(char* full_name, char* library_name, const char* suffix) {
+	const char* file_name = strrchr(library_name, '/');
+	size_t path_length;
+	int has_prefix, has_extension;
+	size_t length = strlen(library_name);
+
+	file_name = file_name ? file_name+1 : library_name;
+	path_length = file_name - library_name;
+	has_prefix = strncmp(file_name, "lib", 3) == 0;
+	has_extension = (length > 3) && (strcmp(library_name+length-3, ".so") == 0);
+	if (has_extension) length -= 3;
+
+	snprintf(full_name, 8192, "%.*s%s%.*s%s.so",
+		(int)path_length, library_name, has_prefix ? "" : "lib",
+		(int)(length - path_length), file_name, suffix);
+	full_name[8192] = 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Ask the kernel to read library file into page cache, trying names in load order.
+///
+/// Only files which can be found by path (relative to the current directory) are
+/// prefetched, since the search path of the dynamic linker is not known here. The
+/// read-ahead is asynchronous, so this call returns immediately.
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Library_Prefetch(char* library_name) {
+	char full_name[8193];
+	int i, file = -1;
+
+	for (i = 0; SIMC_Library_Suffixes[i] && (file < 0); i++) {
+		SIMC_Library_GetFileName(full_name, library_name, SIMC_Library_Suffixes[i]);
+		file = open(full_name, O_RDONLY);
+	}
+	if (file < 0) file = open(library_name, O_RDONLY);
+	if (file < 0) return;
+#ifdef POSIX_FADV_WILLNEED
+	posix_fadvise(file, 0, 0, POSIX_FADV_WILLNEED);
+#endif
+	close(file);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Load a library
+///
+/// Libraries are searched in the same order as on Windows: debug build of the
+/// library first ("d" suffix, "_32d" for 32-bit platform), then release build
+/// ("_32" suffix for 32-bit platform), then library name as given.
+////////////////////////////////////////////////////////////////////////////////
+SIMC_LIBRARY_ID SIMC_Library_Load(char* library_name) {
+	return SIMC_Library_LoadWithFlags(library_name, 0);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Load a library with options (SIMC_LIBRARY_LOAD_...)
+///
+/// With SIMC_LIBRARY_LOAD_LAZY the library is opened with RTLD_LAZY, so function
+/// references inside it are only bound by the dynamic linker when first called.
+////////////////////////////////////////////////////////////////////////////////
+SIMC_LIBRARY_ID SIMC_Library_LoadWithFlags(char* library_name, int flags) {
+	SIMC_LIBRARY_STATE* library;
+	char full_name[8193];
+	int mode = (flags & SIMC_LIBRARY_LOAD_LAZY) ? RTLD_LAZY : RTLD_NOW;
+	void* handle = 0;
+	int i;
+
+	if (flags & SIMC_LIBRARY_LOAD_PREFETCH) SIMC_Library_Prefetch(library_name);
+	for (i = 0; SIMC_Library_Suffixes[i] && (!handle); i++) {
+		SIMC_Library_GetFileName(full_name, library_name, SIMC_Library_Suffixes[i]);
+		handle = dlopen(full_name, mode);
+	}
+	if (!handle) handle = dlopen(library_name, mode);
+	if (!handle) return 0;
+
+	library = (SIMC_LIBRARY_STATE*)SIMC_Allocate(SIMC_Userdata, sizeof(SIMC_LIBRARY_STATE));
+	if (!library) {
+		dlclose(handle);
+		return 0;
+	}
+	memset(library, 0, sizeof(SIMC_LIBRARY_STATE));
+	library->handle = handle;
+#ifndef SIMC_SINGLETHREADED
+	library->lock = SIMC_SRW_Create();
+#endif
+	return (SIMC_LIBRARY_ID)library;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Unload library
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Library_Unload(SIMC_LIBRARY_ID library_id) {
+	SIMC_LIBRARY_STATE* library = (SIMC_LIBRARY_STATE*)library_id;
+	size_t i;
+	if (!library) return;
+
+	for (i = 0; i < library->capacity; i++) {
+		if (library->symbols[i].name) SIMC_Free(SIMC_Userdata, library->symbols[i].name);
+	}
+	if (library->symbols) SIMC_Free(SIMC_Userdata, library->symbols);
+	SIMC_SRW_Destroy(library->lock);
+	dlclose(library->handle);
+	SIMC_Free(SIMC_Userdata, library);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief FNV-1a hash of a symbol name.
+////////////////////////////////////////////////////////////////////////////////
+uint32_t SIMC_Library_Hash(const char* name) {
+	uint32_t hash = 2166136261U;
+	while (*name) hash = (hash ^ (unsigned char)(*name++)) * 16777619U;
+	return hash;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Find slot of symbol in cache (or empty slot where it must be added).
+////////////////////////////////////////////////////////////////////////////////
+SIMC_LIBRARY_SYMBOL* SIMC_Library_FindSymbol(SIMC_LIBRARY_STATE* library, const char* name, uint32_t hash) {
+	size_t mask = library->capacity - 1;
+	size_t i = hash & mask;
+	while (library->symbols[i].name) {
+		if ((library->symbols[i].hash == hash) && (strcmp(library->symbols[i].name, name) == 0)) break;
+		i = (i + 1) & mask;
+	}
+	return &library->symbols[i];
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Add resolved symbol to cache (write lock must be held).
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Library_CacheSymbol(SIMC_LIBRARY_STATE* library, const char* name, uint32_t hash, void* function) {
+	SIMC_LIBRARY_SYMBOL* symbol;
+	size_t length;
+
+	//Keep load factor below one half
+	if ((library->count + 1) * 2 > library->capacity) {
+		SIMC_LIBRARY_SYMBOL* old_symbols = library->symbols;
+		size_t old_capacity = library->capacity;
+		size_t new_capacity = old_capacity ? old_capacity * 2 : SIMC_LIBRARY_CACHE_SIZE;
+		size_t i;
+
+		SIMC_LIBRARY_SYMBOL* new_symbols = (SIMC_LIBRARY_SYMBOL*)SIMC_Allocate(SIMC_Userdata, sizeof(SIMC_LIBRARY_SYMBOL)*new_capacity);
+		if (!new_symbols) return;
+		memset(new_symbols, 0, sizeof(SIMC_LIBRARY_SYMBOL)*new_capacity);
+		library->symbols = new_symbols;
+		library->capacity = new_capacity;
+		for (i = 0; i < old_capacity; i++) {
+			if (old_symbols[i].name) {
+				*SIMC_Library_FindSymbol(library, old_symbols[i].name, old_symbols[i].hash) = old_symbols[i];
+			}
+		}
+		if (old_symbols) SIMC_Free(SIMC_Userdata, old_symbols);
+	}
+
+	symbol = SIMC_Library_FindSymbol(library, name, hash);
+	if (symbol->name) return; //Added by another thread
+
+	length = strlen(name);
+	symbol->name = (char*)SIMC_Allocate(SIMC_Userdata, length+1);
+	if (!symbol->name) return;
+	memcpy(symbol->name, name, length+1);
+	symbol->hash = hash;
+	symbol->function = function;
+	library->count++;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Get pointer to a function
+///
+/// Resolved symbols (including ones which were not found) are cached per library,
+/// so repeated lookups do not go through the dynamic linker.
+////////////////////////////////////////////////////////////////////////////////
+void* SIMC_Library_GetFunction(SIMC_LIBRARY_ID library_id, char* function_name) {
+	SIMC_LIBRARY_STATE* library = (SIMC_LIBRARY_STATE*)library_id;
+	uint32_t hash;
+	void* function;
+	if (!library) return 0;
+	if (!function_name) return 0;
+
+	//Look up in cache
+	hash = SIMC_Library_Hash(function_name);
+	SIMC_SRW_EnterRead(library->lock);
+	if (library->capacity) {
+		SIMC_LIBRARY_SYMBOL* symbol = SIMC_Library_FindSymbol(library, function_name, hash);
+		if (symbol->name) {
+			function = symbol->function;
+			SIMC_SRW_LeaveRead(library->lock);
+			return function;
+		}
+	}
+	SIMC_SRW_LeaveRead(library->lock);
+
+	//Resolve symbol and remember it
+	function = dlsym(library->handle, function_name);
+	SIMC_SRW_EnterWrite(library->lock);
+	SIMC_Library_CacheSymbol(library, function_name, hash, function);
+	SIMC_SRW_LeaveWrite(library->lock);
+	return function;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Get pointers to several functions
+///
+/// Writes address of every function into the functions array (null for functions
+/// which were not found).
+///
+/// @returns Number of functions found
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_Library_GetFunctions(SIMC_LIBRARY_ID library_id, char** function_names, void** functions, int count) {
+	SIMC_LIBRARY_STATE* library = (SIMC_LIBRARY_STATE*)library_id;
+	int i, resolved = 0, missing = 0;
+	if (!library) return 0;
+
+	//Take cached symbols under one read lock
+	SIMC_SRW_EnterRead(library->lock);
+	for (i = 0; i < count; i++) {
+		SIMC_LIBRARY_SYMBOL* symbol = library->capacity ?
+			SIMC_Library_FindSymbol(library, function_names[i], SIMC_Library_Hash(function_names[i])) : 0;
+		if (symbol && symbol->name) {
+			functions[i] = symbol->function;
+			if (functions[i]) resolved++;
+		} else {
+			functions[i] = 0;
+			missing++;
+		}
+	}
+	SIMC_SRW_LeaveRead(library->lock);
+	if (!missing) return resolved;
+
+	//Resolve the rest and add them under one write lock
+	SIMC_SRW_EnterWrite(library->lock);
+	for (i = 0; i < count; i++) {
+		uint32_t hash;
+		SIMC_LIBRARY_SYMBOL* symbol;
+		if (functions[i]) continue;
+
+		hash = SIMC_Library_Hash(function_names[i]);
+		symbol = library->capacity ? SIMC_Library_FindSymbol(library, function_names[i], hash) : 0;
+		if (symbol && symbol->name) {
+			functions[i] = symbol->function; //Cached since the first pass
+		} else {
+			functions[i] = dlsym(library->handle, function_names[i]);
+			SIMC_Library_CacheSymbol(library, function_names[i], hash, functions[i]);
+		}
+		if (functions[i]) resolved++;
+	}
+	SIMC_SRW_LeaveWrite(library->lock);
+	return resolved;
+}
+
+#endif
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Internal data structures
+////////////////////////////////////////////////////////////////////////////////
+#ifndef DOXYGEN_INTERNAL_STRUCTS
+typedef struct SIMC_LIBRARY_BATCH_TAG {
+	char** library_names;
+	SIMC_LIBRARY_ID* libraries;
+	int count;
+	int flags;
+	int next_prefetch;						//Index of next file to prefetch
+	int next;								//Index of next library to load
+	int loaded;								//Number of libraries loaded
+	SIMC_Callback_LibraryLoaded* callback;
+	void* userdata;
+#ifndef SIMC_SINGLETHREADED
+	SIMC_LOCK_ID lock;						//Protects counters and serializes callbacks
+#endif
+} SIMC_LIBRARY_BATCH;
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Take next index from a batch counter (returns -1 when none are left).
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_Library_Batch_Next(SIMC_LIBRARY_BATCH* batch, int* counter) {
+	int index;
+#ifndef SIMC_SINGLETHREADED
+	SIMC_Lock_Enter(batch->lock);
+#endif
+	index = (*counter)++;
+#ifndef SIMC_SINGLETHREADED
+	SIMC_Lock_Leave(batch->lock);
+#endif
+	return (index < batch->count) ? index : -1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Prefetch and load libraries from the batch until none are left.
+///
+/// All files are prefetched before loading starts, so file reads for libraries
+/// further down the list overlap with loading of the first ones.
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Library_Batch_Worker(SIMC_LIBRARY_BATCH* batch) {
+	int index;
+	if (batch->flags & SIMC_LIBRARY_LOAD_PREFETCH) {
+		while ((index = SIMC_Library_Batch_Next(batch, &batch->next_prefetch)) >= 0) {
+			SIMC_Library_Prefetch(batch->library_names[index]);
+		}
+	}
+
+	while ((index = SIMC_Library_Batch_Next(batch, &batch->next)) >= 0) {
+		SIMC_LIBRARY_ID library = SIMC_Library_LoadWithFlags(batch->library_names[index],
+			batch->flags & (~SIMC_LIBRARY_LOAD_PREFETCH));
+		batch->libraries[index] = library;
+
+#ifndef SIMC_SINGLETHREADED
+		SIMC_Lock_Enter(batch->lock);
+#endif
+		if (library) batch->loaded++;
+		if (batch->callback) batch->callback(batch->userdata, index, batch->library_names[index], library);
+#ifndef SIMC_SINGLETHREADED
+		SIMC_Lock_Leave(batch->lock);
+#endif
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Load all libraries of the batch on a pool of worker threads.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_Library_Batch_Run(SIMC_LIBRARY_BATCH* batch) {
+#ifndef SIMC_SINGLETHREADED
+	SIMC_THREAD_ID* workers;
+	int i, num_workers;
+
+	batch->lock = SIMC_Lock_Create();
+
+	//Calling thread works too, so only num_workers-1 threads are started
+	num_workers = SIMC_Thread_GetNumProcessors();
+	if (num_workers > batch->count) num_workers = batch->count;
+	if (num_workers < 1) num_workers = 1;
+	workers = (SIMC_THREAD_ID*)SIMC_Allocate(SIMC_Userdata, sizeof(SIMC_THREAD_ID)*num_workers);
+	if (!workers) num_workers = 1;
+	for (i = 1; i < num_workers; i++) {
+		workers[i] = SIMC_Thread_CreateWithName(SIMC_Library_Batch_Worker, batch, "SIMC_Library_LoadMany");
+	}
+	SIMC_Library_Batch_Worker(batch);
+	for (i = 1; i < num_workers; i++) {
+		if (workers[i] != SIMC_THREAD_BAD_ID) SIMC_Thread_WaitFor(workers[i]);
+	}
+	if (workers) SIMC_Free(SIMC_Userdata, workers);
+	SIMC_Lock_Destroy(batch->lock);
 #else
+	SIMC_Library_Batch_Worker(batch);
+#endif
+	return batch->loaded;
+}
 
-// Not supported yet
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Load several libraries at once.
+///
+/// Libraries are loaded by a pool of worker threads (one per processor, but no
+/// more than there are libraries). The result is the same as calling
+/// SIMC_Library_LoadWithFlags() for every library in turn: libraries[i] receives
+/// the handle of library_names[i] (or null if it could not be loaded).
+///
+/// The dynamic linker serializes most of its own work, so the gain comes from
+/// overlapping file reads and library initialization. It is largest together with
+/// SIMC_LIBRARY_LOAD_PREFETCH (all files are read ahead before loading starts)
+/// and SIMC_LIBRARY_LOAD_LAZY (function references are bound on first call, and
+/// plugin entry points can then be resolved with SIMC_Library_GetFunctions()).
+///
+/// The callback is called once for every library as soon as it is loaded. It is
+/// never called from two threads at once, but it may be called from a worker
+/// thread and the order of calls is not defined.
+///
+/// ~~~{.c}
+///		char* plugins[3] = { "ivss_plugin_fuel", "ivss_plugin_engine", "rdrs_plugin_rcs" };
+///		SIMC_LIBRARY_ID libraries[3];
+///		SIMC_Library_LoadMany(plugins,3,libraries,SIMC_LIBRARY_LOAD_LAZY | SIMC_LIBRARY_LOAD_PREFETCH,0,0);
+/// ~~~
+///
+/// @param[in] library_names Names of libraries to load
+/// @param[in] count Number of libraries
+/// @param[out] libraries Array which receives library handles
+/// @param[in] flags Load options (SIMC_LIBRARY_LOAD_...)
+/// @param[in] callback Called after each library is loaded (may be null)
+/// @param[in] userdata Userdata passed into the callback
+///
+/// @returns Number of libraries successfully loaded
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_Library_LoadMany(char** library_names, int count, SIMC_LIBRARY_ID* libraries, int flags,
+						  SIMC_Callback_LibraryLoaded* callback, void* userdata) {
+	SIMC_LIBRARY_BATCH batch;
+	if (!library_names) return 0;
+	if (!libraries) return 0;
+	if (count <= 0) return 0;
+
+	memset(&batch, 0, sizeof(SIMC_LIBRARY_BATCH));
+	memset(libraries, 0, sizeof(SIMC_LIBRARY_ID)*count);
+	batch.library_names = library_names;
+	batch.libraries = libraries;
+	batch.count = count;
+	batch.flags = flags;
+	batch.callback = callback;
+	batch.userdata = userdata;
+	return SIMC_Library_Batch_Run(&batch);
+}
+
+
+#ifndef SIMC_SINGLETHREADED
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Load libraries of a batch in the background and free the batch.
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Library_Batch_AsyncWorker(SIMC_LIBRARY_BATCH* batch) {
+	SIMC_Library_Batch_Run(batch);
+	SIMC_Free(SIMC_Userdata, batch);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Start loading several libraries in the background.
+///
+/// Works like SIMC_Library_LoadMany(), but returns immediately. Completion of each
+/// library is reported through the callback, and the returned thread can be waited
+/// for with SIMC_Thread_WaitFor() to find out when all of them are loaded:
+/// ~~~{.c}
+///		SIMC_THREAD_ID loader = SIMC_Library_LoadAsync(plugins,60,libraries,SIMC_LIBRARY_LOAD_LAZY,on_loaded,0);
+///		...other initialization...
+///		SIMC_Thread_WaitFor(loader);
+/// ~~~
+///
+/// The library_names and libraries arrays must remain valid until loading is
+/// completed.
+///
+/// @returns Thread which loads the libraries (SIMC_THREAD_BAD_ID if it could not be started)
+////////////////////////////////////////////////////////////////////////////////
+SIMC_THREAD_ID SIMC_Library_LoadAsync(char** library_names, int count, SIMC_LIBRARY_ID* libraries, int flags,
+									  SIMC_Callback_LibraryLoaded* callback, void* userdata) {
+	SIMC_LIBRARY_BATCH* batch;
+	SIMC_THREAD_ID thread;
+	if (!library_names) return SIMC_THREAD_BAD_ID;
+	if (!libraries) return SIMC_THREAD_BAD_ID;
+	if (count <= 0) return SIMC_THREAD_BAD_ID;
+
+	batch = (SIMC_LIBRARY_BATCH*)SIMC_Allocate(SIMC_Userdata, sizeof(SIMC_LIBRARY_BATCH));
+	if (!batch) return SIMC_THREAD_BAD_ID;
+	memset(batch, 0, sizeof(SIMC_LIBRARY_BATCH));
+	memset(libraries, 0, sizeof(SIMC_LIBRARY_ID)*count);
+	batch->library_names = library_names;
+	batch->libraries = libraries;
+	batch->count = count;
+	batch->flags = flags;
+	batch->callback = callback;
+	batch->userdata = userdata;
+
+	thread = SIMC_Thread_CreateWithName(SIMC_Library_Batch_AsyncWorker, batch, "SIMC_Library_LoadAsync");
+	if (thread == SIMC_THREAD_BAD_ID) SIMC_Free(SIMC_Userdata, batch);
+	return thread;
+}
 #endif
\ No newline at end of file
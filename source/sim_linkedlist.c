@@ -52,7 +52,7 @@ void SIMC_List_Create(SIMC_LIST** p_list, int multithreaded) {
 	list->last = 0;
 #ifndef SIMC_SINGLETHREADED
 	list->lock = SIMC_THREAD_BAD_ID;
-	if (multithreaded) list->lock = SIMC_SRW_Create();
+	if (multithreaded) list->lock = SIMC_SRW_CreateWithName("SIMC_LIST");
 #endif
 	*p_list = list;
 }
@@ -98,6 +98,7 @@ SIMC_LIST_ENTRY* SIMC_List_Append(SIMC_LIST* list, void* data) {
 	SIMC_LIST_ENTRY* entry;
 
 	//Start atomic write operation on list and block everyones access to it
+	SIMC_TRACE_BEGIN("SIMC_List_Append");
 	SIMC_SRW_EnterWrite(list->lock);
 
 	//Create new entry
@@ -113,6 +114,7 @@ SIMC_LIST_ENTRY* SIMC_List_Append(SIMC_LIST* list, void* data) {
 
 	//End atomic operation on list and give everyone access
 	SIMC_SRW_LeaveWrite(list->lock);
+	SIMC_TRACE_END("SIMC_List_Append");
 	return entry;
 }
 
@@ -143,6 +145,7 @@ SIMC_LIST_ENTRY* SIMC_List_Append(SIMC_LIST* list, void* data) {
 /// @param[in] entry List entry
 ////////////////////////////////////////////////////////////////////////////////
 void SIMC_List_Remove(SIMC_LIST* list, SIMC_LIST_ENTRY* entry) {
+	SIMC_TRACE_BEGIN("SIMC_List_Remove");
 #ifndef SIMC_SINGLETHREADED
 	//Start atomic write operation on list and block everyones access to it
 	SIMC_SRW_LeaveRead(list->lock);
@@ -163,6 +166,7 @@ void SIMC_List_Remove(SIMC_LIST* list, SIMC_LIST_ENTRY* entry) {
 
 	//End atomic operation on list and give everyone access
 	SIMC_SRW_LeaveWrite(list->lock);
+	SIMC_TRACE_END("SIMC_List_Remove");
 }
 
 
@@ -185,6 +189,7 @@ void SIMC_List_MoveInFront(SIMC_LIST* list, SIMC_LIST_ENTRY* dest, SIMC_LIST_ENT
 		return;
 	}
 
+	SIMC_TRACE_BEGIN("SIMC_List_MoveInFront");
 #ifndef SIMC_SINGLETHREADED
 	//Start atomic operation on list and block everyones access to it
 	SIMC_SRW_LeaveRead(list->lock);
@@ -214,6 +219,7 @@ void SIMC_List_MoveInFront(SIMC_LIST* list, SIMC_LIST_ENTRY* dest, SIMC_LIST_ENT
 
 	//End atomic operation on list and give everyone access
 	SIMC_SRW_LeaveWrite(list->lock);
+	SIMC_TRACE_END("SIMC_List_MoveInFront");
 }
 
 
@@ -0,0 +1,435 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file
+////////////////////////////////////////////////////////////////////////////////
+/// Copyright (C) 2012-2015, Black Phoenix
+///
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the GNU Lesser General Public License as published by the Free Software
+/// Foundation; either version 2 of the License, or (at your option) any later
+/// version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+/// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+/// details.
+///
+/// You should have received a copy of the GNU Lesser General Public License along with
+/// this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+/// Place - Suite 330, Boston, MA  02111-1307, USA.
+///
+/// Further information about the GNU Lesser General Public License can also be found on
+/// the world wide web at http://www.gnu.org.
+////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <string.h>
+#include "sim_core.h"
+#ifdef _WIN32
+#	include <windows.h>
+#else
+#	include <pthread.h>
+#endif
+
+#ifndef SIMC_SINGLETHREADED
+#ifdef SIMC_LOCK_PROFILING
+
+////////////////////////////////////////////////////////////////////////////////
+// Internal data structures
+////////////////////////////////////////////////////////////////////////////////
+#ifndef DOXYGEN_INTERNAL_STRUCTS
+typedef struct SIMC_LOCK_RECORD_TAG {
+	struct SIMC_LOCK_RECORD_TAG* next;	//Next record in list of all records
+	SIMC_LOCK_STATISTICS stats;			//Statistics shared by all locks with this name
+} SIMC_LOCK_RECORD;
+
+typedef struct SIMC_LOCK_PROFILE_TAG {
+	void* handle;						//Native lock handle
+	SIMC_LOCK_RECORD* record;			//Statistics record
+	int64_t acquire_time;				//Time at which exclusive ownership was acquired
+	int depth;							//Recursion depth of exclusive ownership (changed by owner only)
+} SIMC_LOCK_PROFILE;
+#endif
+
+//List of all statistics records
+SIMC_LOCK_RECORD* SIMC_Lock_Records = 0;
+
+//Lock protecting list of records (statically initialized)
+#ifdef _WIN32
+SRWLOCK SIMC_Lock_RecordsLock = SRWLOCK_INIT;
+#	define SIMC_LOCKPROFILE_LOCK()		AcquireSRWLockExclusive(&SIMC_Lock_RecordsLock)
+#	define SIMC_LOCKPROFILE_UNLOCK()	ReleaseSRWLockExclusive(&SIMC_Lock_RecordsLock)
+#	define SIMC_ATOMIC_ADD(ptr,value)	InterlockedExchangeAdd64((volatile LONGLONG*)(ptr),(value))
+#	define SIMC_ATOMIC_CAS(ptr,old,new)	(InterlockedCompareExchange64((volatile LONGLONG*)(ptr),(new),(old)) == (old))
+#else
+pthread_mutex_t SIMC_Lock_RecordsLock = PTHREAD_MUTEX_INITIALIZER;
+#	define SIMC_LOCKPROFILE_LOCK()		pthread_mutex_lock(&SIMC_Lock_RecordsLock)
+#	define SIMC_LOCKPROFILE_UNLOCK()	pthread_mutex_unlock(&SIMC_Lock_RecordsLock)
+#	define SIMC_ATOMIC_ADD(ptr,value)	__sync_fetch_and_add((ptr),(value))
+#	define SIMC_ATOMIC_CAS(ptr,old,new)	__sync_bool_compare_and_swap((ptr),(old),(new))
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Atomically update maximum value.
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Lock_Internal_UpdateMax(int64_t* max_value, int64_t value) {
+	int64_t old_value = *max_value;
+	while (value > old_value) {
+		if (SIMC_ATOMIC_CAS(max_value, old_value, value)) break;
+		old_value = *max_value;
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Find or create statistics record for the lock name.
+/// @returns Lock profile (null if memory could not be allocated)
+////////////////////////////////////////////////////////////////////////////////
+SIMC_LOCK_PROFILE* SIMC_Lock_Internal_CreateProfile(void* handle, const char* name, int type) {
+	SIMC_LOCK_PROFILE* profile;
+	SIMC_LOCK_RECORD* record;
+	if (!name) name = "(unnamed)";
+
+	profile = (SIMC_LOCK_PROFILE*)SIMC_Allocate(SIMC_Userdata, sizeof(SIMC_LOCK_PROFILE));
+	if (!profile) return 0;
+
+	SIMC_LOCKPROFILE_LOCK();
+	for (record = SIMC_Lock_Records; record; record = record->next) {
+		if ((record->stats.type == type) && (strcmp(record->stats.name, name) == 0)) break;
+	}
+	if (!record) {
+		char* name_copy = (char*)SIMC_Allocate(SIMC_Userdata, strlen(name)+1);
+		record = (SIMC_LOCK_RECORD*)SIMC_Allocate(SIMC_Userdata, sizeof(SIMC_LOCK_RECORD));
+		if ((!name_copy) || (!record)) {
+			SIMC_LOCKPROFILE_UNLOCK();
+			if (name_copy) SIMC_Free(SIMC_Userdata, name_copy);
+			if (record) SIMC_Free(SIMC_Userdata, record);
+			SIMC_Free(SIMC_Userdata, profile);
+			return 0;
+		}
+		strcpy(name_copy, name);
+		memset(record, 0, sizeof(SIMC_LOCK_RECORD));
+		record->stats.name = name_copy;
+		record->stats.type = type;
+		record->next = SIMC_Lock_Records;
+		SIMC_Lock_Records = record;
+	}
+	record->stats.instances++;
+	SIMC_LOCKPROFILE_UNLOCK();
+
+	profile->handle = handle;
+	profile->record = record;
+	profile->acquire_time = 0;
+	profile->depth = 0;
+	return profile;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Account for one acquisition of the lock.
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Lock_Internal_Acquired(SIMC_LOCK_PROFILE* profile, int read, int contended, int64_t wait) {
+	SIMC_LOCK_STATISTICS* stats = &profile->record->stats;
+	if (read) {
+		SIMC_ATOMIC_ADD(&stats->read_acquisitions, 1);
+		if (contended) {
+			SIMC_ATOMIC_ADD(&stats->read_contended, 1);
+			SIMC_ATOMIC_ADD(&stats->read_wait_total, wait);
+			SIMC_Lock_Internal_UpdateMax(&stats->read_wait_max, wait);
+		}
+	} else {
+		SIMC_ATOMIC_ADD(&stats->acquisitions, 1);
+		if (contended) {
+			SIMC_ATOMIC_ADD(&stats->contended, 1);
+			SIMC_ATOMIC_ADD(&stats->wait_total, wait);
+			SIMC_Lock_Internal_UpdateMax(&stats->wait_max, wait);
+		}
+		//Hold time is measured from the outermost enter of a recursive lock
+		if (profile->depth++ == 0) profile->acquire_time = SIMC_Thread_GetTimeNs();
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Account for release of exclusive ownership.
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Lock_Internal_Released(SIMC_LOCK_PROFILE* profile) {
+	SIMC_LOCK_STATISTICS* stats = &profile->record->stats;
+	int64_t hold;
+	if (--profile->depth > 0) return;
+
+	hold = SIMC_Thread_GetTimeNs() - profile->acquire_time;
+	SIMC_ATOMIC_ADD(&stats->hold_total, hold);
+	SIMC_Lock_Internal_UpdateMax(&stats->hold_max, hold);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Profiled lock API
+////////////////////////////////////////////////////////////////////////////////
+SIMC_LOCK_ID SIMC_Lock_CreateWithName(const char* name) {
+	SIMC_LOCK_PROFILE* profile;
+	SIMC_LOCK_ID handle = SIMC_Lock_Internal_Create();
+	if ((!handle) || (handle == SIMC_THREAD_BAD_ID)) return SIMC_THREAD_BAD_ID;
+
+	profile = SIMC_Lock_Internal_CreateProfile(handle, name, SIMC_LOCK_TYPE_MUTEX);
+	if (!profile) {
+		SIMC_Lock_Internal_Destroy(handle);
+		return SIMC_THREAD_BAD_ID;
+	}
+	return (SIMC_LOCK_ID)profile;
+}
+
+SIMC_LOCK_ID SIMC_Lock_Create() {
+	return SIMC_Lock_CreateWithName(0);
+}
+
+void SIMC_Lock_Destroy(SIMC_LOCK_ID lockID) {
+	SIMC_LOCK_PROFILE* profile = (SIMC_LOCK_PROFILE*)lockID;
+	if ((!lockID) || (lockID == SIMC_THREAD_BAD_ID)) return;
+	SIMC_Lock_Internal_Destroy(profile->handle);
+	SIMC_Free(SIMC_Userdata, profile);
+}
+
+SIMC_LOCK_ID SIMC_Lock_Enter(SIMC_LOCK_ID lockID) {
+	SIMC_LOCK_PROFILE* profile = (SIMC_LOCK_PROFILE*)lockID;
+	if ((!lockID) || (lockID == SIMC_THREAD_BAD_ID)) return lockID;
+
+	if (SIMC_Lock_Internal_TryEnter(profile->handle)) {
+		SIMC_Lock_Internal_Acquired(profile, 0, 0, 0);
+	} else {
+		int64_t t0 = SIMC_Thread_GetTimeNs();
+		SIMC_Lock_Internal_Enter(profile->handle);
+		SIMC_Lock_Internal_Acquired(profile, 0, 1, SIMC_Thread_GetTimeNs() - t0);
+	}
+	return lockID;
+}
+
+int SIMC_Lock_TryEnter(SIMC_LOCK_ID lockID) {
+	SIMC_LOCK_PROFILE* profile = (SIMC_LOCK_PROFILE*)lockID;
+	if ((!lockID) || (lockID == SIMC_THREAD_BAD_ID)) return 0;
+
+	if (!SIMC_Lock_Internal_TryEnter(profile->handle)) return 0;
+	SIMC_Lock_Internal_Acquired(profile, 0, 0, 0);
+	return 1;
+}
+
+void SIMC_Lock_Leave(SIMC_LOCK_ID lockID) {
+	SIMC_LOCK_PROFILE* profile = (SIMC_LOCK_PROFILE*)lockID;
+	if ((!lockID) || (lockID == SIMC_THREAD_BAD_ID)) return;
+	SIMC_Lock_Internal_Released(profile);
+	SIMC_Lock_Internal_Leave(profile->handle);
+}
+
+void SIMC_Lock_WaitFor(SIMC_LOCK_ID lockID) {
+	SIMC_Lock_Leave(SIMC_Lock_Enter(lockID));
+}
+
+SIMC_SRW_ID SIMC_SRW_CreateWithName(const char* name) {
+	SIMC_LOCK_PROFILE* profile;
+	SIMC_SRW_ID handle = SIMC_SRW_Internal_Create();
+	if ((!handle) || (handle == SIMC_THREAD_BAD_ID)) return SIMC_THREAD_BAD_ID;
+
+	profile = SIMC_Lock_Internal_CreateProfile(handle, name, SIMC_LOCK_TYPE_SRW);
+	if (!profile) {
+		SIMC_SRW_Internal_Destroy(handle);
+		return SIMC_THREAD_BAD_ID;
+	}
+	return (SIMC_SRW_ID)profile;
+}
+
+SIMC_SRW_ID SIMC_SRW_Create() {
+	return SIMC_SRW_CreateWithName(0);
+}
+
+void SIMC_SRW_Destroy(SIMC_SRW_ID srwID) {
+	SIMC_LOCK_PROFILE* profile = (SIMC_LOCK_PROFILE*)srwID;
+	if ((!srwID) || (srwID == SIMC_THREAD_BAD_ID)) return;
+	SIMC_SRW_Internal_Destroy(profile->handle);
+	SIMC_Free(SIMC_Userdata, profile);
+}
+
+void SIMC_SRW_EnterRead(SIMC_SRW_ID srwID) {
+	SIMC_LOCK_PROFILE* profile = (SIMC_LOCK_PROFILE*)srwID;
+	if ((!srwID) || (srwID == SIMC_THREAD_BAD_ID)) return;
+
+	if (SIMC_SRW_Internal_TryEnterRead(profile->handle)) {
+		SIMC_Lock_Internal_Acquired(profile, 1, 0, 0);
+	} else {
+		int64_t t0 = SIMC_Thread_GetTimeNs();
+		SIMC_SRW_Internal_EnterRead(profile->handle);
+		SIMC_Lock_Internal_Acquired(profile, 1, 1, SIMC_Thread_GetTimeNs() - t0);
+	}
+}
+
+void SIMC_SRW_LeaveRead(SIMC_SRW_ID srwID) {
+	SIMC_LOCK_PROFILE* profile = (SIMC_LOCK_PROFILE*)srwID;
+	if ((!srwID) || (srwID == SIMC_THREAD_BAD_ID)) return;
+	SIMC_SRW_Internal_LeaveRead(profile->handle);
+}
+
+void SIMC_SRW_EnterWrite(SIMC_SRW_ID srwID) {
+	SIMC_LOCK_PROFILE* profile = (SIMC_LOCK_PROFILE*)srwID;
+	if ((!srwID) || (srwID == SIMC_THREAD_BAD_ID)) return;
+
+	if (SIMC_SRW_Internal_TryEnterWrite(profile->handle)) {
+		SIMC_Lock_Internal_Acquired(profile, 0, 0, 0);
+	} else {
+		int64_t t0 = SIMC_Thread_GetTimeNs();
+		SIMC_SRW_Internal_EnterWrite(profile->handle);
+		SIMC_Lock_Internal_Acquired(profile, 0, 1, SIMC_Thread_GetTimeNs() - t0);
+	}
+}
+
+void SIMC_SRW_LeaveWrite(SIMC_SRW_ID srwID) {
+	SIMC_LOCK_PROFILE* profile = (SIMC_LOCK_PROFILE*)srwID;
+	if ((!srwID) || (srwID == SIMC_THREAD_BAD_ID)) return;
+	SIMC_Lock_Internal_Released(profile);
+	SIMC_SRW_Internal_LeaveWrite(profile->handle);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Get lock contention statistics.
+///
+/// Only available when SIMC is compiled with SIMC_LOCK_PROFILING, otherwise no
+/// statistics are returned. Statistics are accumulated per lock name: all locks
+/// created with the same name (see SIMC_Lock_CreateWithName(), SIMC_SRW_CreateWithName())
+/// share one record. Locks created without a name are reported as "(unnamed)".
+///
+/// Records are sorted by total time spent waiting (exclusive and shared), so the
+/// most contended locks come first:
+/// ~~~{.c}
+///		SIMC_LOCK_STATISTICS stats[16];
+///		int i, count = SIMC_Lock_GetStatistics(stats, 16);
+///		for (i = 0; (i < count) && (i < 16); i++) {
+///			printf("%s: %.3f ms\n", stats[i].name, stats[i].wait_total*1e-6);
+///		}
+/// ~~~
+///
+/// All times are in nanoseconds. Hold time is measured for exclusive ownership
+/// only (mutex enter and SRW write), from the outermost enter to the matching leave
+/// of a recursively entered mutex.
+///
+/// @param[out] stats Array for statistics records (may be null)
+/// @param[in] max_count Size of the array
+///
+/// @returns Total number of records available
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_Lock_GetStatistics(SIMC_LOCK_STATISTICS* stats, int max_count) {
+	SIMC_LOCK_RECORD* record;
+	int count = 0;
+
+	SIMC_LOCKPROFILE_LOCK();
+	for (record = SIMC_Lock_Records; record; record = record->next) {
+		//Insert into sorted position
+		if (stats) {
+			int64_t wait = record->stats.wait_total + record->stats.read_wait_total;
+			int i = (count < max_count) ? count : max_count;
+			while ((i > 0) && (stats[i-1].wait_total + stats[i-1].read_wait_total < wait)) {
+				if (i < max_count) stats[i] = stats[i-1];
+				i--;
+			}
+			if (i < max_count) stats[i] = record->stats;
+		}
+		count++;
+	}
+	SIMC_LOCKPROFILE_UNLOCK();
+	return count;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Reset lock contention statistics.
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Lock_ResetStatistics() {
+	SIMC_LOCK_RECORD* record;
+
+	SIMC_LOCKPROFILE_LOCK();
+	for (record = SIMC_Lock_Records; record; record = record->next) {
+		const char* name = record->stats.name;
+		int type = record->stats.type;
+		int instances = record->stats.instances;
+		memset(&record->stats, 0, sizeof(SIMC_LOCK_STATISTICS));
+		record->stats.name = name;
+		record->stats.type = type;
+		record->stats.instances = instances;
+	}
+	SIMC_LOCKPROFILE_UNLOCK();
+}
+
+#else
+
+////////////////////////////////////////////////////////////////////////////////
+// Without profiling lock names are ignored
+////////////////////////////////////////////////////////////////////////////////
+SIMC_LOCK_ID SIMC_Lock_CreateWithName(const char* name) {
+	(void)name;
+	return SIMC_Lock_Create();
+}
+
+SIMC_SRW_ID SIMC_SRW_CreateWithName(const char* name) {
+	(void)name;
+	return SIMC_SRW_Create();
+}
+
+int SIMC_Lock_GetStatistics(SIMC_LOCK_STATISTICS* stats, int max_count) {
+	(void)stats;
+	(void)max_count;
+	return 0;
+}
+
+void SIMC_Lock_ResetStatistics() {
+}
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Write lock contention report into a text file.
+///
+/// Writes a table of all statistics records returned by SIMC_Lock_GetStatistics(),
+/// with times converted to microseconds.
+///
+/// @param[in] filename Output file name
+///
+/// @returns Error code
+/// @retval SIMC_OK Report successfully written
+/// @retval SIMC_ERROR_FILE Could not open output file
+/// @retval SIMC_ERROR_INTERNAL Could not allocate memory for the report
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_Lock_SaveStatistics(const char* filename) {
+	SIMC_LOCK_STATISTICS* stats;
+	int i, count, capacity;
+	FILE* f;
+
+	f = fopen(filename, "w");
+	if (!f) return SIMC_ERROR_FILE;
+
+	//Locks may be created between the calls, only the records which fit are written
+	capacity = SIMC_Lock_GetStatistics(0, 0);
+	stats = (SIMC_LOCK_STATISTICS*)SIMC_Allocate(SIMC_Userdata, sizeof(SIMC_LOCK_STATISTICS)*(capacity+1));
+	if (!stats) {
+		fclose(f);
+		return SIMC_ERROR_INTERNAL;
+	}
+	count = SIMC_Lock_GetStatistics(stats, capacity);
+	if (count > capacity) count = capacity;
+
+	fprintf(f, "%-40s %5s %6s %12s %12s %14s %12s %14s %12s %12s %12s %14s %12s\n",
+		"name", "type", "count", "acquired", "contended", "wait_us", "wait_max_us", "hold_us", "hold_max_us",
+		"read_acq", "read_cont", "read_wait_us", "read_max_us");
+	for (i = 0; i < count; i++) {
+		fprintf(f, "%-40s %5s %6d %12lld %12lld %14.3f %12.3f %14.3f %12.3f %12lld %12lld %14.3f %12.3f\n",
+			stats[i].name, stats[i].type == SIMC_LOCK_TYPE_SRW ? "srw" : "mutex", stats[i].instances,
+			(long long)stats[i].acquisitions, (long long)stats[i].contended,
+			stats[i].wait_total*1e-3, stats[i].wait_max*1e-3,
+			stats[i].hold_total*1e-3, stats[i].hold_max*1e-3,
+			(long long)stats[i].read_acquisitions, (long long)stats[i].read_contended,
+			stats[i].read_wait_total*1e-3, stats[i].read_wait_max*1e-3);
+	}
+
+	SIMC_Free(SIMC_Userdata, stats);
+	fclose(f);
+	return SIMC_OK;
+}
+
+#endif
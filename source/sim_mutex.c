@@ -0,0 +1,215 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file
+////////////////////////////////////////////////////////////////////////////////
+/// Copyright (C) 2012-2015, Black Phoenix
+///
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the GNU Lesser General Public License as published by the Free Software
+/// Foundation; either version 2 of the License, or (at your option) any later
+/// version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+/// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+/// details.
+///
+/// You should have received a copy of the GNU Lesser General Public License along with
+/// this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+/// Place - Suite 330, Boston, MA  02111-1307, USA.
+///
+/// Further information about the GNU Lesser General Public License can also be found on
+/// the world wide web at http://www.gnu.org.
+////////////////////////////////////////////////////////////////////////////////
+#include "sim_core.h"
+#ifdef _WIN32
+#	include <windows.h>
+#else
+#	include <sched.h>
+#	ifdef __linux__
+#		include <unistd.h>
+#		include <sys/syscall.h>
+#		include <linux/futex.h>
+#	endif
+#endif
+
+#ifndef SIMC_SINGLETHREADED
+
+// Number of times the mutex is polled before the thread is parked
+#define SIMC_MUTEX_SPIN_COUNT		40
+// Largest number of pause instructions between two polls
+#define SIMC_MUTEX_MAX_BACKOFF		16
+
+// Hint to the processor that the thread is spinning
+#if defined(_WIN32)
+#	define SIMC_MUTEX_PAUSE()		YieldProcessor()
+#elif defined(__i386__) || defined(__x86_64__)
+#	define SIMC_MUTEX_PAUSE()		__builtin_ia32_pause()
+#else
+#	define SIMC_MUTEX_PAUSE()		((void)0)
+#endif
+
+// Atomic operations on the mutex word (compare-and-swap, exchange and add return old value)
+#ifdef _WIN32
+#	define SIMC_MUTEX_LOAD(ptr)				(*(ptr))
+#	define SIMC_MUTEX_CAS(ptr,old,new)		InterlockedCompareExchange((volatile LONG*)(ptr),(new),(old))
+#	define SIMC_MUTEX_EXCHANGE(ptr,value)	InterlockedExchange((volatile LONG*)(ptr),(value))
+#	define SIMC_MUTEX_ADD(ptr,value)		InterlockedExchangeAdd((volatile LONG*)(ptr),(value))
+#else
+#	define SIMC_MUTEX_LOAD(ptr)				__atomic_load_n((ptr),__ATOMIC_RELAXED)
+#	define SIMC_MUTEX_CAS(ptr,old,new)		__sync_val_compare_and_swap((ptr),(old),(new))
+#	define SIMC_MUTEX_EXCHANGE(ptr,value)	__atomic_exchange_n((ptr),(value),__ATOMIC_SEQ_CST)
+#	define SIMC_MUTEX_ADD(ptr,value)		__sync_fetch_and_add((ptr),(value))
+#endif
+
+// Parking on the mutex word is available on Linux (futex) and Windows 8 or newer (WaitOnAddress)
+#if defined(_WIN32) && defined(_WIN32_WINNT) && (_WIN32_WINNT >= 0x0602)
+#	define SIMC_MUTEX_WAIT_ON_ADDRESS
+#	pragma comment(lib, "Synchronization.lib")
+#elif defined(__linux__)
+#	define SIMC_MUTEX_FUTEX
+#endif
+
+//Number of polls before parking (negative until number of processors is known)
+volatile int32_t SIMC_Mutex_SpinCount = -1;
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Get number of polls before parking.
+///
+/// Spinning is useless on a single processor, because the owner of the mutex cannot
+/// run while the waiting thread spins.
+////////////////////////////////////////////////////////////////////////////////
+int32_t SIMC_Mutex_Internal_GetSpinCount() {
+	int32_t spin_count = SIMC_MUTEX_LOAD(&SIMC_Mutex_SpinCount);
+	if (spin_count < 0) {
+		spin_count = (SIMC_Thread_GetNumProcessors() > 1) ? SIMC_MUTEX_SPIN_COUNT : 0;
+		SIMC_MUTEX_EXCHANGE(&SIMC_Mutex_SpinCount,spin_count);
+	}
+	return spin_count;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Park the calling thread while the mutex is locked with waiters.
+///
+/// May return early (spuriously), the caller must check the mutex state again.
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Mutex_Internal_Park(SIMC_MUTEX* mutex) {
+#if defined(SIMC_MUTEX_WAIT_ON_ADDRESS)
+	LONG expected = 2;
+	WaitOnAddress((volatile VOID*)&mutex->state,&expected,sizeof(LONG),INFINITE);
+#elif defined(SIMC_MUTEX_FUTEX)
+	syscall(SYS_futex,&mutex->state,FUTEX_WAIT_PRIVATE,2,NULL,NULL,0);
+#elif defined(_WIN32)
+	SwitchToThread();
+#else
+	sched_yield();
+#endif
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Wake up one thread parked on the mutex.
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Mutex_Internal_Wake(SIMC_MUTEX* mutex) {
+#if defined(SIMC_MUTEX_WAIT_ON_ADDRESS)
+	WakeByAddressSingle((PVOID)&mutex->state);
+#elif defined(SIMC_MUTEX_FUTEX)
+	syscall(SYS_futex,&mutex->state,FUTEX_WAKE_PRIVATE,1,NULL,NULL,0);
+#endif
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Initialize inline mutex.
+///
+/// Inline mutex is a single 32-bit word which is meant to be embedded into the
+/// structure it protects. It does not allocate any memory and does not need to be
+/// destroyed. A mutex filled with zeroes (or SIMC_MUTEX_INIT) is already initialized.
+///
+/// Inline mutex is not recursive: the thread which owns the mutex must not enter
+/// it again. Use SIMC_Lock_Create() when recursive locking is required.
+///
+/// Example of use:
+/// ~~~{.c}
+///		typedef struct {
+///			SIMC_MUTEX lock;
+///			int counter;
+///		} COUNTER;
+///
+///		SIMC_Mutex_Enter(&counter->lock);
+///			counter->counter++;
+///		SIMC_Mutex_Leave(&counter->lock);
+/// ~~~
+///
+/// @param[in] mutex Pointer to the mutex
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Mutex_Initialize(SIMC_MUTEX* mutex) {
+	mutex->state = 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Enter inline mutex.
+///
+/// An uncontended mutex is entered with a single atomic operation. Otherwise the
+/// thread polls the mutex for a short time with growing pauses between polls,
+/// because most critical sections are only a few dozen nanoseconds long. If the
+/// mutex is still locked, or other threads are already parked on it, the thread
+/// is parked until the owner leaves the mutex.
+///
+/// @param[in] mutex Pointer to the mutex
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Mutex_Enter(SIMC_MUTEX* mutex) {
+	int32_t state, spin_count;
+	int spin, backoff = 1, i;
+
+	//Uncontended case
+	if (SIMC_MUTEX_CAS(&mutex->state,0,1) == 0) return;
+
+	//Spin while the owner is likely to leave soon
+	spin_count = SIMC_Mutex_Internal_GetSpinCount();
+	for (spin = 0; spin < spin_count; spin++) {
+		state = SIMC_MUTEX_LOAD(&mutex->state);
+		if (state == 0) {
+			if (SIMC_MUTEX_CAS(&mutex->state,0,1) == 0) return;
+		} else if (state == 2) { //Other threads are parked already, no point spinning
+			break;
+		}
+		for (i = 0; i < backoff; i++) SIMC_MUTEX_PAUSE();
+		if (backoff < SIMC_MUTEX_MAX_BACKOFF) backoff *= 2;
+	}
+
+	//Mark mutex as having waiters and park until it is left
+	state = SIMC_MUTEX_EXCHANGE(&mutex->state,2);
+	while (state != 0) {
+		SIMC_Mutex_Internal_Park(mutex);
+		state = SIMC_MUTEX_EXCHANGE(&mutex->state,2);
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Try to enter inline mutex without waiting.
+/// @param[in] mutex Pointer to the mutex
+/// @returns Whether mutex was entered
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_Mutex_TryEnter(SIMC_MUTEX* mutex) {
+	return SIMC_MUTEX_CAS(&mutex->state,0,1) == 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Leave inline mutex.
+///
+/// A parked thread is only woken up if there may be any.
+///
+/// @param[in] mutex Pointer to the mutex
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Mutex_Leave(SIMC_MUTEX* mutex) {
+	if (SIMC_MUTEX_ADD(&mutex->state,-1) != 1) {
+		SIMC_MUTEX_EXCHANGE(&mutex->state,0);
+		SIMC_Mutex_Internal_Wake(mutex);
+	}
+}
+#endif
@@ -23,6 +23,12 @@
 #include <stdlib.h>
 #include <string.h>
 #include "sim_core.h"
+#ifdef _WIN32
+#	include <windows.h>
+#	define SIMC_QUEUE_BARRIER()	MemoryBarrier()
+#else
+#	define SIMC_QUEUE_BARRIER()	__sync_synchronize()
+#endif
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -30,8 +36,14 @@
 ////////////////////////////////////////////////////////////////////////////////
 void SIMC_Queue_Create(SIMC_QUEUE** p_queue, int size, int element_size) {
 	SIMC_QUEUE* queue = (SIMC_QUEUE*)SIMC_Allocate(SIMC_Userdata, sizeof(SIMC_QUEUE));
+	*p_queue = 0;
+	if (!queue) return;
 
 	queue->data = SIMC_Allocate(SIMC_Userdata, element_size*size);
+	if (!queue->data) {
+		SIMC_Free(SIMC_Userdata, queue);
+		return;
+	}
 	queue->data_last = (void*)((char*)queue->data + element_size*(size - 1));
 	queue->write_ptr = queue->data;
 	queue->read_ptr = queue->data;
@@ -71,8 +83,9 @@ int SIMC_Queue_LeaveWrite(SIMC_QUEUE* queue) {
 		new_ptr = (char*)queue->write_ptr + queue->element_size;
 	}
 
-	//If possible, move queue pointer up
+	//If possible, move queue pointer up (value must be visible to reader before the pointer)
 	if (new_ptr != queue->read_ptr) {
+		SIMC_QUEUE_BARRIER();
 		queue->write_ptr = new_ptr;
 		return 1;
 	} else {
@@ -90,6 +103,7 @@ int SIMC_Queue_EnterRead(SIMC_QUEUE* queue, void** p_value) {
 
 	//If possible, move pointer up
 	if (queue->read_ptr != queue->write_ptr) {
+		SIMC_QUEUE_BARRIER(); //Value must be read after the write pointer
 		if (!p_value) SIMC_Queue_LeaveRead(queue);
 		return 1;
 	} else {
@@ -103,6 +117,7 @@ int SIMC_Queue_EnterRead(SIMC_QUEUE* queue, void** p_value) {
 /// @brief Leaves reading mode.
 ////////////////////////////////////////////////////////////////////////////////
 void SIMC_Queue_LeaveRead(SIMC_QUEUE* queue) {
+	SIMC_QUEUE_BARRIER(); //Value must be read before the slot is released to writer
 	if (queue->read_ptr == queue->data_last) {
 		queue->read_ptr = queue->data;
 	} else {
@@ -122,6 +137,7 @@ int SIMC_Queue_Peek(SIMC_QUEUE* queue, void** p_value) {
 	//Lock
 	*p_value = queue->read_ptr;
 	if (queue->read_ptr != queue->write_ptr) {
+		SIMC_QUEUE_BARRIER();
 		return 1;
 	} else {
 		//Unlock
@@ -0,0 +1,123 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file
+////////////////////////////////////////////////////////////////////////////////
+/// Copyright (C) 2012-2015, Black Phoenix
+///
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the GNU Lesser General Public License as published by the Free Software
+/// Foundation; either version 2 of the License, or (at your option) any later
+/// version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+/// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+/// details.
+///
+/// You should have received a copy of the GNU Lesser General Public License along with
+/// this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+/// Place - Suite 330, Boston, MA  02111-1307, USA.
+///
+/// Further information about the GNU Lesser General Public License can also be found on
+/// the world wide web at http://www.gnu.org.
+////////////////////////////////////////////////////////////////////////////////
+#include "sim_core.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Create a new rate limiter.
+///
+/// Rate limiter paces a loop so that each iteration starts at a fixed period
+/// after the previous one. Schedule is absolute, time spent inside the loop body
+/// does not accumulate as drift:
+/// ~~~{.c}
+///		SIMC_RATELIMITER* limiter;
+///		SIMC_RateLimiter_Create(&limiter, 1.0/1000.0); //1 kHz
+///		while (running) {
+///			... loop body ...
+///			SIMC_RateLimiter_Wait(limiter);
+///		}
+///		SIMC_RateLimiter_Destroy(limiter);
+/// ~~~
+///
+/// The schedule starts when the limiter is created (or reset).
+///
+/// @param[out] p_limiter Pointer to the rate limiter will be written here
+/// @param[in] period Loop period in seconds
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_RateLimiter_Create(SIMC_RATELIMITER** p_limiter, double period) {
+	SIMC_RATELIMITER* limiter = (SIMC_RATELIMITER*)SIMC_Allocate(SIMC_Userdata, sizeof(SIMC_RATELIMITER));
+	SIMC_RateLimiter_SetPeriod(limiter, period);
+	SIMC_RateLimiter_Reset(limiter);
+	*p_limiter = limiter;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Destroy rate limiter.
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_RateLimiter_Destroy(SIMC_RATELIMITER* limiter) {
+	SIMC_Free(SIMC_Userdata, limiter);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Restart schedule from the current time.
+///
+/// Should be called after the loop was paused, otherwise the first call to
+/// SIMC_RateLimiter_Wait() will report all the periods during pause as skipped.
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_RateLimiter_Reset(SIMC_RATELIMITER* limiter) {
+	limiter->deadline = SIMC_Thread_GetTimeNs();
+	limiter->missed = 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Change loop period.
+///
+/// New period applies starting from the next call to SIMC_RateLimiter_Wait().
+///
+/// @param[in] limiter Rate limiter
+/// @param[in] period Loop period in seconds
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_RateLimiter_SetPeriod(SIMC_RATELIMITER* limiter, double period) {
+	limiter->period = (int64_t)(period*1e9 + 0.5);
+	if (limiter->period < 1) limiter->period = 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Wait until the start of the next period.
+///
+/// If the loop body overran its period, the function returns immediately. When
+/// one or more whole periods were overrun, these periods are skipped (the schedule
+/// is not compressed to catch up with lost time) and their number is returned.
+///
+/// @param[in] limiter Rate limiter
+/// @returns Number of periods skipped due to overrun, or 0 if loop is on schedule
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_RateLimiter_Wait(SIMC_RATELIMITER* limiter) {
+	int64_t now = SIMC_Thread_GetTimeNs();
+	int64_t skipped;
+
+	//Start of the next period
+	limiter->deadline += limiter->period;
+	if (now < limiter->deadline) {
+		SIMC_Thread_SleepUntilNs(limiter->deadline);
+		return 0;
+	}
+
+	//Next period has already started, skip periods which have been missed completely
+	skipped = (now - limiter->deadline) / limiter->period;
+	limiter->deadline += skipped*limiter->period;
+	limiter->missed += skipped;
+	return (int)skipped;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Get total number of periods skipped since the schedule started.
+////////////////////////////////////////////////////////////////////////////////
+int64_t SIMC_RateLimiter_GetMissed(SIMC_RATELIMITER* limiter) {
+	return limiter->missed;
+}
@@ -1,1216 +1,1362 @@
-////////////////////////////////////////////////////////////////////////////////
-/// @file
-////////////////////////////////////////////////////////////////////////////////
-/// Portions of this source file are derived from GLFW (http://www.glfw.org).
-/// The original work belongs to its authors:
-///  Copyright (C) 2002-2006, Marcus Geelnard
-///  Copyright (C) 2006-2011, Camilla Berglund
-////////////////////////////////////////////////////////////////////////////////
-/// Copyright (C) 2012-2015, Black Phoenix
-///
-/// This program is free software; you can redistribute it and/or modify it under
-/// the terms of the GNU Lesser General Public License as published by the Free Software
-/// Foundation; either version 2 of the License, or (at your option) any later
-/// version.
-///
-/// This program is distributed in the hope that it will be useful, but WITHOUT
-/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
-/// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
-/// details.
-///
-/// You should have received a copy of the GNU Lesser General Public License along with
-/// this program; if not, write to the Free Software Foundation, Inc., 59 Temple
-/// Place - Suite 330, Boston, MA  02111-1307, USA.
-///
-/// Further information about the GNU Lesser General Public License can also be found on
-/// the world wide web at http://www.gnu.org.
-////////////////////////////////////////////////////////////////////////////////
-#include "sim_core.h"
-#ifdef _WIN32
-#	include <windows.h>
-#else
-#	include <stdlib.h>
-#	include <pthread.h>
-#	include <sched.h>
-#	include <signal.h>
-#	include <sys/time.h>
-#	include <unistd.h>
-#endif
-
-// Use WinAPI/POSIX implementation of SRW locks instead of custom implementation (windows-only)
-#define SIMC_NATIVE_SRW
-
-// Allocate memory
-void* SIMC_Default_Allocate(void* userdata, size_t size) {
-	return malloc(size);
-}
-
-// Free memory
-void SIMC_Default_Free(void* userdata, void* pointer) {
-	free(pointer);
-}
-
-// Pointers to memory allocation functions
-SIMC_Callback_Allocate* SIMC_Allocate = &SIMC_Default_Allocate;
-SIMC_Callback_Free* SIMC_Free = &SIMC_Default_Free;
-void* SIMC_Userdata = 0;
-
-// Set allocation functions
-void SIMC_SetCallbacks(void* userdata, SIMC_Callback_Allocate* OnAllocate, SIMC_Callback_Free* OnFree) {
-	SIMC_Userdata = userdata;
-	SIMC_Allocate = OnAllocate;
-	SIMC_Free = OnFree;
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-// Internal data structures and typedefs
-////////////////////////////////////////////////////////////////////////////////
-#ifndef SIMC_SINGLETHREADED
-
-/// Callback for the function that can be used as a pointer for a thread
-typedef void SIMC_THREAD_FUNCTION(void* userdata);
-
-#ifndef DOXYGEN_INTERNAL_STRUCTS
-typedef struct SIMC_THREAD_TAG {
-	//Shared members
-	struct SIMC_THREAD_TAG	*previous, *next;  //Linked list implementation
-	SIMC_THREAD_ID			id;               //Thread ID
-	void*					function;         //Function to call
-
-	//System-specific handles
-#ifdef _WIN32
-	HANDLE         handle;
-	DWORD          winID;
-#else
-	pthread_t      posixID;
-#endif
-} SIMC_THREAD;
-#endif
-
-
-//Global variables for threading system
-SIMC_THREAD_ID SIMC_Thread_NextID = (void*)1;
-SIMC_THREAD SIMC_Thread_Main;
-unsigned int SIMC_Instance_Counter = 0;
-
-
-//Get thread pointer
-SIMC_THREAD* SIMC_Thread_Internal_GetPointer(SIMC_THREAD_ID ID) {
-	SIMC_THREAD* thread;
-	for (thread = &SIMC_Thread_Main; thread != NULL; thread = thread->next) {
-		if (thread->id == ID) break;
-	}
-	return thread;
-}
-
-//Remove thread
-void SIMC_Thread_Internal_Remove(SIMC_THREAD* thread) {
-	if (thread->previous != NULL) thread->previous->next = thread->next;
-	if (thread->next != NULL) thread->next->previous = thread->previous;
-	SIMC_Free(SIMC_Userdata, (void*)thread);
-}
-#endif
-
-
-
-
-
-
-
-
-////////////////////////////////////////////////////////////////////////////////
-// Windows specific code
-////////////////////////////////////////////////////////////////////////////////
-#ifdef _WIN32
-#ifndef SIMC_SINGLETHREADED
-
-CRITICAL_SECTION SIMC_Thread_CriticalSection;
-void SIMC_Thread_EnterCriticalSection() {
-	EnterCriticalSection(&SIMC_Thread_CriticalSection);
-}
-
-void SIMC_Thread_LeaveCriticalSection() {
-	LeaveCriticalSection(&SIMC_Thread_CriticalSection);
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-/// @brief Wrapper function for the newly created threads
-////////////////////////////////////////////////////////////////////////////////
-DWORD WINAPI SIMC_Thread_Internal_New(LPVOID lpParam) {
-	SIMC_THREAD_FUNCTION* threadfun;
-	SIMC_THREAD* thread;
-
-	//Get pointer to thread information for current thread
-	thread = SIMC_Thread_Internal_GetPointer(SIMC_Thread_GetCurrentID());
-	if (thread == NULL) return 0;
-
-	//Get user thread function pointer
-	threadfun = thread->function;
-
-	//Call the user thread function
-	threadfun((void*)lpParam);
-
-	//Remove thread from thread list
-	SIMC_Thread_EnterCriticalSection();
-	SIMC_Thread_Internal_Remove(thread);
-	SIMC_Thread_LeaveCriticalSection();
-
-	//Return and kill the thread
-	return 0;
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-/// @brief Create a new thread.
-///
-/// Creates new thread and starts it immediately. For example:
-/// ~~~{.c}
-///		void test_thread(void* data) {
-///		}
-///
-///		SIMC_Thread_Create(test_thread,data);
-/// ~~~
-///
-/// @param[in] func_ptr Pointer to the thread function
-/// @param[in] userdata Variable to pass into the threading function
-///
-/// @returns Thread handle
-////////////////////////////////////////////////////////////////////////////////
-typedef struct tagTHREADNAME_INFO
-{
-	DWORD dwType;		// Must be 0x1000
-	LPCSTR szName;		// Pointer to name (in user addr space)
-	DWORD dwThreadID;	// Thread ID (-1 = caller thread)
-	DWORD dwFlags;		// Reserved for future use, must be zero
-} THREADNAME_INFO;
-
-SIMC_THREAD_ID SIMC_Thread_CreateWithName(void* funcPtr, void* userData, char* funcName) {
-	SIMC_THREAD_ID ID;
-	SIMC_THREAD* thread, *thread_tmp;
-	HANDLE hThread;
-	DWORD dwThreadId;
-
-	//Enter critical section
-	SIMC_Thread_EnterCriticalSection();
-
-	//Create a new thread information memory area
-	thread = (SIMC_THREAD*)SIMC_Allocate(SIMC_Userdata, sizeof(SIMC_THREAD));
-	if (thread == NULL) {
-		SIMC_Thread_LeaveCriticalSection();
-		return SIMC_THREAD_BAD_ID;
-	}
-
-	//Get a new unique thread id
-	ID = (((char*)SIMC_Thread_NextID)++);
-
-	//Store thread information in the thread list
-	thread->function = funcPtr;
-	thread->id       = ID;
-
-	//Create thread
-	hThread = CreateThread(
-	              NULL,                       //Default security attributes
-	              0,                          //Default stack size (1 MB)
-	              SIMC_Thread_Internal_New,   //Thread function (a wrapper function)
-	              (LPVOID)userData,           //Argument to thread is the user argument
-	              0,                          //Default creation flags
-	              &dwThreadId                 //Returned thread identifier
-	         );
-
-	//Did the thread creation fail?
-	if (hThread == NULL) {
-		SIMC_Free(SIMC_Userdata, (void*)thread);
-		SIMC_Thread_LeaveCriticalSection();
-		return SIMC_THREAD_BAD_ID;
-	}
-
-	//Store more thread information in the thread list
-	thread->handle = hThread;
-	thread->winID = dwThreadId;
-
-	//Append thread to thread list
-	thread_tmp = &SIMC_Thread_Main;
-	while (thread_tmp->next != NULL) {
-		thread_tmp = thread_tmp->next;
-	}
-	thread_tmp->next = thread;
-	thread->previous = thread_tmp;
-	thread->next     = NULL;
-
-	// Set name for the thread
-	if (funcName) {
-		THREADNAME_INFO info;
-		info.dwType = 0x1000;
-		info.szName = funcName;
-		info.dwThreadID = dwThreadId;
-		info.dwFlags = 0;
-
-		__try
-		{
-			RaiseException( 0x406D1388, 0, sizeof(info)/sizeof(DWORD), (ULONG_PTR*)&info );
-		}
-		__except (EXCEPTION_CONTINUE_EXECUTION)
-		{ }
-	}
-
-	//Leave critical section
-	SIMC_Thread_LeaveCriticalSection();
-
-	//Return the thread ID
-	//log_writem("Spawned thread [%p] (SIMC_THREAD_ID[0x%x])",funcPtr,ID);
-	return ID;
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-/// @brief Get handle of the currently executed thread.
-///
-/// This function returns the handle of a currently executed thread. It's a relatively
-/// slow call, and should not be used in tight loops.
-///
-/// For checking and identifying threads in a fast way, use SIMC_Thread_GetUniqueID() API
-/// call. The handles returned by both calls are not compatible.
-///
-/// @returns Thread handle
-////////////////////////////////////////////////////////////////////////////////
-SIMC_THREAD_ID SIMC_Thread_GetCurrentID() {
-	SIMC_THREAD* thread;
-	SIMC_THREAD_ID ID = SIMC_THREAD_BAD_ID;
-	DWORD WinID;
-
-	//Get Windows thread ID
-	WinID = GetCurrentThreadId();
-
-	//Enter critical section (to avoid an inconsistent thread list)
-	SIMC_Thread_EnterCriticalSection();
-
-	//Loop through entire list of threads to find the matching Windows thread ID
-	for (thread = &SIMC_Thread_Main; thread != NULL; thread = thread->next) {
-		if (thread->winID == WinID) {
-			ID = thread->id;
-			break;
-		}
-	}
-
-	//Leave critical section
-	SIMC_Thread_LeaveCriticalSection();
-	return ID;
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-/// @brief Return unique identifier of the current thread.
-///
-/// Returns OS handle for the currently executed thread. Unlike SIMC_Thread_GetCurrentID()
-/// does not carry any significant overhead. This call is mostly used to identify threads:
-/// ~~~{.c}
-///		thread_id = SIMC_Thread_GetUniqueID()
-///		...
-///		if (SIMC_Thread_GetUniqueID() == thread_id) ...
-/// ~~~
-///
-/// @returns Unique handle
-////////////////////////////////////////////////////////////////////////////////
-SIMC_THREAD_ID SIMC_Thread_GetUniqueID() {
-	return (SIMC_THREAD_ID)GetCurrentThreadId();
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-/// @brief Waits current thread until the target thread finishes execution.
-///
-/// Several of these calls can be used together to wait until an array of worker
-/// threads complete. For example:
-/// ~~~{.c}
-///		SIMC_THREAD_ID workers[32];
-///		for (i = 0; i < 32; i++) workers[i] = SIMC_Thread_Create(worker_thread,(void*)i);
-///		for (i = 0; i < 32; i++) SIMC_Thread_WaitFor(workers[i]);
-/// ~~~
-///
-/// @param[in] ID Thread handle
-////////////////////////////////////////////////////////////////////////////////
-int SIMC_Thread_WaitFor(SIMC_THREAD_ID ID) {
-	DWORD result;
-	HANDLE hThread;
-	SIMC_THREAD* thread;
-
-	//Enter critical section
-	SIMC_Thread_EnterCriticalSection();
-
-	//Get thread information pointer
-	thread = SIMC_Thread_Internal_GetPointer(ID);
-
-	//Is the thread already dead?
-	if (thread == NULL)	{
-		SIMC_Thread_LeaveCriticalSection();
-		return 1;
-	}
-
-	//Get thread handle
-	hThread = thread->handle;
-
-	//Leave critical section
-	SIMC_Thread_LeaveCriticalSection();
-
-	//Wait for thread to die
-	//if(waitmode == GLFW_WAIT) {
-	result = WaitForSingleObject(hThread, INFINITE);
-	//} else if(waitmode == GLFW_NOWAIT) {
-	//result = WaitForSingleObject(hThread, 0);
-	//} else {
-	//return 0;
-	//}
-
-	//Did we have a time-out?
-	if (result == WAIT_TIMEOUT) return 0;
-	return 1;
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-/// @brief Stop and remove thread by handle.
-///
-/// @param[in] ID Thread ID
-////////////////////////////////////////////////////////////////////////////////
-void SIMC_Thread_Kill(SIMC_THREAD_ID ID) {
-	SIMC_THREAD* thread;
-
-	//Enter critical section
-	SIMC_Thread_EnterCriticalSection();
-
-	//Get thread information pointer
-	thread = SIMC_Thread_Internal_GetPointer(ID);
-	if (thread == NULL) {
-		SIMC_Thread_LeaveCriticalSection();
-		return;
-	}
-
-	//Kill the process
-	if (TerminateThread(thread->handle, 0)) {
-		//Close thread handle
-		CloseHandle(thread->handle);
-
-		//Remove thread from thread list
-		SIMC_Thread_Internal_Remove(thread);
-	}
-
-	//Leave critical section
-	SIMC_Thread_LeaveCriticalSection();
-}
-#endif
-
-
-////////////////////////////////////////////////////////////////////////////////
-/// @brief Wait current thread for the specified time.
-///
-/// This function accepts time in seconds. On all platforms wait time cannot
-/// exceed \f$2^{31}\f$ seconds, and cannot be less than one millisecond.
-///
-/// Passing wait time of 0.0 will simply yield execution of the current thread.
-///
-/// @param[in] time Delay in seconds, or 0.0 if thread must yield execution
-////////////////////////////////////////////////////////////////////////////////
-void SIMC_Thread_Sleep(double time) {
-	DWORD t;
-
-	if (time == 0.0) {
-		SwitchToThread();
-	}
-
-	if (time <= 1e-3) {
-		t = 1;
-	} else if (time > 2147483647.0) {
-		t = 2147483647;
-	} else {
-		t = (DWORD)(time*1000.0 + 0.5);
-	}
-	Sleep(t);
-}
-
-
-#ifndef SIMC_SINGLETHREADED
-////////////////////////////////////////////////////////////////////////////////
-/// @brief Thread get number of processors (cores).
-///
-/// This returns number of processors as reported by the OS - returns double the
-/// physical amount on hyperthreaded systems.
-///
-/// @returns Number of processors (cores) on the system
-////////////////////////////////////////////////////////////////////////////////
-int SIMC_Thread_GetNumProcessors() {
-	SYSTEM_INFO si;
-	GetSystemInfo(&si);
-	return (int)si.dwNumberOfProcessors;
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-/// @brief Creates an exclusive lock (mutex/critical section).
-/// 
-/// Example of use:
-/// ~~~{.c}
-///		SIMC_LOCK_ID lock = SIMC_Lock_Create();
-///		SIMC_Lock_Enter(lock);
-///			...
-///		SIMC_Lock_Leave(lock);
-/// ~~~
-///
-/// @returns Lock handle
-////////////////////////////////////////////////////////////////////////////////
-SIMC_LOCK_ID SIMC_Lock_Create() {
-	CRITICAL_SECTION* lock;
-
-	//Allocate memory for lock
-	lock = (CRITICAL_SECTION*)SIMC_Allocate(SIMC_Userdata, sizeof(SIMC_Thread_CriticalSection));
-	if (!lock)
-	{
-		return SIMC_THREAD_BAD_ID;
-	}
-	if ((SIMC_LOCK_ID)lock == SIMC_THREAD_BAD_ID)
-	{
-		return SIMC_THREAD_BAD_ID;
-	}
-
-	//Initialize lock
-	InitializeCriticalSection(lock);
-
-	//Cast to lock ID and return
-	return (SIMC_LOCK_ID)lock;
-}
-
-////////////////////////////////////////////////////////////////////////////////
-/// @brief Deletes an exclusive lock.
-/// @param[in] lockID Lock handle
-////////////////////////////////////////////////////////////////////////////////
-void SIMC_Lock_Destroy(SIMC_LOCK_ID lockID) {
-	DeleteCriticalSection((CRITICAL_SECTION*)lockID);
-	SIMC_Free(SIMC_Userdata, (void*)lockID);
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-/// @brief Enter exclusive lock.
-/// @param[in] lockID Lock handle
-/// @returns Lock handle passed into the function
-////////////////////////////////////////////////////////////////////////////////
-SIMC_LOCK_ID SIMC_Lock_Enter(SIMC_LOCK_ID lockID) {
-	if (lockID != SIMC_THREAD_BAD_ID) {
-		//Wait for lock to be released
-		EnterCriticalSection((CRITICAL_SECTION*)lockID);
-	}
-	return lockID;
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-/// @brief Try to enter exclusive lock.
-/// @param[in] lockID Lock handle
-/// @returns Whether lock could be entered
-////////////////////////////////////////////////////////////////////////////////
-/*int SIMC_Lock_TryEnter(SIMC_LOCK_ID lockID) {
-	if (lockID != SIMC_THREAD_BAD_ID) {
-		return TryEnterCriticalSection((CRITICAL_SECTION*)lockID) != 0;
-	}
-	return 0;
-}*/
-
-
-////////////////////////////////////////////////////////////////////////////////
-/// @brief Leave exclusive lock.
-/// @param[in] lockID Lock handle
-////////////////////////////////////////////////////////////////////////////////
-void SIMC_Lock_Leave(SIMC_LOCK_ID lockID) {
-	if (lockID != SIMC_THREAD_BAD_ID) {
-		LeaveCriticalSection((CRITICAL_SECTION*)lockID);
-	}
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-/// @brief Waits until exclusive lock is left by locking thread.
-///
-/// It is useful to make a lock when some worker thread is running, and then simply
-/// unlock it in the end. Main thread can use SIMC_Lock_WaitFor() to wait until
-/// the worked thread(s) complete it task.
-///
-/// @param[in] lockID Lock handle
-////////////////////////////////////////////////////////////////////////////////
-void SIMC_Lock_WaitFor(SIMC_LOCK_ID lockID) {
-	SIMC_Lock_Leave(SIMC_Lock_Enter(lockID));
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-/// @brief Create a new event
-////////////////////////////////////////////////////////////////////////////////
-SIMC_EVENT_ID SIMC_Event_Create(char* eventName) {
-	HANDLE handle = CreateEventA(NULL, TRUE, FALSE, (LPCSTR)eventName);
-	if (handle == NULL) return SIMC_THREAD_BAD_ID;
-	return (SIMC_EVENT_ID)handle;
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-/// @brief Fire event
-////////////////////////////////////////////////////////////////////////////////
-void SIMC_Event_Fire(SIMC_EVENT_ID eventID) {
-	if (eventID != SIMC_THREAD_BAD_ID) {
-		SetEvent((HANDLE)eventID);
-	}
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-/// @brief Reset event
-////////////////////////////////////////////////////////////////////////////////
-void SIMC_Event_Reset(SIMC_EVENT_ID eventID) {
-	if (eventID != SIMC_THREAD_BAD_ID) {
-		ResetEvent((HANDLE)eventID);
-	}
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-/// @brief Wait for event to be fired
-////////////////////////////////////////////////////////////////////////////////
-int SIMC_Event_WaitFor(SIMC_EVENT_ID eventID, double time) {
-	if (eventID != SIMC_THREAD_BAD_ID) {
-		DWORD timeMs = (DWORD)(time*1000);
-		DWORD waitResult;
-		
-		if (time <= 0.0) timeMs = 0;
-		if (time > 1e9) timeMs = INFINITE;
-		waitResult = WaitForSingleObject((HANDLE)eventID, timeMs);
-
-		if (waitResult == WAIT_OBJECT_0) return 1;
-	}
-	return 0;
-}
-
-
-
-
-//Slim read-write locks (WinAPI implementation)
-#ifdef SIMC_NATIVE_SRW
-
-////////////////////////////////////////////////////////////////////////////////
-/// @brief Create slim read/write lock.
-///
-/// SRW locks are useful for protecting data when write operations are much more
-/// sparse than read operations. For example:
-/// ~~~{.c}
-///		SIMC_SRW_ID lock = SIMC_SRW_Create();
-///		SIMC_SRW_EnterRead(lock);
-///			... data will not be changed here ...
-///		SIMC_SRW_LeaveRead(lock);
-///
-///		SIMC_SRW_EnterWrite(lock);
-///			... no other thread will read data ...
-///		SIMC_SRW_LeaveWrite(lock);
-/// ~~~
-///
-/// @returns Lock handle
-////////////////////////////////////////////////////////////////////////////////
-SIMC_SRW_ID SIMC_SRW_Create() {
-	PSRWLOCK lock = (PSRWLOCK)SIMC_Allocate(SIMC_Userdata, sizeof(SRWLOCK));
-	InitializeSRWLock(lock);
-	return (SIMC_SRW_ID)lock;
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-/// @brief Destroy SRW lock.
-/// @param[in] srwID Lock handle
-////////////////////////////////////////////////////////////////////////////////
-void SIMC_SRW_Destroy(SIMC_SRW_ID srwID) {
-	PSRWLOCK lock = (PSRWLOCK)srwID;
-	if ((!srwID) || (srwID == SIMC_THREAD_BAD_ID)) return;
-	SIMC_Free(SIMC_Userdata, lock);
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-/// @brief Enter shared reading section (within this section, no writes will be performed to data).
-/// @param[in] srwID Lock handle
-////////////////////////////////////////////////////////////////////////////////
-void SIMC_SRW_EnterRead(SIMC_SRW_ID srwID) {
-	PSRWLOCK lock = (PSRWLOCK)srwID;
-	if ((!srwID) || (srwID == SIMC_THREAD_BAD_ID)) return;
-	AcquireSRWLockShared(lock);
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-/// @brief Leave shared reading section.
-/// @param[in] srwID Lock handle
-////////////////////////////////////////////////////////////////////////////////
-void SIMC_SRW_LeaveRead(SIMC_SRW_ID srwID) {
-	PSRWLOCK lock = (PSRWLOCK)srwID;
-	if ((!srwID) || (srwID == SIMC_THREAD_BAD_ID)) return;
-	ReleaseSRWLockShared(lock);
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-/// @brief Enter exclusive writing section.
-/// @param[in] srwID Lock handle
-////////////////////////////////////////////////////////////////////////////////
-void SIMC_SRW_EnterWrite(SIMC_SRW_ID srwID) {
-	PSRWLOCK lock = (PSRWLOCK)srwID;
-	if ((!srwID) || (srwID == SIMC_THREAD_BAD_ID)) return;
-
-	AcquireSRWLockExclusive(lock);
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-/// @brief Leave exclusive writing section.
-/// @param[in] srwID Lock handle
-////////////////////////////////////////////////////////////////////////////////
-void SIMC_SRW_LeaveWrite(SIMC_SRW_ID srwID) {
-	PSRWLOCK lock = (PSRWLOCK)srwID;
-	if ((!srwID) || (srwID == SIMC_THREAD_BAD_ID)) return;
-	ReleaseSRWLockExclusive(lock);
-}
-
-#else
-
-#define SIMC_SRW_THRESHOLD	0xFFFF
-typedef struct SIMC_SRW_LOCK_TAG {
-	SIMC_LOCK_ID write_lock;
-	long srw_lock;
-} SIMC_SRW_LOCK;
-
-SIMC_SRW_ID SIMC_SRW_Create() {
-	SIMC_SRW_LOCK* lock = (SIMC_SRW_LOCK*)SIMC_Allocate(SIMC_Userdata, sizeof(SIMC_SRW_LOCK));
-	lock->write_lock = SIMC_Lock_Create();
-	lock->srw_lock = 0;
-	return (SIMC_SRW_ID)lock;
-}
-
-void SIMC_SRW_Destroy(SIMC_SRW_ID srwID) {
-	SIMC_SRW_LOCK* lock = (SIMC_SRW_LOCK*)srwID;
-	if ((!srwID) || (srwID == SIMC_THREAD_BAD_ID)) return;
-
-	SIMC_Lock_Destroy(lock->write_lock);
-	SIMC_Free(SIMC_Userdata, lock);
-}
-
-void SIMC_SRW_EnterRead(SIMC_SRW_ID srwID) {
-	SIMC_SRW_LOCK* lock = (SIMC_SRW_LOCK*)srwID;
-	if ((!srwID) || (srwID == SIMC_THREAD_BAD_ID)) return;
-
-	while (InterlockedIncrement(&lock->srw_lock) < 0) {
-        InterlockedDecrement(&lock->srw_lock);
-        SwitchToThread();
-    }
-}
-
-void SIMC_SRW_LeaveRead(SIMC_SRW_ID srwID) {
-	SIMC_SRW_LOCK* lock = (SIMC_SRW_LOCK*)srwID;
-	if ((!srwID) || (srwID == SIMC_THREAD_BAD_ID)) return;
-
-	InterlockedDecrement(&lock->srw_lock);
-}
-
-void SIMC_SRW_EnterWrite(SIMC_SRW_ID srwID) {
-	SIMC_SRW_LOCK* lock = (SIMC_SRW_LOCK*)srwID;
-	if ((!srwID) || (srwID == SIMC_THREAD_BAD_ID)) return;
-
-	SIMC_Lock_Enter(lock->write_lock); //Block other threads from writing
-	InterlockedExchangeAdd(&lock->srw_lock,-SIMC_SRW_THRESHOLD);
-	while ((lock->srw_lock) > -SIMC_SRW_THRESHOLD) { //Wait until read threads finish
-        SwitchToThread();
-    }
-}
-
-void SIMC_SRW_LeaveWrite(SIMC_SRW_ID srwID) {
-	SIMC_SRW_LOCK* lock = (SIMC_SRW_LOCK*)srwID;
-	if ((!srwID) || (srwID == SIMC_THREAD_BAD_ID)) return;
-
-	while ((lock->srw_lock) != -SIMC_SRW_THRESHOLD) { //Block execution if not leaving write lock
-		SwitchToThread();
-	}
-	InterlockedExchangeAdd(&lock->srw_lock,SIMC_SRW_THRESHOLD);
-	SIMC_Lock_Leave(lock->write_lock);
-}
-
-#endif
-
-
-
-////////////////////////////////////////////////////////////////////////////////
-/// @brief Initialize threading
-////////////////////////////////////////////////////////////////////////////////
-void SIMC_Thread_Initialize() {
-	if (SIMC_Instance_Counter == 0) {
-		//Initialize critical section handle
-		InitializeCriticalSection(&SIMC_Thread_CriticalSection);
-	
-		//The first thread (the main thread) has ID 0
-		SIMC_Thread_NextID = 0;
-	
-		//Fill out information about the main thread (this thread)
-		SIMC_Thread_Main.id       = (((char*)SIMC_Thread_NextID)++);
-		SIMC_Thread_Main.function = 0;
-		SIMC_Thread_Main.handle   = GetCurrentThread();
-		SIMC_Thread_Main.winID    = GetCurrentThreadId();
-		SIMC_Thread_Main.previous = 0;
-		SIMC_Thread_Main.next     = 0;
-	}
-
-	SIMC_Instance_Counter++;
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-/// @brief Deinitialize threading and shut down all threads
-////////////////////////////////////////////////////////////////////////////////
-void SIMC_Thread_Deinitialize() {
-	SIMC_THREAD* thread, *thread_next;
-
-	//Check reference counter
-	SIMC_Instance_Counter--;
-	if (SIMC_Instance_Counter > 0) return;
-
-	//Enter critical section
-	SIMC_Thread_EnterCriticalSection();
-
-	//Kill all threads
-	thread = SIMC_Thread_Main.next;
-	while (thread != NULL) {
-		//Get pointer to next thread
-		thread_next = thread->next;
-
-		//Simply murder the process, no mercy!
-		if (TerminateThread(thread->handle, 0)) {
-			//Close thread handle
-			CloseHandle(thread->handle);
-
-			//Free memory allocated for this thread
-			SIMC_Free(SIMC_Userdata, (void*)thread);
-		}
-
-		//Select next thread in list
-		thread = thread_next;
-	}
-
-	//Leave critical section
-	SIMC_Thread_LeaveCriticalSection();
-
-	//Delete critical section handle
-	DeleteCriticalSection(&SIMC_Thread_CriticalSection);
-}
-#endif
-
-
-
-
-
-
-
-
-#else
-////////////////////////////////////////////////////////////////////////////////
-// POSIX specific code
-////////////////////////////////////////////////////////////////////////////////
-#ifndef SIMC_SINGLETHREADED
-
-pthread_mutex_t SIMC_Thread_CriticalSection;
-
-void SIMC_Thread_EnterCriticalSection() {
-	pthread_mutex_lock(&SIMC_Thread_CriticalSection);
-}
-
-void SIMC_Thread_LeaveCriticalSection() {
-	pthread_mutex_unlock(&SIMC_Thread_CriticalSection);
-}
-
-
-void* SIMC_Thread_Internal_New(void *arg) {
-	SIMC_THREAD_FUNCTION* threadfunc;
-	SIMC_THREAD *thread;
-	pthread_t posixID;
-
-	//Get current thread ID
-	posixID = pthread_self();
-
-	//Enter critical section
-	SIMC_Thread_EnterCriticalSection();
-
-	//Loop through entire list of threads to find the matching POSIX thread ID
-	for (thread = &SIMC_Thread_Main; thread != NULL; thread = thread->next) {
-		if(thread->posixID == posixID) break;
-	}
-
-	if (thread == NULL) {
-		SIMC_Thread_LeaveCriticalSection();
-		return NULL;
-	}
-
-	//Get user thread function pointer
-	threadfunc = thread->function;
-
-	//Leave critical section
-	SIMC_Thread_LeaveCriticalSection();
-
-	//Call the user thread function
-	threadfunc(arg);
-
-	//Remove thread from thread list
-	SIMC_Thread_EnterCriticalSection();
-	SIMC_Thread_Internal_Remove(thread);
-	SIMC_Thread_LeaveCriticalSection();
-
-	//When the thread function returns, the thread will die...
-	return NULL;
-}
-
-
-SIMC_THREAD_ID SIMC_Thread_Create(void* funcPtr, void* userData) {
-	SIMC_THREAD_ID ID;
-	SIMC_THREAD *thread, *thread_tmp;
-	int result;
-
-	//Enter critical section
-	SIMC_Thread_EnterCriticalSection();
-
-	//Create a new thread information memory area
-	thread = (SIMC_THREAD*)SIMC_Allocate(SIMC_Userdata, sizeof(SIMC_THREAD));
-	if (thread == NULL) {
-		SIMC_Thread_LeaveCriticalSection();
-		return SIMC_THREAD_BAD_ID;
-	}
-
-	//Get a new unique thread id
-	ID = SIMC_Thread_NextID++;
-
-	//Store thread information in the thread list
-	thread->function = funcPtr;
-	thread->id       = ID;
-
-	//Create thread
-	result = pthread_create(
-		&thread->posixID,      //Thread handle
-		NULL,             //Default thread attributes
-		SIMC_Thread_Internal_New,      //Thread function (a wrapper function)
-		(void*)userData   //Argument to thread is user argument
-   	);
-
-	//Did the thread creation fail?
-	if (result != 0) {
-		SIMC_Free(SIMC_Userdata, (void*)thread);
-		SIMC_Thread_LeaveCriticalSection();
-		return SIMC_THREAD_BAD_ID;
-	}
-
-	//Append thread to thread list
-	thread_tmp = &SIMC_Thread_Main;
-	while (thread_tmp->next != NULL) {
-		thread_tmp = thread_tmp->next;
-	}
-	thread_tmp->next = thread;
-	thread->previous = thread_tmp;
-	thread->next     = NULL;
-
-	//Leave critical section
-	SIMC_Thread_LeaveCriticalSection();
-	return ID;
-}
-
-
-SIMC_THREAD_ID SIMC_Thread_GetCurrentID() {
-	SIMC_THREAD *thread;
-	SIMC_THREAD_ID ID = SIMC_THREAD_BAD_ID;
-	pthread_t posixID;
-
-	//Get current thread ID
-	posixID = pthread_self();
-
-	//Enter critical section
-	SIMC_Thread_EnterCriticalSection();
-
-	//Loop through entire list of threads to find the matching POSIX thread ID
-	for (thread = &SIMC_Thread_Main; thread != NULL; thread = thread->next) {
-		if(thread->posixID == posixID)
-		{
-			ID = thread->id;
-			break;
-		}
-	}
-
-	//Leave critical section
-	SIMC_Thread_LeaveCriticalSection();
-	return ID;
-}
-
-
-SIMC_THREAD_ID SIMC_Thread_GetUniqueID() {
-	return (SIMC_THREAD_ID)pthread_self();
-}
-
-
-int SIMC_Thread_WaitFor(SIMC_THREAD_ID ID) {
-	pthread_t pthread;
-	SIMC_THREAD *thread;
-
-	//Enter critical section
-	SIMC_Thread_EnterCriticalSection();
-
-	//Get thread information pointer
-	thread = SIMC_Thread_Internal_GetPointer(ID);
-
-	//Is the thread already dead?
-	if (thread == NULL) {
-		SIMC_Thread_LeaveCriticalSection();
-		return 1;
-	}
-
-	//If got this far, the thread is alive => polling returns FALSE
-	//if(waitmode == GLFW_NOWAIT)
-	//{
-		//SIMC_Thread_LeaveCriticalSection();
-		//return 0;
-	//}
-
-	//Get thread handle
-	pthread = thread->posixID;
-
-	//Leave critical section
-	SIMC_Thread_LeaveCriticalSection();
-
-	//Wait for thread to die
-	(void)pthread_join(pthread, NULL);
-
-	return 1;
-}
-
-
-void SIMC_Thread_Kill(SIMC_THREAD_ID ID) {
-	SIMC_THREAD *thread;
-
-	//Enter critical section
-	SIMC_Thread_EnterCriticalSection();
-
-	//Get thread information pointer
-	thread = SIMC_Thread_Internal_GetPointer(ID);
-	if (thread == NULL) {
-		SIMC_Thread_LeaveCriticalSection();
-		return;
-	}
-
-	//Simply murder the process, no mercy!
-	pthread_kill(thread->posixID, SIGKILL);
-
-	//Remove thread from thread list
-	SIMC_Thread_Internal_Remove(thread);
-
-	//Leave critical section
-	SIMC_Thread_LeaveCriticalSection();
-}
-#endif
-
-void SIMC_Thread_Sleep(double time)
-{
-	struct timeval  currenttime;
-	struct timespec wait;
-	pthread_mutex_t mutex;
-	pthread_cond_t  cond;
-	long dt_sec, dt_usec;
-
-	if (time < 1e-3) {
-		sched_yield();
-		return;
-	}
-
-	//Set timeout time, relatvie to current time
-	gettimeofday( &currenttime, NULL );
-	dt_sec  = (long)time;
-	dt_usec = (long)((time - (double)dt_sec) * 1000000.0);
-	wait.tv_nsec = (currenttime.tv_usec + dt_usec) * 1000L;
-	if (wait.tv_nsec > 1000000000L) 	{
-		wait.tv_nsec -= 1000000000L;
-		dt_sec++;
-	}
-	wait.tv_sec  = currenttime.tv_sec + dt_sec;
-
-	//Initialize condition and mutex objects
-	pthread_mutex_init(&mutex, NULL);
-	pthread_cond_init(&cond, NULL);
-
-	//Do a timed wait
-	pthread_mutex_lock(&mutex);
-	pthread_cond_timedwait(&cond, &mutex, &wait);
-	pthread_mutex_unlock(&mutex);
-
-	//Destroy condition and mutex objects
-	pthread_mutex_destroy(&mutex);
-	pthread_cond_destroy(&cond);
-}
-
-#ifndef SIMC_SINGLETHREADED
-int SIMC_Thread_GetNumProcessors() {
-	return (int)sysconf(_SC_NPROCESSORS_ONLN);
-}
-
-
-//#ifndef SIMC_NATIVE_SRW
-
-#define SIMC_SRW_THRESHOLD	0xFFFF
-typedef struct SIMC_SRW_LOCK_TAG {
-	SIMC_LOCK_ID write_lock;
-	long srw_lock;
-} SIMC_SRW_LOCK;
-
-
-SIMC_SRW_ID SIMC_SRW_Create() {
-	SIMC_SRW_LOCK* lock = (SIMC_SRW_LOCK*)SIMC_Allocate(SIMC_Userdata, sizeof(SIMC_SRW_LOCK));
-	lock->write_lock = SIMC_Lock_Create();
-	lock->srw_lock = 0;
-	return (SIMC_SRW_ID)lock;
-}
-
-void SIMC_SRW_Destroy(SIMC_SRW_ID srwID) {
-	SIMC_SRW_LOCK* lock = (SIMC_SRW_LOCK*)srwID;
-	if ((!srwID) || (srwID == SIMC_THREAD_BAD_ID)) return;
-
-	SIMC_Lock_Destroy(lock->write_lock);
-	SIMC_Free(SIMC_Userdata, lock);
-}
-
-void SIMC_SRW_EnterRead(SIMC_SRW_ID srwID) {
-	SIMC_SRW_LOCK* lock = (SIMC_SRW_LOCK*)srwID;
-	if ((!srwID) || (srwID == SIMC_THREAD_BAD_ID)) return;
-
-	while (__sync_fetch_and_add(&lock->srw_lock,1) < 0) {
-        __sync_fetch_and_add(&lock->srw_lock,-1);
-        pthread_yield();
-    }
-}
-
-void SIMC_SRW_LeaveRead(SIMC_SRW_ID srwID) {
-	SIMC_SRW_LOCK* lock = (SIMC_SRW_LOCK*)srwID;
-	if ((!srwID) || (srwID == SIMC_THREAD_BAD_ID)) return;
-
-	__sync_fetch_and_add(&lock->srw_lock,-1);
-}
-
-void SIMC_SRW_EnterWrite(SIMC_SRW_ID srwID) {
-	SIMC_SRW_LOCK* lock = (SIMC_SRW_LOCK*)srwID;
-	if ((!srwID) || (srwID == SIMC_THREAD_BAD_ID)) return;
-
-	SIMC_Lock_Enter(lock->write_lock); //Block other threads from writing
-	__sync_fetch_and_add(&lock->srw_lock,-SIMC_SRW_THRESHOLD);
-	while ((lock->srw_lock) > -SIMC_SRW_THRESHOLD) { //Wait until read threads finish
-        pthread_yield();
-    }
-}
-
-void SIMC_SRW_LeaveWrite(SIMC_SRW_ID srwID) {
-	SIMC_SRW_LOCK* lock = (SIMC_SRW_LOCK*)srwID;
-	if ((!srwID) || (srwID == SIMC_THREAD_BAD_ID)) return;
-
-	while ((lock->srw_lock) != -SIMC_SRW_THRESHOLD) { //Block execution if not leaving write lock
-		pthread_yield();
-	}
-	__sync_fetch_and_add(&lock->srw_lock,SIMC_SRW_THRESHOLD);
-	SIMC_Lock_Leave(lock->write_lock);
-}
-//#endif
-
-
-SIMC_LOCK_ID SIMC_Lock_Create() {
-	pthread_mutex_t *mutex;
-
-	//Allocate memory for mutex
-	mutex = (pthread_mutex_t*)SIMC_Allocate(SIMC_Userdata, sizeof(pthread_mutex_t));
-	if(!mutex) return SIMC_THREAD_BAD_ID;
-
-	//Initialise a mutex object
-	(void)pthread_mutex_init(mutex, NULL);
-	return (SIMC_LOCK_ID)mutex;
-}
-
-
-void SIMC_Lock_Destroy(SIMC_LOCK_ID lockID) {
-	//Destroy the mutex object
-	pthread_mutex_destroy((pthread_mutex_t*)lockID);
-	//Free memory for mutex object
-	SIMC_Free(SIMC_Userdata, (void*)lockID);
-}
-
-
-SIMC_LOCK_ID SIMC_Lock_Enter(SIMC_LOCK_ID lockID) {
-	//Wait for mutex to be released
-	(void)pthread_mutex_lock((pthread_mutex_t*)lockID);
-	return lockID;
-}
-
-
-void SIMC_Lock_Leave(SIMC_LOCK_ID lockID) {
-	//Release mutex
-	pthread_mutex_unlock((pthread_mutex_t*)lockID);
-}
-
-
-void SIMC_Lock_WaitFor(SIMC_LOCK_ID lockID) {
-	SIMC_Lock_Leave(SIMC_Lock_Enter(lockID));
-}
-
-
-void SIMC_Thread_Initialize() {
-	if (SIMC_Instance_Counter == 0) {
-		// Initialize critical section handle
-		(void) pthread_mutex_init(&SIMC_Thread_CriticalSection, NULL );
-	
-		// The first thread (the main thread) has ID 0
-		SIMC_Thread_NextID = 0;
-	
-		// Fill out information about the main thread (this thread)
-		SIMC_Thread_Main.id       = SIMC_Thread_NextID++;
-		SIMC_Thread_Main.function = NULL;
-		SIMC_Thread_Main.previous = NULL;
-		SIMC_Thread_Main.next     = NULL;
-		SIMC_Thread_Main.posixID  = pthread_self();
-	}
-	SIMC_Instance_Counter++;
-}
-
-
-void SIMC_Thread_Deinitialize() {
-	SIMC_THREAD *thread, *thread_next;
-
-	//Check instance counter
-	SIMC_Instance_Counter--;
-	if (SIMC_Instance_Counter > 0) return;
-
-	//Enter critical section
-	SIMC_Thread_EnterCriticalSection();
-
-	//Kill all threads
-	thread = SIMC_Thread_Main.next;
-	while (thread != NULL) {
-		//Get pointer to next thread
-		thread_next = thread->next;
-
-		//Simply murder the process, no mercy!
-		pthread_kill(thread->posixID, SIGKILL);
-
-		//Free memory allocated for this thread
-		SIMC_Free(SIMC_Userdata, (void*)thread);
-
-		//Select next thread in list
-		thread = thread_next;
-	}
-
-	//Leave critical section
-	SIMC_Thread_LeaveCriticalSection();
-
-	//Delete critical section handle
-	pthread_mutex_destroy(&SIMC_Thread_CriticalSection);
-}
-#endif
-
-#endif
+////////////////////////////////////////////////////////////////////////////////
+/// @file
+////////////////////////////////////////////////////////////////////////////////
+/// Portions of this source file are derived from GLFW (http://www.glfw.org).
+/// The original work belongs to its authors:
+///  Copyright (C) 2002-2006, Marcus Geelnard
+///  Copyright (C) 2006-2011, Camilla Berglund
+////////////////////////////////////////////////////////////////////////////////
+/// Copyright (C) 2012-2015, Black Phoenix
+///
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the GNU Lesser General Public License as published by the Free Software
+/// Foundation; either version 2 of the License, or (at your option) any later
+/// version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+/// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+/// details.
+///
+/// You should have received a copy of the GNU Lesser General Public License along with
+/// this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+/// Place - Suite 330, Boston, MA  02111-1307, USA.
+///
+/// Further information about the GNU Lesser General Public License can also be found on
+/// the world wide web at http://www.gnu.org.
+////////////////////////////////////////////////////////////////////////////////
+#include "sim_core.h"
+#ifdef _WIN32
+#	include <windows.h>
+#else
+#	include <stdlib.h>
+#	include <pthread.h>
+#	include <sched.h>
+#	include <signal.h>
+#	include <errno.h>
+#	include <time.h>
+#	include <unistd.h>
+#endif
+
+// Use WinAPI/POSIX implementation of SRW locks instead of custom implementation (windows-only)
+#define SIMC_NATIVE_SRW
+
+// Time before the deadline at which precise sleep stops waiting on the OS timer and starts spinning (ns)
+#ifdef _WIN32
+#	define SIMC_THREAD_SPIN_TAIL	2000000
+#else
+#	define SIMC_THREAD_SPIN_TAIL	50000
+#endif
+
+// Hint to the processor that the thread is spinning
+#if defined(_WIN32)
+#	define SIMC_THREAD_PAUSE()		YieldProcessor()
+#elif defined(__i386__) || defined(__x86_64__)
+#	define SIMC_THREAD_PAUSE()		__builtin_ia32_pause()
+#else
+#	define SIMC_THREAD_PAUSE()		((void)0)
+#endif
+
+// With lock profiling the native locks are wrapped by the public API in sim_lockprofile.c
+#if defined(SIMC_LOCK_PROFILING) && !defined(SIMC_SINGLETHREADED)
+#	define SIMC_Lock_Create			SIMC_Lock_Internal_Create
+#	define SIMC_Lock_Destroy		SIMC_Lock_Internal_Destroy
+#	define SIMC_Lock_Enter			SIMC_Lock_Internal_Enter
+#	define SIMC_Lock_TryEnter		SIMC_Lock_Internal_TryEnter
+#	define SIMC_Lock_Leave			SIMC_Lock_Internal_Leave
+#	define SIMC_Lock_WaitFor		SIMC_Lock_Internal_WaitFor
+#	define SIMC_SRW_Create			SIMC_SRW_Internal_Create
+#	define SIMC_SRW_Destroy			SIMC_SRW_Internal_Destroy
+#	define SIMC_SRW_EnterRead		SIMC_SRW_Internal_EnterRead
+#	define SIMC_SRW_LeaveRead		SIMC_SRW_Internal_LeaveRead
+#	define SIMC_SRW_EnterWrite		SIMC_SRW_Internal_EnterWrite
+#	define SIMC_SRW_LeaveWrite		SIMC_SRW_Internal_LeaveWrite
+#endif
+
+// Allocate memory
+void* SIMC_Default_Allocate(void* userdata, size_t size) {
+	return malloc(size);
+}
+
+// Free memory
+void SIMC_Default_Free(void* userdata, void* pointer) {
+	free(pointer);
+}
+
+// Pointers to memory allocation functions
+SIMC_Callback_Allocate* SIMC_Allocate = &SIMC_Default_Allocate;
+SIMC_Callback_Free* SIMC_Free = &SIMC_Default_Free;
+void* SIMC_Userdata = 0;
+
+// Set allocation functions
+void SIMC_SetCallbacks(void* userdata, SIMC_Callback_Allocate* OnAllocate, SIMC_Callback_Free* OnFree) {
+	SIMC_Userdata = userdata;
+	SIMC_Allocate = OnAllocate;
+	SIMC_Free = OnFree;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Internal data structures and typedefs
+////////////////////////////////////////////////////////////////////////////////
+#ifndef SIMC_SINGLETHREADED
+
+/// Callback for the function that can be used as a pointer for a thread
+typedef void SIMC_THREAD_FUNCTION(void* userdata);
+
+#ifndef DOXYGEN_INTERNAL_STRUCTS
+typedef struct SIMC_THREAD_TAG {
+	//Shared members
+	struct SIMC_THREAD_TAG	*previous, *next;  //Linked list implementation
+	SIMC_THREAD_ID			id;               //Thread ID
+	void*					function;         //Function to call
+	char*					name;             //Thread name
+
+	//System-specific handles
+#ifdef _WIN32
+	HANDLE         handle;
+	DWORD          winID;
+#else
+	pthread_t      posixID;
+#endif
+} SIMC_THREAD;
+#endif
+
+
+//Global variables for threading system
+SIMC_THREAD_ID SIMC_Thread_NextID = (void*)1;
+SIMC_THREAD SIMC_Thread_Main;
+unsigned int SIMC_Instance_Counter = 0;
+
+
+//Get thread pointer
+SIMC_THREAD* SIMC_Thread_Internal_GetPointer(SIMC_THREAD_ID ID) {
+	SIMC_THREAD* thread;
+	for (thread = &SIMC_Thread_Main; thread != NULL; thread = thread->next) {
+		if (thread->id == ID) break;
+	}
+	return thread;
+}
+
+//Remove thread
+void SIMC_Thread_Internal_Remove(SIMC_THREAD* thread) {
+	if (thread->previous != NULL) thread->previous->next = thread->next;
+	if (thread->next != NULL) thread->next->previous = thread->previous;
+	SIMC_Free(SIMC_Userdata, (void*)thread);
+}
+#endif
+
+
+
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Windows specific code
+////////////////////////////////////////////////////////////////////////////////
+#ifdef _WIN32
+#ifndef SIMC_SINGLETHREADED
+
+CRITICAL_SECTION SIMC_Thread_CriticalSection;
+void SIMC_Thread_EnterCriticalSection() {
+	EnterCriticalSection(&SIMC_Thread_CriticalSection);
+}
+
+void SIMC_Thread_LeaveCriticalSection() {
+	LeaveCriticalSection(&SIMC_Thread_CriticalSection);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Wrapper function for the newly created threads
+////////////////////////////////////////////////////////////////////////////////
+DWORD WINAPI SIMC_Thread_Internal_New(LPVOID lpParam) {
+	SIMC_THREAD_FUNCTION* threadfun;
+	SIMC_THREAD* thread;
+
+	//Get pointer to thread information for current thread
+	thread = SIMC_Thread_Internal_GetPointer(SIMC_Thread_GetCurrentID());
+	if (thread == NULL) return 0;
+
+	//Get user thread function pointer
+	threadfun = thread->function;
+	if (SIMC_Trace_Enabled && thread->name) SIMC_Trace_SetThreadName(thread->name);
+
+	//Call the user thread function
+	threadfun((void*)lpParam);
+
+	//Remove thread from thread list
+	SIMC_Thread_EnterCriticalSection();
+	SIMC_Thread_Internal_Remove(thread);
+	SIMC_Thread_LeaveCriticalSection();
+
+	//Return and kill the thread
+	return 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Create a new thread.
+///
+/// Creates new thread and starts it immediately. For example:
+/// ~~~{.c}
+///		void test_thread(void* data) {
+///		}
+///
+///		SIMC_Thread_Create(test_thread,data);
+/// ~~~
+///
+/// @param[in] func_ptr Pointer to the thread function
+/// @param[in] userdata Variable to pass into the threading function
+///
+/// @returns Thread handle
+////////////////////////////////////////////////////////////////////////////////
+typedef struct tagTHREADNAME_INFO
+{
+	DWORD dwType;		// Must be 0x1000
+	LPCSTR szName;		// Pointer to name (in user addr space)
+	DWORD dwThreadID;	// Thread ID (-1 = caller thread)
+	DWORD dwFlags;		// Reserved for future use, must be zero
+} THREADNAME_INFO;
+
+SIMC_THREAD_ID SIMC_Thread_CreateWithName(void* funcPtr, void* userData, char* funcName) {
+	SIMC_THREAD_ID ID;
+	SIMC_THREAD* thread, *thread_tmp;
+	HANDLE hThread;
+	DWORD dwThreadId;
+
+	//Enter critical section
+	SIMC_Thread_EnterCriticalSection();
+
+	//Create a new thread information memory area
+	thread = (SIMC_THREAD*)SIMC_Allocate(SIMC_Userdata, sizeof(SIMC_THREAD));
+	if (thread == NULL) {
+		SIMC_Thread_LeaveCriticalSection();
+		return SIMC_THREAD_BAD_ID;
+	}
+
+	//Get a new unique thread id
+	ID = (((char*)SIMC_Thread_NextID)++);
+
+	//Store thread information in the thread list
+	thread->function = funcPtr;
+	thread->id       = ID;
+	thread->name     = funcName;
+
+	//Create thread
+	SIMC_TRACE_INSTANT("SIMC_Thread_Create");
+	hThread = CreateThread(
+	              NULL,                       //Default security attributes
+	              0,                          //Default stack size (1 MB)
+	              SIMC_Thread_Internal_New,   //Thread function (a wrapper function)
+	              (LPVOID)userData,           //Argument to thread is the user argument
+	              0,                          //Default creation flags
+	              &dwThreadId                 //Returned thread identifier
+	         );
+
+	//Did the thread creation fail?
+	if (hThread == NULL) {
+		SIMC_Free(SIMC_Userdata, (void*)thread);
+		SIMC_Thread_LeaveCriticalSection();
+		return SIMC_THREAD_BAD_ID;
+	}
+
+	//Store more thread information in the thread list
+	thread->handle = hThread;
+	thread->winID = dwThreadId;
+
+	//Append thread to thread list
+	thread_tmp = &SIMC_Thread_Main;
+	while (thread_tmp->next != NULL) {
+		thread_tmp = thread_tmp->next;
+	}
+	thread_tmp->next = thread;
+	thread->previous = thread_tmp;
+	thread->next     = NULL;
+
+	// Set name for the thread
+	if (funcName) {
+		THREADNAME_INFO info;
+		info.dwType = 0x1000;
+		info.szName = funcName;
+		info.dwThreadID = dwThreadId;
+		info.dwFlags = 0;
+
+		__try
+		{
+			RaiseException( 0x406D1388, 0, sizeof(info)/sizeof(DWORD), (ULONG_PTR*)&info );
+		}
+		__except (EXCEPTION_CONTINUE_EXECUTION)
+		{ }
+	}
+
+	//Leave critical section
+	SIMC_Thread_LeaveCriticalSection();
+
+	//Return the thread ID
+	//log_writem("Spawned thread [%p] (SIMC_THREAD_ID[0x%x])",funcPtr,ID);
+	return ID;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Get handle of the currently executed thread.
+///
+/// This function returns the handle of a currently executed thread. It's a relatively
+/// slow call, and should not be used in tight loops.
+///
+/// For checking and identifying threads in a fast way, use SIMC_Thread_GetUniqueID() API
+/// call. The handles returned by both calls are not compatible.
+///
+/// @returns Thread handle
+////////////////////////////////////////////////////////////////////////////////
+SIMC_THREAD_ID SIMC_Thread_GetCurrentID() {
+	SIMC_THREAD* thread;
+	SIMC_THREAD_ID ID = SIMC_THREAD_BAD_ID;
+	DWORD WinID;
+
+	//Get Windows thread ID
+	WinID = GetCurrentThreadId();
+
+	//Enter critical section (to avoid an inconsistent thread list)
+	SIMC_Thread_EnterCriticalSection();
+
+	//Loop through entire list of threads to find the matching Windows thread ID
+	for (thread = &SIMC_Thread_Main; thread != NULL; thread = thread->next) {
+		if (thread->winID == WinID) {
+			ID = thread->id;
+			break;
+		}
+	}
+
+	//Leave critical section
+	SIMC_Thread_LeaveCriticalSection();
+	return ID;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Return unique identifier of the current thread.
+///
+/// Returns OS handle for the currently executed thread. Unlike SIMC_Thread_GetCurrentID()
+/// does not carry any significant overhead. This call is mostly used to identify threads:
+/// ~~~{.c}
+///		thread_id = SIMC_Thread_GetUniqueID()
+///		...
+///		if (SIMC_Thread_GetUniqueID() == thread_id) ...
+/// ~~~
+///
+/// @returns Unique handle
+////////////////////////////////////////////////////////////////////////////////
+SIMC_THREAD_ID SIMC_Thread_GetUniqueID() {
+	return (SIMC_THREAD_ID)GetCurrentThreadId();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Waits current thread until the target thread finishes execution.
+///
+/// Several of these calls can be used together to wait until an array of worker
+/// threads complete. For example:
+/// ~~~{.c}
+///		SIMC_THREAD_ID workers[32];
+///		for (i = 0; i < 32; i++) workers[i] = SIMC_Thread_Create(worker_thread,(void*)i);
+///		for (i = 0; i < 32; i++) SIMC_Thread_WaitFor(workers[i]);
+/// ~~~
+///
+/// @param[in] ID Thread handle
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_Thread_WaitFor(SIMC_THREAD_ID ID) {
+	DWORD result;
+	HANDLE hThread;
+	SIMC_THREAD* thread;
+
+	//Enter critical section
+	SIMC_Thread_EnterCriticalSection();
+
+	//Get thread information pointer
+	thread = SIMC_Thread_Internal_GetPointer(ID);
+
+	//Is the thread already dead?
+	if (thread == NULL)	{
+		SIMC_Thread_LeaveCriticalSection();
+		return 1;
+	}
+
+	//Get thread handle
+	hThread = thread->handle;
+
+	//Leave critical section
+	SIMC_Thread_LeaveCriticalSection();
+
+	//Wait for thread to die
+	//if(waitmode == GLFW_WAIT) {
+	result = WaitForSingleObject(hThread, INFINITE);
+	//} else if(waitmode == GLFW_NOWAIT) {
+	//result = WaitForSingleObject(hThread, 0);
+	//} else {
+	//return 0;
+	//}
+
+	//Did we have a time-out?
+	if (result == WAIT_TIMEOUT) return 0;
+	return 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Stop and remove thread by handle.
+///
+/// @param[in] ID Thread ID
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Thread_Kill(SIMC_THREAD_ID ID) {
+	SIMC_THREAD* thread;
+
+	//Enter critical section
+	SIMC_Thread_EnterCriticalSection();
+
+	//Get thread information pointer
+	thread = SIMC_Thread_Internal_GetPointer(ID);
+	if (thread == NULL) {
+		SIMC_Thread_LeaveCriticalSection();
+		return;
+	}
+
+	//Kill the process
+	if (TerminateThread(thread->handle, 0)) {
+		//Close thread handle
+		CloseHandle(thread->handle);
+
+		//Remove thread from thread list
+		SIMC_Thread_Internal_Remove(thread);
+	}
+
+	//Leave critical section
+	SIMC_Thread_LeaveCriticalSection();
+}
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Wait current thread for the specified time.
+///
+/// This function accepts time in seconds. On all platforms wait time cannot
+/// exceed \f$2^{31}\f$ seconds. Under Windows wait time cannot be less than one
+/// millisecond, other platforms use a precise timer (see SIMC_Thread_SleepUntilNs()).
+///
+/// Passing wait time of 0.0 will simply yield execution of the current thread.
+///
+/// @param[in] time Delay in seconds, or 0.0 if thread must yield execution
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Thread_Sleep(double time) {
+	DWORD t;
+
+	if (time == 0.0) {
+		SwitchToThread();
+		return;
+	}
+
+	if (time <= 1e-3) {
+		t = 1;
+	} else if (time > 2147483647.0) {
+		t = 2147483647;
+	} else {
+		t = (DWORD)(time*1000.0 + 0.5);
+	}
+	Sleep(t);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Wait current thread until the specified time.
+///
+/// The deadline is given in the time base of SIMC_Thread_GetTimeNs(). The thread
+/// sleeps on the OS timer until shortly before the deadline, and then spins for
+/// the remaining time. This allows waking up within microseconds of the deadline:
+/// ~~~{.c}
+///		int64_t deadline = SIMC_Thread_GetTimeNs();
+///		while (running) {
+///			deadline += 1000000; //1 kHz
+///			...
+///			SIMC_Thread_SleepUntilNs(deadline);
+///		}
+/// ~~~
+///
+/// Returns immediately if the deadline has already passed. See also SIMC_RateLimiter_Wait().
+///
+/// @param[in] deadline Time at which the thread must resume (nanoseconds)
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Thread_SleepUntilNs(int64_t deadline) {
+	int64_t remaining = deadline - SIMC_Thread_GetTimeNs();
+
+	//Sleep() has scheduler tick granularity and may wake up late, so the sleep time
+	//is rounded down (Sleep(0) only yields) and the final approach is left to spinning
+	while (remaining > SIMC_THREAD_SPIN_TAIL) {
+		Sleep((DWORD)((remaining - SIMC_THREAD_SPIN_TAIL) / 1000000));
+		remaining = deadline - SIMC_Thread_GetTimeNs();
+	}
+
+	//Spin for the remaining time
+	while (SIMC_Thread_GetTimeNs() < deadline) SIMC_THREAD_PAUSE();
+}
+
+
+#ifndef SIMC_SINGLETHREADED
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Thread get number of processors (cores).
+///
+/// This returns number of processors as reported by the OS - returns double the
+/// physical amount on hyperthreaded systems.
+///
+/// @returns Number of processors (cores) on the system
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_Thread_GetNumProcessors() {
+	SYSTEM_INFO si;
+	GetSystemInfo(&si);
+	return (int)si.dwNumberOfProcessors;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Creates an exclusive lock (mutex/critical section).
+/// 
+/// Example of use:
+/// ~~~{.c}
+///		SIMC_LOCK_ID lock = SIMC_Lock_Create();
+///		SIMC_Lock_Enter(lock);
+///			...
+///		SIMC_Lock_Leave(lock);
+/// ~~~
+///
+/// @returns Lock handle
+////////////////////////////////////////////////////////////////////////////////
+SIMC_LOCK_ID SIMC_Lock_Create() {
+	CRITICAL_SECTION* lock;
+
+	//Allocate memory for lock
+	lock = (CRITICAL_SECTION*)SIMC_Allocate(SIMC_Userdata, sizeof(SIMC_Thread_CriticalSection));
+	if (!lock)
+	{
+		return SIMC_THREAD_BAD_ID;
+	}
+	if ((SIMC_LOCK_ID)lock == SIMC_THREAD_BAD_ID)
+	{
+		return SIMC_THREAD_BAD_ID;
+	}
+
+	//Initialize lock
+	InitializeCriticalSection(lock);
+
+	//Cast to lock ID and return
+	return (SIMC_LOCK_ID)lock;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Deletes an exclusive lock.
+/// @param[in] lockID Lock handle
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Lock_Destroy(SIMC_LOCK_ID lockID) {
+	DeleteCriticalSection((CRITICAL_SECTION*)lockID);
+	SIMC_Free(SIMC_Userdata, (void*)lockID);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Enter exclusive lock.
+/// @param[in] lockID Lock handle
+/// @returns Lock handle passed into the function
+////////////////////////////////////////////////////////////////////////////////
+SIMC_LOCK_ID SIMC_Lock_Enter(SIMC_LOCK_ID lockID) {
+	if (lockID != SIMC_THREAD_BAD_ID) {
+		//Wait for lock to be released
+		EnterCriticalSection((CRITICAL_SECTION*)lockID);
+	}
+	return lockID;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Try to enter exclusive lock.
+/// @param[in] lockID Lock handle
+/// @returns Whether lock could be entered
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_Lock_TryEnter(SIMC_LOCK_ID lockID) {
+	if (lockID != SIMC_THREAD_BAD_ID) {
+		return TryEnterCriticalSection((CRITICAL_SECTION*)lockID) != 0;
+	}
+	return 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Leave exclusive lock.
+/// @param[in] lockID Lock handle
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Lock_Leave(SIMC_LOCK_ID lockID) {
+	if (lockID != SIMC_THREAD_BAD_ID) {
+		LeaveCriticalSection((CRITICAL_SECTION*)lockID);
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Waits until exclusive lock is left by locking thread.
+///
+/// It is useful to make a lock when some worker thread is running, and then simply
+/// unlock it in the end. Main thread can use SIMC_Lock_WaitFor() to wait until
+/// the worked thread(s) complete it task.
+///
+/// @param[in] lockID Lock handle
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Lock_WaitFor(SIMC_LOCK_ID lockID) {
+	SIMC_Lock_Leave(SIMC_Lock_Enter(lockID));
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Create a new event
+////////////////////////////////////////////////////////////////////////////////
+SIMC_EVENT_ID SIMC_Event_Create(char* eventName) {
+	HANDLE handle = CreateEventA(NULL, TRUE, FALSE, (LPCSTR)eventName);
+	if (handle == NULL) return SIMC_THREAD_BAD_ID;
+	return (SIMC_EVENT_ID)handle;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Fire event
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Event_Fire(SIMC_EVENT_ID eventID) {
+	if (eventID != SIMC_THREAD_BAD_ID) {
+		SetEvent((HANDLE)eventID);
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Reset event
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Event_Reset(SIMC_EVENT_ID eventID) {
+	if (eventID != SIMC_THREAD_BAD_ID) {
+		ResetEvent((HANDLE)eventID);
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Wait for event to be fired
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_Event_WaitFor(SIMC_EVENT_ID eventID, double time) {
+	if (eventID != SIMC_THREAD_BAD_ID) {
+		DWORD timeMs = (DWORD)(time*1000);
+		DWORD waitResult;
+		
+		if (time <= 0.0) timeMs = 0;
+		if (time > 1e9) timeMs = INFINITE;
+		waitResult = WaitForSingleObject((HANDLE)eventID, timeMs);
+
+		if (waitResult == WAIT_OBJECT_0) return 1;
+	}
+	return 0;
+}
+
+
+
+
+//Slim read-write locks (WinAPI implementation)
+#ifdef SIMC_NATIVE_SRW
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Create slim read/write lock.
+///
+/// SRW locks are useful for protecting data when write operations are much more
+/// sparse than read operations. For example:
+/// ~~~{.c}
+///		SIMC_SRW_ID lock = SIMC_SRW_Create();
+///		SIMC_SRW_EnterRead(lock);
+///			... data will not be changed here ...
+///		SIMC_SRW_LeaveRead(lock);
+///
+///		SIMC_SRW_EnterWrite(lock);
+///			... no other thread will read data ...
+///		SIMC_SRW_LeaveWrite(lock);
+/// ~~~
+///
+/// @returns Lock handle
+////////////////////////////////////////////////////////////////////////////////
+SIMC_SRW_ID SIMC_SRW_Create() {
+	PSRWLOCK lock = (PSRWLOCK)SIMC_Allocate(SIMC_Userdata, sizeof(SRWLOCK));
+	InitializeSRWLock(lock);
+	return (SIMC_SRW_ID)lock;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Destroy SRW lock.
+/// @param[in] srwID Lock handle
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_SRW_Destroy(SIMC_SRW_ID srwID) {
+	PSRWLOCK lock = (PSRWLOCK)srwID;
+	if ((!srwID) || (srwID == SIMC_THREAD_BAD_ID)) return;
+	SIMC_Free(SIMC_Userdata, lock);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Enter shared reading section (within this section, no writes will be performed to data).
+/// @param[in] srwID Lock handle
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_SRW_EnterRead(SIMC_SRW_ID srwID) {
+	PSRWLOCK lock = (PSRWLOCK)srwID;
+	if ((!srwID) || (srwID == SIMC_THREAD_BAD_ID)) return;
+	if (TryAcquireSRWLockShared(lock)) return;
+
+	SIMC_TRACE_BEGIN("SIMC_SRW_EnterRead wait");
+	AcquireSRWLockShared(lock);
+	SIMC_TRACE_END("SIMC_SRW_EnterRead wait");
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Leave shared reading section.
+/// @param[in] srwID Lock handle
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_SRW_LeaveRead(SIMC_SRW_ID srwID) {
+	PSRWLOCK lock = (PSRWLOCK)srwID;
+	if ((!srwID) || (srwID == SIMC_THREAD_BAD_ID)) return;
+	ReleaseSRWLockShared(lock);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Enter exclusive writing section.
+/// @param[in] srwID Lock handle
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_SRW_EnterWrite(SIMC_SRW_ID srwID) {
+	PSRWLOCK lock = (PSRWLOCK)srwID;
+	if ((!srwID) || (srwID == SIMC_THREAD_BAD_ID)) return;
+	if (TryAcquireSRWLockExclusive(lock)) return;
+
+	SIMC_TRACE_BEGIN("SIMC_SRW_EnterWrite wait");
+	AcquireSRWLockExclusive(lock);
+	SIMC_TRACE_END("SIMC_SRW_EnterWrite wait");
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Leave exclusive writing section.
+/// @param[in] srwID Lock handle
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_SRW_LeaveWrite(SIMC_SRW_ID srwID) {
+	PSRWLOCK lock = (PSRWLOCK)srwID;
+	if ((!srwID) || (srwID == SIMC_THREAD_BAD_ID)) return;
+	ReleaseSRWLockExclusive(lock);
+}
+
+#ifdef SIMC_LOCK_PROFILING
+int SIMC_SRW_Internal_TryEnterRead(SIMC_SRW_ID srwID) {
+	return TryAcquireSRWLockShared((PSRWLOCK)srwID) != 0;
+}
+
+int SIMC_SRW_Internal_TryEnterWrite(SIMC_SRW_ID srwID) {
+	return TryAcquireSRWLockExclusive((PSRWLOCK)srwID) != 0;
+}
+#endif
+
+#else
+
+#define SIMC_SRW_THRESHOLD	0xFFFF
+typedef struct SIMC_SRW_LOCK_TAG {
+	SIMC_LOCK_ID write_lock;
+	long srw_lock;
+} SIMC_SRW_LOCK;
+
+SIMC_SRW_ID SIMC_SRW_Create() {
+	SIMC_SRW_LOCK* lock = (SIMC_SRW_LOCK*)SIMC_Allocate(SIMC_Userdata, sizeof(SIMC_SRW_LOCK));
+	lock->write_lock = SIMC_Lock_Create();
+	lock->srw_lock = 0;
+	return (SIMC_SRW_ID)lock;
+}
+
+void SIMC_SRW_Destroy(SIMC_SRW_ID srwID) {
+	SIMC_SRW_LOCK* lock = (SIMC_SRW_LOCK*)srwID;
+	if ((!srwID) || (srwID == SIMC_THREAD_BAD_ID)) return;
+
+	SIMC_Lock_Destroy(lock->write_lock);
+	SIMC_Free(SIMC_Userdata, lock);
+}
+
+void SIMC_SRW_EnterRead(SIMC_SRW_ID srwID) {
+	SIMC_SRW_LOCK* lock = (SIMC_SRW_LOCK*)srwID;
+	if ((!srwID) || (srwID == SIMC_THREAD_BAD_ID)) return;
+
+	if (InterlockedIncrement(&lock->srw_lock) >= 0) return;
+
+	SIMC_TRACE_BEGIN("SIMC_SRW_EnterRead wait");
+	do {
+		InterlockedDecrement(&lock->srw_lock);
+		SwitchToThread();
+	} while (InterlockedIncrement(&lock->srw_lock) < 0);
+	SIMC_TRACE_END("SIMC_SRW_EnterRead wait");
+}
+
+void SIMC_SRW_LeaveRead(SIMC_SRW_ID srwID) {
+	SIMC_SRW_LOCK* lock = (SIMC_SRW_LOCK*)srwID;
+	if ((!srwID) || (srwID == SIMC_THREAD_BAD_ID)) return;
+
+	InterlockedDecrement(&lock->srw_lock);
+}
+
+void SIMC_SRW_EnterWrite(SIMC_SRW_ID srwID) {
+	SIMC_SRW_LOCK* lock = (SIMC_SRW_LOCK*)srwID;
+	if ((!srwID) || (srwID == SIMC_THREAD_BAD_ID)) return;
+
+	SIMC_TRACE_BEGIN("SIMC_SRW_EnterWrite wait");
+	SIMC_Lock_Enter(lock->write_lock); //Block other threads from writing
+	InterlockedExchangeAdd(&lock->srw_lock,-SIMC_SRW_THRESHOLD);
+	while ((lock->srw_lock) > -SIMC_SRW_THRESHOLD) { //Wait until read threads finish
+		SwitchToThread();
+	}
+	SIMC_TRACE_END("SIMC_SRW_EnterWrite wait");
+}
+
+void SIMC_SRW_LeaveWrite(SIMC_SRW_ID srwID) {
+	SIMC_SRW_LOCK* lock = (SIMC_SRW_LOCK*)srwID;
+	if ((!srwID) || (srwID == SIMC_THREAD_BAD_ID)) return;
+
+	while ((lock->srw_lock) != -SIMC_SRW_THRESHOLD) { //Block execution if not leaving write lock
+		SwitchToThread();
+	}
+	InterlockedExchangeAdd(&lock->srw_lock,SIMC_SRW_THRESHOLD);
+	SIMC_Lock_Leave(lock->write_lock);
+}
+
+#ifdef SIMC_LOCK_PROFILING
+int SIMC_SRW_Internal_TryEnterRead(SIMC_SRW_ID srwID) {
+	SIMC_SRW_LOCK* lock = (SIMC_SRW_LOCK*)srwID;
+	if (InterlockedIncrement(&lock->srw_lock) >= 0) return 1;
+	InterlockedDecrement(&lock->srw_lock);
+	return 0;
+}
+
+int SIMC_SRW_Internal_TryEnterWrite(SIMC_SRW_ID srwID) {
+	SIMC_SRW_LOCK* lock = (SIMC_SRW_LOCK*)srwID;
+	if (!SIMC_Lock_Internal_TryEnter(lock->write_lock)) return 0;
+	if (InterlockedCompareExchange(&lock->srw_lock,-SIMC_SRW_THRESHOLD,0) == 0) return 1;
+	SIMC_Lock_Leave(lock->write_lock);
+	return 0;
+}
+#endif
+
+#endif
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Initialize threading
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Thread_Initialize() {
+	if (SIMC_Instance_Counter == 0) {
+		//Initialize critical section handle
+		InitializeCriticalSection(&SIMC_Thread_CriticalSection);
+	
+		//The first thread (the main thread) has ID 0
+		SIMC_Thread_NextID = 0;
+	
+		//Fill out information about the main thread (this thread)
+		SIMC_Thread_Main.id       = (((char*)SIMC_Thread_NextID)++);
+		SIMC_Thread_Main.function = 0;
+		SIMC_Thread_Main.name     = 0;
+		SIMC_Thread_Main.handle   = GetCurrentThread();
+		SIMC_Thread_Main.winID    = GetCurrentThreadId();
+		SIMC_Thread_Main.previous = 0;
+		SIMC_Thread_Main.next     = 0;
+	}
+
+	SIMC_Instance_Counter++;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Deinitialize threading and shut down all threads
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Thread_Deinitialize() {
+	SIMC_THREAD* thread, *thread_next;
+
+	//Check reference counter
+	SIMC_Instance_Counter--;
+	if (SIMC_Instance_Counter > 0) return;
+
+	//Enter critical section
+	SIMC_Thread_EnterCriticalSection();
+
+	//Kill all threads
+	thread = SIMC_Thread_Main.next;
+	while (thread != NULL) {
+		//Get pointer to next thread
+		thread_next = thread->next;
+
+		//Simply murder the process, no mercy!
+		if (TerminateThread(thread->handle, 0)) {
+			//Close thread handle
+			CloseHandle(thread->handle);
+
+			//Free memory allocated for this thread
+			SIMC_Free(SIMC_Userdata, (void*)thread);
+		}
+
+		//Select next thread in list
+		thread = thread_next;
+	}
+
+	//Leave critical section
+	SIMC_Thread_LeaveCriticalSection();
+
+	//Delete critical section handle
+	DeleteCriticalSection(&SIMC_Thread_CriticalSection);
+}
+#endif
+
+
+
+
+
+
+
+
+#else
+////////////////////////////////////////////////////////////////////////////////
+// POSIX specific code
+////////////////////////////////////////////////////////////////////////////////
+#ifndef SIMC_SINGLETHREADED
+
+pthread_mutex_t SIMC_Thread_CriticalSection;
+
+void SIMC_Thread_EnterCriticalSection() {
+	pthread_mutex_lock(&SIMC_Thread_CriticalSection);
+}
+
+void SIMC_Thread_LeaveCriticalSection() {
+	pthread_mutex_unlock(&SIMC_Thread_CriticalSection);
+}
+
+
+void* SIMC_Thread_Internal_New(void *arg) {
+	SIMC_THREAD_FUNCTION* threadfunc;
+	SIMC_THREAD *thread;
+	pthread_t posixID;
+
+	//Get current thread ID
+	posixID = pthread_self();
+
+	//Enter critical section
+	SIMC_Thread_EnterCriticalSection();
+
+	//Loop through entire list of threads to find the matching POSIX thread ID
+	for (thread = &SIMC_Thread_Main; thread != NULL; thread = thread->next) {
+		if(thread->posixID == posixID) break;
+	}
+
+	if (thread == NULL) {
+		SIMC_Thread_LeaveCriticalSection();
+		return NULL;
+	}
+
+	//Get user thread function pointer
+	threadfunc = thread->function;
+
+	//Leave critical section
+	SIMC_Thread_LeaveCriticalSection();
+	if (SIMC_Trace_Enabled && thread->name) SIMC_Trace_SetThreadName(thread->name);
+
+	//Call the user thread function
+	threadfunc(arg);
+
+	//Remove thread from thread list
+	SIMC_Thread_EnterCriticalSection();
+	SIMC_Thread_Internal_Remove(thread);
+	SIMC_Thread_LeaveCriticalSection();
+
+	//When the thread function returns, the thread will die...
+	return NULL;
+}
+
+
+SIMC_THREAD_ID SIMC_Thread_CreateWithName(void* funcPtr, void* userData, char* funcName) {
+	SIMC_THREAD_ID ID;
+	SIMC_THREAD *thread, *thread_tmp;
+	int result;
+
+	//Enter critical section
+	SIMC_Thread_EnterCriticalSection();
+
+	//Create a new thread information memory area
+	thread = (SIMC_THREAD*)SIMC_Allocate(SIMC_Userdata, sizeof(SIMC_THREAD));
+	if (thread == NULL) {
+		SIMC_Thread_LeaveCriticalSection();
+		return SIMC_THREAD_BAD_ID;
+	}
+
+	//Get a new unique thread id
+	ID = SIMC_Thread_NextID++;
+
+	//Store thread information in the thread list
+	thread->function = funcPtr;
+	thread->id       = ID;
+	thread->name     = funcName;
+
+	//Create thread
+	SIMC_TRACE_INSTANT("SIMC_Thread_Create");
+	result = pthread_create(
+		&thread->posixID,      //Thread handle
+		NULL,             //Default thread attributes
+		SIMC_Thread_Internal_New,      //Thread function (a wrapper function)
+		(void*)userData   //Argument to thread is user argument
+   	);
+
+	//Did the thread creation fail?
+	if (result != 0) {
+		SIMC_Free(SIMC_Userdata, (void*)thread);
+		SIMC_Thread_LeaveCriticalSection();
+		return SIMC_THREAD_BAD_ID;
+	}
+
+	//Append thread to thread list
+	thread_tmp = &SIMC_Thread_Main;
+	while (thread_tmp->next != NULL) {
+		thread_tmp = thread_tmp->next;
+	}
+	thread_tmp->next = thread;
+	thread->previous = thread_tmp;
+	thread->next     = NULL;
+
+	//Leave critical section
+	SIMC_Thread_LeaveCriticalSection();
+	return ID;
+}
+
+
+SIMC_THREAD_ID SIMC_Thread_GetCurrentID() {
+	SIMC_THREAD *thread;
+	SIMC_THREAD_ID ID = SIMC_THREAD_BAD_ID;
+	pthread_t posixID;
+
+	//Get current thread ID
+	posixID = pthread_self();
+
+	//Enter critical section
+	SIMC_Thread_EnterCriticalSection();
+
+	//Loop through entire list of threads to find the matching POSIX thread ID
+	for (thread = &SIMC_Thread_Main; thread != NULL; thread = thread->next) {
+		if(thread->posixID == posixID)
+		{
+			ID = thread->id;
+			break;
+		}
+	}
+
+	//Leave critical section
+	SIMC_Thread_LeaveCriticalSection();
+	return ID;
+}
+
+
+SIMC_THREAD_ID SIMC_Thread_GetUniqueID() {
+	return (SIMC_THREAD_ID)pthread_self();
+}
+
+
+int SIMC_Thread_WaitFor(SIMC_THREAD_ID ID) {
+	pthread_t pthread;
+	SIMC_THREAD *thread;
+
+	//Enter critical section
+	SIMC_Thread_EnterCriticalSection();
+
+	//Get thread information pointer
+	thread = SIMC_Thread_Internal_GetPointer(ID);
+
+	//Is the thread already dead?
+	if (thread == NULL) {
+		SIMC_Thread_LeaveCriticalSection();
+		return 1;
+	}
+
+	//If got this far, the thread is alive => polling returns FALSE
+	//if(waitmode == GLFW_NOWAIT)
+	//{
+		//SIMC_Thread_LeaveCriticalSection();
+		//return 0;
+	//}
+
+	//Get thread handle
+	pthread = thread->posixID;
+
+	//Leave critical section
+	SIMC_Thread_LeaveCriticalSection();
+
+	//Wait for thread to die
+	(void)pthread_join(pthread, NULL);
+
+	return 1;
+}
+
+
+void SIMC_Thread_Kill(SIMC_THREAD_ID ID) {
+	SIMC_THREAD *thread;
+
+	//Enter critical section
+	SIMC_Thread_EnterCriticalSection();
+
+	//Get thread information pointer
+	thread = SIMC_Thread_Internal_GetPointer(ID);
+	if (thread == NULL) {
+		SIMC_Thread_LeaveCriticalSection();
+		return;
+	}
+
+	//Simply murder the process, no mercy!
+	pthread_kill(thread->posixID, SIGKILL);
+
+	//Remove thread from thread list
+	SIMC_Thread_Internal_Remove(thread);
+
+	//Leave critical section
+	SIMC_Thread_LeaveCriticalSection();
+}
+#endif
+
+void SIMC_Thread_Sleep(double time) {
+	if (time <= 0.0) {
+		sched_yield();
+		return;
+	}
+	if (time > 2147483647.0) time = 2147483647.0;
+
+	SIMC_Thread_SleepUntilNs(SIMC_Thread_GetTimeNs() + (int64_t)(time*1e9));
+}
+
+
+void SIMC_Thread_SleepUntilNs(int64_t deadline) {
+	int64_t remaining = deadline - SIMC_Thread_GetTimeNs();
+
+	//Sleep on the OS timer until shortly before the deadline
+	if (remaining > SIMC_THREAD_SPIN_TAIL) {
+		struct timespec ts;
+		int64_t target;
+
+#ifdef __APPLE__
+		target = remaining - SIMC_THREAD_SPIN_TAIL;
+		ts.tv_sec = (time_t)(target / 1000000000);
+		ts.tv_nsec = (long)(target % 1000000000);
+		while (nanosleep(&ts, &ts) == -1 && errno == EINTR) ;
+#else
+		//Absolute deadline on the monotonic clock (restarting after a signal does not accumulate error)
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		target = (int64_t)ts.tv_sec*1000000000 + (int64_t)ts.tv_nsec + remaining - SIMC_THREAD_SPIN_TAIL;
+		ts.tv_sec = (time_t)(target / 1000000000);
+		ts.tv_nsec = (long)(target % 1000000000);
+		while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) ;
+#endif
+	}
+
+	//Spin for the remaining time
+	while (SIMC_Thread_GetTimeNs() < deadline) SIMC_THREAD_PAUSE();
+}
+
+#ifndef SIMC_SINGLETHREADED
+int SIMC_Thread_GetNumProcessors() {
+	return (int)sysconf(_SC_NPROCESSORS_ONLN);
+}
+
+
+//#ifndef SIMC_NATIVE_SRW
+
+#define SIMC_SRW_THRESHOLD	0xFFFF
+typedef struct SIMC_SRW_LOCK_TAG {
+	SIMC_MUTEX write_lock;
+	long srw_lock;
+} SIMC_SRW_LOCK;
+
+
+SIMC_SRW_ID SIMC_SRW_Create() {
+	SIMC_SRW_LOCK* lock = (SIMC_SRW_LOCK*)SIMC_Allocate(SIMC_Userdata, sizeof(SIMC_SRW_LOCK));
+	SIMC_Mutex_Initialize(&lock->write_lock);
+	lock->srw_lock = 0;
+	return (SIMC_SRW_ID)lock;
+}
+
+void SIMC_SRW_Destroy(SIMC_SRW_ID srwID) {
+	SIMC_SRW_LOCK* lock = (SIMC_SRW_LOCK*)srwID;
+	if ((!srwID) || (srwID == SIMC_THREAD_BAD_ID)) return;
+
+	SIMC_Free(SIMC_Userdata, lock);
+}
+
+void SIMC_SRW_EnterRead(SIMC_SRW_ID srwID) {
+	SIMC_SRW_LOCK* lock = (SIMC_SRW_LOCK*)srwID;
+	if ((!srwID) || (srwID == SIMC_THREAD_BAD_ID)) return;
+
+	if (__sync_fetch_and_add(&lock->srw_lock,1) >= 0) return;
+
+	SIMC_TRACE_BEGIN("SIMC_SRW_EnterRead wait");
+	do {
+		__sync_fetch_and_add(&lock->srw_lock,-1);
+		sched_yield();
+	} while (__sync_fetch_and_add(&lock->srw_lock,1) < 0);
+	SIMC_TRACE_END("SIMC_SRW_EnterRead wait");
+}
+
+void SIMC_SRW_LeaveRead(SIMC_SRW_ID srwID) {
+	SIMC_SRW_LOCK* lock = (SIMC_SRW_LOCK*)srwID;
+	if ((!srwID) || (srwID == SIMC_THREAD_BAD_ID)) return;
+
+	__sync_fetch_and_add(&lock->srw_lock,-1);
+}
+
+void SIMC_SRW_EnterWrite(SIMC_SRW_ID srwID) {
+	SIMC_SRW_LOCK* lock = (SIMC_SRW_LOCK*)srwID;
+	if ((!srwID) || (srwID == SIMC_THREAD_BAD_ID)) return;
+
+	SIMC_TRACE_BEGIN("SIMC_SRW_EnterWrite wait");
+	SIMC_Mutex_Enter(&lock->write_lock); //Block other threads from writing
+	__sync_fetch_and_add(&lock->srw_lock,-SIMC_SRW_THRESHOLD);
+	while (__sync_fetch_and_add(&lock->srw_lock,0) > -SIMC_SRW_THRESHOLD) { //Wait until read threads finish
+		sched_yield();
+	}
+	SIMC_TRACE_END("SIMC_SRW_EnterWrite wait");
+}
+
+void SIMC_SRW_LeaveWrite(SIMC_SRW_ID srwID) {
+	SIMC_SRW_LOCK* lock = (SIMC_SRW_LOCK*)srwID;
+	if ((!srwID) || (srwID == SIMC_THREAD_BAD_ID)) return;
+
+	while (__sync_fetch_and_add(&lock->srw_lock,0) != -SIMC_SRW_THRESHOLD) { //Block execution if not leaving write lock
+		sched_yield();
+	}
+	__sync_fetch_and_add(&lock->srw_lock,SIMC_SRW_THRESHOLD);
+	SIMC_Mutex_Leave(&lock->write_lock);
+}
+
+#ifdef SIMC_LOCK_PROFILING
+int SIMC_SRW_Internal_TryEnterRead(SIMC_SRW_ID srwID) {
+	SIMC_SRW_LOCK* lock = (SIMC_SRW_LOCK*)srwID;
+	if (__sync_fetch_and_add(&lock->srw_lock,1) >= 0) return 1;
+	__sync_fetch_and_add(&lock->srw_lock,-1);
+	return 0;
+}
+
+int SIMC_SRW_Internal_TryEnterWrite(SIMC_SRW_ID srwID) {
+	SIMC_SRW_LOCK* lock = (SIMC_SRW_LOCK*)srwID;
+	if (!SIMC_Mutex_TryEnter(&lock->write_lock)) return 0;
+	if (__sync_bool_compare_and_swap(&lock->srw_lock,0,-SIMC_SRW_THRESHOLD)) return 1;
+	SIMC_Mutex_Leave(&lock->write_lock);
+	return 0;
+}
+#endif
+//#endif
+
+
+SIMC_LOCK_ID SIMC_Lock_Create() {
+	pthread_mutex_t *mutex;
+
+	//Allocate memory for mutex
+	mutex = (pthread_mutex_t*)SIMC_Allocate(SIMC_Userdata, sizeof(pthread_mutex_t));
+	if(!mutex) return SIMC_THREAD_BAD_ID;
+
+	//Initialise a mutex object
+	(void)pthread_mutex_init(mutex, NULL);
+	return (SIMC_LOCK_ID)mutex;
+}
+
+
+void SIMC_Lock_Destroy(SIMC_LOCK_ID lockID) {
+	//Destroy the mutex object
+	pthread_mutex_destroy((pthread_mutex_t*)lockID);
+	//Free memory for mutex object
+	SIMC_Free(SIMC_Userdata, (void*)lockID);
+}
+
+
+SIMC_LOCK_ID SIMC_Lock_Enter(SIMC_LOCK_ID lockID) {
+	//Wait for mutex to be released
+	(void)pthread_mutex_lock((pthread_mutex_t*)lockID);
+	return lockID;
+}
+
+
+int SIMC_Lock_TryEnter(SIMC_LOCK_ID lockID) {
+	//Try to lock mutex without waiting
+	return pthread_mutex_trylock((pthread_mutex_t*)lockID) == 0;
+}
+
+
+void SIMC_Lock_Leave(SIMC_LOCK_ID lockID) {
+	//Release mutex
+	pthread_mutex_unlock((pthread_mutex_t*)lockID);
+}
+
+
+void SIMC_Lock_WaitFor(SIMC_LOCK_ID lockID) {
+	SIMC_Lock_Leave(SIMC_Lock_Enter(lockID));
+}
+
+
+void SIMC_Thread_Initialize() {
+	if (SIMC_Instance_Counter == 0) {
+		// Initialize critical section handle
+		(void) pthread_mutex_init(&SIMC_Thread_CriticalSection, NULL );
+	
+		// The first thread (the main thread) has ID 0
+		SIMC_Thread_NextID = 0;
+	
+		// Fill out information about the main thread (this thread)
+		SIMC_Thread_Main.id       = SIMC_Thread_NextID++;
+		SIMC_Thread_Main.function = NULL;
+		SIMC_Thread_Main.name     = NULL;
+		SIMC_Thread_Main.previous = NULL;
+		SIMC_Thread_Main.next     = NULL;
+		SIMC_Thread_Main.posixID  = pthread_self();
+	}
+	SIMC_Instance_Counter++;
+}
+
+
+void SIMC_Thread_Deinitialize() {
+	SIMC_THREAD *thread, *thread_next;
+
+	//Check instance counter
+	SIMC_Instance_Counter--;
+	if (SIMC_Instance_Counter > 0) return;
+
+	//Enter critical section
+	SIMC_Thread_EnterCriticalSection();
+
+	//Kill all threads
+	thread = SIMC_Thread_Main.next;
+	while (thread != NULL) {
+		//Get pointer to next thread
+		thread_next = thread->next;
+
+		//Simply murder the process, no mercy!
+		pthread_kill(thread->posixID, SIGKILL);
+
+		//Free memory allocated for this thread
+		SIMC_Free(SIMC_Userdata, (void*)thread);
+
+		//Select next thread in list
+		thread = thread_next;
+	}
+
+	//Leave critical section
+	SIMC_Thread_LeaveCriticalSection();
+
+	//Delete critical section handle
+	pthread_mutex_destroy(&SIMC_Thread_CriticalSection);
+}
+#endif
+
+#endif
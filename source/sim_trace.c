@@ -0,0 +1,482 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file
+////////////////////////////////////////////////////////////////////////////////
+/// Copyright (C) 2012-2015, Black Phoenix
+///
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the GNU Lesser General Public License as published by the Free Software
+/// Foundation; either version 2 of the License, or (at your option) any later
+/// version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+/// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+/// details.
+///
+/// You should have received a copy of the GNU Lesser General Public License along with
+/// this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+/// Place - Suite 330, Boston, MA  02111-1307, USA.
+///
+/// Further information about the GNU Lesser General Public License can also be found on
+/// the world wide web at http://www.gnu.org.
+////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <string.h>
+#include "sim_core.h"
+#ifdef _WIN32
+#	include <windows.h>
+#else
+#	include <pthread.h>
+#endif
+
+//Default number of events in a per-thread buffer
+#define SIMC_TRACE_DEFAULT_BUFFER_SIZE	16384
+
+//Event types
+#define SIMC_TRACE_EVENT_BEGIN		0
+#define SIMC_TRACE_EVENT_END		1
+#define SIMC_TRACE_EVENT_COUNTER	2
+#define SIMC_TRACE_EVENT_INSTANT	3
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Internal data structures
+////////////////////////////////////////////////////////////////////////////////
+#ifndef DOXYGEN_INTERNAL_STRUCTS
+typedef struct SIMC_TRACE_EVENT_TAG {
+	int64_t timestamp;			//Time of event (nanoseconds, SIMC_Thread_GetTimeNs)
+	double value;				//Counter value
+	const char* name;			//Event name (static string)
+	int type;					//Event type
+} SIMC_TRACE_EVENT;
+
+typedef struct SIMC_TRACE_BUFFER_TAG {
+	struct SIMC_TRACE_BUFFER_TAG* next;	//Next buffer in list of all buffers
+	SIMC_QUEUE* queue;					//Ring buffer (written by owner thread, read by flush)
+	const char* thread_name;			//Name of the owner thread
+	unsigned int index;					//Sequential thread index
+	volatile unsigned int dropped;		//Number of events dropped because buffer was full
+	int released;						//Owner thread has exited (buffer is freed by the next flush)
+} SIMC_TRACE_BUFFER;
+#endif
+
+//Global state
+volatile int SIMC_Trace_Enabled = 0;
+int SIMC_Trace_BufferSize = SIMC_TRACE_DEFAULT_BUFFER_SIZE;
+SIMC_TRACE_BUFFER* SIMC_Trace_Buffers = 0;
+unsigned int SIMC_Trace_BufferCount = 0;
+SIMC_THREAD_LOCAL SIMC_TRACE_BUFFER* SIMC_Trace_ThreadBuffer = 0;
+
+//Lock protecting list of buffers (statically initialized, used before any threading init)
+#ifdef _WIN32
+SRWLOCK SIMC_Trace_Lock = SRWLOCK_INIT;
+#	define SIMC_TRACE_LOCK()	AcquireSRWLockExclusive(&SIMC_Trace_Lock)
+#	define SIMC_TRACE_UNLOCK()	ReleaseSRWLockExclusive(&SIMC_Trace_Lock)
+#else
+pthread_mutex_t SIMC_Trace_Lock = PTHREAD_MUTEX_INITIALIZER;
+#	define SIMC_TRACE_LOCK()	pthread_mutex_lock(&SIMC_Trace_Lock)
+#	define SIMC_TRACE_UNLOCK()	pthread_mutex_unlock(&SIMC_Trace_Lock)
+#endif
+
+//Thread exit notification (releases buffer of the exiting thread)
+void SIMC_Trace_Internal_ReleaseBuffer(void* buffer);
+#ifdef _WIN32
+DWORD SIMC_Trace_ExitKey = FLS_OUT_OF_INDEXES;
+INIT_ONCE SIMC_Trace_ExitKeyOnce = INIT_ONCE_STATIC_INIT;
+void WINAPI SIMC_Trace_Internal_ExitCallback(PVOID buffer) {
+	if (buffer) SIMC_Trace_Internal_ReleaseBuffer(buffer);
+}
+BOOL CALLBACK SIMC_Trace_Internal_ExitKeyInitialize(PINIT_ONCE once, PVOID parameter, PVOID* context) {
+	SIMC_Trace_ExitKey = FlsAlloc(SIMC_Trace_Internal_ExitCallback);
+	return TRUE;
+}
+#	define SIMC_TRACE_REGISTER_EXIT(buffer) do { \
+		InitOnceExecuteOnce(&SIMC_Trace_ExitKeyOnce, SIMC_Trace_Internal_ExitKeyInitialize, 0, 0); \
+		if (SIMC_Trace_ExitKey != FLS_OUT_OF_INDEXES) FlsSetValue(SIMC_Trace_ExitKey, buffer); \
+	} while (0)
+#else
+pthread_key_t SIMC_Trace_ExitKey;
+int SIMC_Trace_ExitKeyValid = 0;
+pthread_once_t SIMC_Trace_ExitKeyOnce = PTHREAD_ONCE_INIT;
+void SIMC_Trace_Internal_ExitKeyInitialize() {
+	SIMC_Trace_ExitKeyValid = (pthread_key_create(&SIMC_Trace_ExitKey, SIMC_Trace_Internal_ReleaseBuffer) == 0);
+}
+#	define SIMC_TRACE_REGISTER_EXIT(buffer) do { \
+		pthread_once(&SIMC_Trace_ExitKeyOnce, SIMC_Trace_Internal_ExitKeyInitialize); \
+		if (SIMC_Trace_ExitKeyValid) pthread_setspecific(SIMC_Trace_ExitKey, buffer); \
+	} while (0)
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Mark buffer of an exiting thread as released.
+///
+/// Events which are still in the buffer are written out by the next flush, which
+/// then frees the buffer.
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Trace_Internal_ReleaseBuffer(void* buffer) {
+	SIMC_TRACE_LOCK();
+	((SIMC_TRACE_BUFFER*)buffer)->released = 1;
+	SIMC_TRACE_UNLOCK();
+	SIMC_Trace_ThreadBuffer = 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Get trace buffer of the current thread, create one if required.
+////////////////////////////////////////////////////////////////////////////////
+SIMC_TRACE_BUFFER* SIMC_Trace_Internal_GetBuffer() {
+	SIMC_TRACE_BUFFER* buffer = SIMC_Trace_ThreadBuffer;
+	if (buffer) return buffer;
+
+	buffer = (SIMC_TRACE_BUFFER*)SIMC_Allocate(SIMC_Userdata, sizeof(SIMC_TRACE_BUFFER));
+	if (!buffer) return 0;
+	SIMC_Queue_Create(&buffer->queue, SIMC_Trace_BufferSize, sizeof(SIMC_TRACE_EVENT));
+	if (!buffer->queue) {
+		SIMC_Free(SIMC_Userdata, buffer);
+		return 0;
+	}
+	buffer->thread_name = 0;
+	buffer->dropped = 0;
+	buffer->released = 0;
+
+	SIMC_TRACE_LOCK();
+	buffer->index = SIMC_Trace_BufferCount++;
+	buffer->next = SIMC_Trace_Buffers;
+	SIMC_Trace_Buffers = buffer;
+	SIMC_TRACE_UNLOCK();
+
+	SIMC_Trace_ThreadBuffer = buffer;
+	SIMC_TRACE_REGISTER_EXIT(buffer);
+	return buffer;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Record a single event into the buffer of the current thread.
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Trace_Internal_Record(int type, const char* name, double value) {
+	SIMC_TRACE_BUFFER* buffer = SIMC_Trace_Internal_GetBuffer();
+	SIMC_TRACE_EVENT* event;
+	if (!buffer) return; //Could not allocate buffer, drop the event
+
+	SIMC_Queue_EnterWrite(buffer->queue, (void**)&event);
+	event->timestamp = SIMC_Thread_GetTimeNs();
+	event->value = value;
+	event->name = name;
+	event->type = type;
+	if (!SIMC_Queue_LeaveWrite(buffer->queue)) {
+		buffer->dropped++; //Never block the traced thread, drop the event instead
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Enable or disable recording of trace events.
+///
+/// Tracing is disabled by default. When disabled, the trace calls cost a single
+/// check of a global flag. When enabled, every event is timestamped with
+/// SIMC_Thread_GetTimeNs() and written into a lock-free ring buffer owned by the
+/// calling thread. Events are collected from all threads by SIMC_Trace_Flush().
+///
+/// SIMC itself records SRW lock waits, linked list write sections and thread
+/// creation when tracing is enabled (unless compiled with SIMC_NO_TRACE).
+///
+/// @param[in] enabled Should trace events be recorded
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Trace_Enable(int enabled) {
+	SIMC_Trace_Enabled = enabled;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Set size of trace buffers created from now on.
+///
+/// Each thread that records trace events allocates a buffer for the given number
+/// of events. When the buffer fills up before it is flushed, new events are dropped.
+///
+/// @param[in] events Number of events per thread buffer
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Trace_SetBufferSize(int events) {
+	if (events < 2) events = 2;
+	SIMC_Trace_BufferSize = events;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Set name of the current thread in the trace output.
+///
+/// Called automatically for threads created by SIMC_Thread_CreateWithName().
+///
+/// @param[in] name Thread name (must remain valid until trace is flushed)
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Trace_SetThreadName(const char* name) {
+	SIMC_TRACE_BUFFER* buffer = SIMC_Trace_Internal_GetBuffer();
+	if (buffer) buffer->thread_name = name;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Begin a traced scope.
+///
+/// Every call must be paired with SIMC_Trace_End() on the same thread:
+/// ~~~{.c}
+///		SIMC_Trace_Begin("Integrate");
+///		...
+///		SIMC_Trace_End("Integrate");
+/// ~~~
+///
+/// Only the pointer to the name is stored, so the name must be a string constant
+/// (or otherwise remain valid until the trace is flushed).
+///
+/// @param[in] name Scope name
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Trace_Begin(const char* name) {
+	if (!SIMC_Trace_Enabled) return;
+	SIMC_Trace_Internal_Record(SIMC_TRACE_EVENT_BEGIN, name, 0.0);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief End a traced scope.
+/// @param[in] name Scope name
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Trace_End(const char* name) {
+	if (!SIMC_Trace_Enabled) return;
+	SIMC_Trace_Internal_Record(SIMC_TRACE_EVENT_END, name, 0.0);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Record value of a counter.
+/// @param[in] name Counter name
+/// @param[in] value Current value of the counter
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Trace_Counter(const char* name, double value) {
+	if (!SIMC_Trace_Enabled) return;
+	SIMC_Trace_Internal_Record(SIMC_TRACE_EVENT_COUNTER, name, value);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Record an instant event (a point in time without duration).
+/// @param[in] name Event name
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Trace_Instant(const char* name) {
+	if (!SIMC_Trace_Enabled) return;
+	SIMC_Trace_Internal_Record(SIMC_TRACE_EVENT_INSTANT, name, 0.0);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Write string into JSON output with escaping.
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_Trace_Internal_WriteJSONString(FILE* f, const char* str) {
+	fputc('"', f);
+	if (str) {
+		for (; *str; str++) {
+			if ((*str == '"') || (*str == '\\')) {
+				fputc('\\', f);
+				fputc(*str, f);
+			} else if ((unsigned char)(*str) < 0x20) {
+				fprintf(f, "\\u%04x", (unsigned char)(*str));
+			} else {
+				fputc(*str, f);
+			}
+		}
+	}
+	fputc('"', f);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Find index of a name in the name table (names are compared by pointer).
+////////////////////////////////////////////////////////////////////////////////
+unsigned int SIMC_Trace_Internal_GetNameIndex(const char** table, unsigned int* count,
+                                              const char** hash, unsigned int* hash_index, unsigned int hash_size,
+                                              const char* name) {
+	size_t h = (((size_t)name) >> 3) & (hash_size - 1);
+	while (hash[h]) {
+		if (hash[h] == name) return hash_index[h];
+		h = (h + 1) & (hash_size - 1);
+	}
+	hash[h] = name;
+	hash_index[h] = *count;
+	table[*count] = name;
+	return (*count)++;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Write all recorded events to a file and clear the trace buffers.
+///
+/// Supported formats:
+///	- SIMC_TRACE_FORMAT_JSON: Chrome trace-event JSON, can be opened in chrome://tracing
+///		or other trace viewers.
+///	- SIMC_TRACE_FORMAT_BINARY: compact binary format (native byte order):
+///		- Header: "SIMCTRC" followed by a zero byte, uint32 version (1)
+///		- uint32 number of names, each name is uint16 length and characters
+///		- uint32 number of threads, each thread is uint32 index, uint16 name length and characters
+///		- uint64 number of events, each event is int64 timestamp (ns), double value,
+///			uint32 name index, uint16 thread index, uint8 type (0: begin, 1: end,
+///			2: counter, 3: instant), one reserved byte
+///
+/// Flushing may be performed while other threads are recording events. Only
+/// one thread may flush the trace at any time. Buffers of threads which have
+/// exited are freed after their events are written out.
+///
+/// @param[in] filename Output file name
+/// @param[in] format Output format
+///
+/// @returns Error code
+/// @retval SIMC_OK Trace successfully written
+/// @retval SIMC_ERROR_FILE Could not open output file
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_Trace_Flush(const char* filename, int format) {
+	SIMC_TRACE_BUFFER* buffer;
+	SIMC_TRACE_BUFFER** previous;
+	SIMC_TRACE_EVENT* event;
+	FILE* f;
+
+	f = fopen(filename, "wb");
+	if (!f) return SIMC_ERROR_FILE;
+
+	SIMC_TRACE_LOCK();
+	if (format == SIMC_TRACE_FORMAT_JSON) {
+		int first = 1;
+		fprintf(f, "{\"traceEvents\":[\n");
+		for (buffer = SIMC_Trace_Buffers; buffer; buffer = buffer->next) {
+			//Thread name metadata
+			if (buffer->thread_name) {
+				fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":",
+					first ? "" : ",\n", buffer->index);
+				SIMC_Trace_Internal_WriteJSONString(f, buffer->thread_name);
+				fprintf(f, "}}");
+				first = 0;
+			}
+
+			//Events
+			while (SIMC_Queue_EnterRead(buffer->queue, (void**)&event)) {
+				static const char* phases[] = { "B", "E", "C", "i" };
+				fprintf(f, "%s{\"name\":", first ? "" : ",\n");
+				SIMC_Trace_Internal_WriteJSONString(f, event->name);
+				fprintf(f, ",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":1,\"tid\":%u",
+					phases[event->type], (double)event->timestamp*1e-3, buffer->index);
+				if (event->type == SIMC_TRACE_EVENT_COUNTER) {
+					fprintf(f, ",\"args\":{\"value\":%.17g}", event->value);
+				} else if (event->type == SIMC_TRACE_EVENT_INSTANT) {
+					fprintf(f, ",\"s\":\"t\"");
+				}
+				fprintf(f, "}");
+				first = 0;
+				SIMC_Queue_LeaveRead(buffer->queue);
+			}
+
+			//Report events lost due to buffer overflow
+			if (buffer->dropped) {
+				fprintf(f, "%s{\"name\":\"Dropped trace events\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{\"value\":%u}}",
+					first ? "" : ",\n", (double)SIMC_Thread_GetTimeNs()*1e-3, buffer->index, buffer->dropped);
+				first = 0;
+			}
+			buffer->dropped = 0;
+		}
+		fprintf(f, "\n]}\n");
+	} else {
+		SIMC_STORAGEARRAY* events;
+		SIMC_STORAGEARRAY* threads;
+		const char** names;
+		const char** hash;
+		unsigned int* hash_index;
+		unsigned int hash_size = 1;
+		unsigned int name_count = 0;
+		uint32_t u32;
+		uint64_t u64;
+		uint16_t u16;
+		int i, count;
+
+		//Drain all buffers into a single array (thread index is stored in the type field)
+		SIMC_StorageArray_Create(&events, sizeof(SIMC_TRACE_EVENT));
+		SIMC_StorageArray_Create(&threads, sizeof(SIMC_TRACE_BUFFER*));
+		for (buffer = SIMC_Trace_Buffers; buffer; buffer = buffer->next) {
+			*((SIMC_TRACE_BUFFER**)SIMC_StorageArray_Add(threads)) = buffer;
+			while (SIMC_Queue_EnterRead(buffer->queue, (void**)&event)) {
+				SIMC_TRACE_EVENT* copy = (SIMC_TRACE_EVENT*)SIMC_StorageArray_Add(events);
+				*copy = *event;
+				copy->type = (int)((buffer->index << 8) | (unsigned int)event->type);
+				SIMC_Queue_LeaveRead(buffer->queue);
+			}
+			buffer->dropped = 0;
+		}
+		count = SIMC_StorageArray_Count(events);
+
+		//Build table of unique names
+		while (hash_size < 2*(unsigned int)(count + SIMC_StorageArray_Count(threads)) + 2) hash_size *= 2;
+		names = (const char**)SIMC_Allocate(SIMC_Userdata, sizeof(const char*)*(count + 1));
+		hash = (const char**)SIMC_Allocate(SIMC_Userdata, sizeof(const char*)*hash_size);
+		hash_index = (unsigned int*)SIMC_Allocate(SIMC_Userdata, sizeof(unsigned int)*hash_size);
+		memset((void*)hash, 0, sizeof(const char*)*hash_size);
+		for (i = 0; i < count; i++) {
+			event = (SIMC_TRACE_EVENT*)SIMC_StorageArray_Get(events, i);
+			SIMC_Trace_Internal_GetNameIndex(names, &name_count, hash, hash_index, hash_size, event->name);
+		}
+
+		//Header and names
+		fwrite("SIMCTRC", 1, 8, f);
+		u32 = 1; fwrite(&u32, 4, 1, f);
+		u32 = name_count; fwrite(&u32, 4, 1, f);
+		for (i = 0; i < (int)name_count; i++) {
+			u16 = names[i] ? (uint16_t)strlen(names[i]) : 0;
+			fwrite(&u16, 2, 1, f);
+			fwrite(names[i], 1, u16, f);
+		}
+
+		//Threads
+		u32 = SIMC_StorageArray_Count(threads); fwrite(&u32, 4, 1, f);
+		for (i = 0; i < SIMC_StorageArray_Count(threads); i++) {
+			buffer = *((SIMC_TRACE_BUFFER**)SIMC_StorageArray_Get(threads, i));
+			u32 = buffer->index; fwrite(&u32, 4, 1, f);
+			u16 = buffer->thread_name ? (uint16_t)strlen(buffer->thread_name) : 0;
+			fwrite(&u16, 2, 1, f);
+			fwrite(buffer->thread_name, 1, u16, f);
+		}
+
+		//Events
+		u64 = (uint64_t)count; fwrite(&u64, 8, 1, f);
+		for (i = 0; i < count; i++) {
+			unsigned char tail[8];
+			event = (SIMC_TRACE_EVENT*)SIMC_StorageArray_Get(events, i);
+			u32 = SIMC_Trace_Internal_GetNameIndex(names, &name_count, hash, hash_index, hash_size, event->name);
+			u16 = (uint16_t)(event->type >> 8);
+			memcpy(tail, &u32, 4);
+			memcpy(tail+4, &u16, 2);
+			tail[6] = (unsigned char)(event->type & 0xFF);
+			tail[7] = 0;
+			fwrite(&event->timestamp, 8, 1, f);
+			fwrite(&event->value, 8, 1, f);
+			fwrite(tail, 1, 8, f);
+		}
+
+		SIMC_Free(SIMC_Userdata, (void*)names);
+		SIMC_Free(SIMC_Userdata, (void*)hash);
+		SIMC_Free(SIMC_Userdata, hash_index);
+		SIMC_StorageArray_Destroy(events);
+		SIMC_StorageArray_Destroy(threads);
+	}
+
+	//Free buffers of threads which have exited
+	previous = &SIMC_Trace_Buffers;
+	while (*previous) {
+		buffer = *previous;
+		if (buffer->released && (!SIMC_Queue_Peek(buffer->queue, (void**)&event))) {
+			*previous = buffer->next;
+			SIMC_Queue_Destroy(buffer->queue);
+			SIMC_Free(SIMC_Userdata, buffer);
+		} else {
+			previous = &buffer->next;
+		}
+	}
+	SIMC_TRACE_UNLOCK();
+
+	fclose(f);
+	return SIMC_OK;
+}
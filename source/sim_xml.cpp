@@ -1,372 +1,979 @@
-////////////////////////////////////////////////////////////////////////////////
-/// @file
-////////////////////////////////////////////////////////////////////////////////
-/// Copyright (C) 2012-2015, Black Phoenix
-///
-/// This program is free software; you can redistribute it and/or modify it under
-/// the terms of the GNU Lesser General Public License as published by the Free Software
-/// Foundation; either version 2 of the License, or (at your option) any later
-/// version.
-///
-/// This program is distributed in the hope that it will be useful, but WITHOUT
-/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
-/// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
-/// details.
-///
-/// You should have received a copy of the GNU Lesser General Public License along with
-/// this program; if not, write to the Free Software Foundation, Inc., 59 Temple
-/// Place - Suite 330, Boston, MA  02111-1307, USA.
-///
-/// Further information about the GNU Lesser General Public License can also be found on
-/// the world wide web at http://www.gnu.org.
-////////////////////////////////////////////////////////////////////////////////
-#include <tinyxml.h>
-#include "sim_core.h"
-#include "sim_xml.h"
-
-int SIMC_XML_Open(const char* filename, SIMC_XML_DOCUMENT** xmldoc, SIMC_Callback_XMLSyntaxError* syntaxError, void* userdata) {
-	if (!filename) return SIMC_ERROR_INTERNAL;
-	if (!xmldoc) return SIMC_ERROR_INTERNAL;
-
-	TiXmlDocument* doc = new TiXmlDocument(filename);
-	if (!doc->LoadFile(filename)) {
-		if (doc->ErrorId() == TiXmlDocument::TIXML_ERROR_OPENING_FILE) {
-			delete doc;
-			*xmldoc = 0;
-
-			return SIMC_ERROR_FILE;
-		} else {
-			char errorText[8192];
-			snprintf(errorText,8191,"%s:%d %s",filename,doc->ErrorRow(),doc->ErrorDesc());
-			errorText[8191] = 0;
-
-			delete doc;
-			*xmldoc = 0;
-
-			if (syntaxError) syntaxError(userdata,errorText);
-			return SIMC_ERROR_SYNTAX;
-		}
-	}
-	*xmldoc = (SIMC_XML_DOCUMENT*)(doc);
-	return SIMC_OK;
-}
-
-int SIMC_XML_OpenString(const char* string, SIMC_XML_DOCUMENT** xmldoc, SIMC_Callback_XMLSyntaxError* syntaxError, void* userdata) {
-	if (!string) return SIMC_ERROR_INTERNAL;
-	if (!xmldoc) return SIMC_ERROR_INTERNAL;
-
-	TiXmlDocument* doc = new TiXmlDocument();
-	doc->Parse(string, 0, TIXML_ENCODING_UTF8);
-	if (doc->Error()) {
-		char errorText[8192];
-		snprintf(errorText,8191,"[string]:%d %s",doc->ErrorRow(),doc->ErrorDesc());
-		errorText[8191] = 0;
-
-		*xmldoc = 0;
-		delete doc;
-
-		if (syntaxError) syntaxError(userdata,errorText);
-		return SIMC_ERROR_SYNTAX;
-	}
-	*xmldoc = (SIMC_XML_DOCUMENT*)(doc);
-	return SIMC_OK;
-}
-
-int SIMC_XML_Close(SIMC_XML_DOCUMENT* xmldoc) {
-	if (!xmldoc) return SIMC_ERROR_INTERNAL;
-
-	TiXmlDocument* doc = (TiXmlDocument*)xmldoc;
-	delete doc;
-	return SIMC_OK;
-}
-
-int SIMC_XML_GetRootElement(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT** xmlelement, const char* name) {
-	if (!name) return SIMC_ERROR_INTERNAL;
-	if (!xmldoc) return SIMC_ERROR_INTERNAL;
-	if (!xmlelement) return SIMC_ERROR_INTERNAL;
-
-	TiXmlDocument* doc = (TiXmlDocument*)xmldoc;
-	TiXmlNode* node = doc->FirstChild(name);
-	*xmlelement = (SIMC_XML_ELEMENT*)node;
-	return SIMC_OK;
-}
-
-int SIMC_XML_GetElement(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlrootelement, SIMC_XML_ELEMENT** xmlelement, const char* name) {
-	//if (!name) return SIMC_ERROR_INTERNAL;
-	if (!xmldoc) return SIMC_ERROR_INTERNAL;
-	if (!xmlelement) return SIMC_ERROR_INTERNAL;
-	if (!xmlrootelement) return SIMC_ERROR_INTERNAL;
-
-	TiXmlDocument* doc = (TiXmlDocument*)xmldoc;
-	TiXmlElement* element = ((TiXmlNode*)xmlrootelement)->ToElement();
-	if (!element) return SIMC_ERROR_INTERNAL;
-
-	if (name) {
-		TiXmlNode* node = element->FirstChild(name);
-		*xmlelement = (SIMC_XML_ELEMENT*)node;
-	} else {
-		TiXmlNode* node = element->FirstChild();
-		while (node && node->ToText()) { //Skip text nodes (which are not elements)
-			SIMC_XML_Iterate(xmldoc,xmlrootelement,(SIMC_XML_ELEMENT**)&node,0);
-		}
-		*xmlelement = (SIMC_XML_ELEMENT*)node;
-	}
-	return SIMC_OK;
-}
-
-int SIMC_XML_GetAttribute(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, const char* name, char** value) {
-	if (!name) return SIMC_ERROR_INTERNAL;
-	if (!value) return SIMC_ERROR_INTERNAL;
-	if (!xmldoc) return SIMC_ERROR_INTERNAL;
-	if (!xmlelement) return SIMC_ERROR_INTERNAL;
-
-	TiXmlDocument* doc = (TiXmlDocument*)xmldoc;
-	TiXmlElement* element = ((TiXmlNode*)xmlelement)->ToElement();
-	if (!element) return SIMC_ERROR_INTERNAL;
-	*value = (char*)element->Attribute(name);
-	if (!(*value)) *value = "";
-	return SIMC_OK;
-}
-
-int SIMC_XML_GetAttributeInt(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, const char* name, int* value) {
-	if (!name) return SIMC_ERROR_INTERNAL;
-	if (!value) return SIMC_ERROR_INTERNAL;
-	if (!xmldoc) return SIMC_ERROR_INTERNAL;
-	if (!xmlelement) return SIMC_ERROR_INTERNAL;
-
-	TiXmlDocument* doc = (TiXmlDocument*)xmldoc;
-	TiXmlElement* element = ((TiXmlNode*)xmlelement)->ToElement();
-	if (!element) return SIMC_ERROR_INTERNAL;
-	if (!element->Attribute(name,value)) {
-		*value = 0;
-	}
-	return SIMC_OK;
-}
-
-int SIMC_XML_GetAttributeDouble(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, const char* name, double* value) {
-	if (!name) return SIMC_ERROR_INTERNAL;
-	if (!value) return SIMC_ERROR_INTERNAL;
-	if (!xmldoc) return SIMC_ERROR_INTERNAL;
-	if (!xmlelement) return SIMC_ERROR_INTERNAL;
-
-	TiXmlDocument* doc = (TiXmlDocument*)xmldoc;
-	TiXmlElement* element = ((TiXmlNode*)xmlelement)->ToElement();
-	if (!element) return SIMC_ERROR_INTERNAL;
-	if (!element->Attribute(name,value)) {
-		*value = 0.0;
-	}
-	return SIMC_OK;
-}
-
-int SIMC_XML_GetText(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, char** value) {
-	if (!value) return SIMC_ERROR_INTERNAL;
-	if (!xmldoc) return SIMC_ERROR_INTERNAL;
-	if (!xmlelement) return SIMC_ERROR_INTERNAL;
-
-	TiXmlDocument* doc = (TiXmlDocument*)xmldoc;
-	TiXmlElement* element = ((TiXmlNode*)xmlelement)->ToElement();
-	if (!element) return SIMC_ERROR_INTERNAL;
-	*value = (char*)element->GetText();
-	return SIMC_OK;
-}
-
-int SIMC_XML_GetName(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, char** value) {
-	if (!value) return SIMC_ERROR_INTERNAL;
-	if (!xmldoc) return SIMC_ERROR_INTERNAL;
-	if (!xmlelement) return SIMC_ERROR_INTERNAL;
-
-	TiXmlDocument* doc = (TiXmlDocument*)xmldoc;
-	TiXmlElement* element = ((TiXmlNode*)xmlelement)->ToElement();
-	if (!element) return SIMC_ERROR_INTERNAL;
-	*value = (char*)element->Value();
-	return SIMC_OK;
-}
-
-int SIMC_XML_Iterate(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, SIMC_XML_ELEMENT** xmlnested_element, const char* name) {
-	//if (!name) return SIMC_ERROR_INTERNAL;
-	if (!xmldoc) return SIMC_ERROR_INTERNAL;
-	if (!xmlelement) return SIMC_ERROR_INTERNAL;
-	if (!xmlnested_element) return SIMC_ERROR_INTERNAL;
-
-	TiXmlDocument* doc = (TiXmlDocument*)xmldoc;
-	TiXmlNode* node = (TiXmlNode*)xmlelement;
-	TiXmlNode* nested_node = (TiXmlNode*)(*xmlnested_element);
-	TiXmlElement* element = node->ToElement();
-	if (!element) return SIMC_ERROR_INTERNAL;
-
-	if (name) {
-		TiXmlNode* new_node = element->IterateChildren(name, nested_node);
-		*xmlnested_element = (SIMC_XML_ELEMENT*)new_node;
-	} else {
-		TiXmlNode* new_node = element->IterateChildren(nested_node);
-		*xmlnested_element = (SIMC_XML_ELEMENT*)new_node;
-	}
-	return SIMC_OK;
-}
-
-int SIMC_XML_GetFirstAttribute(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, SIMC_XML_ATTRIBUTE** xmlnested_attribute) {
-	if (!xmldoc) return SIMC_ERROR_INTERNAL;
-	if (!xmlelement) return SIMC_ERROR_INTERNAL;
-	if (!xmlnested_attribute) return SIMC_ERROR_INTERNAL;
-
-	TiXmlDocument* doc = (TiXmlDocument*)xmldoc;
-	TiXmlNode* node = (TiXmlNode*)xmlelement;
-	TiXmlElement* element = node->ToElement();
-	if (!element) return SIMC_ERROR_INTERNAL;
-
-	TiXmlAttribute* new_attribute = element->FirstAttribute();
-	*xmlnested_attribute = (SIMC_XML_ATTRIBUTE*)new_attribute;
-	return SIMC_OK;
-}
-
-int SIMC_XML_IterateAttributes(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ATTRIBUTE* xmlattribute, SIMC_XML_ATTRIBUTE** xmlnested_attribute) {
-	if (!xmldoc) return SIMC_ERROR_INTERNAL;
-	if (!xmlattribute) return SIMC_ERROR_INTERNAL;
-	if (!xmlnested_attribute) return SIMC_ERROR_INTERNAL;
-
-	TiXmlDocument* doc = (TiXmlDocument*)xmldoc;
-	TiXmlAttribute* attribute = (TiXmlAttribute*)xmlattribute;
-	if (!attribute) return SIMC_ERROR_INTERNAL;
-
-	TiXmlAttribute* new_attribute = attribute->Next();
-	*xmlnested_attribute = (SIMC_XML_ATTRIBUTE*)new_attribute;
-	return SIMC_OK;
-}
-
-int SIMC_XML_GetAttributeText(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ATTRIBUTE* xmlattribute, char** value) {
-	if (!value) return SIMC_ERROR_INTERNAL;
-	if (!xmldoc) return SIMC_ERROR_INTERNAL;
-	if (!xmlattribute) return SIMC_ERROR_INTERNAL;
-
-	TiXmlDocument* doc = (TiXmlDocument*)xmldoc;
-	TiXmlAttribute* attribute = (TiXmlAttribute*)xmlattribute;
-	if (!attribute) return SIMC_ERROR_INTERNAL;
-
-	*value = (char*)attribute->Value();
-	return SIMC_OK;
-}
-
-int SIMC_XML_GetAttributeName(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ATTRIBUTE* xmlattribute, char** value) {
-	if (!value) return SIMC_ERROR_INTERNAL;
-	if (!xmldoc) return SIMC_ERROR_INTERNAL;
-	if (!xmlattribute) return SIMC_ERROR_INTERNAL;
-
-	TiXmlDocument* doc = (TiXmlDocument*)xmldoc;
-	TiXmlAttribute* attribute = (TiXmlAttribute*)xmlattribute;
-	if (!attribute) return SIMC_ERROR_INTERNAL;
-
-	*value = (char*)attribute->Name();
-	return SIMC_OK;
-}
-
-
-int SIMC_XML_Create(SIMC_XML_DOCUMENT** xmldoc) {
-	if (!xmldoc) return SIMC_ERROR_INTERNAL;
-
-	TiXmlDocument* doc = new TiXmlDocument();
-	*xmldoc = (SIMC_XML_DOCUMENT*)(doc);
-	return SIMC_OK;
-}
-
-int SIMC_XML_Save(SIMC_XML_DOCUMENT* xmldoc, const char* filename) {
-	if (!filename) return SIMC_ERROR_INTERNAL;
-	if (!xmldoc) return SIMC_ERROR_INTERNAL;
-
-	TiXmlDocument* doc = (TiXmlDocument*)xmldoc;
-	doc->SaveFile(filename);
-	return SIMC_OK;
-}
-
-int SIMC_XML_SaveString(SIMC_XML_DOCUMENT* xmldoc, char** description) {
-	if (!xmldoc) return SIMC_ERROR_INTERNAL;
-	if (!description) return SIMC_ERROR_INTERNAL;
-
-	TiXmlDocument* doc = (TiXmlDocument*)xmldoc;
-	TiXmlPrinter printer;
-	printer.SetIndent("\t");
-
-	doc->Accept(&printer);
-	const char* buffer = printer.CStr();
-	*description = (char*)SIMC_Allocate(SIMC_Userdata, sizeof(char)*(strlen(buffer)+1));
-	strcpy((char*)(*description),buffer);
-	return SIMC_OK;
-}
-
-int SIMC_XML_AddRootElement(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT** xmlelement, const char* name) {
-	if (!name) return SIMC_ERROR_INTERNAL;
-	if (!xmldoc) return SIMC_ERROR_INTERNAL;
-	if (!xmlelement) return SIMC_ERROR_INTERNAL;
-
-	TiXmlDocument* doc = (TiXmlDocument*)xmldoc;
-	TiXmlElement* root = new TiXmlElement(name);
-	doc->LinkEndChild(root);
-
-	*xmlelement = (SIMC_XML_ELEMENT*)root;
-	return SIMC_OK;
-}
-
-int SIMC_XML_AddElement(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlrootelement, SIMC_XML_ELEMENT** xmlelement, const char* name) {
-	if (!xmldoc) return SIMC_ERROR_INTERNAL;
-	if (!xmlelement) return SIMC_ERROR_INTERNAL;
-	if (!xmlrootelement) return SIMC_ERROR_INTERNAL;
-
-	TiXmlDocument* doc = (TiXmlDocument*)xmldoc;
-	TiXmlElement* root = ((TiXmlNode*)xmlrootelement)->ToElement();
-	if (!root) return SIMC_ERROR_INTERNAL;
-	TiXmlElement* element = new TiXmlElement(name);
-	if (!element) return SIMC_ERROR_INTERNAL;
-	root->LinkEndChild(element);
-
-	*xmlelement = (SIMC_XML_ELEMENT*)element;
-	return SIMC_OK;
-}
-
-
-int SIMC_XML_AddAttribute(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, const char* name, const char* value) {
-	if (!name) return SIMC_ERROR_INTERNAL;
-	if (!value) return SIMC_ERROR_INTERNAL;
-	if (!xmldoc) return SIMC_ERROR_INTERNAL;
-	if (!xmlelement) return SIMC_ERROR_INTERNAL;
-	if (*value == 0) return SIMC_OK; //Do not create empty attributes
-
-	TiXmlDocument* doc = (TiXmlDocument*)xmldoc;
-	TiXmlElement* element = ((TiXmlNode*)xmlelement)->ToElement();
-	if (!element) return SIMC_ERROR_INTERNAL;
-	
-	element->SetAttribute(name,value);
-	return SIMC_OK;
-}
-
-int SIMC_XML_AddAttributeDouble(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, const char* name, double value) {
-	if (!name) return SIMC_ERROR_INTERNAL;
-	if (!xmldoc) return SIMC_ERROR_INTERNAL;
-	if (!xmlelement) return SIMC_ERROR_INTERNAL;
-	if (value == 0) return SIMC_OK; //Do not create empty attributes
-
-	TiXmlDocument* doc = (TiXmlDocument*)xmldoc;
-	TiXmlElement* element = ((TiXmlNode*)xmlelement)->ToElement();
-	if (!element) return SIMC_ERROR_INTERNAL;
-	
-	if ((value < 1e-15) && (value > -1e-15)) value = 0.0;
-	
-	char buffer[1024] = { 0 };
-	snprintf(buffer,1023,"%.15g",value);
-	element->SetAttribute(name,buffer);
-	//element->SetDoubleAttribute(name,value);
-	return SIMC_OK;
-}
-
-int SIMC_XML_SetText(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, const char* value) {
-	if (!value) return SIMC_ERROR_INTERNAL;
-	if (!xmldoc) return SIMC_ERROR_INTERNAL;
-	if (!xmlelement) return SIMC_ERROR_INTERNAL;
-
-	TiXmlDocument* doc = (TiXmlDocument*)xmldoc;
-	TiXmlElement* element = ((TiXmlNode*)xmlelement)->ToElement();
-	if (!element) return SIMC_ERROR_INTERNAL;
-	//element->SetValue(value);
-
-	TiXmlText* text = new TiXmlText(value);
-	element->LinkEndChild(text);
-	return SIMC_OK;
-}
+////////////////////////////////////////////////////////////////////////////////
+/// @file
+////////////////////////////////////////////////////////////////////////////////
+/// Copyright (C) 2012-2015, Black Phoenix
+///
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the GNU Lesser General Public License as published by the Free Software
+/// Foundation; either version 2 of the License, or (at your option) any later
+/// version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+/// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+/// details.
+///
+/// You should have received a copy of the GNU Lesser General Public License along with
+/// this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+/// Place - Suite 330, Boston, MA  02111-1307, USA.
+///
+/// Further information about the GNU Lesser General Public License can also be found on
+/// the world wide web at http://www.gnu.org.
+////////////////////////////////////////////////////////////////////////////////
+#include <tinyxml.h>
+#include "sim_core.h"
+#include "sim_xml.h"
+
+//Check if document is parsed by SIMC (otherwise TinyXML)
+#define SIMC_XML_IS_NATIVE(xmldoc)	(((SIMC_XML_DOC*)(xmldoc))->backend == SIMC_XML_BACKEND_NATIVE)
+//Get TinyXML document
+#define SIMC_XML_TINYXML(xmldoc)	((TiXmlDocument*)((SIMC_XML_DOC*)(xmldoc))->tinyxml)
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Create document handle for a TinyXML document.
+////////////////////////////////////////////////////////////////////////////////
+SIMC_XML_DOCUMENT* SIMC_XML_Internal_WrapTinyXML(TiXmlDocument* tinyxml) {
+	SIMC_XML_DOC* doc = (SIMC_XML_DOC*)SIMC_Allocate(SIMC_Userdata,sizeof(SIMC_XML_DOC));
+	memset(doc,0,sizeof(SIMC_XML_DOC));
+	doc->backend = SIMC_XML_BACKEND_TINYXML;
+	doc->tinyxml = tinyxml;
+	return (SIMC_XML_DOCUMENT*)doc;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Open XML file.
+///
+/// The file is read into memory and parsed in place. All nodes of the document
+/// (and strings added later) are allocated from a per-document arena, which gets
+/// memory from SIMC_Allocate() in large chunks: loading does not allocate per node
+/// and SIMC_XML_Close() only frees a handful of chunks. The document can be changed
+/// with SIMC_XML_Add...() and SIMC_XML_SetText() until it is frozen.
+///
+/// Files compressed with gzip are recognized by their magic bytes and decompressed
+/// while they are parsed, without writing the decompressed text anywhere (strings
+/// are copied into the arena as they are parsed).
+///
+/// If the library is built with SIMC_XML_USE_TINYXML defined, uncompressed files
+/// are loaded with TinyXML instead.
+///
+/// @param[in] filename Name of the file to open
+/// @param[out] xmldoc Document handle
+/// @param[in] syntaxError Callback for syntax errors (may be null)
+/// @param[in] userdata Userdata passed into the syntax error callback
+///
+/// @returns Error code
+/// @retval SIMC_OK Document successfully loaded
+/// @retval SIMC_ERROR_FILE File could not be opened
+/// @retval SIMC_ERROR_SYNTAX Syntax error in file, or corrupt compressed data
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Open(const char* filename, SIMC_XML_DOCUMENT** xmldoc, SIMC_Callback_XMLSyntaxError* syntaxError, void* userdata) {
+	if (!filename) return SIMC_ERROR_INTERNAL;
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+
+#ifndef SIMC_XML_USE_TINYXML
+	return SIMC_XML_Native_OpenFile(filename,0,(SIMC_XML_DOC**)xmldoc,syntaxError,userdata);
+#else
+	FILE* file = fopen(filename,"rb");
+	if (file) {
+		int compression = SIMC_XML_Internal_DetectCompression(file);
+		fclose(file);
+		if (compression != SIMC_XML_COMPRESSION_NONE) {
+			return SIMC_XML_Native_OpenFile(filename,0,(SIMC_XML_DOC**)xmldoc,syntaxError,userdata);
+		}
+	}
+
+	TiXmlDocument* doc = new TiXmlDocument(filename);
+	if (!doc->LoadFile(filename)) {
+		if (doc->ErrorId() == TiXmlDocument::TIXML_ERROR_OPENING_FILE) {
+			delete doc;
+			*xmldoc = 0;
+
+			return SIMC_ERROR_FILE;
+		} else {
+			char errorText[8192];
+			snprintf(errorText,8191,"%s:%d %s",filename,doc->ErrorRow(),doc->ErrorDesc());
+			errorText[8191] = 0;
+
+			delete doc;
+			*xmldoc = 0;
+
+			if (syntaxError) syntaxError(userdata,errorText);
+			return SIMC_ERROR_SYNTAX;
+		}
+	}
+	*xmldoc = SIMC_XML_Internal_WrapTinyXML(doc);
+	return SIMC_OK;
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Parse XML document from a string.
+///
+/// The string is copied into the document arena and parsed there (see
+/// SIMC_XML_Open()), the original string is not modified.
+///
+/// @param[in] string XML text
+/// @param[out] xmldoc Document handle
+/// @param[in] syntaxError Callback for syntax errors (may be null)
+/// @param[in] userdata Userdata passed into the syntax error callback
+///
+/// @returns Error code
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_OpenString(const char* string, SIMC_XML_DOCUMENT** xmldoc, SIMC_Callback_XMLSyntaxError* syntaxError, void* userdata) {
+	if (!string) return SIMC_ERROR_INTERNAL;
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+
+#ifndef SIMC_XML_USE_TINYXML
+	return SIMC_XML_Native_OpenString(string,(SIMC_XML_DOC**)xmldoc,syntaxError,userdata);
+#else
+	TiXmlDocument* doc = new TiXmlDocument();
+	doc->Parse(string, 0, TIXML_ENCODING_UTF8);
+	if (doc->Error()) {
+		char errorText[8192];
+		snprintf(errorText,8191,"[string]:%d %s",doc->ErrorRow(),doc->ErrorDesc());
+		errorText[8191] = 0;
+
+		*xmldoc = 0;
+		delete doc;
+
+		if (syntaxError) syntaxError(userdata,errorText);
+		return SIMC_ERROR_SYNTAX;
+	}
+	*xmldoc = SIMC_XML_Internal_WrapTinyXML(doc);
+	return SIMC_OK;
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Open XML file by mapping it into memory and parsing it in place.
+///
+/// Unlike SIMC_XML_Open(), no strings are copied: element names, attributes and
+/// text returned by the getters point directly into the mapped file (which is
+/// mapped copy-on-write, so the file itself is never modified). All nodes are
+/// allocated from a per-document arena. Use SIMC_XML_GetAttributeView(),
+/// SIMC_XML_GetTextView() and SIMC_XML_GetNameView() to get strings together with
+/// their length.
+///
+/// The document can be changed like any other document (new strings are copied
+/// into the arena).
+///
+/// Pages of the file which were not modified by the parser are shared with the
+/// file, so the file must not be modified in place while the document is open
+/// (write a new file and rename it over the old one instead).
+///
+/// Compressed files cannot be parsed in place: they are decompressed while being
+/// parsed and all strings are copied into the document arena.
+///
+/// @param[in] filename Name of the file to open
+/// @param[out] xmldoc Document handle
+/// @param[in] syntaxError Callback for syntax errors (may be null)
+/// @param[in] userdata Userdata passed into the syntax error callback
+///
+/// @returns Error code
+/// @retval SIMC_OK Document successfully loaded
+/// @retval SIMC_ERROR_FILE File could not be opened or mapped
+/// @retval SIMC_ERROR_SYNTAX Syntax error in file
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_OpenMapped(const char* filename, SIMC_XML_DOCUMENT** xmldoc, SIMC_Callback_XMLSyntaxError* syntaxError, void* userdata) {
+	if (!filename) return SIMC_ERROR_INTERNAL;
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+
+	return SIMC_XML_Native_OpenMapped(filename,(SIMC_XML_DOC**)xmldoc,syntaxError,userdata);
+}
+
+int SIMC_XML_Close(SIMC_XML_DOCUMENT* xmldoc) {
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+
+	SIMC_XML_DOC* doc = (SIMC_XML_DOC*)xmldoc;
+	if (doc->backend == SIMC_XML_BACKEND_NATIVE) {
+		SIMC_XML_Native_Close(doc);
+		return SIMC_OK;
+	}
+	delete (TiXmlDocument*)doc->tinyxml;
+	SIMC_XML_Atom_Destroy(&doc->atoms);
+	SIMC_XML_Arena_Destroy(&doc->arena);
+	SIMC_Free(SIMC_Userdata,doc);
+	return SIMC_OK;
+}
+
+int SIMC_XML_GetRootElement(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT** xmlelement, const char* name) {
+	if (!name) return SIMC_ERROR_INTERNAL;
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+	if (!xmlelement) return SIMC_ERROR_INTERNAL;
+
+	if (SIMC_XML_IS_NATIVE(xmldoc)) {
+		SIMC_XML_DOC* doc = (SIMC_XML_DOC*)xmldoc;
+		*xmlelement = (SIMC_XML_ELEMENT*)SIMC_XML_Native_FindElement(doc,doc->root.first_child,name);
+		return SIMC_OK;
+	}
+
+	TiXmlDocument* doc = SIMC_XML_TINYXML(xmldoc);
+	TiXmlNode* node = doc->FirstChild(name);
+	*xmlelement = (SIMC_XML_ELEMENT*)node;
+	return SIMC_OK;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Get root element of the document (first top-level element).
+////////////////////////////////////////////////////////////////////////////////
+SIMC_XML_ELEMENT* SIMC_XML_Internal_GetDocumentElement(SIMC_XML_DOCUMENT* xmldoc) {
+	if (SIMC_XML_IS_NATIVE(xmldoc)) {
+		return (SIMC_XML_ELEMENT*)((SIMC_XML_DOC*)xmldoc)->root.first_child;
+	}
+	return (SIMC_XML_ELEMENT*)SIMC_XML_TINYXML(xmldoc)->RootElement();
+}
+
+int SIMC_XML_GetElement(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlrootelement, SIMC_XML_ELEMENT** xmlelement, const char* name) {
+	//if (!name) return SIMC_ERROR_INTERNAL;
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+	if (!xmlelement) return SIMC_ERROR_INTERNAL;
+	if (!xmlrootelement) return SIMC_ERROR_INTERNAL;
+
+	if (SIMC_XML_IS_NATIVE(xmldoc)) {
+		SIMC_XML_NATIVE_ELEMENT* element = (SIMC_XML_NATIVE_ELEMENT*)xmlrootelement;
+		*xmlelement = (SIMC_XML_ELEMENT*)SIMC_XML_Native_FindElement((SIMC_XML_DOC*)xmldoc,element->first_child,name);
+		return SIMC_OK;
+	}
+
+	TiXmlElement* element = ((TiXmlNode*)xmlrootelement)->ToElement();
+	if (!element) return SIMC_ERROR_INTERNAL;
+
+	if (name) {
+		TiXmlNode* node = element->FirstChild(name);
+		*xmlelement = (SIMC_XML_ELEMENT*)node;
+	} else {
+		TiXmlNode* node = element->FirstChild();
+		while (node && node->ToText()) { //Skip text nodes (which are not elements)
+			SIMC_XML_Iterate(xmldoc,xmlrootelement,(SIMC_XML_ELEMENT**)&node,0);
+		}
+		*xmlelement = (SIMC_XML_ELEMENT*)node;
+	}
+	return SIMC_OK;
+}
+
+int SIMC_XML_GetAttribute(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, const char* name, char** value) {
+	if (!name) return SIMC_ERROR_INTERNAL;
+	if (!value) return SIMC_ERROR_INTERNAL;
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+	if (!xmlelement) return SIMC_ERROR_INTERNAL;
+
+	if (SIMC_XML_IS_NATIVE(xmldoc)) {
+		SIMC_XML_NATIVE_ATTRIBUTE* attribute = SIMC_XML_Native_FindAttribute((SIMC_XML_DOC*)xmldoc,(SIMC_XML_NATIVE_ELEMENT*)xmlelement,name);
+		*value = attribute ? (char*)attribute->value.data : (char*)"";
+		return SIMC_OK;
+	}
+
+	TiXmlElement* element = ((TiXmlNode*)xmlelement)->ToElement();
+	if (!element) return SIMC_ERROR_INTERNAL;
+	*value = (char*)element->Attribute(name);
+	if (!(*value)) *value = "";
+	return SIMC_OK;
+}
+
+int SIMC_XML_GetAttributeInt(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, const char* name, int* value) {
+	if (!name) return SIMC_ERROR_INTERNAL;
+	if (!value) return SIMC_ERROR_INTERNAL;
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+	if (!xmlelement) return SIMC_ERROR_INTERNAL;
+
+	if (SIMC_XML_IS_NATIVE(xmldoc)) {
+		SIMC_XML_NATIVE_ATTRIBUTE* attribute = SIMC_XML_Native_FindAttribute((SIMC_XML_DOC*)xmldoc,(SIMC_XML_NATIVE_ELEMENT*)xmlelement,name);
+		*value = 0;
+		if (attribute) SIMC_XML_Internal_ParseInt(attribute->value.data,attribute->value.data+attribute->value.length,value);
+		return SIMC_OK;
+	}
+
+	TiXmlElement* element = ((TiXmlNode*)xmlelement)->ToElement();
+	if (!element) return SIMC_ERROR_INTERNAL;
+	const char* text = element->Attribute(name);
+	*value = 0;
+	if (text) SIMC_XML_Internal_ParseInt(text,text+strlen(text),value);
+	return SIMC_OK;
+}
+
+int SIMC_XML_GetAttributeDouble(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, const char* name, double* value) {
+	if (!name) return SIMC_ERROR_INTERNAL;
+	if (!value) return SIMC_ERROR_INTERNAL;
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+	if (!xmlelement) return SIMC_ERROR_INTERNAL;
+
+	if (SIMC_XML_IS_NATIVE(xmldoc)) {
+		SIMC_XML_NATIVE_ATTRIBUTE* attribute = SIMC_XML_Native_FindAttribute((SIMC_XML_DOC*)xmldoc,(SIMC_XML_NATIVE_ELEMENT*)xmlelement,name);
+		*value = 0.0;
+		if (attribute && (attribute->number_state == SIMC_XML_NUMBER_VALID)) {
+			*value = attribute->number;
+		} else if (attribute) {
+			SIMC_XML_Internal_ParseDouble(attribute->value.data,attribute->value.data+attribute->value.length,value);
+		}
+		return SIMC_OK;
+	}
+
+	TiXmlElement* element = ((TiXmlNode*)xmlelement)->ToElement();
+	if (!element) return SIMC_ERROR_INTERNAL;
+	const char* text = element->Attribute(name);
+	*value = 0.0;
+	if (text) SIMC_XML_Internal_ParseDouble(text,text+strlen(text),value);
+	return SIMC_OK;
+}
+
+int SIMC_XML_GetText(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, char** value) {
+	if (!value) return SIMC_ERROR_INTERNAL;
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+	if (!xmlelement) return SIMC_ERROR_INTERNAL;
+
+	if (SIMC_XML_IS_NATIVE(xmldoc)) {
+		*value = (char*)((SIMC_XML_NATIVE_ELEMENT*)xmlelement)->text.data;
+		return SIMC_OK;
+	}
+
+	TiXmlElement* element = ((TiXmlNode*)xmlelement)->ToElement();
+	if (!element) return SIMC_ERROR_INTERNAL;
+	*value = (char*)element->GetText();
+	return SIMC_OK;
+}
+
+int SIMC_XML_GetName(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, char** value) {
+	if (!value) return SIMC_ERROR_INTERNAL;
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+	if (!xmlelement) return SIMC_ERROR_INTERNAL;
+
+	if (SIMC_XML_IS_NATIVE(xmldoc)) {
+		*value = (char*)((SIMC_XML_NATIVE_ELEMENT*)xmlelement)->name.data;
+		return SIMC_OK;
+	}
+
+	TiXmlElement* element = ((TiXmlNode*)xmlelement)->ToElement();
+	if (!element) return SIMC_ERROR_INTERNAL;
+	*value = (char*)element->Value();
+	return SIMC_OK;
+}
+
+int SIMC_XML_Iterate(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, SIMC_XML_ELEMENT** xmlnested_element, const char* name) {
+	//if (!name) return SIMC_ERROR_INTERNAL;
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+	if (!xmlelement) return SIMC_ERROR_INTERNAL;
+	if (!xmlnested_element) return SIMC_ERROR_INTERNAL;
+
+	if (SIMC_XML_IS_NATIVE(xmldoc)) {
+		SIMC_XML_NATIVE_ELEMENT* element = (SIMC_XML_NATIVE_ELEMENT*)xmlelement;
+		SIMC_XML_NATIVE_ELEMENT* nested_element = (SIMC_XML_NATIVE_ELEMENT*)(*xmlnested_element);
+		nested_element = nested_element ? nested_element->next : element->first_child;
+		*xmlnested_element = (SIMC_XML_ELEMENT*)SIMC_XML_Native_FindElement((SIMC_XML_DOC*)xmldoc,nested_element,name);
+		return SIMC_OK;
+	}
+
+	TiXmlNode* node = (TiXmlNode*)xmlelement;
+	TiXmlNode* nested_node = (TiXmlNode*)(*xmlnested_element);
+	TiXmlElement* element = node->ToElement();
+	if (!element) return SIMC_ERROR_INTERNAL;
+
+	if (name) {
+		TiXmlNode* new_node = element->IterateChildren(name, nested_node);
+		*xmlnested_element = (SIMC_XML_ELEMENT*)new_node;
+	} else {
+		TiXmlNode* new_node = element->IterateChildren(nested_node);
+		*xmlnested_element = (SIMC_XML_ELEMENT*)new_node;
+	}
+	return SIMC_OK;
+}
+
+int SIMC_XML_GetFirstAttribute(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, SIMC_XML_ATTRIBUTE** xmlnested_attribute) {
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+	if (!xmlelement) return SIMC_ERROR_INTERNAL;
+	if (!xmlnested_attribute) return SIMC_ERROR_INTERNAL;
+
+	if (SIMC_XML_IS_NATIVE(xmldoc)) {
+		*xmlnested_attribute = (SIMC_XML_ATTRIBUTE*)((SIMC_XML_NATIVE_ELEMENT*)xmlelement)->first_attribute;
+		return SIMC_OK;
+	}
+
+	TiXmlNode* node = (TiXmlNode*)xmlelement;
+	TiXmlElement* element = node->ToElement();
+	if (!element) return SIMC_ERROR_INTERNAL;
+
+	TiXmlAttribute* new_attribute = element->FirstAttribute();
+	*xmlnested_attribute = (SIMC_XML_ATTRIBUTE*)new_attribute;
+	return SIMC_OK;
+}
+
+int SIMC_XML_IterateAttributes(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ATTRIBUTE* xmlattribute, SIMC_XML_ATTRIBUTE** xmlnested_attribute) {
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+	if (!xmlattribute) return SIMC_ERROR_INTERNAL;
+	if (!xmlnested_attribute) return SIMC_ERROR_INTERNAL;
+
+	if (SIMC_XML_IS_NATIVE(xmldoc)) {
+		*xmlnested_attribute = (SIMC_XML_ATTRIBUTE*)((SIMC_XML_NATIVE_ATTRIBUTE*)xmlattribute)->next;
+		return SIMC_OK;
+	}
+
+	TiXmlAttribute* attribute = (TiXmlAttribute*)xmlattribute;
+	if (!attribute) return SIMC_ERROR_INTERNAL;
+
+	TiXmlAttribute* new_attribute = attribute->Next();
+	*xmlnested_attribute = (SIMC_XML_ATTRIBUTE*)new_attribute;
+	return SIMC_OK;
+}
+
+int SIMC_XML_GetAttributeText(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ATTRIBUTE* xmlattribute, char** value) {
+	if (!value) return SIMC_ERROR_INTERNAL;
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+	if (!xmlattribute) return SIMC_ERROR_INTERNAL;
+
+	if (SIMC_XML_IS_NATIVE(xmldoc)) {
+		*value = (char*)((SIMC_XML_NATIVE_ATTRIBUTE*)xmlattribute)->value.data;
+		return SIMC_OK;
+	}
+
+	TiXmlAttribute* attribute = (TiXmlAttribute*)xmlattribute;
+	if (!attribute) return SIMC_ERROR_INTERNAL;
+
+	*value = (char*)attribute->Value();
+	return SIMC_OK;
+}
+
+int SIMC_XML_GetAttributeName(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ATTRIBUTE* xmlattribute, char** value) {
+	if (!value) return SIMC_ERROR_INTERNAL;
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+	if (!xmlattribute) return SIMC_ERROR_INTERNAL;
+
+	if (SIMC_XML_IS_NATIVE(xmldoc)) {
+		*value = (char*)((SIMC_XML_NATIVE_ATTRIBUTE*)xmlattribute)->name.data;
+		return SIMC_OK;
+	}
+
+	TiXmlAttribute* attribute = (TiXmlAttribute*)xmlattribute;
+	if (!attribute) return SIMC_ERROR_INTERNAL;
+
+	*value = (char*)attribute->Name();
+	return SIMC_OK;
+}
+
+int SIMC_XML_GetAttributeView(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, const char* name, SIMC_XML_STRING* value) {
+	if (!name) return SIMC_ERROR_INTERNAL;
+	if (!value) return SIMC_ERROR_INTERNAL;
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+	if (!xmlelement) return SIMC_ERROR_INTERNAL;
+
+	if (SIMC_XML_IS_NATIVE(xmldoc)) {
+		SIMC_XML_NATIVE_ATTRIBUTE* attribute = SIMC_XML_Native_FindAttribute((SIMC_XML_DOC*)xmldoc,(SIMC_XML_NATIVE_ELEMENT*)xmlelement,name);
+		value->data = attribute ? attribute->value.data : "";
+		value->length = attribute ? attribute->value.length : 0;
+		return SIMC_OK;
+	}
+
+	char* text;
+	int error = SIMC_XML_GetAttribute(xmldoc,xmlelement,name,&text);
+	if (error) return error;
+	value->data = text;
+	value->length = strlen(text);
+	return SIMC_OK;
+}
+
+int SIMC_XML_GetTextView(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, SIMC_XML_STRING* value) {
+	if (!value) return SIMC_ERROR_INTERNAL;
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+	if (!xmlelement) return SIMC_ERROR_INTERNAL;
+
+	if (SIMC_XML_IS_NATIVE(xmldoc)) {
+		*value = ((SIMC_XML_NATIVE_ELEMENT*)xmlelement)->text;
+		return SIMC_OK;
+	}
+
+	char* text;
+	int error = SIMC_XML_GetText(xmldoc,xmlelement,&text);
+	if (error) return error;
+	value->data = text;
+	value->length = text ? strlen(text) : 0;
+	return SIMC_OK;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Parse element text as an array of whitespace-separated numbers.
+///
+/// Parses up to max_count numbers directly into the caller buffer. The total
+/// number of values in the text is returned in count, so the required buffer size
+/// can be found by calling this function with max_count set to zero:
+/// ~~~{.c}
+///		int count;
+///		SIMC_XML_GetTextDoubleArray(xmldoc,element,0,0,&count);
+///		values = (double*)malloc(sizeof(double)*count);
+///		SIMC_XML_GetTextDoubleArray(xmldoc,element,values,count,&count);
+/// ~~~
+///
+/// @param[in] xmldoc Document
+/// @param[in] xmlelement Element
+/// @param[out] values Buffer for values (may be null if max_count is zero)
+/// @param[in] max_count Size of the buffer
+/// @param[out] count Number of values in element text
+///
+/// @returns Error code
+/// @retval SIMC_OK Text successfully parsed (or element has no text)
+/// @retval SIMC_ERROR_SYNTAX Text contains something that is not a number (count is set to number of values before it)
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_GetTextDoubleArray(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, double* values, int max_count, int* count) {
+	SIMC_XML_STRING text;
+	if (!count) return SIMC_ERROR_INTERNAL;
+	if ((!values) && (max_count > 0)) return SIMC_ERROR_INTERNAL;
+
+	int error = SIMC_XML_GetTextView(xmldoc,xmlelement,&text);
+	if (error) return error;
+	*count = 0;
+	if (!text.data) return SIMC_OK;
+	return SIMC_XML_Internal_ParseArray(text.data,text.data+text.length,values,1,max_count,count);
+}
+
+int SIMC_XML_GetTextIntArray(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, int* values, int max_count, int* count) {
+	SIMC_XML_STRING text;
+	if (!count) return SIMC_ERROR_INTERNAL;
+	if ((!values) && (max_count > 0)) return SIMC_ERROR_INTERNAL;
+
+	int error = SIMC_XML_GetTextView(xmldoc,xmlelement,&text);
+	if (error) return error;
+	*count = 0;
+	if (!text.data) return SIMC_OK;
+	return SIMC_XML_Internal_ParseArray(text.data,text.data+text.length,values,0,max_count,count);
+}
+
+int SIMC_XML_GetNameView(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, SIMC_XML_STRING* value) {
+	if (!value) return SIMC_ERROR_INTERNAL;
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+	if (!xmlelement) return SIMC_ERROR_INTERNAL;
+
+	if (SIMC_XML_IS_NATIVE(xmldoc)) {
+		*value = ((SIMC_XML_NATIVE_ELEMENT*)xmlelement)->name;
+		return SIMC_OK;
+	}
+
+	char* text;
+	int error = SIMC_XML_GetName(xmldoc,xmlelement,&text);
+	if (error) return error;
+	value->data = text;
+	value->length = strlen(text);
+	return SIMC_OK;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Resolve name to an atom of the document.
+///
+/// Atoms are unique per document: every element and attribute with the given name
+/// refers to the same atom, so the lookups which accept an atom compare pointers
+/// instead of strings. Loaders which query the same names many times should
+/// resolve them once after opening the document:
+/// ~~~{.c}
+///		SIMC_XML_ATOM atom_mass;
+///		SIMC_XML_GetAtom(xmldoc,"mass",&atom_mass);
+///		while (SIMC_XML_Iterate(xmldoc,root,&element,0), element) {
+///			SIMC_XML_GetAttributeDoubleAtom(xmldoc,element,atom_mass,&mass);
+///		}
+/// ~~~
+///
+/// Names are interned while the document is parsed. Atom is set to null if the
+/// name does not occur in the document at all (lookups with a null atom never find
+/// anything), this call never modifies the document. Atoms stay valid while the
+/// document is changed, but a name added after this call needs a new lookup.
+/// Documents loaded with TinyXML (SIMC_XML_USE_TINYXML builds) add the name to the
+/// document's atom table instead.
+///
+/// @param[in] xmldoc Document
+/// @param[in] name Name to resolve
+/// @param[out] atom Atom (valid until the document is closed)
+///
+/// @returns Error code
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_GetAtom(SIMC_XML_DOCUMENT* xmldoc, const char* name, SIMC_XML_ATOM* atom) {
+	if (!name) return SIMC_ERROR_INTERNAL;
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+	if (!atom) return SIMC_ERROR_INTERNAL;
+
+	SIMC_XML_DOC* doc = (SIMC_XML_DOC*)xmldoc;
+	if (SIMC_XML_IS_NATIVE(xmldoc)) {
+		*atom = SIMC_XML_Atom_Find(&doc->atoms,name,strlen(name));
+		return SIMC_OK;
+	}
+
+	*atom = SIMC_XML_Atom_Intern(&doc->atoms,&doc->arena,name,strlen(name),1);
+	if (!(*atom)) return SIMC_ERROR_INTERNAL;
+	return SIMC_OK;
+}
+
+int SIMC_XML_GetElementAtom(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlrootelement, SIMC_XML_ELEMENT** xmlelement, SIMC_XML_ATOM atom) {
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+	if (!xmlelement) return SIMC_ERROR_INTERNAL;
+	if (!xmlrootelement) return SIMC_ERROR_INTERNAL;
+
+	*xmlelement = 0;
+	if (!atom) return SIMC_OK;
+	if (SIMC_XML_IS_NATIVE(xmldoc)) {
+		SIMC_XML_NATIVE_ELEMENT* element = (SIMC_XML_NATIVE_ELEMENT*)xmlrootelement;
+		*xmlelement = (SIMC_XML_ELEMENT*)SIMC_XML_Native_FindElementAtom(element->first_child,atom);
+		return SIMC_OK;
+	}
+	return SIMC_XML_GetElement(xmldoc,xmlrootelement,xmlelement,atom);
+}
+
+int SIMC_XML_IterateAtom(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, SIMC_XML_ELEMENT** xmlnested_element, SIMC_XML_ATOM atom) {
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+	if (!xmlelement) return SIMC_ERROR_INTERNAL;
+	if (!xmlnested_element) return SIMC_ERROR_INTERNAL;
+
+	if (!atom) {
+		*xmlnested_element = 0;
+		return SIMC_OK;
+	}
+	if (SIMC_XML_IS_NATIVE(xmldoc)) {
+		SIMC_XML_NATIVE_ELEMENT* element = (SIMC_XML_NATIVE_ELEMENT*)xmlelement;
+		SIMC_XML_NATIVE_ELEMENT* nested_element = (SIMC_XML_NATIVE_ELEMENT*)(*xmlnested_element);
+		nested_element = nested_element ? nested_element->next : element->first_child;
+		*xmlnested_element = (SIMC_XML_ELEMENT*)SIMC_XML_Native_FindElementAtom(nested_element,atom);
+		return SIMC_OK;
+	}
+	return SIMC_XML_Iterate(xmldoc,xmlelement,xmlnested_element,atom);
+}
+
+int SIMC_XML_GetAttributeViewAtom(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, SIMC_XML_ATOM atom, SIMC_XML_STRING* value) {
+	if (!value) return SIMC_ERROR_INTERNAL;
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+	if (!xmlelement) return SIMC_ERROR_INTERNAL;
+
+	value->data = "";
+	value->length = 0;
+	if (!atom) return SIMC_OK;
+	if (SIMC_XML_IS_NATIVE(xmldoc)) {
+		SIMC_XML_NATIVE_ATTRIBUTE* attribute = SIMC_XML_Native_FindAttributeAtom((SIMC_XML_NATIVE_ELEMENT*)xmlelement,atom);
+		if (attribute) *value = attribute->value;
+		return SIMC_OK;
+	}
+	return SIMC_XML_GetAttributeView(xmldoc,xmlelement,atom,value);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Find attribute by atom, telling a missing attribute apart from an empty one.
+/// @returns 1 if element has the attribute, 0 otherwise
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Internal_FindAttributeAtom(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, SIMC_XML_ATOM atom, SIMC_XML_STRING* value) {
+	value->data = "";
+	value->length = 0;
+	if (!atom) return 0;
+	if (SIMC_XML_IS_NATIVE(xmldoc)) {
+		SIMC_XML_NATIVE_ATTRIBUTE* attribute = SIMC_XML_Native_FindAttributeAtom((SIMC_XML_NATIVE_ELEMENT*)xmlelement,atom);
+		if (!attribute) return 0;
+		*value = attribute->value;
+		return 1;
+	}
+
+	TiXmlElement* element = ((TiXmlNode*)xmlelement)->ToElement();
+	const char* text = element ? element->Attribute(atom) : 0;
+	if (!text) return 0;
+	value->data = text;
+	value->length = strlen(text);
+	return 1;
+}
+
+int SIMC_XML_GetAttributeIntAtom(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, SIMC_XML_ATOM atom, int* value) {
+	SIMC_XML_STRING text;
+	if (!value) return SIMC_ERROR_INTERNAL;
+
+	int error = SIMC_XML_GetAttributeViewAtom(xmldoc,xmlelement,atom,&text);
+	if (error) return error;
+	*value = 0;
+	SIMC_XML_Internal_ParseInt(text.data,text.data+text.length,value);
+	return SIMC_OK;
+}
+
+int SIMC_XML_GetAttributeDoubleAtom(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, SIMC_XML_ATOM atom, double* value) {
+	SIMC_XML_STRING text;
+	if (!value) return SIMC_ERROR_INTERNAL;
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+	if (!xmlelement) return SIMC_ERROR_INTERNAL;
+
+	if (SIMC_XML_IS_NATIVE(xmldoc)) {
+		SIMC_XML_NATIVE_ATTRIBUTE* attribute = atom ? SIMC_XML_Native_FindAttributeAtom((SIMC_XML_NATIVE_ELEMENT*)xmlelement,atom) : 0;
+		if (attribute && (attribute->number_state == SIMC_XML_NUMBER_VALID)) {
+			*value = attribute->number;
+			return SIMC_OK;
+		}
+	}
+
+	int error = SIMC_XML_GetAttributeViewAtom(xmldoc,xmlelement,atom,&text);
+	if (error) return error;
+	*value = 0.0;
+	SIMC_XML_Internal_ParseDouble(text.data,text.data+text.length,value);
+	return SIMC_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Copy TinyXML element and everything nested in it into native nodes.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Internal_ConvertTinyXML(SIMC_XML_DOC* doc, SIMC_XML_NATIVE_ELEMENT* parent, TiXmlElement* source) {
+	const char* name = source->Value();
+	SIMC_XML_NATIVE_ELEMENT* element = SIMC_XML_Native_NewElement(doc,parent,name,strlen(name),1);
+	if (!element) return SIMC_ERROR_INTERNAL;
+
+	for (TiXmlAttribute* attribute = source->FirstAttribute(); attribute; attribute = attribute->Next()) {
+		const char* attribute_name = attribute->Name();
+		const char* attribute_value = attribute->Value();
+		if (!SIMC_XML_Native_NewAttribute(doc,element,attribute_name,strlen(attribute_name),
+										  attribute_value,strlen(attribute_value),1)) {
+			return SIMC_ERROR_INTERNAL;
+		}
+	}
+
+	const char* text = source->GetText();
+	if (text) {
+		element->text.length = strlen(text);
+		element->text.data = SIMC_XML_Native_CopyString(doc,text,element->text.length);
+		if (!element->text.data) return SIMC_ERROR_INTERNAL;
+	}
+
+	for (TiXmlElement* child = source->FirstChildElement(); child; child = child->NextSiblingElement()) {
+		int error = SIMC_XML_Internal_ConvertTinyXML(doc,element,child);
+		if (error) return error;
+	}
+	return SIMC_OK;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Make document immutable so it can be read from many threads at once.
+///
+/// A document which can still be changed may only be used by one thread at a
+/// time. A frozen document is never written to again: every getter, SIMC_XML_GetAtom(),
+/// SIMC_XML_GetChildren(), queries and SIMC_XML_Save...() may be called from any
+/// number of threads concurrently without locking. Freezing also builds an index
+/// of child elements, which lets work be split between threads by element number:
+/// ~~~{.c}
+///		SIMC_XML_Freeze(xmldoc);
+///		SIMC_XML_GetChildren(xmldoc,root,&children,&count);
+///		//Worker i processes children[i*count/workers] ... children[(i+1)*count/workers-1]
+/// ~~~
+///
+/// The document must be frozen before worker threads are started (thread start
+/// makes the index visible to them), and must not be closed while any thread is
+/// still reading it. Frozen documents are read-only: SIMC_XML_Add...() and
+/// SIMC_XML_SetText() fail.
+///
+/// Documents loaded with TinyXML (SIMC_XML_USE_TINYXML builds) are converted into
+/// the arena representation first, which invalidates all element and attribute
+/// handles obtained from such a document before this call.
+///
+/// @param[in] xmldoc Document
+///
+/// @returns Error code
+/// @retval SIMC_OK Document is frozen (also if it was frozen before)
+/// @retval SIMC_ERROR_INTERNAL Out of memory
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Freeze(SIMC_XML_DOCUMENT* xmldoc) {
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+
+	SIMC_XML_DOC* doc = (SIMC_XML_DOC*)xmldoc;
+	if (doc->backend == SIMC_XML_BACKEND_TINYXML) {
+		TiXmlDocument* tinyxml = SIMC_XML_TINYXML(xmldoc);
+
+		//Atoms interned for the TinyXML document stay valid
+		for (TiXmlElement* element = tinyxml->FirstChildElement(); element; element = element->NextSiblingElement()) {
+			int error = SIMC_XML_Internal_ConvertTinyXML(doc,&doc->root,element);
+			if (error) return error;
+		}
+		delete tinyxml;
+		doc->tinyxml = 0;
+		doc->backend = SIMC_XML_BACKEND_NATIVE;
+	}
+	return SIMC_XML_Native_Freeze(doc);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Get all child elements of an element in a frozen document.
+///
+/// Returns a pointer into the document index, so no memory is allocated and the
+/// array stays valid until the document is closed.
+///
+/// @param[in] xmldoc Frozen document
+/// @param[in] xmlelement Element (null for top-level elements of the document)
+/// @param[out] xmlchildren Array of child elements
+/// @param[out] count Number of child elements
+///
+/// @returns Error code
+/// @retval SIMC_ERROR_INTERNAL Document is not frozen
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_GetChildren(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, SIMC_XML_ELEMENT*** xmlchildren, int* count) {
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+	if (!xmlchildren) return SIMC_ERROR_INTERNAL;
+	if (!count) return SIMC_ERROR_INTERNAL;
+
+	SIMC_XML_DOC* doc = (SIMC_XML_DOC*)xmldoc;
+	if (!doc->frozen) return SIMC_ERROR_INTERNAL;
+
+	SIMC_XML_NATIVE_ELEMENT* element = xmlelement ? (SIMC_XML_NATIVE_ELEMENT*)xmlelement : &doc->root;
+	*xmlchildren = (SIMC_XML_ELEMENT**)element->children;
+	*count = (int)element->child_count;
+	return SIMC_OK;
+}
+
+
+int SIMC_XML_Create(SIMC_XML_DOCUMENT** xmldoc) {
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+
+#ifndef SIMC_XML_USE_TINYXML
+	*xmldoc = (SIMC_XML_DOCUMENT*)SIMC_XML_Native_Create();
+	if (!(*xmldoc)) return SIMC_ERROR_INTERNAL;
+#else
+	TiXmlDocument* doc = new TiXmlDocument();
+	*xmldoc = SIMC_XML_Internal_WrapTinyXML(doc);
+#endif
+	return SIMC_OK;
+}
+
+int SIMC_XML_Save(SIMC_XML_DOCUMENT* xmldoc, const char* filename) {
+	if (!filename) return SIMC_ERROR_INTERNAL;
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+
+	if (SIMC_XML_IS_NATIVE(xmldoc)) {
+		SIMC_XML_WRITER* writer;
+		int error = SIMC_XML_Writer_Create(filename,&writer);
+		if (error) return error;
+		error = SIMC_XML_Native_Write((SIMC_XML_DOC*)xmldoc,writer);
+		if (error) {
+			SIMC_XML_Writer_Close(writer,0);
+			return error;
+		}
+		return SIMC_XML_Writer_Close(writer,0);
+	}
+
+	TiXmlDocument* doc = SIMC_XML_TINYXML(xmldoc);
+	doc->SaveFile(filename);
+	return SIMC_OK;
+}
+
+int SIMC_XML_SaveString(SIMC_XML_DOCUMENT* xmldoc, char** description) {
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+	if (!description) return SIMC_ERROR_INTERNAL;
+
+	if (SIMC_XML_IS_NATIVE(xmldoc)) {
+		SIMC_XML_WRITER* writer;
+		int error = SIMC_XML_Writer_Create(0,&writer);
+		if (error) return error;
+		error = SIMC_XML_Native_Write((SIMC_XML_DOC*)xmldoc,writer);
+		if (error) {
+			SIMC_XML_Writer_Close(writer,0);
+			return error;
+		}
+		return SIMC_XML_Writer_Close(writer,description);
+	}
+
+	TiXmlDocument* doc = SIMC_XML_TINYXML(xmldoc);
+	TiXmlPrinter printer;
+	printer.SetIndent("\t");
+
+	doc->Accept(&printer);
+	const char* buffer = printer.CStr();
+	*description = (char*)SIMC_Allocate(SIMC_Userdata, sizeof(char)*(strlen(buffer)+1));
+	strcpy((char*)(*description),buffer);
+	return SIMC_OK;
+}
+
+int SIMC_XML_AddRootElement(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT** xmlelement, const char* name) {
+	if (!name) return SIMC_ERROR_INTERNAL;
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+	if (!xmlelement) return SIMC_ERROR_INTERNAL;
+
+	if (SIMC_XML_IS_NATIVE(xmldoc)) {
+		SIMC_XML_DOC* doc = (SIMC_XML_DOC*)xmldoc;
+		if (doc->frozen) return SIMC_ERROR_INTERNAL;
+		*xmlelement = (SIMC_XML_ELEMENT*)SIMC_XML_Native_NewElement(doc,&doc->root,name,strlen(name),1);
+		if (!(*xmlelement)) return SIMC_ERROR_INTERNAL;
+		return SIMC_OK;
+	}
+
+	TiXmlDocument* doc = SIMC_XML_TINYXML(xmldoc);
+	TiXmlElement* root = new TiXmlElement(name);
+	doc->LinkEndChild(root);
+
+	*xmlelement = (SIMC_XML_ELEMENT*)root;
+	return SIMC_OK;
+}
+
+int SIMC_XML_AddElement(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlrootelement, SIMC_XML_ELEMENT** xmlelement, const char* name) {
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+	if (!xmlelement) return SIMC_ERROR_INTERNAL;
+	if (!xmlrootelement) return SIMC_ERROR_INTERNAL;
+
+	if (SIMC_XML_IS_NATIVE(xmldoc)) {
+		SIMC_XML_DOC* doc = (SIMC_XML_DOC*)xmldoc;
+		if (doc->frozen) return SIMC_ERROR_INTERNAL;
+		if (!name) return SIMC_ERROR_INTERNAL;
+		*xmlelement = (SIMC_XML_ELEMENT*)SIMC_XML_Native_NewElement(doc,(SIMC_XML_NATIVE_ELEMENT*)xmlrootelement,name,strlen(name),1);
+		if (!(*xmlelement)) return SIMC_ERROR_INTERNAL;
+		return SIMC_OK;
+	}
+
+	TiXmlElement* root = ((TiXmlNode*)xmlrootelement)->ToElement();
+	if (!root) return SIMC_ERROR_INTERNAL;
+	TiXmlElement* element = new TiXmlElement(name);
+	if (!element) return SIMC_ERROR_INTERNAL;
+	root->LinkEndChild(element);
+
+	*xmlelement = (SIMC_XML_ELEMENT*)element;
+	return SIMC_OK;
+}
+
+
+int SIMC_XML_AddAttribute(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, const char* name, const char* value) {
+	if (!name) return SIMC_ERROR_INTERNAL;
+	if (!value) return SIMC_ERROR_INTERNAL;
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+	if (!xmlelement) return SIMC_ERROR_INTERNAL;
+	if (*value == 0) return SIMC_OK; //Do not create empty attributes
+
+	if (SIMC_XML_IS_NATIVE(xmldoc)) {
+		SIMC_XML_DOC* doc = (SIMC_XML_DOC*)xmldoc;
+		if (doc->frozen) return SIMC_ERROR_INTERNAL;
+		if (!SIMC_XML_Native_SetAttribute(doc,(SIMC_XML_NATIVE_ELEMENT*)xmlelement,name,value)) return SIMC_ERROR_INTERNAL;
+		return SIMC_OK;
+	}
+
+	TiXmlElement* element = ((TiXmlNode*)xmlelement)->ToElement();
+	if (!element) return SIMC_ERROR_INTERNAL;
+	
+	element->SetAttribute(name,value);
+	return SIMC_OK;
+}
+
+int SIMC_XML_AddAttributeDouble(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, const char* name, double value) {
+	if (!name) return SIMC_ERROR_INTERNAL;
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+	if (!xmlelement) return SIMC_ERROR_INTERNAL;
+	if (value == 0) return SIMC_OK; //Do not create empty attributes
+
+	if ((value < 1e-15) && (value > -1e-15)) value = 0.0;
+	
+	char buffer[64] = { 0 };
+	SIMC_XML_Internal_FormatDouble(buffer,value);
+	if (SIMC_XML_IS_NATIVE(xmldoc)) return SIMC_XML_AddAttribute(xmldoc,xmlelement,name,buffer);
+
+	TiXmlElement* element = ((TiXmlNode*)xmlelement)->ToElement();
+	if (!element) return SIMC_ERROR_INTERNAL;
+	element->SetAttribute(name,buffer);
+	//element->SetDoubleAttribute(name,value);
+	return SIMC_OK;
+}
+
+int SIMC_XML_SetText(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, const char* value) {
+	if (!value) return SIMC_ERROR_INTERNAL;
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+	if (!xmlelement) return SIMC_ERROR_INTERNAL;
+
+	if (SIMC_XML_IS_NATIVE(xmldoc)) {
+		SIMC_XML_DOC* doc = (SIMC_XML_DOC*)xmldoc;
+		if (doc->frozen) return SIMC_ERROR_INTERNAL;
+		return SIMC_XML_Native_SetText(doc,(SIMC_XML_NATIVE_ELEMENT*)xmlelement,value);
+	}
+
+	TiXmlElement* element = ((TiXmlNode*)xmlelement)->ToElement();
+	if (!element) return SIMC_ERROR_INTERNAL;
+	//element->SetValue(value);
+
+	TiXmlText* text = new TiXmlText(value);
+	element->LinkEndChild(text);
+	return SIMC_OK;
+}
@@ -0,0 +1,147 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file
+////////////////////////////////////////////////////////////////////////////////
+/// Copyright (C) 2012-2015, Black Phoenix
+///
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the GNU Lesser General Public License as published by the Free Software
+/// Foundation; either version 2 of the License, or (at your option) any later
+/// version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+/// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+/// details.
+///
+/// You should have received a copy of the GNU Lesser General Public License along with
+/// this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+/// Place - Suite 330, Boston, MA  02111-1307, USA.
+///
+/// Further information about the GNU Lesser General Public License can also be found on
+/// the world wide web at http://www.gnu.org.
+////////////////////////////////////////////////////////////////////////////////
+#include <string.h>
+#include "sim_core.h"
+#include "sim_xml.h"
+
+//Initial number of slots in the atom table (grows when half full)
+#define SIMC_XML_ATOM_MIN_CAPACITY	64
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Hash name (FNV-1a).
+////////////////////////////////////////////////////////////////////////////////
+uint32_t SIMC_XML_Atom_Hash(const char* name, size_t length) {
+	uint32_t hash = 2166136261U;
+	size_t i;
+	for (i = 0; i < length; i++) {
+		hash ^= (unsigned char)name[i];
+		hash *= 16777619U;
+	}
+	return hash;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Find slot for name (either the slot holding it or an empty one).
+////////////////////////////////////////////////////////////////////////////////
+SIMC_XML_ATOM_ENTRY* SIMC_XML_Atom_Lookup(SIMC_XML_ATOM_TABLE* table, const char* name, size_t length, uint32_t hash) {
+	size_t mask = table->capacity - 1;
+	size_t index = hash & mask;
+	while (1) {
+		SIMC_XML_ATOM_ENTRY* entry = &table->entries[index];
+		if (!entry->name) return entry;
+		if ((entry->hash == hash) && (entry->length == length) &&
+			(memcmp(entry->name,name,length) == 0)) {
+			return entry;
+		}
+		index = (index + 1) & mask;
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Resize table to a new number of slots.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Atom_Resize(SIMC_XML_ATOM_TABLE* table, size_t capacity) {
+	SIMC_XML_ATOM_ENTRY* old_entries = table->entries;
+	size_t old_capacity = table->capacity;
+	size_t i;
+
+	table->entries = (SIMC_XML_ATOM_ENTRY*)SIMC_Allocate(SIMC_Userdata,sizeof(SIMC_XML_ATOM_ENTRY)*capacity);
+	if (!table->entries) {
+		table->entries = old_entries;
+		return SIMC_ERROR_INTERNAL;
+	}
+	memset(table->entries,0,sizeof(SIMC_XML_ATOM_ENTRY)*capacity);
+	table->capacity = capacity;
+
+	for (i = 0; i < old_capacity; i++) {
+		if (old_entries[i].name) {
+			*SIMC_XML_Atom_Lookup(table,old_entries[i].name,old_entries[i].length,old_entries[i].hash) = old_entries[i];
+		}
+	}
+	if (old_entries) SIMC_Free(SIMC_Userdata,old_entries);
+	return SIMC_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Find interned name.
+///
+/// Does not modify the table, so it is safe to call from several threads at once.
+///
+/// @returns Atom or null if the name was never interned
+////////////////////////////////////////////////////////////////////////////////
+SIMC_XML_ATOM SIMC_XML_Atom_Find(SIMC_XML_ATOM_TABLE* table, const char* name, size_t length) {
+	if (!table->entries) return 0;
+	return SIMC_XML_Atom_Lookup(table,name,length,SIMC_XML_Atom_Hash(name,length))->name;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Intern name.
+///
+/// If copy is zero, name must be null-terminated and remain valid until the table
+/// is destroyed (names inside the parsed document data are used directly).
+/// Otherwise a null-terminated copy is allocated from the arena.
+///
+/// @returns Atom or null if out of memory
+////////////////////////////////////////////////////////////////////////////////
+SIMC_XML_ATOM SIMC_XML_Atom_Intern(SIMC_XML_ATOM_TABLE* table, SIMC_XML_ARENA* arena, const char* name, size_t length, int copy) {
+	SIMC_XML_ATOM_ENTRY* entry;
+	uint32_t hash = SIMC_XML_Atom_Hash(name,length);
+
+	if ((table->count+1)*2 > table->capacity) {
+		if (SIMC_XML_Atom_Resize(table,table->capacity ? table->capacity*2 : SIMC_XML_ATOM_MIN_CAPACITY) != SIMC_OK) {
+			return 0;
+		}
+	}
+
+	entry = SIMC_XML_Atom_Lookup(table,name,length,hash);
+	if (entry->name) return entry->name;
+
+	if (copy) {
+		char* name_copy = (char*)SIMC_XML_Arena_Allocate(arena,length+1);
+		if (!name_copy) return 0;
+		memcpy(name_copy,name,length);
+		name_copy[length] = 0;
+		name = name_copy;
+	}
+	entry->name = name;
+	entry->length = length;
+	entry->hash = hash;
+	table->count++;
+	return name;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Free atom table (names copied into the arena are freed with the arena).
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_XML_Atom_Destroy(SIMC_XML_ATOM_TABLE* table) {
+	if (table->entries) SIMC_Free(SIMC_Userdata,table->entries);
+	table->entries = 0;
+	table->capacity = 0;
+	table->count = 0;
+}
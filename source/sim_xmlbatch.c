@@ -0,0 +1,173 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file
+////////////////////////////////////////////////////////////////////////////////
+/// Copyright (C) 2012-2015, Black Phoenix
+///
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the GNU Lesser General Public License as published by the Free Software
+/// Foundation; either version 2 of the License, or (at your option) any later
+/// version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+/// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+/// details.
+///
+/// You should have received a copy of the GNU Lesser General Public License along with
+/// this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+/// Place - Suite 330, Boston, MA  02111-1307, USA.
+///
+/// Further information about the GNU Lesser General Public License can also be found on
+/// the world wide web at http://www.gnu.org.
+////////////////////////////////////////////////////////////////////////////////
+#include <string.h>
+#include "sim_core.h"
+#include "sim_xml.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Internal data structures
+////////////////////////////////////////////////////////////////////////////////
+#ifndef DOXYGEN_INTERNAL_STRUCTS
+typedef struct SIMC_XML_BATCH_TAG {
+	const char** filenames;
+	SIMC_XML_DOCUMENT** xmldocs;
+	int* results;
+	int count;
+	int next;								//Index of next file to load
+	SIMC_Callback_XMLSyntaxError* syntaxError;
+	void* userdata;
+#ifndef SIMC_SINGLETHREADED
+	SIMC_LOCK_ID lock;						//Protects next and serializes syntax error callbacks
+#endif
+} SIMC_XML_BATCH;
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Forward syntax error to the user callback (one at a time).
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Batch_SyntaxError(void* userdata, const char* error) {
+	SIMC_XML_BATCH* batch = (SIMC_XML_BATCH*)userdata;
+	int result = SIMC_OK;
+	if (!batch->syntaxError) return SIMC_OK;
+
+#ifndef SIMC_SINGLETHREADED
+	SIMC_Lock_Enter(batch->lock);
+#endif
+	result = batch->syntaxError(batch->userdata,error);
+#ifndef SIMC_SINGLETHREADED
+	SIMC_Lock_Leave(batch->lock);
+#endif
+	return result;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Load files from the batch until none are left.
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_XML_Batch_Worker(SIMC_XML_BATCH* batch) {
+	while (1) {
+		int index;
+#ifndef SIMC_SINGLETHREADED
+		SIMC_Lock_Enter(batch->lock);
+#endif
+		index = batch->next++;
+#ifndef SIMC_SINGLETHREADED
+		SIMC_Lock_Leave(batch->lock);
+#endif
+		if (index >= batch->count) return;
+
+		batch->results[index] = SIMC_XML_Open(batch->filenames[index],&batch->xmldocs[index],
+			SIMC_XML_Batch_SyntaxError,batch);
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Open several XML files at once.
+///
+/// Files are loaded and parsed in parallel by a pool of worker threads (one per
+/// processor, but no more than there are files). The result is the same as calling
+/// SIMC_XML_Open() for every file in turn: xmldocs[i] receives the document loaded
+/// from filenames[i] (or null if it could not be loaded) and results[i] receives
+/// the error code for that file.
+///
+/// Syntax errors are reported through syntaxError as usual. The callback is never
+/// called from two threads at once, but it may be called from a worker thread and
+/// the order of errors between different files is not defined.
+///
+/// ~~~{.c}
+///		const char* files[3] = { "vessel1.xml", "vessel2.xml", "materials.xml" };
+///		SIMC_XML_DOCUMENT* docs[3];
+///		int results[3];
+///		SIMC_XML_OpenMany(files,3,docs,results,syntax_error,0);
+/// ~~~
+///
+/// @param[in] filenames Names of files to open
+/// @param[in] count Number of files
+/// @param[out] xmldocs Array which receives document handles
+/// @param[out] results Array which receives error code for each file (may be null)
+/// @param[in] syntaxError Callback for syntax errors (may be null)
+/// @param[in] userdata Userdata passed into the syntax error callback
+///
+/// @returns Error code
+/// @retval SIMC_OK All files successfully loaded
+/// @retval SIMC_ERROR_FILE At least one file could not be opened (first failed file decides the error)
+/// @retval SIMC_ERROR_SYNTAX At least one file has a syntax error (first failed file decides the error)
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_OpenMany(const char** filenames, int count, SIMC_XML_DOCUMENT** xmldocs, int* results,
+					  SIMC_Callback_XMLSyntaxError* syntaxError, void* userdata) {
+	SIMC_XML_BATCH batch;
+	int i;
+#ifndef SIMC_SINGLETHREADED
+	SIMC_THREAD_ID* workers;
+	int num_workers;
+#endif
+	if (!filenames) return SIMC_ERROR_INTERNAL;
+	if (!xmldocs) return SIMC_ERROR_INTERNAL;
+	if (count <= 0) return SIMC_OK;
+
+	batch.filenames = filenames;
+	batch.xmldocs = xmldocs;
+	batch.results = results ? results : (int*)SIMC_Allocate(SIMC_Userdata,sizeof(int)*count);
+	batch.count = count;
+	batch.next = 0;
+	batch.syntaxError = syntaxError;
+	batch.userdata = userdata;
+	if (!batch.results) return SIMC_ERROR_INTERNAL;
+	memset(xmldocs,0,sizeof(SIMC_XML_DOCUMENT*)*count);
+
+#ifndef SIMC_SINGLETHREADED
+	batch.lock = SIMC_Lock_Create();
+
+	//Calling thread works too, so only num_workers-1 threads are started
+	num_workers = SIMC_Thread_GetNumProcessors();
+	if (num_workers > count) num_workers = count;
+	if (num_workers < 1) num_workers = 1;
+	workers = (SIMC_THREAD_ID*)SIMC_Allocate(SIMC_Userdata,sizeof(SIMC_THREAD_ID)*num_workers);
+	if (!workers) num_workers = 1;
+	for (i = 1; i < num_workers; i++) {
+		workers[i] = SIMC_Thread_CreateWithName(SIMC_XML_Batch_Worker,&batch,"SIMC_XML_OpenMany");
+	}
+	SIMC_XML_Batch_Worker(&batch);
+	for (i = 1; i < num_workers; i++) {
+		if (workers[i] != SIMC_THREAD_BAD_ID) SIMC_Thread_WaitFor(workers[i]);
+	}
+	if (workers) SIMC_Free(SIMC_Userdata,workers);
+	SIMC_Lock_Destroy(batch.lock);
+#else
+	SIMC_XML_Batch_Worker(&batch);
+#endif
+
+	//Report first error
+	for (i = 0; i < count; i++) {
+		if (batch.results[i] != SIMC_OK) {
+			int result = batch.results[i];
+			if (!results) SIMC_Free(SIMC_Userdata,batch.results);
+			return result;
+		}
+	}
+	if (!results) SIMC_Free(SIMC_Userdata,batch.results);
+	return SIMC_OK;
+}
@@ -0,0 +1,399 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file
+////////////////////////////////////////////////////////////////////////////////
+/// Copyright (C) 2012-2015, Black Phoenix
+///
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the GNU Lesser General Public License as published by the Free Software
+/// Foundation; either version 2 of the License, or (at your option) any later
+/// version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+/// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+/// details.
+///
+/// You should have received a copy of the GNU Lesser General Public License along with
+/// this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+/// Place - Suite 330, Boston, MA  02111-1307, USA.
+///
+/// Further information about the GNU Lesser General Public License can also be found on
+/// the world wide web at http://www.gnu.org.
+////////////////////////////////////////////////////////////////////////////////
+#include <stdlib.h>
+#include <string.h>
+#include "sim_core.h"
+#include "sim_xml.h"
+
+//Number of hash seeds tried for every table size
+#define SIMC_XML_BINDING_SEEDS		256
+//Largest table size (in slots per field) before giving up
+#define SIMC_XML_BINDING_MAX_LOAD	64
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Internal data structures
+////////////////////////////////////////////////////////////////////////////////
+#ifndef DOXYGEN_INTERNAL_STRUCTS
+typedef struct SIMC_XML_BINDING_ENTRY_TAG {
+	const char* name;					//Attribute name
+	size_t length;
+	int type;
+	size_t offset;
+	double default_number;				//Parsed default value of numeric field
+	const char* default_string;			//Default value of string field
+} SIMC_XML_BINDING_ENTRY;
+
+typedef struct SIMC_XML_BINDING_STATE_TAG {
+	SIMC_XML_BINDING_ENTRY* entries;
+	int count;
+	int* slots;							//Perfect hash table (index of entry or -1)
+	uint32_t mask;						//Number of slots minus one
+	uint32_t seed;						//Seed for which no two names collide
+	char* strings;						//Storage for all names and default values
+} SIMC_XML_BINDING_STATE;
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Seeded FNV-1a hash of a name.
+////////////////////////////////////////////////////////////////////////////////
+uint32_t SIMC_XML_Binding_Hash(uint32_t seed, const char* name, size_t length) {
+	uint32_t hash = 2166136261U ^ (seed * 0x9E3779B9U);
+	size_t i;
+	for (i = 0; i < length; i++) {
+		hash = (hash ^ (unsigned char)name[i]) * 16777619U;
+	}
+	return hash ^ (hash >> 15);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Find seed and table size for which all names hash to distinct slots.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Binding_BuildHash(SIMC_XML_BINDING_STATE* binding) {
+	uint32_t size = 8;
+	int i;
+	while (size < (uint32_t)binding->count*2) size *= 2;
+
+	for (; size <= (uint32_t)(binding->count+1)*SIMC_XML_BINDING_MAX_LOAD; size *= 2) {
+		uint32_t seed;
+		if (binding->slots) SIMC_Free(SIMC_Userdata,binding->slots);
+		binding->slots = (int*)SIMC_Allocate(SIMC_Userdata,sizeof(int)*size);
+		if (!binding->slots) return SIMC_ERROR_INTERNAL;
+		binding->mask = size-1;
+
+		for (seed = 0; seed < SIMC_XML_BINDING_SEEDS; seed++) {
+			for (i = 0; i < (int)size; i++) binding->slots[i] = -1;
+			for (i = 0; i < binding->count; i++) {
+				SIMC_XML_BINDING_ENTRY* entry = &binding->entries[i];
+				uint32_t slot = SIMC_XML_Binding_Hash(seed,entry->name,entry->length) & binding->mask;
+				if (binding->slots[slot] >= 0) break;
+				binding->slots[slot] = i;
+			}
+			if (i == binding->count) {
+				binding->seed = seed;
+				return SIMC_OK;
+			}
+		}
+	}
+	return SIMC_ERROR_INTERNAL;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Compile binding table which fills a structure from element attributes.
+///
+/// Every field names an attribute, the type and offset of the structure member it
+/// is written into, and a default value (as text) used when the attribute is
+/// missing. Attribute names are compiled into a perfect hash, so SIMC_XML_Bind()
+/// makes a single pass over the attributes of an element and finds the field for
+/// each one with one hash and one string comparison:
+/// ~~~{.c}
+///		typedef struct ENGINE_TAG {
+///			const char* name;
+///			double thrust;
+///			double isp;
+///			int stages;
+///		} ENGINE;
+///
+///		static const SIMC_XML_BINDING_FIELD engine_fields[] = {
+///			{ "name",   SIMC_XML_BIND_STRING, offsetof(ENGINE,name),   0 },
+///			{ "thrust", SIMC_XML_BIND_DOUBLE, offsetof(ENGINE,thrust), "0" },
+///			{ "isp",    SIMC_XML_BIND_DOUBLE, offsetof(ENGINE,isp),    "300" },
+///			{ "stages", SIMC_XML_BIND_INT,    offsetof(ENGINE,stages), "1" },
+///			{ 0 }
+///		};
+///
+///		SIMC_XML_BINDING* binding;
+///		ENGINE engine;
+///		SIMC_XML_Binding_Compile(engine_fields,&binding);
+///		SIMC_XML_Bind(xmldoc,element,binding,&engine);
+///		SIMC_XML_Binding_Destroy(binding);
+/// ~~~
+///
+/// The field table is copied, so it does not have to outlive the compiled binding.
+/// A compiled binding is never modified and can be used from several threads.
+///
+/// @param[in] fields Table of fields (terminated by an entry with null name)
+/// @param[out] xmlbinding Compiled binding (can be reused with any number of documents)
+///
+/// @returns Error code
+/// @retval SIMC_OK Binding compiled
+/// @retval SIMC_ERROR_SYNTAX Field has unknown type, or two fields have the same name
+/// @retval SIMC_ERROR_INTERNAL Out of memory
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Binding_Compile(const SIMC_XML_BINDING_FIELD* fields, SIMC_XML_BINDING** xmlbinding) {
+	SIMC_XML_BINDING_STATE* binding;
+	size_t strings_size = 0;
+	char* strings;
+	int i, j, count = 0;
+	if (!fields) return SIMC_ERROR_INTERNAL;
+	if (!xmlbinding) return SIMC_ERROR_INTERNAL;
+	*xmlbinding = 0;
+
+	//Validate fields and find storage size
+	for (count = 0; fields[count].name; count++) {
+		if ((fields[count].type < SIMC_XML_BIND_DOUBLE) || (fields[count].type > SIMC_XML_BIND_STRING)) return SIMC_ERROR_SYNTAX;
+		for (j = 0; j < count; j++) {
+			if (strcmp(fields[j].name,fields[count].name) == 0) return SIMC_ERROR_SYNTAX;
+		}
+		strings_size += strlen(fields[count].name)+1;
+		if (fields[count].default_value) strings_size += strlen(fields[count].default_value)+1;
+	}
+
+	binding = (SIMC_XML_BINDING_STATE*)SIMC_Allocate(SIMC_Userdata,sizeof(SIMC_XML_BINDING_STATE));
+	if (!binding) return SIMC_ERROR_INTERNAL;
+	memset(binding,0,sizeof(SIMC_XML_BINDING_STATE));
+	binding->count = count;
+	binding->entries = (SIMC_XML_BINDING_ENTRY*)SIMC_Allocate(SIMC_Userdata,sizeof(SIMC_XML_BINDING_ENTRY)*(count+1));
+	binding->strings = (char*)SIMC_Allocate(SIMC_Userdata,strings_size+1);
+	if ((!binding->entries) || (!binding->strings)) {
+		SIMC_XML_Binding_Destroy((SIMC_XML_BINDING*)binding);
+		return SIMC_ERROR_INTERNAL;
+	}
+
+	//Copy fields and parse default values
+	strings = binding->strings;
+	for (i = 0; i < count; i++) {
+		SIMC_XML_BINDING_ENTRY* entry = &binding->entries[i];
+		entry->length = strlen(fields[i].name);
+		entry->name = strings;
+		memcpy(strings,fields[i].name,entry->length+1);
+		strings += entry->length+1;
+
+		entry->type = fields[i].type;
+		entry->offset = fields[i].offset;
+		entry->default_number = 0.0;
+		entry->default_string = "";
+		if (fields[i].default_value) {
+			size_t length = strlen(fields[i].default_value);
+			entry->default_string = strings;
+			memcpy(strings,fields[i].default_value,length+1);
+			strings += length+1;
+
+			if (entry->type == SIMC_XML_BIND_INT) {
+				int value = 0;
+				SIMC_XML_Internal_ParseInt(entry->default_string,entry->default_string+length,&value);
+				entry->default_number = value;
+			} else if (entry->type != SIMC_XML_BIND_STRING) {
+				SIMC_XML_Internal_ParseDouble(entry->default_string,entry->default_string+length,&entry->default_number);
+			}
+		}
+	}
+
+	if (SIMC_XML_Binding_BuildHash(binding) != SIMC_OK) {
+		SIMC_XML_Binding_Destroy((SIMC_XML_BINDING*)binding);
+		return SIMC_ERROR_INTERNAL;
+	}
+	*xmlbinding = (SIMC_XML_BINDING*)binding;
+	return SIMC_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Free compiled binding.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Binding_Destroy(SIMC_XML_BINDING* xmlbinding) {
+	SIMC_XML_BINDING_STATE* binding = (SIMC_XML_BINDING_STATE*)xmlbinding;
+	if (!binding) return SIMC_ERROR_INTERNAL;
+	if (binding->entries) SIMC_Free(SIMC_Userdata,binding->entries);
+	if (binding->slots) SIMC_Free(SIMC_Userdata,binding->slots);
+	if (binding->strings) SIMC_Free(SIMC_Userdata,binding->strings);
+	SIMC_Free(SIMC_Userdata,binding);
+	return SIMC_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Find field which is bound to an attribute name.
+////////////////////////////////////////////////////////////////////////////////
+SIMC_XML_BINDING_ENTRY* SIMC_XML_Binding_Find(SIMC_XML_BINDING_STATE* binding, const char* name, size_t length) {
+	int index = binding->slots[SIMC_XML_Binding_Hash(binding->seed,name,length) & binding->mask];
+	SIMC_XML_BINDING_ENTRY* entry;
+	if (index < 0) return 0;
+
+	entry = &binding->entries[index];
+	if ((entry->length != length) || (memcmp(entry->name,name,length) != 0)) return 0;
+	return entry;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Write value into structure field.
+///
+/// If number_valid is set, number is the already converted value of the text
+/// (used for floating point fields only).
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_XML_Binding_Store(SIMC_XML_BINDING_ENTRY* entry, char* object, const char* text, size_t length,
+							double number, int number_valid) {
+	switch (entry->type) {
+		case SIMC_XML_BIND_DOUBLE:
+			if (!number_valid) SIMC_XML_Internal_ParseDouble(text,text+length,&number);
+			*((double*)(object + entry->offset)) = number;
+			break;
+		case SIMC_XML_BIND_FLOAT:
+			if (!number_valid) SIMC_XML_Internal_ParseDouble(text,text+length,&number);
+			*((float*)(object + entry->offset)) = (float)number;
+			break;
+		case SIMC_XML_BIND_INT: {
+			//Always parsed from text, so that "1.5" or "1e3" bind the same as in uncached documents
+			int value = 0;
+			SIMC_XML_Internal_ParseInt(text,text+length,&value);
+			*((int*)(object + entry->offset)) = value;
+		} break;
+		case SIMC_XML_BIND_STRING:
+			*((const char**)(object + entry->offset)) = text;
+			break;
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Fill structure from element attributes using a compiled binding.
+///
+/// All fields are first set to their default values, then every attribute of the
+/// element which has a field is converted and stored. Attributes without a field
+/// are ignored. Numbers which cannot be parsed are stored as zero, the same as
+/// SIMC_XML_GetAttributeDouble() and SIMC_XML_GetAttributeInt() return them.
+///
+/// String fields point into document memory and remain valid until the document
+/// is closed or modified.
+///
+/// @param[in] xmldoc Document
+/// @param[in] xmlelement Element
+/// @param[in] xmlbinding Compiled binding
+/// @param[out] object Structure to fill
+///
+/// @returns Error code
+/// @retval SIMC_OK Structure filled
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Bind(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, SIMC_XML_BINDING* xmlbinding, void* object) {
+	SIMC_XML_BINDING_STATE* binding = (SIMC_XML_BINDING_STATE*)xmlbinding;
+	SIMC_XML_ATTRIBUTE* xmlattribute;
+	int i;
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+	if (!xmlelement) return SIMC_ERROR_INTERNAL;
+	if (!binding) return SIMC_ERROR_INTERNAL;
+	if (!object) return SIMC_ERROR_INTERNAL;
+
+	//Default values
+	for (i = 0; i < binding->count; i++) {
+		SIMC_XML_BINDING_ENTRY* entry = &binding->entries[i];
+		SIMC_XML_Binding_Store(entry,(char*)object,entry->default_string,0,entry->default_number,1);
+	}
+
+	//Natively parsed documents (attribute values may be pre-parsed numbers)
+	if (((SIMC_XML_DOC*)xmldoc)->backend == SIMC_XML_BACKEND_NATIVE) {
+		SIMC_XML_NATIVE_ATTRIBUTE* attribute;
+		for (attribute = ((SIMC_XML_NATIVE_ELEMENT*)xmlelement)->first_attribute; attribute; attribute = attribute->next) {
+			SIMC_XML_BINDING_ENTRY* entry = SIMC_XML_Binding_Find(binding,attribute->name.data,attribute->name.length);
+			if (entry) {
+				SIMC_XML_Binding_Store(entry,(char*)object,attribute->value.data,attribute->value.length,
+					attribute->number,attribute->number_state == SIMC_XML_NUMBER_VALID);
+			}
+		}
+		return SIMC_OK;
+	}
+
+	//Any other document
+	if (SIMC_XML_GetFirstAttribute(xmldoc,xmlelement,&xmlattribute) != SIMC_OK) return SIMC_ERROR_INTERNAL;
+	while (xmlattribute) {
+		SIMC_XML_BINDING_ENTRY* entry;
+		char* name;
+		char* value;
+		SIMC_XML_GetAttributeName(xmldoc,xmlattribute,&name);
+		entry = SIMC_XML_Binding_Find(binding,name,strlen(name));
+		if (entry) {
+			SIMC_XML_GetAttributeText(xmldoc,xmlattribute,&value);
+			SIMC_XML_Binding_Store(entry,(char*)object,value,strlen(value),0.0,0);
+		}
+		if (SIMC_XML_IterateAttributes(xmldoc,xmlattribute,&xmlattribute) != SIMC_OK) break;
+	}
+	return SIMC_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Fill an array of structures from nested elements.
+///
+/// Every nested element with the given name (or every nested element if name is
+/// null) fills the next structure in the array, up to max_count structures which
+/// are stride bytes apart. The total number of matching elements is returned in
+/// count, so the required array size can be found by calling this function with
+/// max_count set to zero:
+/// ~~~{.c}
+///		int count;
+///		SIMC_XML_BindArray(xmldoc,vessel,"engine",binding,0,sizeof(ENGINE),0,&count);
+///		engines = (ENGINE*)malloc(sizeof(ENGINE)*count);
+///		SIMC_XML_BindArray(xmldoc,vessel,"engine",binding,engines,sizeof(ENGINE),count,&count);
+/// ~~~
+///
+/// @param[in] xmldoc Document
+/// @param[in] xmlelement Parent element
+/// @param[in] name Name of nested elements (may be null)
+/// @param[in] xmlbinding Compiled binding
+/// @param[out] objects Array of structures (may be null if max_count is zero)
+/// @param[in] stride Distance between structures in bytes
+/// @param[in] max_count Number of structures in the array
+/// @param[out] count Number of matching nested elements
+///
+/// @returns Error code
+/// @retval SIMC_OK Structures filled
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_BindArray(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, const char* name, SIMC_XML_BINDING* xmlbinding,
+					   void* objects, size_t stride, int max_count, int* count) {
+	SIMC_XML_ELEMENT* xmlnested_element = 0;
+	int n = 0;
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+	if (!xmlelement) return SIMC_ERROR_INTERNAL;
+	if (!xmlbinding) return SIMC_ERROR_INTERNAL;
+	if (!count) return SIMC_ERROR_INTERNAL;
+	if ((!objects) && (max_count > 0)) return SIMC_ERROR_INTERNAL;
+
+	//Natively parsed documents (names compared by atom)
+	if (((SIMC_XML_DOC*)xmldoc)->backend == SIMC_XML_BACKEND_NATIVE) {
+		SIMC_XML_DOC* doc = (SIMC_XML_DOC*)xmldoc;
+		SIMC_XML_NATIVE_ELEMENT* element = ((SIMC_XML_NATIVE_ELEMENT*)xmlelement)->first_child;
+		SIMC_XML_ATOM atom = 0;
+		if (name) {
+			atom = SIMC_XML_Atom_Find(&doc->atoms,name,strlen(name));
+			if (!atom) element = 0;
+		}
+		for (; element; element = element->next) {
+			if (atom && (element->name.data != atom)) continue;
+			if (n < max_count) SIMC_XML_Bind(xmldoc,(SIMC_XML_ELEMENT*)element,xmlbinding,(char*)objects + n*stride);
+			n++;
+		}
+		*count = n;
+		return SIMC_OK;
+	}
+
+	//Any other document
+	while ((SIMC_XML_Iterate(xmldoc,xmlelement,&xmlnested_element,name) == SIMC_OK) && xmlnested_element) {
+		if (n < max_count) SIMC_XML_Bind(xmldoc,xmlnested_element,xmlbinding,(char*)objects + n*stride);
+		n++;
+	}
+	*count = n;
+	return SIMC_OK;
+}
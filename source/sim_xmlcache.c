@@ -0,0 +1,651 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file
+////////////////////////////////////////////////////////////////////////////////
+/// Copyright (C) 2012-2015, Black Phoenix
+///
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the GNU Lesser General Public License as published by the Free Software
+/// Foundation; either version 2 of the License, or (at your option) any later
+/// version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+/// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+/// details.
+///
+/// You should have received a copy of the GNU Lesser General Public License along with
+/// this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+/// Place - Suite 330, Boston, MA  02111-1307, USA.
+///
+/// Further information about the GNU Lesser General Public License can also be found on
+/// the world wide web at http://www.gnu.org.
+////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "sim_core.h"
+#include "sim_xml.h"
+
+//Cache file signature and format version
+#define SIMC_XML_CACHE_MAGIC		"SIMCXMLC"
+#define SIMC_XML_CACHE_VERSION		1
+//Written into cache to reject files created on a machine with different byte order
+#define SIMC_XML_CACHE_BYTE_ORDER	0x01020304
+//Cache file name suffix (cache is written next to the source file)
+#define SIMC_XML_CACHE_SUFFIX		".cache"
+//Alignment of tables in the cache file (every record contains pointers)
+#define SIMC_XML_CACHE_ALIGNMENT	sizeof(void*)
+
+//Encode/decode pointers as offsets from the start of the cache file (0 is null)
+#define SIMC_XML_CACHE_OFFSET(offset)				((void*)(uintptr_t)(offset))
+#define SIMC_XML_CACHE_POINTER(base,pointer)		((pointer) ? (void*)((base) + (uintptr_t)(pointer)) : 0)
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Internal data structures
+////////////////////////////////////////////////////////////////////////////////
+#ifndef DOXYGEN_INTERNAL_STRUCTS
+typedef struct SIMC_XML_CACHE_HEADER_TAG {
+	char magic[8];
+	uint32_t version;
+	uint32_t byte_order;
+	uint32_t element_size;					//sizeof(SIMC_XML_NATIVE_ELEMENT) when cache was written
+	uint32_t attribute_size;				//sizeof(SIMC_XML_NATIVE_ATTRIBUTE) when cache was written
+
+	uint64_t source_size;					//Source file size
+	int64_t source_mtime;					//Source file modification time
+	uint64_t source_hash;					//Hash of source file contents
+
+	uint64_t file_size;						//Total size of cache file
+	uint64_t element_offset;				//Element table (element 0 is the document node)
+	uint64_t element_count;
+	uint64_t attribute_offset;				//Attribute table
+	uint64_t attribute_count;
+	uint64_t string_offset;					//String pool (all strings null-terminated)
+	uint64_t string_size;
+	uint64_t atom_offset;					//Offsets of interned names in the string pool
+	uint64_t atom_count;
+} SIMC_XML_CACHE_HEADER;
+
+typedef struct SIMC_XML_CACHE_ATOM_TAG {
+	SIMC_XML_ATOM atom;
+	uint64_t offset;
+} SIMC_XML_CACHE_ATOM;
+
+typedef struct SIMC_XML_CACHE_WRITER_TAG {
+	SIMC_XML_NATIVE_ELEMENT* elements;
+	SIMC_XML_NATIVE_ATTRIBUTE* attributes;
+	char* strings;
+	uint64_t* atom_offsets;
+	SIMC_XML_CACHE_ATOM* atoms;				//Atom pointer to string pool offset (hashed by pointer)
+	size_t atoms_mask;
+	size_t element_count;
+	size_t attribute_count;
+	size_t string_size;
+	size_t string_pos;
+	SIMC_XML_CACHE_HEADER header;
+} SIMC_XML_CACHE_WRITER;
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Get size and modification time of the source file.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Cache_StatSource(const char* filename, uint64_t* size, int64_t* mtime) {
+	struct stat info;
+	if (stat(filename,&info) != 0) return SIMC_ERROR_FILE;
+	*size = (uint64_t)info.st_size;
+	*mtime = (int64_t)info.st_mtime;
+	return SIMC_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Hash contents of the source file.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Cache_HashSource(const char* filename, uint64_t* hash) {
+	char buffer[65536];
+	uint64_t h = 14695981039346656037ULL;
+	size_t count;
+	FILE* file;
+
+	file = fopen(filename,"rb");
+	if (!file) return SIMC_ERROR_FILE;
+	while ((count = fread(buffer,1,sizeof(buffer),file)) > 0) {
+		size_t i = 0;
+		//Eight bytes per step, tail byte by byte
+		for (; i + 8 <= count; i += 8) {
+			uint64_t word;
+			memcpy(&word,buffer+i,8);
+			h = (h ^ word) * 1099511628211ULL;
+			h ^= h >> 29;
+		}
+		for (; i < count; i++) {
+			h = (h ^ (unsigned char)buffer[i]) * 1099511628211ULL;
+		}
+	}
+	fclose(file);
+
+	*hash = h;
+	return SIMC_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Find string pool offset of an atom.
+////////////////////////////////////////////////////////////////////////////////
+uint64_t SIMC_XML_Cache_AtomOffset(SIMC_XML_CACHE_WRITER* writer, SIMC_XML_ATOM atom) {
+	size_t index = (size_t)(((uintptr_t)atom >> 3) * 2654435761U) & writer->atoms_mask;
+	while (writer->atoms[index].atom) {
+		if (writer->atoms[index].atom == atom) return writer->atoms[index].offset;
+		index = (index + 1) & writer->atoms_mask;
+	}
+	return 0;
+}
+
+void SIMC_XML_Cache_AddAtom(SIMC_XML_CACHE_WRITER* writer, SIMC_XML_ATOM atom, uint64_t offset) {
+	size_t index = (size_t)(((uintptr_t)atom >> 3) * 2654435761U) & writer->atoms_mask;
+	while (writer->atoms[index].atom) index = (index + 1) & writer->atoms_mask;
+	writer->atoms[index].atom = atom;
+	writer->atoms[index].offset = offset;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Copy string into the string pool and return its file offset.
+////////////////////////////////////////////////////////////////////////////////
+void* SIMC_XML_Cache_AddString(SIMC_XML_CACHE_WRITER* writer, SIMC_XML_STRING* string) {
+	uint64_t offset;
+	if (!string->data) return 0;
+
+	offset = writer->header.string_offset + writer->string_pos;
+	memcpy(writer->strings + writer->string_pos,string->data,string->length);
+	writer->strings[writer->string_pos + string->length] = 0;
+	writer->string_pos += string->length+1;
+	return SIMC_XML_CACHE_OFFSET(offset);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Convert element (and its attributes) into cache records.
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_XML_Cache_AddElement(SIMC_XML_CACHE_WRITER* writer, SIMC_XML_NATIVE_ELEMENT* element, size_t index, size_t parent) {
+	SIMC_XML_NATIVE_ELEMENT* record = &writer->elements[index];
+	SIMC_XML_NATIVE_ATTRIBUTE* attribute;
+
+	memset(record,0,sizeof(SIMC_XML_NATIVE_ELEMENT));
+	record->name.data = element->name.data ? (const char*)SIMC_XML_CACHE_OFFSET(SIMC_XML_Cache_AtomOffset(writer,element->name.data)) : 0;
+	record->name.length = element->name.length;
+	record->text.data = (const char*)SIMC_XML_Cache_AddString(writer,&element->text);
+	record->text.length = element->text.length;
+	record->attribute_count = element->attribute_count;
+	if (index > 0) {
+		record->parent = (SIMC_XML_NATIVE_ELEMENT*)SIMC_XML_CACHE_OFFSET(
+			writer->header.element_offset + parent*sizeof(SIMC_XML_NATIVE_ELEMENT));
+	}
+
+	for (attribute = element->first_attribute; attribute; attribute = attribute->next) {
+		SIMC_XML_NATIVE_ATTRIBUTE* attribute_record = &writer->attributes[writer->attribute_count];
+		uint64_t offset = writer->header.attribute_offset + writer->attribute_count*sizeof(SIMC_XML_NATIVE_ATTRIBUTE);
+		const char* number_end;
+
+		attribute_record->name.data = (const char*)SIMC_XML_CACHE_OFFSET(SIMC_XML_Cache_AtomOffset(writer,attribute->name.data));
+		attribute_record->name.length = attribute->name.length;
+		attribute_record->value.data = (const char*)SIMC_XML_Cache_AddString(writer,&attribute->value);
+		attribute_record->value.length = attribute->value.length;
+		attribute_record->next = 0;
+
+		//Pre-parse values which are a single number
+		number_end = SIMC_XML_Internal_ParseDouble(attribute->value.data,attribute->value.data+attribute->value.length,&attribute_record->number);
+		while ((number_end < attribute->value.data+attribute->value.length) &&
+			   ((*number_end == ' ') || (*number_end == '\t') || (*number_end == '\n') || (*number_end == '\r'))) {
+			number_end++;
+		}
+		if ((number_end != attribute->value.data) && (number_end == attribute->value.data+attribute->value.length)) {
+			attribute_record->number_state = SIMC_XML_NUMBER_VALID;
+		} else {
+			attribute_record->number = 0.0;
+			attribute_record->number_state = SIMC_XML_NUMBER_INVALID;
+		}
+
+		if (record->last_attribute) {
+			writer->attributes[writer->attribute_count-1].next = (SIMC_XML_NATIVE_ATTRIBUTE*)SIMC_XML_CACHE_OFFSET(offset);
+		} else {
+			record->first_attribute = (SIMC_XML_NATIVE_ATTRIBUTE*)SIMC_XML_CACHE_OFFSET(offset);
+		}
+		record->last_attribute = (SIMC_XML_NATIVE_ATTRIBUTE*)SIMC_XML_CACHE_OFFSET(offset);
+		writer->attribute_count++;
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Write binary cache of a natively parsed document.
+///
+/// The cache contains the element and attribute tables in the same layout as the
+/// in-memory document (with pointers replaced by file offsets), a string pool and
+/// a list of interned names. Attribute values which are numbers are stored already
+/// converted.
+///
+/// The cache is written into a temporary file which is then renamed over the old
+/// cache, so documents which were loaded from the old cache remain valid.
+///
+/// @param[in] xmldoc Document (must be opened with SIMC_XML_OpenMapped() or SIMC_XML_OpenCached())
+/// @param[in] source_filename File the document was loaded from
+/// @param[in] cache_filename Name of the cache file (null for source_filename with ".cache" appended)
+///
+/// @returns Error code
+/// @retval SIMC_OK Cache written
+/// @retval SIMC_ERROR_FILE Source file could not be read or cache file could not be written
+/// @retval SIMC_ERROR_INTERNAL Document cannot be cached
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_SaveCache(SIMC_XML_DOCUMENT* xmldoc, const char* source_filename, const char* cache_filename) {
+	SIMC_XML_DOC* doc = (SIMC_XML_DOC*)xmldoc;
+	SIMC_XML_CACHE_WRITER writer;
+	SIMC_XML_NATIVE_ELEMENT* element;
+	char default_filename[4096];
+	char temporary_filename[4096];
+	size_t* stack = 0;
+	size_t stack_size = 64;
+	size_t depth;
+	size_t atom_index;
+	size_t i;
+	int result = SIMC_OK;
+	FILE* file;
+
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+	if (!source_filename) return SIMC_ERROR_INTERNAL;
+	if (doc->backend != SIMC_XML_BACKEND_NATIVE) return SIMC_ERROR_INTERNAL;
+	if (!cache_filename) {
+		snprintf(default_filename,4095,"%s%s",source_filename,SIMC_XML_CACHE_SUFFIX);
+		default_filename[4095] = 0;
+		cache_filename = default_filename;
+	}
+
+	memset(&writer,0,sizeof(writer));
+	memcpy(writer.header.magic,SIMC_XML_CACHE_MAGIC,8);
+	writer.header.version = SIMC_XML_CACHE_VERSION;
+	writer.header.byte_order = SIMC_XML_CACHE_BYTE_ORDER;
+	writer.header.element_size = sizeof(SIMC_XML_NATIVE_ELEMENT);
+	writer.header.attribute_size = sizeof(SIMC_XML_NATIVE_ATTRIBUTE);
+	result = SIMC_XML_Cache_StatSource(source_filename,&writer.header.source_size,&writer.header.source_mtime);
+	if (result == SIMC_OK) result = SIMC_XML_Cache_HashSource(source_filename,&writer.header.source_hash);
+	if (result != SIMC_OK) return result;
+
+	//Count nodes and strings
+	writer.element_count = 1;
+	for (i = 0; i < doc->atoms.capacity; i++) {
+		if (doc->atoms.entries[i].name) writer.string_size += doc->atoms.entries[i].length+1;
+	}
+	element = &doc->root;
+	while (element) {
+		SIMC_XML_NATIVE_ATTRIBUTE* native_attribute;
+		for (native_attribute = element->first_attribute; native_attribute; native_attribute = native_attribute->next) {
+			writer.attribute_count++;
+			writer.string_size += native_attribute->value.length+1;
+		}
+		if (element->text.data) writer.string_size += element->text.length+1;
+
+		if (element->first_child) {
+			element = element->first_child;
+		} else {
+			while (element && (!element->next)) element = element->parent;
+			if (element) element = element->next;
+		}
+		if (element) writer.element_count++;
+	}
+
+	//Lay out file
+	writer.header.element_offset = sizeof(SIMC_XML_CACHE_HEADER);
+	writer.header.element_count = writer.element_count;
+	writer.header.attribute_offset = writer.header.element_offset + writer.element_count*sizeof(SIMC_XML_NATIVE_ELEMENT);
+	writer.header.attribute_count = writer.attribute_count;
+	writer.header.atom_offset = writer.header.attribute_offset + writer.attribute_count*sizeof(SIMC_XML_NATIVE_ATTRIBUTE);
+	writer.header.atom_count = doc->atoms.count;
+	writer.header.string_offset = writer.header.atom_offset + doc->atoms.count*sizeof(uint64_t);
+	writer.header.string_size = writer.string_size;
+	writer.header.file_size = writer.header.string_offset + writer.string_size;
+
+	writer.elements = (SIMC_XML_NATIVE_ELEMENT*)SIMC_Allocate(SIMC_Userdata,sizeof(SIMC_XML_NATIVE_ELEMENT)*writer.element_count);
+	writer.attributes = (SIMC_XML_NATIVE_ATTRIBUTE*)SIMC_Allocate(SIMC_Userdata,sizeof(SIMC_XML_NATIVE_ATTRIBUTE)*(writer.attribute_count+1));
+	writer.strings = (char*)SIMC_Allocate(SIMC_Userdata,writer.string_size+1);
+	writer.atom_offsets = (uint64_t*)SIMC_Allocate(SIMC_Userdata,sizeof(uint64_t)*(doc->atoms.count+1));
+	writer.atoms_mask = doc->atoms.capacity ? doc->atoms.capacity-1 : 0;
+	writer.atoms = (SIMC_XML_CACHE_ATOM*)SIMC_Allocate(SIMC_Userdata,sizeof(SIMC_XML_CACHE_ATOM)*(writer.atoms_mask+1));
+	stack = (size_t*)SIMC_Allocate(SIMC_Userdata,sizeof(size_t)*stack_size);
+	if ((!writer.elements) || (!writer.attributes) || (!writer.strings) ||
+		(!writer.atom_offsets) || (!writer.atoms) || (!stack)) {
+		result = SIMC_ERROR_INTERNAL;
+		goto cleanup;
+	}
+	memset(writer.atoms,0,sizeof(SIMC_XML_CACHE_ATOM)*(writer.atoms_mask+1));
+
+	//Interned names go first into the string pool
+	atom_index = 0;
+	for (i = 0; i < doc->atoms.capacity; i++) {
+		SIMC_XML_ATOM_ENTRY* entry = &doc->atoms.entries[i];
+		if (entry->name) {
+			SIMC_XML_STRING name;
+			name.data = entry->name;
+			name.length = entry->length;
+			writer.atom_offsets[atom_index] = (uint64_t)(uintptr_t)SIMC_XML_Cache_AddString(&writer,&name);
+			SIMC_XML_Cache_AddAtom(&writer,entry->name,writer.atom_offsets[atom_index]);
+			atom_index++;
+		}
+	}
+	writer.attribute_count = 0;
+
+	//Convert elements in document order, stack holds indexes of open elements
+	SIMC_XML_Cache_AddElement(&writer,&doc->root,0,0);
+	writer.element_count = 1;
+	stack[0] = 0;
+	depth = 0;
+	element = &doc->root;
+	while (1) {
+		size_t index = writer.element_count++;
+		size_t parent;
+		if (element->first_child) {
+			parent = stack[depth];
+			element = element->first_child;
+			writer.elements[parent].first_child = (SIMC_XML_NATIVE_ELEMENT*)SIMC_XML_CACHE_OFFSET(
+				writer.header.element_offset + index*sizeof(SIMC_XML_NATIVE_ELEMENT));
+			depth++;
+			if (depth >= stack_size) {
+				size_t* new_stack = (size_t*)SIMC_Allocate(SIMC_Userdata,sizeof(size_t)*stack_size*2);
+				if (!new_stack) {
+					result = SIMC_ERROR_INTERNAL;
+					goto cleanup;
+				}
+				memcpy(new_stack,stack,sizeof(size_t)*stack_size);
+				SIMC_Free(SIMC_Userdata,stack);
+				stack = new_stack;
+				stack_size *= 2;
+			}
+		} else {
+			while ((depth > 0) && (!element->next)) {
+				element = element->parent;
+				depth--;
+			}
+			if (depth == 0) break;
+			element = element->next;
+			parent = stack[depth-1];
+			writer.elements[stack[depth]].next = (SIMC_XML_NATIVE_ELEMENT*)SIMC_XML_CACHE_OFFSET(
+				writer.header.element_offset + index*sizeof(SIMC_XML_NATIVE_ELEMENT));
+		}
+
+		SIMC_XML_Cache_AddElement(&writer,element,index,parent);
+		writer.elements[parent].last_child = (SIMC_XML_NATIVE_ELEMENT*)SIMC_XML_CACHE_OFFSET(
+			writer.header.element_offset + index*sizeof(SIMC_XML_NATIVE_ELEMENT));
+		stack[depth] = index;
+	}
+	writer.element_count--;
+
+	//Write cache file (into a temporary file first, documents loaded from the old cache map it)
+	SIMC_XML_Internal_TemporaryName(cache_filename,temporary_filename,sizeof(temporary_filename));
+	file = fopen(temporary_filename,"wb");
+	if (!file) {
+		result = SIMC_ERROR_FILE;
+		goto cleanup;
+	}
+	if ((fwrite(&writer.header,sizeof(SIMC_XML_CACHE_HEADER),1,file) != 1) ||
+		(fwrite(writer.elements,sizeof(SIMC_XML_NATIVE_ELEMENT),writer.element_count,file) != writer.element_count) ||
+		(fwrite(writer.attributes,sizeof(SIMC_XML_NATIVE_ATTRIBUTE),writer.attribute_count,file) != writer.attribute_count) ||
+		(fwrite(writer.atom_offsets,sizeof(uint64_t),doc->atoms.count,file) != doc->atoms.count) ||
+		(fwrite(writer.strings,1,writer.string_size,file) != writer.string_size)) {
+		result = SIMC_ERROR_FILE;
+	}
+	if (fclose(file) != 0) result = SIMC_ERROR_FILE;
+	if (result == SIMC_OK) {
+		result = SIMC_XML_Internal_ReplaceFile(temporary_filename,cache_filename);
+	} else {
+		remove(temporary_filename);
+	}
+
+cleanup:
+	if (writer.elements) SIMC_Free(SIMC_Userdata,writer.elements);
+	if (writer.attributes) SIMC_Free(SIMC_Userdata,writer.attributes);
+	if (writer.strings) SIMC_Free(SIMC_Userdata,writer.strings);
+	if (writer.atom_offsets) SIMC_Free(SIMC_Userdata,writer.atom_offsets);
+	if (writer.atoms) SIMC_Free(SIMC_Userdata,writer.atoms);
+	if (stack) SIMC_Free(SIMC_Userdata,stack);
+	return result;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Check that a cache record pointer is null or points to a table record.
+///
+/// Only records with index in range [first, count) are accepted. Links point
+/// forward in document order in caches written by SIMC_XML_SaveCache(), which
+/// rules out loops in corrupted files.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Cache_CheckPointer(const void* pointer, uint64_t table_offset, uint64_t record_size,
+								uint64_t first, uint64_t count) {
+	uint64_t offset = (uint64_t)(uintptr_t)pointer;
+	uint64_t index;
+	if (offset == 0) return 1;
+	if (offset < table_offset) return 0;
+	if ((offset - table_offset) % record_size != 0) return 0;
+	index = (offset - table_offset) / record_size;
+	return (index >= first) && (index < count);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Check that a cache string lies within the string pool and is null-terminated.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Cache_CheckString(const char* base, SIMC_XML_CACHE_HEADER* header, SIMC_XML_STRING* string) {
+	uint64_t offset = (uint64_t)(uintptr_t)string->data;
+	if (offset == 0) return string->length == 0;
+	if ((offset < header->string_offset) || (offset >= header->file_size)) return 0;
+	if ((uint64_t)string->length >= header->file_size - offset) return 0;
+	return base[offset + string->length] == 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Check that a table fits into the cache file before the next table.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Cache_CheckTable(uint64_t offset, uint64_t count, uint64_t record_size, uint64_t end) {
+	if (offset % SIMC_XML_CACHE_ALIGNMENT != 0) return 0;
+	if (offset > end) return 0;
+	return count <= (end - offset) / record_size;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Load document from a cache file (if it is valid for the source file).
+///
+/// The cache is mapped copy-on-write and file offsets in its records are turned
+/// back into pointers in one pass over the element and attribute tables. No text
+/// is parsed.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Cache_Load(const char* filename, const char* cache_filename, SIMC_XML_DOC** p_doc) {
+	SIMC_XML_CACHE_HEADER* header;
+	SIMC_XML_NATIVE_ELEMENT* elements;
+	SIMC_XML_NATIVE_ATTRIBUTE* attributes;
+	uint64_t* atom_offsets;
+	uint64_t source_size, source_hash;
+	int64_t source_mtime;
+	uint64_t i;
+	SIMC_XML_DOC* doc;
+	char* base;
+	*p_doc = 0;
+
+	doc = (SIMC_XML_DOC*)SIMC_Allocate(SIMC_Userdata,sizeof(SIMC_XML_DOC));
+	if (!doc) return SIMC_ERROR_INTERNAL;
+	memset(doc,0,sizeof(SIMC_XML_DOC));
+	doc->backend = SIMC_XML_BACKEND_NATIVE;
+	if (SIMC_XML_Native_MapFile(cache_filename,doc) != SIMC_OK) {
+		SIMC_Free(SIMC_Userdata,doc);
+		return SIMC_ERROR_FILE;
+	}
+
+	//Validate header
+	base = doc->data;
+	header = (SIMC_XML_CACHE_HEADER*)base;
+	if ((doc->data_size < sizeof(SIMC_XML_CACHE_HEADER)) ||
+		(memcmp(header->magic,SIMC_XML_CACHE_MAGIC,8) != 0) ||
+		(header->version != SIMC_XML_CACHE_VERSION) ||
+		(header->byte_order != SIMC_XML_CACHE_BYTE_ORDER) ||
+		(header->element_size != sizeof(SIMC_XML_NATIVE_ELEMENT)) ||
+		(header->attribute_size != sizeof(SIMC_XML_NATIVE_ATTRIBUTE)) ||
+		(header->file_size != doc->data_size) ||
+		(header->element_count < 1) ||
+		(header->element_offset < sizeof(SIMC_XML_CACHE_HEADER)) ||
+		(header->string_offset > header->file_size) ||
+		(!SIMC_XML_Cache_CheckTable(header->element_offset,header->element_count,
+			sizeof(SIMC_XML_NATIVE_ELEMENT),header->attribute_offset)) ||
+		(!SIMC_XML_Cache_CheckTable(header->attribute_offset,header->attribute_count,
+			sizeof(SIMC_XML_NATIVE_ATTRIBUTE),header->atom_offset)) ||
+		(!SIMC_XML_Cache_CheckTable(header->atom_offset,header->atom_count,
+			sizeof(uint64_t),header->string_offset)) ||
+		(header->string_size != header->file_size - header->string_offset) ||
+		(header->string_size == 0) || (base[header->file_size-1] != 0)) {
+		SIMC_XML_Native_Close(doc);
+		return SIMC_ERROR_SYNTAX;
+	}
+
+	//Validate against source file (contents are only hashed if size and time match)
+	if ((SIMC_XML_Cache_StatSource(filename,&source_size,&source_mtime) != SIMC_OK) ||
+		(header->source_size != source_size) ||
+		(header->source_mtime != source_mtime) ||
+		(SIMC_XML_Cache_HashSource(filename,&source_hash) != SIMC_OK) ||
+		(header->source_hash != source_hash)) {
+		SIMC_XML_Native_Close(doc);
+		return SIMC_ERROR_SYNTAX;
+	}
+
+	//Relocate records
+	elements = (SIMC_XML_NATIVE_ELEMENT*)(base + header->element_offset);
+	attributes = (SIMC_XML_NATIVE_ATTRIBUTE*)(base + header->attribute_offset);
+	atom_offsets = (uint64_t*)(base + header->atom_offset);
+	for (i = 0; i < header->element_count; i++) {
+		SIMC_XML_NATIVE_ELEMENT* element = &elements[i];
+		uint64_t element_size = sizeof(SIMC_XML_NATIVE_ELEMENT);
+		uint64_t attribute_size = sizeof(SIMC_XML_NATIVE_ATTRIBUTE);
+		if ((!SIMC_XML_Cache_CheckString(base,header,&element->name)) ||
+			(!SIMC_XML_Cache_CheckString(base,header,&element->text)) ||
+			(!SIMC_XML_Cache_CheckPointer(element->parent,header->element_offset,element_size,0,i)) ||
+			(!SIMC_XML_Cache_CheckPointer(element->first_child,header->element_offset,element_size,i+1,header->element_count)) ||
+			(!SIMC_XML_Cache_CheckPointer(element->last_child,header->element_offset,element_size,i+1,header->element_count)) ||
+			(!SIMC_XML_Cache_CheckPointer(element->next,header->element_offset,element_size,i+1,header->element_count)) ||
+			(!SIMC_XML_Cache_CheckPointer(element->first_attribute,header->attribute_offset,attribute_size,0,header->attribute_count)) ||
+			(!SIMC_XML_Cache_CheckPointer(element->last_attribute,header->attribute_offset,attribute_size,0,header->attribute_count)) ||
+			((i > 0) && (!element->parent))) {
+			SIMC_XML_Native_Close(doc);
+			return SIMC_ERROR_SYNTAX;
+		}
+
+		element->name.data = (const char*)SIMC_XML_CACHE_POINTER(base,element->name.data);
+		element->text.data = (const char*)SIMC_XML_CACHE_POINTER(base,element->text.data);
+		element->parent = (SIMC_XML_NATIVE_ELEMENT*)SIMC_XML_CACHE_POINTER(base,element->parent);
+		element->first_child = (SIMC_XML_NATIVE_ELEMENT*)SIMC_XML_CACHE_POINTER(base,element->first_child);
+		element->last_child = (SIMC_XML_NATIVE_ELEMENT*)SIMC_XML_CACHE_POINTER(base,element->last_child);
+		element->next = (SIMC_XML_NATIVE_ELEMENT*)SIMC_XML_CACHE_POINTER(base,element->next);
+		element->first_attribute = (SIMC_XML_NATIVE_ATTRIBUTE*)SIMC_XML_CACHE_POINTER(base,element->first_attribute);
+		element->last_attribute = (SIMC_XML_NATIVE_ATTRIBUTE*)SIMC_XML_CACHE_POINTER(base,element->last_attribute);
+		element->attribute_index = 0;
+		element->children = 0;
+		element->child_count = 0;
+
+		//Top-level elements belong to the document node, which lives in the document itself
+		if (element->parent == &elements[0]) element->parent = &doc->root;
+	}
+	for (i = 0; i < header->attribute_count; i++) {
+		SIMC_XML_NATIVE_ATTRIBUTE* attribute = &attributes[i];
+		if ((!attribute->name.data) ||
+			(!SIMC_XML_Cache_CheckString(base,header,&attribute->name)) ||
+			(!SIMC_XML_Cache_CheckString(base,header,&attribute->value)) ||
+			(!SIMC_XML_Cache_CheckPointer(attribute->next,header->attribute_offset,sizeof(SIMC_XML_NATIVE_ATTRIBUTE),
+										  i+1,header->attribute_count))) {
+			SIMC_XML_Native_Close(doc);
+			return SIMC_ERROR_SYNTAX;
+		}
+		attribute->name.data = (const char*)SIMC_XML_CACHE_POINTER(base,attribute->name.data);
+		attribute->value.data = (const char*)SIMC_XML_CACHE_POINTER(base,attribute->value.data);
+		attribute->next = (SIMC_XML_NATIVE_ATTRIBUTE*)SIMC_XML_CACHE_POINTER(base,attribute->next);
+	}
+	doc->root = elements[0];
+
+	//Attribute counts are taken from the lists themselves (attribute indexes are sized by them)
+	for (i = 0; i < header->element_count; i++) {
+		SIMC_XML_NATIVE_ATTRIBUTE* attribute;
+		elements[i].attribute_count = 0;
+		for (attribute = elements[i].first_attribute; attribute; attribute = attribute->next) {
+			elements[i].attribute_count++;
+		}
+	}
+
+	//Rebuild name table and attribute indexes
+	for (i = 0; i < header->atom_count; i++) {
+		const char* name;
+		if ((atom_offsets[i] < header->string_offset) || (atom_offsets[i] >= header->file_size)) {
+			SIMC_XML_Native_Close(doc);
+			return SIMC_ERROR_SYNTAX;
+		}
+		name = base + atom_offsets[i];
+		if (!SIMC_XML_Atom_Intern(&doc->atoms,&doc->arena,name,strlen(name),0)) {
+			SIMC_XML_Native_Close(doc);
+			return SIMC_ERROR_INTERNAL;
+		}
+	}
+	for (i = 1; i < header->element_count; i++) {
+		if (elements[i].attribute_count >= SIMC_XML_ATTRIBUTE_INDEX_THRESHOLD) {
+			if (SIMC_XML_Native_IndexAttributes(doc,&elements[i]) != SIMC_OK) {
+				SIMC_XML_Native_Close(doc);
+				return SIMC_ERROR_INTERNAL;
+			}
+		}
+	}
+
+	*p_doc = doc;
+	return SIMC_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Open XML file using a binary cache written next to it.
+///
+/// If a valid cache exists, the document is loaded from it without parsing any
+/// XML: the cache is mapped into memory and used directly. The cache is valid if
+/// size, modification time and contents hash of the source file match the values
+/// stored in it. Otherwise the file is opened with SIMC_XML_OpenMapped() and a new
+/// cache is written (failure to write the cache is not an error).
+///
+/// The document behaves exactly like one opened with SIMC_XML_OpenMapped(). Numeric
+/// attribute values are stored in the cache already converted, so
+/// SIMC_XML_GetAttributeDouble() does not have to parse them.
+///
+/// @param[in] filename Name of the XML file to open
+/// @param[in] cache_filename Name of the cache file (null for filename with ".cache" appended)
+/// @param[out] xmldoc Document handle
+/// @param[in] syntaxError Callback for syntax errors (may be null)
+/// @param[in] userdata Userdata passed into the syntax error callback
+///
+/// @returns Error code
+/// @retval SIMC_OK Document successfully loaded
+/// @retval SIMC_ERROR_FILE File could not be opened
+/// @retval SIMC_ERROR_SYNTAX Syntax error in file
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_OpenCached(const char* filename, const char* cache_filename, SIMC_XML_DOCUMENT** xmldoc,
+						SIMC_Callback_XMLSyntaxError* syntaxError, void* userdata) {
+	char default_filename[4096];
+	int result;
+
+	if (!filename) return SIMC_ERROR_INTERNAL;
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+	if (!cache_filename) {
+		snprintf(default_filename,4095,"%s%s",filename,SIMC_XML_CACHE_SUFFIX);
+		default_filename[4095] = 0;
+		cache_filename = default_filename;
+	}
+
+	if (SIMC_XML_Cache_Load(filename,cache_filename,(SIMC_XML_DOC**)xmldoc) == SIMC_OK) return SIMC_OK;
+
+	result = SIMC_XML_Native_OpenMapped(filename,(SIMC_XML_DOC**)xmldoc,syntaxError,userdata);
+	if (result != SIMC_OK) return result;
+	SIMC_XML_SaveCache(*xmldoc,filename,cache_filename);
+	return SIMC_OK;
+}
@@ -0,0 +1,373 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file
+////////////////////////////////////////////////////////////////////////////////
+/// Copyright (C) 2012-2015, Black Phoenix
+///
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the GNU Lesser General Public License as published by the Free Software
+/// Foundation; either version 2 of the License, or (at your option) any later
+/// version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+/// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+/// details.
+///
+/// You should have received a copy of the GNU Lesser General Public License along with
+/// this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+/// Place - Suite 330, Boston, MA  02111-1307, USA.
+///
+/// Further information about the GNU Lesser General Public License can also be found on
+/// the world wide web at http://www.gnu.org.
+////////////////////////////////////////////////////////////////////////////////
+#include <string.h>
+#include "sim_core.h"
+#include "sim_xml.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Internal data structures
+////////////////////////////////////////////////////////////////////////////////
+#ifndef DOXYGEN_INTERNAL_STRUCTS
+typedef struct SIMC_XML_DIFF_TAG {
+	SIMC_XML_DOCUMENT* old_xmldoc;
+	SIMC_XML_DOCUMENT* new_xmldoc;
+	const char* key_attribute;				//Attribute which identifies elements (may be null)
+	SIMC_XML_DIFF_CALLBACKS* callbacks;
+	void* userdata;
+} SIMC_XML_DIFF;
+
+typedef struct SIMC_XML_DIFF_CHILD_TAG {
+	SIMC_XML_ELEMENT* element;
+	SIMC_XML_STRING name;
+	SIMC_XML_STRING key;					//Value of key attribute (empty if none)
+	int matched;
+} SIMC_XML_DIFF_CHILD;
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Compare two strings with lengths.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Diff_Equal(const SIMC_XML_STRING* a, const SIMC_XML_STRING* b) {
+	if (a->length != b->length) return 0;
+	if (a->length == 0) return 1;
+	return memcmp(a->data,b->data,a->length) == 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Find attribute of an element by name.
+/// @returns 1 if attribute exists (value is set), 0 otherwise
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Diff_FindAttribute(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, const char* name, const char** value) {
+	SIMC_XML_ATTRIBUTE* attribute = 0;
+	SIMC_XML_DOC* doc = (SIMC_XML_DOC*)xmldoc;
+
+	if (doc->backend == SIMC_XML_BACKEND_NATIVE) {
+		SIMC_XML_NATIVE_ATTRIBUTE* native_attribute =
+			SIMC_XML_Native_FindAttribute(doc,(SIMC_XML_NATIVE_ELEMENT*)xmlelement,name);
+		if (!native_attribute) return 0;
+		*value = native_attribute->value.data;
+		return 1;
+	}
+
+	SIMC_XML_GetFirstAttribute(xmldoc,xmlelement,&attribute);
+	while (attribute) {
+		char* attribute_name;
+		SIMC_XML_GetAttributeName(xmldoc,attribute,&attribute_name);
+		if (attribute_name && (strcmp(attribute_name,name) == 0)) {
+			SIMC_XML_GetAttributeText(xmldoc,attribute,(char**)value);
+			return 1;
+		}
+		SIMC_XML_IterateAttributes(xmldoc,attribute,&attribute);
+	}
+	return 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Report attribute and text changes between two matched elements.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Diff_Values(SIMC_XML_DIFF* diff, SIMC_XML_ELEMENT* old_element, SIMC_XML_ELEMENT* new_element) {
+	SIMC_XML_DIFF_CALLBACKS* callbacks = diff->callbacks;
+	SIMC_XML_ATTRIBUTE* attribute = 0;
+	int error;
+
+	if (callbacks->OnAttributeChanged) {
+		//Removed and changed attributes
+		SIMC_XML_GetFirstAttribute(diff->old_xmldoc,old_element,&attribute);
+		while (attribute) {
+			char *name, *old_value;
+			const char* new_value;
+			SIMC_XML_GetAttributeName(diff->old_xmldoc,attribute,&name);
+			SIMC_XML_GetAttributeText(diff->old_xmldoc,attribute,&old_value);
+			if (!SIMC_XML_Diff_FindAttribute(diff->new_xmldoc,new_element,name,&new_value)) {
+				error = callbacks->OnAttributeChanged(diff->userdata,old_element,new_element,name,old_value,0);
+				if (error) return error;
+			} else if (strcmp(old_value,new_value) != 0) {
+				error = callbacks->OnAttributeChanged(diff->userdata,old_element,new_element,name,old_value,new_value);
+				if (error) return error;
+			}
+			SIMC_XML_IterateAttributes(diff->old_xmldoc,attribute,&attribute);
+		}
+
+		//Added attributes
+		SIMC_XML_GetFirstAttribute(diff->new_xmldoc,new_element,&attribute);
+		while (attribute) {
+			char *name, *new_value;
+			const char* old_value;
+			SIMC_XML_GetAttributeName(diff->new_xmldoc,attribute,&name);
+			if (!SIMC_XML_Diff_FindAttribute(diff->old_xmldoc,old_element,name,&old_value)) {
+				SIMC_XML_GetAttributeText(diff->new_xmldoc,attribute,&new_value);
+				error = callbacks->OnAttributeChanged(diff->userdata,old_element,new_element,name,0,new_value);
+				if (error) return error;
+			}
+			SIMC_XML_IterateAttributes(diff->new_xmldoc,attribute,&attribute);
+		}
+	}
+
+	if (callbacks->OnTextChanged) {
+		SIMC_XML_STRING old_text, new_text;
+		SIMC_XML_GetTextView(diff->old_xmldoc,old_element,&old_text);
+		SIMC_XML_GetTextView(diff->new_xmldoc,new_element,&new_text);
+		if (!SIMC_XML_Diff_Equal(&old_text,&new_text)) {
+			error = callbacks->OnTextChanged(diff->userdata,old_element,new_element,0,
+				old_text.data ? old_text.data : "",new_text.data ? new_text.data : "");
+			if (error) return error;
+		}
+	}
+	return SIMC_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Get name and key of an element.
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_XML_Diff_Identify(SIMC_XML_DIFF* diff, SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* element, SIMC_XML_DIFF_CHILD* child) {
+	child->element = element;
+	child->matched = 0;
+	SIMC_XML_GetNameView(xmldoc,element,&child->name);
+	child->key.data = "";
+	child->key.length = 0;
+	if (diff->key_attribute) {
+		SIMC_XML_GetAttributeView(xmldoc,element,diff->key_attribute,&child->key);
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Compare two matched elements and everything nested in them.
+///
+/// Children are matched by name and key attribute; children which share both are
+/// matched in the order they appear. The search for a match starts at the first
+/// child which is not matched yet, so unchanged documents are compared in linear
+/// time.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Diff_Element(SIMC_XML_DIFF* diff, SIMC_XML_ELEMENT* old_element, SIMC_XML_ELEMENT* new_element) {
+	SIMC_XML_DIFF_CALLBACKS* callbacks = diff->callbacks;
+	SIMC_XML_DIFF_CHILD* new_children = 0;
+	SIMC_XML_ELEMENT* element = 0;
+	int new_count = 0;
+	int first_unmatched = 0;
+	int error, i;
+
+	if (callbacks->OnElementMatched) {
+		error = callbacks->OnElementMatched(diff->userdata,diff->old_xmldoc,old_element,diff->new_xmldoc,new_element);
+		if (error) return error;
+	}
+	error = SIMC_XML_Diff_Values(diff,old_element,new_element);
+	if (error) return error;
+
+	//Collect children of the new element
+	while (SIMC_XML_Iterate(diff->new_xmldoc,new_element,&element,0), element) new_count++;
+	if (new_count > 0) {
+		new_children = (SIMC_XML_DIFF_CHILD*)SIMC_Allocate(SIMC_Userdata,sizeof(SIMC_XML_DIFF_CHILD)*new_count);
+		if (!new_children) return SIMC_ERROR_INTERNAL;
+		i = 0;
+		while (SIMC_XML_Iterate(diff->new_xmldoc,new_element,&element,0), element) {
+			SIMC_XML_Diff_Identify(diff,diff->new_xmldoc,element,&new_children[i++]);
+		}
+	}
+
+	//Match children of the old element
+	while (SIMC_XML_Iterate(diff->old_xmldoc,old_element,&element,0), element) {
+		SIMC_XML_DIFF_CHILD old_child;
+		SIMC_XML_Diff_Identify(diff,diff->old_xmldoc,element,&old_child);
+
+		for (i = first_unmatched; i < new_count; i++) {
+			if ((!new_children[i].matched) &&
+				SIMC_XML_Diff_Equal(&new_children[i].name,&old_child.name) &&
+				SIMC_XML_Diff_Equal(&new_children[i].key,&old_child.key)) break;
+		}
+		if (i < new_count) {
+			new_children[i].matched = 1;
+			while ((first_unmatched < new_count) && new_children[first_unmatched].matched) first_unmatched++;
+			error = SIMC_XML_Diff_Element(diff,element,new_children[i].element);
+		} else if (callbacks->OnElementRemoved) {
+			error = callbacks->OnElementRemoved(diff->userdata,diff->old_xmldoc,element,diff->new_xmldoc,new_element);
+		}
+		if (error) break;
+	}
+
+	//Everything left over was added
+	if ((!error) && callbacks->OnElementAdded) {
+		for (i = first_unmatched; i < new_count; i++) {
+			if (new_children[i].matched) continue;
+			error = callbacks->OnElementAdded(diff->userdata,diff->old_xmldoc,old_element,diff->new_xmldoc,new_children[i].element);
+			if (error) break;
+		}
+	}
+
+	if (new_children) SIMC_Free(SIMC_Userdata,new_children);
+	return error;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Compare two documents and report the differences through callbacks.
+///
+/// Elements of both documents are matched top-down: two elements are the same
+/// element if their parents are the same element and they have the same name
+/// (and the same value of key_attribute, if it is given). Elements which share
+/// name and key are matched in the order they appear. For example, with key
+/// attribute "name" reordering the engines of a vessel does not produce any
+/// changes, while without a key it shows up as changed attributes.
+///
+/// Callbacks are called in document order of the old document:
+///  - OnElementMatched for every element which exists in both documents, before
+///    any changes inside it are reported. This pairs old handles with new ones.
+///  - OnAttributeChanged for attributes which were added (old value is null),
+///    removed (new value is null) or changed.
+///  - OnTextChanged if element text changed (name is null).
+///  - OnElementRemoved for elements which exist only in the old document (the
+///    other element is the parent in the new document). Nested elements of a
+///    removed element are not reported separately.
+///  - OnElementAdded for elements which exist only in the new document (the other
+///    element is the parent in the old document), after all old children were
+///    reported. Nested elements of an added element are not reported separately.
+///
+/// Documents with different root elements are reported as one removed and one
+/// added element with null parents. If a callback returns anything other than
+/// SIMC_OK, comparison stops and that value is returned.
+///
+/// @param[in] old_xmldoc Old document
+/// @param[in] new_xmldoc New document
+/// @param[in] key_attribute Name of attribute which identifies elements (may be null)
+/// @param[in] callbacks Diff callbacks (any callback may be null)
+/// @param[in] userdata Userdata passed into every callback
+///
+/// @returns Error code
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Diff(SIMC_XML_DOCUMENT* old_xmldoc, SIMC_XML_DOCUMENT* new_xmldoc, const char* key_attribute,
+				  SIMC_XML_DIFF_CALLBACKS* callbacks, void* userdata) {
+	SIMC_XML_DIFF diff;
+	SIMC_XML_DIFF_CHILD old_root, new_root;
+	SIMC_XML_ELEMENT* old_element;
+	SIMC_XML_ELEMENT* new_element;
+	int error = SIMC_OK;
+	if (!old_xmldoc) return SIMC_ERROR_INTERNAL;
+	if (!new_xmldoc) return SIMC_ERROR_INTERNAL;
+	if (!callbacks) return SIMC_ERROR_INTERNAL;
+
+	diff.old_xmldoc = old_xmldoc;
+	diff.new_xmldoc = new_xmldoc;
+	diff.key_attribute = key_attribute;
+	diff.callbacks = callbacks;
+	diff.userdata = userdata;
+
+	old_element = SIMC_XML_Internal_GetDocumentElement(old_xmldoc);
+	new_element = SIMC_XML_Internal_GetDocumentElement(new_xmldoc);
+	if (old_element && new_element) {
+		SIMC_XML_Diff_Identify(&diff,old_xmldoc,old_element,&old_root);
+		SIMC_XML_Diff_Identify(&diff,new_xmldoc,new_element,&new_root);
+		if (SIMC_XML_Diff_Equal(&old_root.name,&new_root.name) &&
+			SIMC_XML_Diff_Equal(&old_root.key,&new_root.key)) {
+			return SIMC_XML_Diff_Element(&diff,old_element,new_element);
+		}
+	}
+
+	if (old_element && callbacks->OnElementRemoved) {
+		error = callbacks->OnElementRemoved(userdata,old_xmldoc,old_element,new_xmldoc,0);
+	}
+	if ((!error) && new_element && callbacks->OnElementAdded) {
+		error = callbacks->OnElementAdded(userdata,old_xmldoc,0,new_xmldoc,new_element);
+	}
+	return error;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Reload document from a changed file and report what changed.
+///
+/// The file is parsed into a new document of the same kind as the old one (frozen
+/// documents are frozen again). Documents opened with SIMC_XML_OpenMapped() or
+/// SIMC_XML_OpenCached() are reloaded by reading the file into memory rather than
+/// mapping it, so that editing the file in place cannot change the document after
+/// it was reloaded. The two documents are compared with SIMC_XML_Diff(), which lets
+/// the caller apply only the changes:
+/// ~~~{.c}
+///		int OnAttributeChanged(void* userdata, SIMC_XML_ELEMENT* old_element, SIMC_XML_ELEMENT* new_element,
+///							   const char* name, const char* old_value, const char* new_value) {
+///			if (strcmp(name,"thrust") == 0) ...
+///			return SIMC_OK;
+///		}
+///
+///		SIMC_XML_DIFF_CALLBACKS callbacks = { 0 };
+///		callbacks.OnAttributeChanged = OnAttributeChanged;
+///		SIMC_XML_Reload(&xmldoc,"vessel.xml","name",&callbacks,userdata);
+/// ~~~
+///
+/// Both documents are valid while callbacks run. Afterwards the old document is
+/// closed and xmldoc is replaced with the new one, so all old element handles
+/// become invalid (OnElementMatched gives their replacements).
+///
+/// If the file cannot be parsed or a callback returns an error, the new document
+/// is discarded and xmldoc is left unchanged.
+///
+/// @param[in,out] xmldoc Document to reload
+/// @param[in] filename Name of the file to load
+/// @param[in] key_attribute Name of attribute which identifies elements (may be null)
+/// @param[in] callbacks Diff callbacks (any callback may be null)
+/// @param[in] userdata Userdata passed into every callback
+///
+/// @returns Error code
+/// @retval SIMC_OK Document reloaded
+/// @retval SIMC_ERROR_FILE File could not be opened
+/// @retval SIMC_ERROR_SYNTAX Syntax error in file (reported through OnSyntaxError)
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Reload(SIMC_XML_DOCUMENT** xmldoc, const char* filename, const char* key_attribute,
+					SIMC_XML_DIFF_CALLBACKS* callbacks, void* userdata) {
+	SIMC_XML_DOCUMENT* new_xmldoc;
+	SIMC_XML_DOC* doc;
+	int error;
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+	if (!(*xmldoc)) return SIMC_ERROR_INTERNAL;
+	if (!filename) return SIMC_ERROR_INTERNAL;
+	if (!callbacks) return SIMC_ERROR_INTERNAL;
+
+	doc = (SIMC_XML_DOC*)(*xmldoc);
+	if (doc->backend == SIMC_XML_BACKEND_NATIVE) {
+		error = SIMC_XML_Native_OpenFile(filename,0,(SIMC_XML_DOC**)&new_xmldoc,callbacks->OnSyntaxError,userdata);
+	} else {
+		error = SIMC_XML_Open(filename,&new_xmldoc,callbacks->OnSyntaxError,userdata);
+	}
+	if (error) return error;
+	if (doc->frozen) {
+		error = SIMC_XML_Freeze(new_xmldoc);
+		if (error) {
+			SIMC_XML_Close(new_xmldoc);
+			return error;
+		}
+	}
+
+	error = SIMC_XML_Diff(*xmldoc,new_xmldoc,key_attribute,callbacks,userdata);
+	if (error) {
+		SIMC_XML_Close(new_xmldoc);
+		return error;
+	}
+
+	SIMC_XML_Close(*xmldoc);
+	*xmldoc = new_xmldoc;
+	return SIMC_OK;
+}
@@ -0,0 +1,654 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file
+////////////////////////////////////////////////////////////////////////////////
+/// Copyright (C) 2012-2015, Black Phoenix
+///
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the GNU Lesser General Public License as published by the Free Software
+/// Foundation; either version 2 of the License, or (at your option) any later
+/// version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+/// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+/// details.
+///
+/// You should have received a copy of the GNU Lesser General Public License along with
+/// this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+/// Place - Suite 330, Boston, MA  02111-1307, USA.
+///
+/// Further information about the GNU Lesser General Public License can also be found on
+/// the world wide web at http://www.gnu.org.
+////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <string.h>
+#include "sim_core.h"
+#include "sim_xml.h"
+#ifdef _WIN32
+#	include <windows.h>
+#else
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <fcntl.h>
+#	include <unistd.h>
+#endif
+
+//Size of the first arena chunk and the largest size chunks grow to
+#define SIMC_XML_ARENA_MIN_CHUNK	65536
+#define SIMC_XML_ARENA_MAX_CHUNK	16777216
+
+//Alignment of arena allocations
+#define SIMC_XML_ARENA_ALIGN		sizeof(void*)
+
+//Hash of an atom pointer (atoms are unique, so the address itself is the key)
+#define SIMC_XML_ATOM_POINTER_HASH(atom)	((size_t)(((uintptr_t)(atom) >> 3) * 2654435761U))
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Internal data structures
+////////////////////////////////////////////////////////////////////////////////
+#ifndef DOXYGEN_INTERNAL_STRUCTS
+typedef struct SIMC_XML_BUILDER_TAG {
+	SIMC_XML_DOC* doc;
+	SIMC_XML_NATIVE_ELEMENT* current;		//Element being parsed
+	int copy;								//Strings must be copied (not parsing in place)
+	SIMC_Callback_XMLSyntaxError* syntaxError;
+	void* userdata;
+} SIMC_XML_BUILDER;
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Allocate memory from arena.
+///
+/// Allocations are aligned to pointer size. Memory is not initialized.
+////////////////////////////////////////////////////////////////////////////////
+void* SIMC_XML_Arena_Allocate(SIMC_XML_ARENA* arena, size_t size) {
+	void* pointer;
+	size = (size + SIMC_XML_ARENA_ALIGN - 1) & ~(SIMC_XML_ARENA_ALIGN - 1);
+
+	if ((size_t)(arena->end - arena->pos) < size) {
+		size_t chunk_size;
+		void** chunk;
+
+		//Chunks grow geometrically, large allocations get a chunk of their own
+		if (arena->chunk_size < SIMC_XML_ARENA_MIN_CHUNK) arena->chunk_size = SIMC_XML_ARENA_MIN_CHUNK;
+		chunk_size = arena->chunk_size;
+		if (chunk_size < size + SIMC_XML_ARENA_ALIGN) chunk_size = size + SIMC_XML_ARENA_ALIGN;
+		if (arena->chunk_size < SIMC_XML_ARENA_MAX_CHUNK) arena->chunk_size *= 2;
+
+		chunk = (void**)SIMC_Allocate(SIMC_Userdata,chunk_size);
+		if (!chunk) return 0;
+		chunk[0] = arena->chunks;
+		arena->chunks = chunk;
+		arena->pos = (char*)chunk + SIMC_XML_ARENA_ALIGN;
+		arena->end = (char*)chunk + chunk_size;
+	}
+
+	pointer = arena->pos;
+	arena->pos += size;
+	return pointer;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Free all memory allocated from arena.
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_XML_Arena_Destroy(SIMC_XML_ARENA* arena) {
+	void** chunk = (void**)arena->chunks;
+	while (chunk) {
+		void** previous = (void**)chunk[0];
+		SIMC_Free(SIMC_Userdata,chunk);
+		chunk = previous;
+	}
+	arena->chunks = 0;
+	arena->pos = 0;
+	arena->end = 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Copy string into document arena (result is null-terminated).
+////////////////////////////////////////////////////////////////////////////////
+const char* SIMC_XML_Native_CopyString(SIMC_XML_DOC* doc, const char* string, size_t length) {
+	char* copy = (char*)SIMC_XML_Arena_Allocate(&doc->arena,length+1);
+	if (!copy) return 0;
+	memcpy(copy,string,length);
+	copy[length] = 0;
+	return copy;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Append new element to parent.
+///
+/// If copy is zero, name must be null-terminated and stay valid while the document
+/// is open (names inside document data); otherwise it is copied.
+////////////////////////////////////////////////////////////////////////////////
+SIMC_XML_NATIVE_ELEMENT* SIMC_XML_Native_NewElement(SIMC_XML_DOC* doc, SIMC_XML_NATIVE_ELEMENT* parent, const char* name, size_t length, int copy) {
+	SIMC_XML_NATIVE_ELEMENT* element = (SIMC_XML_NATIVE_ELEMENT*)
+		SIMC_XML_Arena_Allocate(&doc->arena,sizeof(SIMC_XML_NATIVE_ELEMENT));
+	if (!element) return 0;
+
+	memset(element,0,sizeof(SIMC_XML_NATIVE_ELEMENT));
+	element->name.data = SIMC_XML_Atom_Intern(&doc->atoms,&doc->arena,name,length,copy);
+	if (!element->name.data) return 0;
+	element->name.length = length;
+	element->parent = parent;
+	if (parent->last_child) {
+		parent->last_child->next = element;
+	} else {
+		parent->first_child = element;
+	}
+	parent->last_child = element;
+	return element;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Append new attribute to element (strings are copied if copy is set).
+////////////////////////////////////////////////////////////////////////////////
+SIMC_XML_NATIVE_ATTRIBUTE* SIMC_XML_Native_NewAttribute(SIMC_XML_DOC* doc, SIMC_XML_NATIVE_ELEMENT* element,
+														const char* name, size_t name_length, const char* value, size_t value_length, int copy) {
+	SIMC_XML_NATIVE_ATTRIBUTE* attribute = (SIMC_XML_NATIVE_ATTRIBUTE*)
+		SIMC_XML_Arena_Allocate(&doc->arena,sizeof(SIMC_XML_NATIVE_ATTRIBUTE));
+	if (!attribute) return 0;
+
+	attribute->name.data = SIMC_XML_Atom_Intern(&doc->atoms,&doc->arena,name,name_length,copy);
+	attribute->name.length = name_length;
+	attribute->value.data = copy ? SIMC_XML_Native_CopyString(doc,value,value_length) : value;
+	attribute->value.length = value_length;
+	if ((!attribute->name.data) || (!attribute->value.data)) return 0;
+	attribute->next = 0;
+	attribute->number = 0.0;
+	attribute->number_state = SIMC_XML_NUMBER_UNKNOWN;
+	if (element->last_attribute) {
+		element->last_attribute->next = attribute;
+	} else {
+		element->first_attribute = attribute;
+	}
+	element->last_attribute = attribute;
+	element->attribute_count++;
+	return attribute;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Set attribute value, adding the attribute if it does not exist yet.
+///
+/// Strings are copied into the arena. The attribute index of the element is kept
+/// up to date (and is created once the element has enough attributes).
+////////////////////////////////////////////////////////////////////////////////
+SIMC_XML_NATIVE_ATTRIBUTE* SIMC_XML_Native_SetAttribute(SIMC_XML_DOC* doc, SIMC_XML_NATIVE_ELEMENT* element,
+														const char* name, const char* value) {
+	SIMC_XML_NATIVE_ATTRIBUTE* attribute;
+	size_t name_length = strlen(name);
+	size_t value_length = strlen(value);
+	SIMC_XML_ATOM atom = SIMC_XML_Atom_Find(&doc->atoms,name,name_length);
+
+	//Replace value of an existing attribute
+	attribute = atom ? SIMC_XML_Native_FindAttributeAtom(element,atom) : 0;
+	if (attribute) {
+		const char* copy = SIMC_XML_Native_CopyString(doc,value,value_length);
+		if (!copy) return 0;
+		attribute->value.data = copy;
+		attribute->value.length = value_length;
+		attribute->number_state = SIMC_XML_NUMBER_UNKNOWN;
+		return attribute;
+	}
+
+	attribute = SIMC_XML_Native_NewAttribute(doc,element,name,name_length,value,value_length,1);
+	if (!attribute) return 0;
+
+	//Rebuild index when it gets half full, otherwise insert into it
+	if (element->attribute_index && (element->attribute_count*2 <= element->attribute_index_mask+1)) {
+		size_t index = SIMC_XML_ATOM_POINTER_HASH(attribute->name.data) & element->attribute_index_mask;
+		while (element->attribute_index[index]) index = (index + 1) & element->attribute_index_mask;
+		element->attribute_index[index] = attribute;
+	} else if (element->attribute_count >= SIMC_XML_ATTRIBUTE_INDEX_THRESHOLD) {
+		if (SIMC_XML_Native_IndexAttributes(doc,element) != SIMC_OK) return 0;
+	}
+	return attribute;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Set element text (copied into arena).
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Native_SetText(SIMC_XML_DOC* doc, SIMC_XML_NATIVE_ELEMENT* element, const char* text) {
+	size_t length = strlen(text);
+	const char* copy = SIMC_XML_Native_CopyString(doc,text,length);
+	if (!copy) return SIMC_ERROR_INTERNAL;
+	element->text.data = copy;
+	element->text.length = length;
+	return SIMC_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Parser callbacks which build the document.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Builder_StartElement(void* userdata, const char* name, size_t length) {
+	SIMC_XML_BUILDER* builder = (SIMC_XML_BUILDER*)userdata;
+	SIMC_XML_NATIVE_ELEMENT* element = SIMC_XML_Native_NewElement(builder->doc,builder->current,name,length,builder->copy);
+	if (!element) return SIMC_ERROR_INTERNAL;
+
+	builder->current = element;
+	return SIMC_OK;
+}
+
+int SIMC_XML_Builder_Attribute(void* userdata, const char* name, size_t name_length, const char* value, size_t value_length) {
+	SIMC_XML_BUILDER* builder = (SIMC_XML_BUILDER*)userdata;
+	if (!SIMC_XML_Native_NewAttribute(builder->doc,builder->current,name,name_length,value,value_length,builder->copy)) {
+		return SIMC_ERROR_INTERNAL;
+	}
+	return SIMC_OK;
+}
+
+int SIMC_XML_Builder_Text(void* userdata, const char* text, size_t length) {
+	SIMC_XML_BUILDER* builder = (SIMC_XML_BUILDER*)userdata;
+	SIMC_XML_NATIVE_ELEMENT* element = builder->current;
+
+	//Only text before the first nested element is kept (same as TinyXML GetText)
+	if ((!element->text.data) && (!element->first_child)) {
+		element->text.data = builder->copy ? SIMC_XML_Native_CopyString(builder->doc,text,length) : text;
+		element->text.length = length;
+		if (!element->text.data) return SIMC_ERROR_INTERNAL;
+	}
+	return SIMC_OK;
+}
+
+int SIMC_XML_Builder_EndElement(void* userdata, const char* name, size_t length) {
+	SIMC_XML_BUILDER* builder = (SIMC_XML_BUILDER*)userdata;
+	SIMC_XML_NATIVE_ELEMENT* element = builder->current;
+	(void)name; //Parser already checked that the end tag matches
+	(void)length;
+	builder->current = element->parent;
+
+	if (element->attribute_count >= SIMC_XML_ATTRIBUTE_INDEX_THRESHOLD) {
+		return SIMC_XML_Native_IndexAttributes(builder->doc,element);
+	}
+	return SIMC_OK;
+}
+
+int SIMC_XML_Builder_SyntaxError(void* userdata, const char* error) {
+	SIMC_XML_BUILDER* builder = (SIMC_XML_BUILDER*)userdata;
+	if (builder->syntaxError) return builder->syntaxError(builder->userdata,error);
+	return SIMC_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Parse document data in place, or stream the file if it is compressed.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Native_Parse(SIMC_XML_DOC* doc, const char* filename, int compressed, SIMC_Callback_XMLSyntaxError* syntaxError, void* userdata) {
+	SIMC_XML_STREAM_CALLBACKS callbacks = { 0 };
+	SIMC_XML_BUILDER builder;
+	int result;
+
+	callbacks.OnStartElement = SIMC_XML_Builder_StartElement;
+	callbacks.OnAttribute = SIMC_XML_Builder_Attribute;
+	callbacks.OnText = SIMC_XML_Builder_Text;
+	callbacks.OnEndElement = SIMC_XML_Builder_EndElement;
+	callbacks.OnSyntaxError = SIMC_XML_Builder_SyntaxError;
+	builder.doc = doc;
+	builder.current = &doc->root;
+	builder.copy = compressed;
+	builder.syntaxError = syntaxError;
+	builder.userdata = userdata;
+
+	if (compressed) {
+		result = SIMC_XML_Internal_ParseFile(filename,&callbacks,&builder);
+	} else {
+		result = SIMC_XML_Internal_Parse(doc->data,doc->data_size,0,0,filename,&callbacks,&builder);
+	}
+	if ((result == SIMC_OK) && (!doc->root.first_child)) {
+		char errorText[8192];
+		snprintf(errorText,8191,"%s:%d %s",filename,1,"Document empty");
+		errorText[8191] = 0;
+
+		if (syntaxError) syntaxError(userdata,errorText);
+		return SIMC_ERROR_SYNTAX;
+	}
+	return result;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Map file into memory as document data.
+///
+/// The file is mapped copy-on-write, so the parser can null-terminate strings and
+/// decode entities in place. Only pages which had to be modified are copied.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Native_MapFile(const char* filename, SIMC_XML_DOC* doc) {
+#ifdef _WIN32
+	HANDLE file, mapping;
+	LARGE_INTEGER size;
+
+	file = CreateFileA(filename,GENERIC_READ,FILE_SHARE_READ,NULL,OPEN_EXISTING,FILE_FLAG_SEQUENTIAL_SCAN,NULL);
+	if (file == INVALID_HANDLE_VALUE) return SIMC_ERROR_FILE;
+	GetFileSizeEx(file,&size);
+	doc->data_size = (size_t)size.QuadPart;
+	if (doc->data_size > 0) {
+		mapping = CreateFileMapping(file,NULL,PAGE_WRITECOPY,0,0,NULL);
+		if (mapping) {
+			doc->data = (char*)MapViewOfFile(mapping,FILE_MAP_COPY,0,0,0);
+			CloseHandle(mapping);
+		}
+		if (!doc->data) {
+			CloseHandle(file);
+			return SIMC_ERROR_FILE;
+		}
+		doc->mapping = doc->data;
+	}
+	CloseHandle(file);
+#else
+	struct stat info;
+	int file;
+
+	file = open(filename,O_RDONLY);
+	if (file < 0) return SIMC_ERROR_FILE;
+	fstat(file,&info);
+	doc->data_size = (size_t)info.st_size;
+	if (doc->data_size > 0) {
+		void* data = mmap(0,doc->data_size,PROT_READ | PROT_WRITE,MAP_PRIVATE,file,0);
+		if (data == MAP_FAILED) {
+			close(file);
+			return SIMC_ERROR_FILE;
+		}
+		madvise(data,doc->data_size,MADV_SEQUENTIAL);
+		doc->data = (char*)data;
+		doc->mapping = data;
+	}
+	close(file);
+#endif
+	return SIMC_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Create empty natively parsed document.
+////////////////////////////////////////////////////////////////////////////////
+SIMC_XML_DOC* SIMC_XML_Native_Create() {
+	SIMC_XML_DOC* doc = (SIMC_XML_DOC*)SIMC_Allocate(SIMC_Userdata,sizeof(SIMC_XML_DOC));
+	if (!doc) return 0;
+	memset(doc,0,sizeof(SIMC_XML_DOC));
+	doc->backend = SIMC_XML_BACKEND_NATIVE;
+	return doc;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Read whole file into document arena as document data.
+///
+/// Unlike a mapped file, the data does not change if the file is modified while
+/// the document is open.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Native_ReadFile(const char* filename, SIMC_XML_DOC* doc) {
+	FILE* file;
+	long size;
+
+	file = fopen(filename,"rb");
+	if (!file) return SIMC_ERROR_FILE;
+	fseek(file,0,SEEK_END);
+	size = ftell(file);
+	fseek(file,0,SEEK_SET);
+	if (size < 0) {
+		fclose(file);
+		return SIMC_ERROR_FILE;
+	}
+
+	doc->data = (char*)SIMC_XML_Arena_Allocate(&doc->arena,(size_t)size+1);
+	if (!doc->data) {
+		fclose(file);
+		return SIMC_ERROR_INTERNAL;
+	}
+	doc->data_size = fread(doc->data,1,(size_t)size,file);
+	doc->data[doc->data_size] = 0;
+	fclose(file);
+	return SIMC_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Read file into memory (or map it) and parse it in place.
+///
+/// Compressed files are decompressed while they are parsed, with all strings
+/// copied into the document arena.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Native_OpenFile(const char* filename, int mapped, SIMC_XML_DOC** p_doc, SIMC_Callback_XMLSyntaxError* syntaxError, void* userdata) {
+	SIMC_XML_DOC* doc;
+	FILE* file;
+	int compressed;
+	int result;
+	*p_doc = 0;
+
+	file = fopen(filename,"rb");
+	if (!file) return SIMC_ERROR_FILE;
+	compressed = (SIMC_XML_Internal_DetectCompression(file) != SIMC_XML_COMPRESSION_NONE);
+	fclose(file);
+
+	doc = SIMC_XML_Native_Create();
+	if (!doc) return SIMC_ERROR_INTERNAL;
+
+	//Get document data
+	if (compressed) {
+		result = SIMC_OK;
+	} else if (mapped) {
+		result = SIMC_XML_Native_MapFile(filename,doc);
+	} else {
+		result = SIMC_XML_Native_ReadFile(filename,doc);
+	}
+	if (result != SIMC_OK) {
+		SIMC_XML_Native_Close(doc);
+		return result;
+	}
+
+	//Parse document
+	result = SIMC_XML_Native_Parse(doc,filename,compressed,syntaxError,userdata);
+	if (result != SIMC_OK) {
+		SIMC_XML_Native_Close(doc);
+		return result;
+	}
+	*p_doc = doc;
+	return SIMC_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Copy string into document arena and parse it in place.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Native_OpenString(const char* string, SIMC_XML_DOC** p_doc, SIMC_Callback_XMLSyntaxError* syntaxError, void* userdata) {
+	SIMC_XML_DOC* doc;
+	int result;
+	*p_doc = 0;
+
+	doc = SIMC_XML_Native_Create();
+	if (!doc) return SIMC_ERROR_INTERNAL;
+	doc->data_size = strlen(string);
+	doc->data = (char*)SIMC_XML_Native_CopyString(doc,string,doc->data_size);
+	if (!doc->data) {
+		SIMC_XML_Native_Close(doc);
+		return SIMC_ERROR_INTERNAL;
+	}
+
+	result = SIMC_XML_Native_Parse(doc,"[string]",0,syntaxError,userdata);
+	if (result != SIMC_OK) {
+		SIMC_XML_Native_Close(doc);
+		return result;
+	}
+	*p_doc = doc;
+	return SIMC_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Open file mapped into memory and parse it in place.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Native_OpenMapped(const char* filename, SIMC_XML_DOC** p_doc, SIMC_Callback_XMLSyntaxError* syntaxError, void* userdata) {
+	return SIMC_XML_Native_OpenFile(filename,1,p_doc,syntaxError,userdata);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Close natively parsed document.
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_XML_Native_Close(SIMC_XML_DOC* doc) {
+	SIMC_XML_Atom_Destroy(&doc->atoms);
+	SIMC_XML_Arena_Destroy(&doc->arena);
+	if (doc->mapping) {
+#ifdef _WIN32
+		UnmapViewOfFile(doc->mapping);
+#else
+		munmap(doc->mapping,doc->data_size);
+#endif
+	}
+	SIMC_Free(SIMC_Userdata,doc);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Make document immutable and build the element index.
+///
+/// Children of every element are stored contiguously in a single array, which is
+/// filled in breadth-first order: the top-level elements come first and every
+/// element appends its own children when it is reached. Elements with many
+/// attributes which were not indexed yet get an attribute index.
+///
+/// After this call nothing in the document is ever written, so it may be read by
+/// any number of threads at once.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Native_Freeze(SIMC_XML_DOC* doc) {
+	SIMC_XML_NATIVE_ELEMENT** index;
+	SIMC_XML_NATIVE_ELEMENT* element;
+	size_t count = 0;
+	size_t pos, end;
+
+	if (doc->frozen) return SIMC_OK;
+
+	//Count all elements (depth-first walk without recursion)
+	element = doc->root.first_child;
+	while (element) {
+		count++;
+		if (element->first_child) {
+			element = element->first_child;
+		} else {
+			while (element && (!element->next)) {
+				element = element->parent;
+				if (element == &doc->root) element = 0;
+			}
+			if (element) element = element->next;
+		}
+	}
+
+	//Fill index level by level, the index itself is the queue
+	index = (SIMC_XML_NATIVE_ELEMENT**)SIMC_XML_Arena_Allocate(&doc->arena,sizeof(SIMC_XML_NATIVE_ELEMENT*)*(count+1));
+	if (!index) return SIMC_ERROR_INTERNAL;
+
+	end = 0;
+	doc->root.children = index;
+	for (element = doc->root.first_child; element; element = element->next) index[end++] = element;
+	doc->root.child_count = end;
+	for (pos = 0; pos < end; pos++) {
+		SIMC_XML_NATIVE_ELEMENT* child;
+		element = index[pos];
+		element->children = &index[end];
+		for (child = element->first_child; child; child = child->next) index[end++] = child;
+		element->child_count = (size_t)(&index[end] - element->children);
+
+		if ((!element->attribute_index) && (element->attribute_count >= SIMC_XML_ATTRIBUTE_INDEX_THRESHOLD)) {
+			if (SIMC_XML_Native_IndexAttributes(doc,element) != SIMC_OK) return SIMC_ERROR_INTERNAL;
+		}
+	}
+
+	doc->frozen = 1;
+	return SIMC_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Build hash index of element attributes.
+///
+/// Attributes are hashed by their atom pointer. If an attribute name repeats, the
+/// first attribute wins (same as the linear search).
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Native_IndexAttributes(SIMC_XML_DOC* doc, SIMC_XML_NATIVE_ELEMENT* element) {
+	SIMC_XML_NATIVE_ATTRIBUTE* attribute;
+	size_t size = 1;
+
+	while (size < element->attribute_count*2) size *= 2;
+	element->attribute_index = (SIMC_XML_NATIVE_ATTRIBUTE**)
+		SIMC_XML_Arena_Allocate(&doc->arena,sizeof(SIMC_XML_NATIVE_ATTRIBUTE*)*size);
+	if (!element->attribute_index) return SIMC_ERROR_INTERNAL;
+	memset(element->attribute_index,0,sizeof(SIMC_XML_NATIVE_ATTRIBUTE*)*size);
+	element->attribute_index_mask = size-1;
+
+	for (attribute = element->first_attribute; attribute; attribute = attribute->next) {
+		size_t index = SIMC_XML_ATOM_POINTER_HASH(attribute->name.data) & element->attribute_index_mask;
+		while (element->attribute_index[index] &&
+			  (element->attribute_index[index]->name.data != attribute->name.data)) {
+			index = (index + 1) & element->attribute_index_mask;
+		}
+		if (!element->attribute_index[index]) element->attribute_index[index] = attribute;
+	}
+	return SIMC_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Find first element with the given name, starting from (and including) first.
+///
+/// The name is resolved to an atom once, so siblings are compared by pointer. A
+/// name which does not occur anywhere in the document is rejected right away.
+////////////////////////////////////////////////////////////////////////////////
+SIMC_XML_NATIVE_ELEMENT* SIMC_XML_Native_FindElement(SIMC_XML_DOC* doc, SIMC_XML_NATIVE_ELEMENT* first, const char* name) {
+	SIMC_XML_ATOM atom;
+	if (!name) return first;
+
+	atom = SIMC_XML_Atom_Find(&doc->atoms,name,strlen(name));
+	if (!atom) return 0;
+	return SIMC_XML_Native_FindElementAtom(first,atom);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Find first element with the given atom, starting from (and including) first.
+////////////////////////////////////////////////////////////////////////////////
+SIMC_XML_NATIVE_ELEMENT* SIMC_XML_Native_FindElementAtom(SIMC_XML_NATIVE_ELEMENT* first, SIMC_XML_ATOM atom) {
+	SIMC_XML_NATIVE_ELEMENT* element;
+	for (element = first; element; element = element->next) {
+		if (element->name.data == atom) return element;
+	}
+	return 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Find attribute by name.
+////////////////////////////////////////////////////////////////////////////////
+SIMC_XML_NATIVE_ATTRIBUTE* SIMC_XML_Native_FindAttribute(SIMC_XML_DOC* doc, SIMC_XML_NATIVE_ELEMENT* element, const char* name) {
+	SIMC_XML_ATOM atom = SIMC_XML_Atom_Find(&doc->atoms,name,strlen(name));
+	if (!atom) return 0;
+	return SIMC_XML_Native_FindAttributeAtom(element,atom);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Find attribute by atom.
+////////////////////////////////////////////////////////////////////////////////
+SIMC_XML_NATIVE_ATTRIBUTE* SIMC_XML_Native_FindAttributeAtom(SIMC_XML_NATIVE_ELEMENT* element, SIMC_XML_ATOM atom) {
+	SIMC_XML_NATIVE_ATTRIBUTE* attribute;
+	if (element->attribute_index) {
+		size_t index = SIMC_XML_ATOM_POINTER_HASH(atom) & element->attribute_index_mask;
+		while ((attribute = element->attribute_index[index])) {
+			if (attribute->name.data == atom) return attribute;
+			index = (index + 1) & element->attribute_index_mask;
+		}
+		return 0;
+	}
+
+	for (attribute = element->first_attribute; attribute; attribute = attribute->next) {
+		if (attribute->name.data == atom) return attribute;
+	}
+	return 0;
+}
@@ -0,0 +1,562 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file
+////////////////////////////////////////////////////////////////////////////////
+/// Copyright (C) 2012-2015, Black Phoenix
+///
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the GNU Lesser General Public License as published by the Free Software
+/// Foundation; either version 2 of the License, or (at your option) any later
+/// version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+/// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+/// details.
+///
+/// You should have received a copy of the GNU Lesser General Public License along with
+/// this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+/// Place - Suite 330, Boston, MA  02111-1307, USA.
+///
+/// Further information about the GNU Lesser General Public License can also be found on
+/// the world wide web at http://www.gnu.org.
+////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <string.h>
+#include "sim_core.h"
+#include "sim_xml.h"
+
+//Size of the history window (largest DEFLATE match distance)
+#define SIMC_XML_INFLATE_WINDOW		32768
+#define SIMC_XML_INFLATE_WINDOW_MASK	(SIMC_XML_INFLATE_WINDOW-1)
+//Size of compressed input buffer
+#define SIMC_XML_INFLATE_INPUT		65536
+//Codes up to this length are decoded with a single table lookup
+#define SIMC_XML_INFLATE_FAST_BITS	10
+//Longest code in DEFLATE
+#define SIMC_XML_INFLATE_MAX_BITS	15
+
+//Decoder states
+#define SIMC_XML_INFLATE_STATE_HEADER		0	//gzip member header
+#define SIMC_XML_INFLATE_STATE_BLOCK		1	//DEFLATE block header
+#define SIMC_XML_INFLATE_STATE_STORED		2	//Inside uncompressed block
+#define SIMC_XML_INFLATE_STATE_HUFFMAN		3	//Inside compressed block
+#define SIMC_XML_INFLATE_STATE_TRAILER		4	//gzip member trailer
+#define SIMC_XML_INFLATE_STATE_DONE			5
+#define SIMC_XML_INFLATE_STATE_ERROR		6
+
+//Write decompressed byte
+#define SIMC_XML_INFLATE_OUTPUT(inflate,output,count,c) { \
+	(inflate)->window[((inflate)->total++) & SIMC_XML_INFLATE_WINDOW_MASK] = (unsigned char)(c); \
+	(inflate)->crc = (inflate)->crc_table[((inflate)->crc ^ (c)) & 0xFF] ^ ((inflate)->crc >> 8); \
+	(output)[(count)++] = (unsigned char)(c); }
+
+//gzip header flags
+#define SIMC_XML_GZIP_FHCRC		0x02
+#define SIMC_XML_GZIP_FEXTRA	0x04
+#define SIMC_XML_GZIP_FNAME		0x08
+#define SIMC_XML_GZIP_FCOMMENT	0x10
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Internal data structures
+////////////////////////////////////////////////////////////////////////////////
+#ifndef DOXYGEN_INTERNAL_STRUCTS
+typedef struct SIMC_XML_HUFFMAN_TAG {
+	uint16_t fast[1 << SIMC_XML_INFLATE_FAST_BITS];	//Symbol and code length for short codes (0 if code is longer)
+	uint16_t count[SIMC_XML_INFLATE_MAX_BITS+1];	//Number of codes of each length
+	uint16_t symbol[288];							//Symbols ordered by code
+} SIMC_XML_HUFFMAN;
+
+struct SIMC_XML_INFLATE_TAG {
+	FILE* file;
+	unsigned char input[SIMC_XML_INFLATE_INPUT];
+	size_t input_pos;
+	size_t input_end;
+	uint32_t bits;									//Bit buffer (next bit is the lowest one)
+	int bit_count;
+	int padding;									//Zero bytes added to bit buffer past the end of input
+
+	unsigned char window[SIMC_XML_INFLATE_WINDOW];	//Last 32 KB of output
+	uint64_t total;									//Bytes written in current member
+
+	int state;
+	int last_block;
+	size_t stored_left;								//Bytes left in stored block
+	int match_length;								//Bytes left to copy from a match
+	int match_distance;
+	SIMC_XML_HUFFMAN literals;
+	SIMC_XML_HUFFMAN distances;
+
+	uint32_t crc;
+	uint32_t crc_table[256];
+};
+#endif
+
+//Base values and extra bits of length and distance codes
+static const uint16_t SIMC_XML_Inflate_LengthBase[29] = {
+	3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+	35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const uint8_t SIMC_XML_Inflate_LengthExtra[29] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+	3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const uint16_t SIMC_XML_Inflate_DistanceBase[30] = {
+	1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+	257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const uint8_t SIMC_XML_Inflate_DistanceExtra[30] = {
+	0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+	7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+//Order in which code length code lengths are stored
+static const uint8_t SIMC_XML_Inflate_CodeLengthOrder[19] = {
+	16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Make sure bit buffer holds at least count bits (count <= 24).
+///
+/// Past the end of input the buffer is padded with zero bytes, so that short codes
+/// at the very end can be decoded with a fixed-size lookup. Reading padding is
+/// detected when the stream trailer is read.
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_XML_Inflate_Need(SIMC_XML_INFLATE* inflate, int count) {
+	while (inflate->bit_count < count) {
+		uint32_t byte = 0;
+		if (inflate->input_pos == inflate->input_end) {
+			inflate->input_pos = 0;
+			inflate->input_end = fread(inflate->input,1,SIMC_XML_INFLATE_INPUT,inflate->file);
+		}
+		if (inflate->input_pos < inflate->input_end) {
+			byte = inflate->input[inflate->input_pos++];
+		} else {
+			inflate->padding++;
+		}
+		inflate->bits |= byte << inflate->bit_count;
+		inflate->bit_count += 8;
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Read count bits (count <= 24).
+////////////////////////////////////////////////////////////////////////////////
+uint32_t SIMC_XML_Inflate_Bits(SIMC_XML_INFLATE* inflate, int count) {
+	uint32_t value;
+	SIMC_XML_Inflate_Need(inflate,count);
+	value = inflate->bits & ((1U << count) - 1);
+	inflate->bits >>= count;
+	inflate->bit_count -= count;
+	return value;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Read next byte of input (byte-aligned).
+/// @returns Byte value or -1 if input ended
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Inflate_Byte(SIMC_XML_INFLATE* inflate) {
+	SIMC_XML_Inflate_Need(inflate,8);
+	if (inflate->bit_count - 8*inflate->padding < 8) return -1;
+	return (int)SIMC_XML_Inflate_Bits(inflate,8);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Build decoding tables for canonical Huffman code from code lengths.
+/// @returns Error code
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Inflate_Build(SIMC_XML_HUFFMAN* huffman, const uint8_t* lengths, int count) {
+	uint16_t offsets[SIMC_XML_INFLATE_MAX_BITS+2];
+	uint32_t next_code[SIMC_XML_INFLATE_MAX_BITS+1];
+	uint32_t code = 0;
+	int left = 1;
+	int i, length;
+
+	memset(huffman->count,0,sizeof(huffman->count));
+	memset(huffman->fast,0,sizeof(huffman->fast));
+	for (i = 0; i < count; i++) huffman->count[lengths[i]]++;
+	huffman->count[0] = 0;
+
+	//Reject over-subscribed codes (incomplete codes are allowed)
+	for (length = 1; length <= SIMC_XML_INFLATE_MAX_BITS; length++) {
+		left = (left << 1) - huffman->count[length];
+		if (left < 0) return SIMC_ERROR_SYNTAX;
+	}
+
+	//Symbols sorted by code for the slow decoder
+	offsets[1] = 0;
+	for (length = 1; length <= SIMC_XML_INFLATE_MAX_BITS; length++) {
+		offsets[length+1] = offsets[length] + huffman->count[length];
+		next_code[length] = code = (code + huffman->count[length-1]) << 1;
+	}
+	for (i = 0; i < count; i++) {
+		if (lengths[i]) huffman->symbol[offsets[lengths[i]]++] = (uint16_t)i;
+	}
+
+	//Lookup table for short codes (codes are stored bit-reversed)
+	for (i = 0; i < count; i++) {
+		uint32_t reversed = 0;
+		uint32_t value;
+		int bit;
+		length = lengths[i];
+		if ((length == 0) || (length > SIMC_XML_INFLATE_FAST_BITS)) {
+			if (length) next_code[length]++;
+			continue;
+		}
+		value = next_code[length]++;
+		for (bit = 0; bit < length; bit++) reversed |= ((value >> bit) & 1) << (length - 1 - bit);
+		for (; reversed < (1U << SIMC_XML_INFLATE_FAST_BITS); reversed += (1U << length)) {
+			huffman->fast[reversed] = (uint16_t)((i << 4) | length);
+		}
+	}
+	return SIMC_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Decode one symbol.
+/// @returns Symbol or -1 if code is invalid
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Inflate_Decode(SIMC_XML_INFLATE* inflate, SIMC_XML_HUFFMAN* huffman) {
+	int code = 0, first = 0, index = 0;
+	int length;
+	uint16_t entry;
+
+	SIMC_XML_Inflate_Need(inflate,SIMC_XML_INFLATE_FAST_BITS);
+	entry = huffman->fast[inflate->bits & ((1U << SIMC_XML_INFLATE_FAST_BITS) - 1)];
+	if (entry) {
+		inflate->bits >>= entry & 15;
+		inflate->bit_count -= entry & 15;
+		return entry >> 4;
+	}
+
+	//Long code, walk canonical code one bit at a time
+	for (length = 1; length <= SIMC_XML_INFLATE_MAX_BITS; length++) {
+		int count;
+		code |= (int)SIMC_XML_Inflate_Bits(inflate,1);
+		count = huffman->count[length];
+		if (code - count < first) return huffman->symbol[index + (code - first)];
+		index += count;
+		first = (first + count) << 1;
+		code <<= 1;
+	}
+	return -1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Read code tables of a dynamic Huffman block.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Inflate_DynamicTables(SIMC_XML_INFLATE* inflate) {
+	uint8_t lengths[320];
+	int literal_count, distance_count, code_count;
+	int i;
+
+	literal_count = (int)SIMC_XML_Inflate_Bits(inflate,5) + 257;
+	distance_count = (int)SIMC_XML_Inflate_Bits(inflate,5) + 1;
+	code_count = (int)SIMC_XML_Inflate_Bits(inflate,4) + 4;
+	if ((literal_count > 286) || (distance_count > 30)) return SIMC_ERROR_SYNTAX;
+
+	//Code for code lengths
+	memset(lengths,0,19);
+	for (i = 0; i < code_count; i++) {
+		lengths[SIMC_XML_Inflate_CodeLengthOrder[i]] = (uint8_t)SIMC_XML_Inflate_Bits(inflate,3);
+	}
+	if (SIMC_XML_Inflate_Build(&inflate->literals,lengths,19) != SIMC_OK) return SIMC_ERROR_SYNTAX;
+
+	//Literal/length and distance code lengths (one sequence, repeats may cross over)
+	i = 0;
+	while (i < literal_count + distance_count) {
+		int symbol = SIMC_XML_Inflate_Decode(inflate,&inflate->literals);
+		int repeat;
+		uint8_t value = 0;
+		if (symbol < 0) return SIMC_ERROR_SYNTAX;
+		if (symbol < 16) {
+			lengths[i++] = (uint8_t)symbol;
+			continue;
+		}
+		if (symbol == 16) {
+			if (i == 0) return SIMC_ERROR_SYNTAX;
+			value = lengths[i-1];
+			repeat = 3 + (int)SIMC_XML_Inflate_Bits(inflate,2);
+		} else if (symbol == 17) {
+			repeat = 3 + (int)SIMC_XML_Inflate_Bits(inflate,3);
+		} else {
+			repeat = 11 + (int)SIMC_XML_Inflate_Bits(inflate,7);
+		}
+		if (i + repeat > literal_count + distance_count) return SIMC_ERROR_SYNTAX;
+		while (repeat--) lengths[i++] = value;
+	}
+	if (lengths[256] == 0) return SIMC_ERROR_SYNTAX; //No end of block code
+
+	if (SIMC_XML_Inflate_Build(&inflate->literals,lengths,literal_count) != SIMC_OK) return SIMC_ERROR_SYNTAX;
+	if (SIMC_XML_Inflate_Build(&inflate->distances,lengths+literal_count,distance_count) != SIMC_OK) return SIMC_ERROR_SYNTAX;
+	return SIMC_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Set up fixed Huffman code tables.
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_XML_Inflate_FixedTables(SIMC_XML_INFLATE* inflate) {
+	uint8_t lengths[288];
+	int i;
+	for (i = 0;   i < 144; i++) lengths[i] = 8;
+	for (i = 144; i < 256; i++) lengths[i] = 9;
+	for (i = 256; i < 280; i++) lengths[i] = 7;
+	for (i = 280; i < 288; i++) lengths[i] = 8;
+	SIMC_XML_Inflate_Build(&inflate->literals,lengths,288);
+	for (i = 0; i < 30; i++) lengths[i] = 5;
+	SIMC_XML_Inflate_Build(&inflate->distances,lengths,30);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Read gzip member header.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Inflate_Header(SIMC_XML_INFLATE* inflate) {
+	int flags, i, c;
+
+	if ((SIMC_XML_Inflate_Byte(inflate) != 0x1F) ||
+		(SIMC_XML_Inflate_Byte(inflate) != 0x8B) ||
+		(SIMC_XML_Inflate_Byte(inflate) != 8)) return SIMC_ERROR_SYNTAX;
+	flags = SIMC_XML_Inflate_Byte(inflate);
+	if (flags < 0) return SIMC_ERROR_SYNTAX;
+	for (i = 0; i < 6; i++) SIMC_XML_Inflate_Byte(inflate); //Time, extra flags, OS
+
+	if (flags & SIMC_XML_GZIP_FEXTRA) {
+		int length = SIMC_XML_Inflate_Byte(inflate);
+		length |= SIMC_XML_Inflate_Byte(inflate) << 8;
+		if (length < 0) return SIMC_ERROR_SYNTAX;
+		while (length-- > 0) {
+			if (SIMC_XML_Inflate_Byte(inflate) < 0) return SIMC_ERROR_SYNTAX;
+		}
+	}
+	if (flags & SIMC_XML_GZIP_FNAME) {
+		while ((c = SIMC_XML_Inflate_Byte(inflate)) > 0) ;
+		if (c < 0) return SIMC_ERROR_SYNTAX;
+	}
+	if (flags & SIMC_XML_GZIP_FCOMMENT) {
+		while ((c = SIMC_XML_Inflate_Byte(inflate)) > 0) ;
+		if (c < 0) return SIMC_ERROR_SYNTAX;
+	}
+	if (flags & SIMC_XML_GZIP_FHCRC) {
+		SIMC_XML_Inflate_Byte(inflate);
+		if (SIMC_XML_Inflate_Byte(inflate) < 0) return SIMC_ERROR_SYNTAX;
+	}
+
+	inflate->crc = 0xFFFFFFFF;
+	inflate->total = 0;
+	inflate->last_block = 0;
+	return SIMC_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Read gzip member trailer and check CRC and size.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Inflate_Trailer(SIMC_XML_INFLATE* inflate) {
+	uint32_t values[2] = { 0, 0 };
+	int i, j;
+
+	//Trailer starts at byte boundary
+	SIMC_XML_Inflate_Bits(inflate,inflate->bit_count & 7);
+	for (i = 0; i < 2; i++) {
+		for (j = 0; j < 4; j++) {
+			int c = SIMC_XML_Inflate_Byte(inflate);
+			if (c < 0) return SIMC_ERROR_SYNTAX;
+			values[i] |= (uint32_t)c << (8*j);
+		}
+	}
+	if (values[0] != (inflate->crc ^ 0xFFFFFFFF)) return SIMC_ERROR_SYNTAX;
+	if (values[1] != (uint32_t)inflate->total) return SIMC_ERROR_SYNTAX;
+	return SIMC_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Check if more input follows (another gzip member).
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Inflate_HasMoreInput(SIMC_XML_INFLATE* inflate) {
+	SIMC_XML_Inflate_Need(inflate,8);
+	return inflate->bit_count - 8*inflate->padding >= 8;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Decompress next chunk of data (reader for SIMC_XML_Internal_Parse).
+///
+/// Decoding is a state machine which can stop after any output byte, so chunks of
+/// any size can be requested. Only the last 32 KB of output are kept.
+///
+/// @returns Number of bytes decompressed, 0 at end of data, -1 on corrupt data
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Inflate_Read(void* source, char* buffer, int size) {
+	SIMC_XML_INFLATE* inflate = (SIMC_XML_INFLATE*)source;
+	unsigned char* output = (unsigned char*)buffer;
+	int count = 0;
+
+	while ((count < size) && (inflate->state != SIMC_XML_INFLATE_STATE_DONE)) {
+		int error = SIMC_OK;
+
+		switch (inflate->state) {
+			case SIMC_XML_INFLATE_STATE_HEADER:
+				error = SIMC_XML_Inflate_Header(inflate);
+				inflate->state = SIMC_XML_INFLATE_STATE_BLOCK;
+				break;
+			case SIMC_XML_INFLATE_STATE_BLOCK: {
+				int type;
+				if (inflate->last_block) {
+					inflate->state = SIMC_XML_INFLATE_STATE_TRAILER;
+					break;
+				}
+				inflate->last_block = (int)SIMC_XML_Inflate_Bits(inflate,1);
+				type = (int)SIMC_XML_Inflate_Bits(inflate,2);
+				if (type == 0) {
+					uint32_t length, inverse;
+					SIMC_XML_Inflate_Bits(inflate,inflate->bit_count & 7);
+					length = SIMC_XML_Inflate_Bits(inflate,16);
+					inverse = SIMC_XML_Inflate_Bits(inflate,16);
+					if (length != (~inverse & 0xFFFF)) error = SIMC_ERROR_SYNTAX;
+					inflate->stored_left = length;
+					inflate->state = SIMC_XML_INFLATE_STATE_STORED;
+				} else if (type == 1) {
+					SIMC_XML_Inflate_FixedTables(inflate);
+					inflate->state = SIMC_XML_INFLATE_STATE_HUFFMAN;
+				} else if (type == 2) {
+					error = SIMC_XML_Inflate_DynamicTables(inflate);
+					inflate->state = SIMC_XML_INFLATE_STATE_HUFFMAN;
+				} else {
+					error = SIMC_ERROR_SYNTAX;
+				}
+			} break;
+			case SIMC_XML_INFLATE_STATE_STORED:
+				while ((inflate->stored_left > 0) && (count < size)) {
+					int c = SIMC_XML_Inflate_Byte(inflate);
+					if (c < 0) {
+						error = SIMC_ERROR_SYNTAX;
+						break;
+					}
+					SIMC_XML_INFLATE_OUTPUT(inflate,output,count,c);
+					inflate->stored_left--;
+				}
+				if (inflate->stored_left == 0) inflate->state = SIMC_XML_INFLATE_STATE_BLOCK;
+				break;
+			case SIMC_XML_INFLATE_STATE_HUFFMAN:
+				while (count < size) {
+					int symbol, distance;
+
+					//Continue match which did not fit into previous chunk
+					if (inflate->match_length > 0) {
+						while ((inflate->match_length > 0) && (count < size)) {
+							int c = inflate->window[(inflate->total - inflate->match_distance) & SIMC_XML_INFLATE_WINDOW_MASK];
+							SIMC_XML_INFLATE_OUTPUT(inflate,output,count,c);
+							inflate->match_length--;
+						}
+						continue;
+					}
+
+					symbol = SIMC_XML_Inflate_Decode(inflate,&inflate->literals);
+					if (symbol < 0) {
+						error = SIMC_ERROR_SYNTAX;
+						break;
+					} else if (symbol < 256) {
+						SIMC_XML_INFLATE_OUTPUT(inflate,output,count,symbol);
+						continue;
+					} else if (symbol == 256) {
+						inflate->state = SIMC_XML_INFLATE_STATE_BLOCK;
+						break;
+					}
+
+					//Length and distance pair
+					symbol -= 257;
+					if (symbol >= 29) {
+						error = SIMC_ERROR_SYNTAX;
+						break;
+					}
+					inflate->match_length = SIMC_XML_Inflate_LengthBase[symbol] +
+						(int)SIMC_XML_Inflate_Bits(inflate,SIMC_XML_Inflate_LengthExtra[symbol]);
+					distance = SIMC_XML_Inflate_Decode(inflate,&inflate->distances);
+					if ((distance < 0) || (distance >= 30)) {
+						error = SIMC_ERROR_SYNTAX;
+						break;
+					}
+					inflate->match_distance = SIMC_XML_Inflate_DistanceBase[distance] +
+						(int)SIMC_XML_Inflate_Bits(inflate,SIMC_XML_Inflate_DistanceExtra[distance]);
+					if ((uint64_t)inflate->match_distance > inflate->total) {
+						error = SIMC_ERROR_SYNTAX;
+						break;
+					}
+				}
+				break;
+			case SIMC_XML_INFLATE_STATE_TRAILER:
+				//Another gzip member may follow (concatenated .gz files)
+				error = SIMC_XML_Inflate_Trailer(inflate);
+				if (SIMC_XML_Inflate_HasMoreInput(inflate)) {
+					inflate->state = SIMC_XML_INFLATE_STATE_HEADER;
+				} else {
+					inflate->state = SIMC_XML_INFLATE_STATE_DONE;
+				}
+				break;
+			default:
+				return -1;
+		}
+
+		//Input ended in the middle of a member
+		if ((!error) && (inflate->bit_count < 8*inflate->padding) &&
+			(inflate->state != SIMC_XML_INFLATE_STATE_DONE)) {
+			error = SIMC_ERROR_SYNTAX;
+		}
+		if (error) {
+			inflate->state = SIMC_XML_INFLATE_STATE_ERROR;
+			return -1;
+		}
+	}
+	return count;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Start decompressing gzip file.
+////////////////////////////////////////////////////////////////////////////////
+SIMC_XML_INFLATE* SIMC_XML_Inflate_Create(FILE* file) {
+	SIMC_XML_INFLATE* inflate;
+	uint32_t i, j;
+
+	inflate = (SIMC_XML_INFLATE*)SIMC_Allocate(SIMC_Userdata,sizeof(SIMC_XML_INFLATE));
+	if (!inflate) return 0;
+	memset(inflate,0,sizeof(SIMC_XML_INFLATE));
+	inflate->file = file;
+	inflate->state = SIMC_XML_INFLATE_STATE_HEADER;
+
+	for (i = 0; i < 256; i++) {
+		uint32_t crc = i;
+		for (j = 0; j < 8; j++) crc = (crc & 1) ? (0xEDB88320 ^ (crc >> 1)) : (crc >> 1);
+		inflate->crc_table[i] = crc;
+	}
+	return inflate;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Free decompressor state (file is not closed).
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_XML_Inflate_Destroy(SIMC_XML_INFLATE* inflate) {
+	SIMC_Free(SIMC_Userdata,inflate);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Detect compression of a file by its magic bytes (file is rewound).
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Internal_DetectCompression(FILE* file) {
+	unsigned char magic[4] = { 0 };
+	size_t count = fread(magic,1,4,file);
+	fseek(file,0,SEEK_SET);
+
+	if ((count >= 3) && (magic[0] == 0x1F) && (magic[1] == 0x8B) && (magic[2] == 8)) {
+		return SIMC_XML_COMPRESSION_GZIP;
+	}
+	if ((count == 4) && (magic[0] == 0x28) && (magic[1] == 0xB5) && (magic[2] == 0x2F) && (magic[3] == 0xFD)) {
+		return SIMC_XML_COMPRESSION_ZSTD;
+	}
+	return SIMC_XML_COMPRESSION_NONE;
+}
@@ -0,0 +1,293 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file
+////////////////////////////////////////////////////////////////////////////////
+/// Copyright (C) 2012-2015, Black Phoenix
+///
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the GNU Lesser General Public License as published by the Free Software
+/// Foundation; either version 2 of the License, or (at your option) any later
+/// version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+/// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+/// details.
+///
+/// You should have received a copy of the GNU Lesser General Public License along with
+/// this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+/// Place - Suite 330, Boston, MA  02111-1307, USA.
+///
+/// Further information about the GNU Lesser General Public License can also be found on
+/// the world wide web at http://www.gnu.org.
+////////////////////////////////////////////////////////////////////////////////
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "sim_core.h"
+#include "sim_xml.h"
+
+//Eight digits can be converted at once on little-endian machines
+#if defined(_WIN32) || (defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__))
+#	define SIMC_XML_SWAR_DIGITS
+#endif
+
+//Test for a decimal digit without branching on the character range
+#define SIMC_XML_IS_DIGIT(c)	((unsigned char)((c) - '0') < 10)
+#define SIMC_XML_IS_SPACE(c)	(((c) == ' ') || ((c) == '\t') || ((c) == '\n') || ((c) == '\r'))
+
+//Largest integer exactly representable in a double
+#define SIMC_XML_MAX_EXACT_INTEGER	9007199254740992ULL
+
+//Powers of ten exactly representable in a double
+static const double SIMC_XML_Pow10[] = {
+	1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+
+#ifdef SIMC_XML_SWAR_DIGITS
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Check if eight characters are all decimal digits.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Internal_IsEightDigits(uint64_t chars) {
+	return (((chars & 0xF0F0F0F0F0F0F0F0ULL) |
+			(((chars + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) == 0x3333333333333333ULL);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Convert eight decimal digits to a number in three multiplications.
+////////////////////////////////////////////////////////////////////////////////
+uint32_t SIMC_XML_Internal_ParseEightDigits(uint64_t chars) {
+	chars -= 0x3030303030303030ULL;
+	chars = (chars * 10) + (chars >> 8);
+	chars = (((chars & 0x000000FF000000FFULL) * 0x000F424000000064ULL) +
+			(((chars >> 16) & 0x000000FF000000FFULL) * 0x0000271000000001ULL)) >> 32;
+	return (uint32_t)chars;
+}
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Accumulate a run of digits into mantissa.
+///
+/// At most 19 significant digits are accumulated, the number of digits which did
+/// not fit is returned in dropped.
+////////////////////////////////////////////////////////////////////////////////
+const char* SIMC_XML_Internal_ParseDigits(const char* p, const char* end, uint64_t* mantissa, int* digits, int* dropped) {
+	uint64_t m = *mantissa;
+	int n = *digits;
+
+#ifdef SIMC_XML_SWAR_DIGITS
+	while ((end - p >= 8) && (n <= 11)) {
+		uint64_t chars;
+		memcpy(&chars,p,8);
+		if (!SIMC_XML_Internal_IsEightDigits(chars)) break;
+		m = m*100000000ULL + SIMC_XML_Internal_ParseEightDigits(chars);
+		if (m) n += 8;
+		p += 8;
+	}
+#endif
+	while ((p < end) && SIMC_XML_IS_DIGIT(*p)) {
+		if (n < 19) {
+			m = m*10 + (*p - '0');
+			if (m) n++;
+		} else {
+			(*dropped)++;
+		}
+		p++;
+	}
+
+	*mantissa = m;
+	*digits = n;
+	return p;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Parse a floating point number.
+///
+/// Decimal numbers with up to 19 significant digits and exponents within the
+/// range of exactly representable powers of ten are converted with a single
+/// correctly rounded multiplication or division (Clinger's fast path). Everything
+/// else (very long mantissas, large exponents, "inf", "nan", hexadecimal floats)
+/// falls back to strtod(), which requires the string to be null-terminated.
+///
+/// @param[in] p Start of the number (leading whitespace is skipped)
+/// @param[in] end End of the string
+/// @param[out] value Parsed value (0.0 if no number could be read)
+///
+/// @returns Pointer after the last character of the number (p if no number)
+////////////////////////////////////////////////////////////////////////////////
+const char* SIMC_XML_Internal_ParseDouble(const char* p, const char* end, double* value) {
+	const char* start;
+	const char* digits_start;
+	uint64_t mantissa = 0;
+	int digits = 0;
+	int dropped = 0;
+	int exponent = 0;
+	int negative = 0;
+
+	while ((p < end) && SIMC_XML_IS_SPACE(*p)) p++;
+	start = p;
+	if ((p < end) && ((*p == '-') || (*p == '+'))) {
+		negative = (*p == '-');
+		p++;
+	}
+
+	//Integer and fractional part
+	digits_start = p;
+	p = SIMC_XML_Internal_ParseDigits(p,end,&mantissa,&digits,&dropped);
+	exponent = dropped;
+	if ((p < end) && (*p == '.')) {
+		const char* fraction = ++p;
+		int fraction_dropped = 0;
+		p = SIMC_XML_Internal_ParseDigits(p,end,&mantissa,&digits,&fraction_dropped);
+		exponent -= (int)(p - fraction) - fraction_dropped;
+		dropped += fraction_dropped;
+	}
+	if ((p == digits_start) || ((p == digits_start+1) && (*digits_start == '.')) ||
+		((p == digits_start+1) && (*digits_start == '0') && (p < end) && ((*p == 'x') || (*p == 'X')))) {
+		//Not a decimal number, let C library handle special values and hexadecimal numbers
+		char* number_end;
+		*value = strtod(start,&number_end);
+		return (number_end == start) ? start : number_end;
+	}
+
+	//Exponent
+	if ((p < end) && ((*p == 'e') || (*p == 'E'))) {
+		const char* exponent_start = p++;
+		int exponent_negative = 0;
+		int exponent_value = 0;
+		if ((p < end) && ((*p == '-') || (*p == '+'))) {
+			exponent_negative = (*p == '-');
+			p++;
+		}
+		if ((p < end) && SIMC_XML_IS_DIGIT(*p)) {
+			while ((p < end) && SIMC_XML_IS_DIGIT(*p)) {
+				if (exponent_value < 100000) exponent_value = exponent_value*10 + (*p - '0');
+				p++;
+			}
+			exponent += exponent_negative ? -exponent_value : exponent_value;
+		} else {
+			p = exponent_start;
+		}
+	}
+
+	//Fast path
+	if (mantissa == 0) {
+		*value = negative ? -0.0 : 0.0;
+		return p;
+	}
+	if (!dropped) {
+		while ((exponent > 22) && (mantissa < SIMC_XML_MAX_EXACT_INTEGER/10)) {
+			mantissa *= 10;
+			exponent--;
+		}
+		if ((mantissa <= SIMC_XML_MAX_EXACT_INTEGER) && (exponent >= -22) && (exponent <= 22)) {
+			double result = (double)mantissa;
+			if (exponent < 0) {
+				result = result / SIMC_XML_Pow10[-exponent];
+			} else {
+				result = result * SIMC_XML_Pow10[exponent];
+			}
+			*value = negative ? -result : result;
+			return p;
+		}
+	}
+
+	//Slow path
+	*value = strtod(start,0);
+	return p;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Parse a decimal integer (same rules as strtol, but without locale).
+///
+/// Values out of range are clamped to INT_MIN and INT_MAX.
+///
+/// @returns Pointer after the last character of the number (p if no number)
+////////////////////////////////////////////////////////////////////////////////
+const char* SIMC_XML_Internal_ParseInt(const char* p, const char* end, int* value) {
+	const char* start = p;
+	const char* digits_start;
+	uint64_t mantissa = 0;
+	int negative = 0;
+
+	while ((p < end) && SIMC_XML_IS_SPACE(*p)) p++;
+	if ((p < end) && ((*p == '-') || (*p == '+'))) {
+		negative = (*p == '-');
+		p++;
+	}
+
+	digits_start = p;
+#ifdef SIMC_XML_SWAR_DIGITS
+	if (end - p >= 8) {
+		uint64_t chars;
+		memcpy(&chars,p,8);
+		if (SIMC_XML_Internal_IsEightDigits(chars)) {
+			mantissa = SIMC_XML_Internal_ParseEightDigits(chars);
+			p += 8;
+		}
+	}
+#endif
+	while ((p < end) && SIMC_XML_IS_DIGIT(*p)) {
+		//Stop accumulating once the value is out of range of any int
+		if (mantissa <= (uint64_t)INT_MAX+1) mantissa = mantissa*10 + (*p - '0');
+		p++;
+	}
+	if (p == digits_start) {
+		*value = 0;
+		return start;
+	}
+
+	if (negative) {
+		*value = (mantissa > (uint64_t)INT_MAX+1) ? INT_MIN : (int)(-(int64_t)mantissa);
+	} else {
+		*value = (mantissa > (uint64_t)INT_MAX) ? INT_MAX : (int)mantissa;
+	}
+	return p;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Parse whitespace-separated numbers.
+///
+/// Numbers are written into values (up to max_count of them), count receives the
+/// total number of values in the string so that the caller can detect a buffer
+/// which is too small.
+///
+/// @returns Error code
+/// @retval SIMC_OK All values parsed
+/// @retval SIMC_ERROR_SYNTAX Text contains something that is not a number
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Internal_ParseArray(const char* p, const char* end, void* values, int is_double, int max_count, int* count) {
+	int n = 0;
+	while (1) {
+		const char* number_end;
+		double double_value;
+		int int_value;
+
+		while ((p < end) && SIMC_XML_IS_SPACE(*p)) p++;
+		if (p >= end) break;
+
+		if (is_double) {
+			number_end = SIMC_XML_Internal_ParseDouble(p,end,&double_value);
+			if (n < max_count) ((double*)values)[n] = double_value;
+		} else {
+			number_end = SIMC_XML_Internal_ParseInt(p,end,&int_value);
+			if (n < max_count) ((int*)values)[n] = int_value;
+		}
+		if ((number_end == p) || ((number_end < end) && (!SIMC_XML_IS_SPACE(*number_end)))) {
+			*count = n;
+			return SIMC_ERROR_SYNTAX;
+		}
+
+		p = number_end;
+		n++;
+	}
+
+	*count = n;
+	return SIMC_OK;
+}
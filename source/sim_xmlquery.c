@@ -0,0 +1,431 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file
+////////////////////////////////////////////////////////////////////////////////
+/// Copyright (C) 2012-2015, Black Phoenix
+///
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the GNU Lesser General Public License as published by the Free Software
+/// Foundation; either version 2 of the License, or (at your option) any later
+/// version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+/// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+/// details.
+///
+/// You should have received a copy of the GNU Lesser General Public License along with
+/// this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+/// Place - Suite 330, Boston, MA  02111-1307, USA.
+///
+/// Further information about the GNU Lesser General Public License can also be found on
+/// the world wide web at http://www.gnu.org.
+////////////////////////////////////////////////////////////////////////////////
+#include <string.h>
+#include "sim_core.h"
+#include "sim_xml.h"
+
+//Predicate types
+#define SIMC_XML_PREDICATE_HAS_ATTRIBUTE	0	//[@name]
+#define SIMC_XML_PREDICATE_ATTRIBUTE_EQUAL	1	//[@name='value']
+#define SIMC_XML_PREDICATE_INDEX			2	//[n] (1-based)
+
+//Characters allowed in names
+#define SIMC_XML_IS_NAME_START(c)	((((c) >= 'a') && ((c) <= 'z')) || (((c) >= 'A') && ((c) <= 'Z')) || ((c) == '_') || ((c) == ':'))
+#define SIMC_XML_IS_NAME(c)			(SIMC_XML_IS_NAME_START(c) || (((c) >= '0') && ((c) <= '9')) || ((c) == '-') || ((c) == '.'))
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Internal data structures
+////////////////////////////////////////////////////////////////////////////////
+#ifndef DOXYGEN_INTERNAL_STRUCTS
+typedef struct SIMC_XML_QUERY_PREDICATE_TAG {
+	int type;
+	const char* name;					//Attribute name
+	const char* value;					//Attribute value
+	size_t value_length;
+	int index;
+} SIMC_XML_QUERY_PREDICATE;
+
+typedef struct SIMC_XML_QUERY_STEP_TAG {
+	const char* name;					//Element name (null for any element)
+	SIMC_XML_QUERY_PREDICATE* predicates;
+	int predicate_count;
+	int has_index;						//Step has an index predicate (siblings must be counted)
+} SIMC_XML_QUERY_STEP;
+
+typedef struct SIMC_XML_QUERY_STATE_TAG {
+	SIMC_XML_QUERY_STEP* steps;
+	int step_count;
+	int absolute;						//Path starts at the document root
+	const char* attribute;				//Attribute selected by the query (null to select elements)
+	char* strings;						//Storage for all names and values
+} SIMC_XML_QUERY_STATE;
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Copy name from path into query string storage.
+////////////////////////////////////////////////////////////////////////////////
+const char* SIMC_XML_Query_ParseName(const char** p_path, char** p_strings) {
+	const char* path = *p_path;
+	char* name = *p_strings;
+	if (!SIMC_XML_IS_NAME_START(*path)) return 0;
+	while (SIMC_XML_IS_NAME(*path)) *(*p_strings)++ = *path++;
+	*(*p_strings)++ = 0;
+	*p_path = path;
+	return name;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Compile path query.
+///
+/// Path consists of element steps separated by "/", optionally followed by an
+/// attribute name. Each step is an element name (or "*" for any element) which may
+/// be followed by predicates:
+///  - `[@name]` element has the attribute (which may be empty)
+///  - `[@name='value']` element has the attribute and it has the given value (either
+///    quote may be used)
+///  - `[n]` n-th element (starting from 1) which matches the step so far
+///
+/// As in XPath, a missing attribute is different from an empty one: `[@name]` and a
+/// trailing `@name` match elements with `name=""`, `[@name='']` does not match
+/// elements without the attribute.
+///
+/// A path starting with "/" is evaluated from the document root (the first step
+/// matches the root element), otherwise from the element passed into
+/// SIMC_XML_Query_First() or SIMC_XML_Query_All(). For example:
+/// ~~~{.c}
+///		SIMC_XML_QUERY* query;
+///		SIMC_XML_ELEMENT* element;
+///		SIMC_XML_STRING thrust;
+///		SIMC_XML_Query_Compile("vessel/engine[@type='rocket']/@thrust",&query);
+///		SIMC_XML_Query_First(xmldoc,root,query,&element,&thrust);
+///		SIMC_XML_Query_Destroy(query);
+/// ~~~
+///
+/// @param[in] path Path to compile
+/// @param[out] query Compiled query (can be reused with any number of documents)
+///
+/// @returns Error code
+/// @retval SIMC_OK Query compiled
+/// @retval SIMC_ERROR_SYNTAX Path is not valid
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Query_Compile(const char* path, SIMC_XML_QUERY** xmlquery) {
+	SIMC_XML_QUERY_STATE* query;
+	SIMC_XML_QUERY_PREDICATE* predicates;
+	const char* p;
+	char* strings;
+	int max_steps = 1, max_predicates = 0;
+	int total_predicates = 0;
+	int invalid = 0;
+	if (!path) return SIMC_ERROR_INTERNAL;
+	if (!xmlquery) return SIMC_ERROR_INTERNAL;
+	*xmlquery = 0;
+
+	//Upper bound on number of steps and predicates
+	for (p = path; *p; p++) {
+		if (*p == '/') max_steps++;
+		if (*p == '[') max_predicates++;
+	}
+
+	query = (SIMC_XML_QUERY_STATE*)SIMC_Allocate(SIMC_Userdata,sizeof(SIMC_XML_QUERY_STATE));
+	if (!query) return SIMC_ERROR_INTERNAL;
+	memset(query,0,sizeof(SIMC_XML_QUERY_STATE));
+	query->steps = (SIMC_XML_QUERY_STEP*)SIMC_Allocate(SIMC_Userdata,
+		sizeof(SIMC_XML_QUERY_STEP)*max_steps + sizeof(SIMC_XML_QUERY_PREDICATE)*(max_predicates+1));
+	query->strings = (char*)SIMC_Allocate(SIMC_Userdata,strlen(path)*2+2);
+	if ((!query->steps) || (!query->strings)) {
+		SIMC_XML_Query_Destroy((SIMC_XML_QUERY*)query);
+		return SIMC_ERROR_INTERNAL;
+	}
+	predicates = (SIMC_XML_QUERY_PREDICATE*)(query->steps + max_steps);
+	strings = query->strings;
+
+	//Parse steps
+	p = path;
+	if (*p == '/') {
+		query->absolute = 1;
+		p++;
+	}
+	while (1) {
+		SIMC_XML_QUERY_STEP* step;
+
+		//Attribute selector ends the path
+		if (*p == '@') {
+			p++;
+			query->attribute = SIMC_XML_Query_ParseName(&p,&strings);
+			if ((!query->attribute) || (*p) || (query->step_count == 0)) break;
+			*xmlquery = (SIMC_XML_QUERY*)query;
+			return SIMC_OK;
+		}
+
+		step = &query->steps[query->step_count++];
+		memset(step,0,sizeof(SIMC_XML_QUERY_STEP));
+		step->predicates = &predicates[total_predicates];
+		if (*p == '*') {
+			p++;
+		} else {
+			step->name = SIMC_XML_Query_ParseName(&p,&strings);
+			if (!step->name) break;
+		}
+
+		//Predicates
+		while (*p == '[') {
+			SIMC_XML_QUERY_PREDICATE* predicate = &step->predicates[step->predicate_count];
+			memset(predicate,0,sizeof(SIMC_XML_QUERY_PREDICATE));
+			invalid = 1;
+			p++;
+			if (*p == '@') {
+				p++;
+				predicate->type = SIMC_XML_PREDICATE_HAS_ATTRIBUTE;
+				predicate->name = SIMC_XML_Query_ParseName(&p,&strings);
+				if (!predicate->name) break;
+				if (*p == '=') {
+					char quote = *(++p);
+					if ((quote != '\'') && (quote != '"')) break;
+					predicate->type = SIMC_XML_PREDICATE_ATTRIBUTE_EQUAL;
+					predicate->value = strings;
+					p++;
+					while (*p && (*p != quote)) *strings++ = *p++;
+					*strings++ = 0;
+					if (*p != quote) break;
+					predicate->value_length = strings - predicate->value - 1;
+					p++;
+				}
+			} else if ((*p >= '1') && (*p <= '9')) {
+				predicate->type = SIMC_XML_PREDICATE_INDEX;
+				while ((*p >= '0') && (*p <= '9')) predicate->index = predicate->index*10 + (*p++ - '0');
+				step->has_index = 1;
+			} else {
+				break;
+			}
+			if (*p != ']') break;
+			p++;
+			step->predicate_count++;
+			total_predicates++;
+			invalid = 0;
+		}
+		if (invalid) break;
+
+		if (*p == 0) {
+			*xmlquery = (SIMC_XML_QUERY*)query;
+			return SIMC_OK;
+		}
+		if (*p != '/') break;
+		p++;
+	}
+
+	SIMC_XML_Query_Destroy((SIMC_XML_QUERY*)query);
+	return SIMC_ERROR_SYNTAX;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Free compiled query.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Query_Destroy(SIMC_XML_QUERY* xmlquery) {
+	SIMC_XML_QUERY_STATE* query = (SIMC_XML_QUERY_STATE*)xmlquery;
+	if (!query) return SIMC_ERROR_INTERNAL;
+	if (query->steps) SIMC_Free(SIMC_Userdata,query->steps);
+	if (query->strings) SIMC_Free(SIMC_Userdata,query->strings);
+	SIMC_Free(SIMC_Userdata,query);
+	return SIMC_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Check predicates of a step.
+///
+/// Index predicates count candidates which passed all predicates before them, so
+/// they must be checked in order and counters are reset for every new parent.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Query_Match(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* element, SIMC_XML_QUERY_STEP* step,
+						 SIMC_XML_ATOM* predicate_atoms, int* counters) {
+	int i;
+	for (i = 0; i < step->predicate_count; i++) {
+		SIMC_XML_QUERY_PREDICATE* predicate = &step->predicates[i];
+		SIMC_XML_STRING value;
+
+		if (predicate->type == SIMC_XML_PREDICATE_INDEX) {
+			if (++counters[i] != predicate->index) return 0;
+			continue;
+		}
+		if (!SIMC_XML_Internal_FindAttributeAtom(xmldoc,element,predicate_atoms[i],&value)) return 0;
+		if (predicate->type == SIMC_XML_PREDICATE_ATTRIBUTE_EQUAL) {
+			if ((value.length != predicate->value_length) ||
+				(memcmp(value.data,predicate->value,value.length) != 0)) return 0;
+		}
+	}
+	return 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Evaluate query in one depth-first pass.
+///
+/// Stores up to max_count matches, count receives the total number of matches
+/// (unless first_only is set, in which case evaluation stops at the first match).
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Query_Evaluate(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, SIMC_XML_QUERY_STATE* query,
+							SIMC_XML_ELEMENT** elements, SIMC_XML_STRING* values, int max_count, int* count, int first_only) {
+	SIMC_XML_QUERY_PREDICATE* first_predicate = query->steps[0].predicates;
+	SIMC_XML_ATOM attribute_atom = 0;
+	SIMC_XML_ATOM* step_atoms;
+	SIMC_XML_ATOM* predicate_atoms;
+	SIMC_XML_ELEMENT** parents;
+	SIMC_XML_ELEMENT** cursors;
+	int* counters;
+	void* memory;
+	int total_predicates = 0;
+	int depth, i;
+	int found = 0;
+	*count = 0;
+
+	//State for every step
+	for (i = 0; i < query->step_count; i++) total_predicates += query->steps[i].predicate_count;
+	memory = SIMC_Allocate(SIMC_Userdata,(sizeof(SIMC_XML_ATOM) + sizeof(SIMC_XML_ELEMENT*)*2)*query->step_count +
+								(sizeof(SIMC_XML_ATOM) + sizeof(int))*(total_predicates+1));
+	if (!memory) return SIMC_ERROR_INTERNAL;
+	parents = (SIMC_XML_ELEMENT**)memory;
+	cursors = parents + query->step_count;
+	step_atoms = (SIMC_XML_ATOM*)(cursors + query->step_count);
+	predicate_atoms = step_atoms + query->step_count;
+	counters = (int*)(predicate_atoms + total_predicates + 1);
+
+	//Resolve names to atoms of this document (a name missing from the document never matches)
+	for (i = 0; i < query->step_count; i++) {
+		SIMC_XML_QUERY_STEP* step = &query->steps[i];
+		int j;
+
+		step_atoms[i] = 0;
+		if (step->name) {
+			SIMC_XML_GetAtom(xmldoc,step->name,&step_atoms[i]);
+			if (!step_atoms[i]) break;
+		}
+		for (j = 0; j < step->predicate_count; j++) {
+			SIMC_XML_ATOM* atom = &predicate_atoms[step->predicates - first_predicate + j];
+			*atom = 0;
+			if (step->predicates[j].name) SIMC_XML_GetAtom(xmldoc,step->predicates[j].name,atom);
+		}
+	}
+	if (query->attribute) SIMC_XML_GetAtom(xmldoc,query->attribute,&attribute_atom);
+	if ((i < query->step_count) || (query->attribute && (!attribute_atom))) {
+		SIMC_Free(SIMC_Userdata,memory);
+		return SIMC_OK;
+	}
+
+	//Walk the document
+	depth = 0;
+	parents[0] = xmlelement;
+	cursors[0] = 0;
+	memset(counters,0,sizeof(int)*query->steps[0].predicate_count);
+	while (depth >= 0) {
+		SIMC_XML_QUERY_STEP* step = &query->steps[depth];
+		size_t predicate_index = step->predicates - first_predicate;
+		SIMC_XML_ELEMENT* element;
+
+		//Next candidate for this step
+		if (query->absolute && (depth == 0)) {
+			SIMC_XML_STRING name;
+			element = cursors[0] ? 0 : SIMC_XML_Internal_GetDocumentElement(xmldoc);
+			if (element && step->name && ((SIMC_XML_GetNameView(xmldoc,element,&name) != SIMC_OK) ||
+				(strcmp(name.data,step->name) != 0))) {
+				element = 0;
+			}
+			cursors[0] = element;
+		} else if (step_atoms[depth]) {
+			SIMC_XML_IterateAtom(xmldoc,parents[depth],&cursors[depth],step_atoms[depth]);
+		} else {
+			SIMC_XML_STRING name;
+			do {
+				SIMC_XML_Iterate(xmldoc,parents[depth],&cursors[depth],0);
+			} while (cursors[depth] && (SIMC_XML_GetNameView(xmldoc,cursors[depth],&name) != SIMC_OK));
+		}
+		element = cursors[depth];
+		if (!element) {
+			depth--;
+			continue;
+		}
+		if (!SIMC_XML_Query_Match(xmldoc,element,step,&predicate_atoms[predicate_index],&counters[predicate_index])) continue;
+
+		//Last step selects element (or its attribute)
+		if (depth == query->step_count-1) {
+			SIMC_XML_STRING value = { "", 0 };
+			if (attribute_atom && (!SIMC_XML_Internal_FindAttributeAtom(xmldoc,element,attribute_atom,&value))) continue;
+			if (found < max_count) {
+				if (elements) elements[found] = element;
+				if (values) values[found] = value;
+			}
+			found++;
+			if (first_only) break;
+			continue;
+		}
+
+		//Descend into element
+		depth++;
+		parents[depth] = element;
+		cursors[depth] = 0;
+		memset(&counters[query->steps[depth].predicates - first_predicate],0,sizeof(int)*query->steps[depth].predicate_count);
+	}
+
+	SIMC_Free(SIMC_Userdata,memory);
+	*count = found;
+	return SIMC_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Find first element (or attribute) matching the query.
+///
+/// @param[in] xmldoc Document
+/// @param[in] xmlelement Element relative paths start from (ignored for absolute paths)
+/// @param[in] xmlquery Compiled query
+/// @param[out] xmlresult First matching element (null if nothing matched)
+/// @param[out] value Value of the selected attribute (empty if query selects elements, may be null)
+///
+/// @returns Error code
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Query_First(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, SIMC_XML_QUERY* xmlquery,
+						 SIMC_XML_ELEMENT** xmlresult, SIMC_XML_STRING* value) {
+	SIMC_XML_QUERY_STATE* query = (SIMC_XML_QUERY_STATE*)xmlquery;
+	SIMC_XML_STRING empty = { "", 0 };
+	int count;
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+	if (!query) return SIMC_ERROR_INTERNAL;
+	if (!xmlresult) return SIMC_ERROR_INTERNAL;
+	if ((!xmlelement) && (!query->absolute)) return SIMC_ERROR_INTERNAL;
+
+	*xmlresult = 0;
+	if (value) *value = empty;
+	return SIMC_XML_Query_Evaluate(xmldoc,xmlelement,query,xmlresult,value,1,&count,1);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Find all elements (or attributes) matching the query.
+///
+/// Matches are returned in document order. Up to max_count of them are stored,
+/// count receives the total number of matches (so the required array size can be
+/// found by calling with max_count set to zero).
+///
+/// @param[in] xmldoc Document
+/// @param[in] xmlelement Element relative paths start from (ignored for absolute paths)
+/// @param[in] xmlquery Compiled query
+/// @param[out] xmlresults Matching elements (may be null)
+/// @param[out] values Values of the selected attribute (may be null)
+/// @param[in] max_count Size of the arrays
+/// @param[out] count Total number of matches
+///
+/// @returns Error code
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Query_All(SIMC_XML_DOCUMENT* xmldoc, SIMC_XML_ELEMENT* xmlelement, SIMC_XML_QUERY* xmlquery,
+					   SIMC_XML_ELEMENT** xmlresults, SIMC_XML_STRING* values, int max_count, int* count) {
+	SIMC_XML_QUERY_STATE* query = (SIMC_XML_QUERY_STATE*)xmlquery;
+	if (!xmldoc) return SIMC_ERROR_INTERNAL;
+	if (!query) return SIMC_ERROR_INTERNAL;
+	if (!count) return SIMC_ERROR_INTERNAL;
+	if ((!xmlelement) && (!query->absolute)) return SIMC_ERROR_INTERNAL;
+
+	return SIMC_XML_Query_Evaluate(xmldoc,xmlelement,query,xmlresults,values,max_count,count,0);
+}
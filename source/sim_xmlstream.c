@@ -0,0 +1,779 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file
+////////////////////////////////////////////////////////////////////////////////
+/// Copyright (C) 2012-2015, Black Phoenix
+///
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the GNU Lesser General Public License as published by the Free Software
+/// Foundation; either version 2 of the License, or (at your option) any later
+/// version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+/// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+/// details.
+///
+/// You should have received a copy of the GNU Lesser General Public License along with
+/// this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+/// Place - Suite 330, Boston, MA  02111-1307, USA.
+///
+/// Further information about the GNU Lesser General Public License can also be found on
+/// the world wide web at http://www.gnu.org.
+////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <string.h>
+#include "sim_core.h"
+#include "sim_xml.h"
+
+//Initial size of the sliding window used for streaming
+#define SIMC_XML_STREAM_WINDOW	65536
+
+//Markup unit types
+#define SIMC_XML_UNIT_TEXT		0
+#define SIMC_XML_UNIT_ELEMENT	1
+#define SIMC_XML_UNIT_END		2
+#define SIMC_XML_UNIT_COMMENT	3
+#define SIMC_XML_UNIT_CDATA		4
+#define SIMC_XML_UNIT_PI		5
+#define SIMC_XML_UNIT_DOCTYPE	6
+
+//Whitespace test
+#define SIMC_XML_IS_SPACE(c)	(((c) == ' ') || ((c) == '\t') || ((c) == '\n') || ((c) == '\r'))
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Internal data structures
+////////////////////////////////////////////////////////////////////////////////
+#ifndef DOXYGEN_INTERNAL_STRUCTS
+typedef struct SIMC_XML_PARSER_TAG {
+	char* buffer;						//Start of data
+	char* pos;							//Start of next unparsed markup unit
+	char* end;							//End of data
+	size_t size;						//Size of the window (streaming only)
+	int eof;							//No more data can be read
+	int line;							//Current line number
+	int lt_pending;						//Character at pos is '<' overwritten by text terminator
+	int error;							//Internal error (out of memory)
+
+	SIMC_XML_READ_FUNCTION* read;		//Input reader (null when parsing in place)
+	void* source;						//Reader state
+
+	char* stack;						//Names of all open elements
+	size_t stack_size;
+	size_t stack_used;
+	size_t* stack_offsets;				//Offset of each name in stack
+	int depth;
+	int max_depth;
+
+	const char* filename;
+	SIMC_XML_STREAM_CALLBACKS* callbacks;
+	void* userdata;
+} SIMC_XML_PARSER;
+
+typedef struct SIMC_XML_STRING_SOURCE_TAG {
+	const char* data;
+	size_t left;
+} SIMC_XML_STRING_SOURCE;
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Report syntax error.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Parser_Error(SIMC_XML_PARSER* parser, const char* message, const char* detail) {
+	char errorText[8192];
+	if (!parser->callbacks->OnSyntaxError) return SIMC_ERROR_SYNTAX;
+
+	snprintf(errorText,8191,"%s:%d %s%s",parser->filename,parser->line,message,detail ? detail : "");
+	errorText[8191] = 0;
+	parser->callbacks->OnSyntaxError(parser->userdata,errorText);
+	return SIMC_ERROR_SYNTAX;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Read more data into the window, keeping everything starting from pos.
+/// @returns 1 if more data is available, 0 if end of input, negative on read error
+///          or if out of memory (parser->error is set)
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Parser_Refill(SIMC_XML_PARSER* parser) {
+	size_t keep;
+	int count;
+	if ((!parser->read) || (parser->eof)) return 0;
+
+	//Move remaining data to the start of the window
+	keep = parser->end - parser->pos;
+	if (parser->pos != parser->buffer) {
+		memmove(parser->buffer,parser->pos,keep);
+		parser->pos = parser->buffer;
+		parser->end = parser->buffer + keep;
+	}
+
+	//Grow window if a single unit does not fit into it
+	if (keep == parser->size) {
+		char* new_buffer = (char*)SIMC_Allocate(SIMC_Userdata,parser->size*2+1);
+		if (!new_buffer) {
+			parser->error = SIMC_ERROR_INTERNAL;
+			return -1;
+		}
+		memcpy(new_buffer,parser->buffer,keep);
+		SIMC_Free(SIMC_Userdata,parser->buffer);
+
+		parser->size *= 2;
+		parser->buffer = new_buffer;
+		parser->pos = new_buffer;
+		parser->end = new_buffer + keep;
+	}
+
+	//Read next chunk
+	count = parser->read(parser->source,parser->end,
+		(parser->size - keep > 0x40000000) ? 0x40000000 : (int)(parser->size - keep));
+	if (count <= 0) {
+		parser->eof = 1;
+		return count;
+	}
+	parser->end += count;
+	return 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Find a string in the data.
+////////////////////////////////////////////////////////////////////////////////
+char* SIMC_XML_Parser_Find(char* start, char* end, const char* str, size_t length) {
+	while (start + length <= end) {
+		start = (char*)memchr(start,str[0],end-start);
+		if ((!start) || (start + length > end)) return 0;
+		if (memcmp(start,str,length) == 0) return start;
+		start++;
+	}
+	return 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Find the end of the next markup unit.
+///
+/// Markup unit is a tag, a run of text, a comment, a CDATA section, a processing
+/// instruction or a document type declaration. The entire unit is brought into the
+/// window before it is parsed, so that all pointers into it remain valid while it
+/// is being processed.
+///
+/// @returns 1 if a unit is available, 0 at end of input or on internal error
+///          (parser->error is set), syntax error code otherwise
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Parser_NextUnit(SIMC_XML_PARSER* parser, int* type, char** unit_end) {
+	while (1) {
+		char* pos = parser->pos;
+		char* end = parser->end;
+		char* found = 0;
+		size_t available = end - pos;
+		int result;
+
+		if (available == 0) {
+			result = SIMC_XML_Parser_Refill(parser);
+			if (result < 0) return parser->error ? 0 : SIMC_XML_Parser_Error(parser,"Error reading input",0);
+			if (result == 0) return 0;
+			continue;
+		}
+
+		//Find end of the unit
+		if ((*pos == '<') || (parser->lt_pending)) {
+			int complete = 1;
+			if (available < 2) {
+				complete = 0;
+			} else if (pos[1] == '/') {
+				*type = SIMC_XML_UNIT_END;
+				found = (char*)memchr(pos+2,'>',end-pos-2);
+			} else if (pos[1] == '?') {
+				*type = SIMC_XML_UNIT_PI;
+				found = SIMC_XML_Parser_Find(pos+2,end,"?>",2);
+				if (found) found++;
+			} else if (pos[1] == '!') {
+				size_t prefix = available-1; //Bytes after '<' (which may be overwritten)
+				if ((!parser->eof) &&
+					(((prefix < 3) && (memcmp(pos+1,"!--",prefix) == 0)) ||
+					 ((prefix < 8) && (memcmp(pos+1,"![CDATA[",prefix) == 0)))) {
+					complete = 0; //Not enough data to tell comment or CDATA from declaration
+				} else if ((prefix >= 3) && (memcmp(pos+1,"!--",3) == 0)) {
+					*type = SIMC_XML_UNIT_COMMENT;
+					found = SIMC_XML_Parser_Find(pos+4,end,"-->",3);
+					if (found) found += 2;
+				} else if ((prefix >= 8) && (memcmp(pos+1,"![CDATA[",8) == 0)) {
+					*type = SIMC_XML_UNIT_CDATA;
+					found = SIMC_XML_Parser_Find(pos+9,end,"]]>",3);
+					if (found) found += 2;
+				} else {
+					int brackets = 0;
+					*type = SIMC_XML_UNIT_DOCTYPE;
+					for (found = pos+2; found < end; found++) {
+						if (*found == '[') brackets++;
+						if (*found == ']') brackets--;
+						if ((*found == '>') && (brackets <= 0)) break;
+					}
+					if (found == end) found = 0;
+				}
+			} else {
+				char quote = 0;
+				*type = SIMC_XML_UNIT_ELEMENT;
+				for (found = pos+1; found < end; found++) {
+					if (quote) {
+						if (*found == quote) quote = 0;
+					} else if ((*found == '"') || (*found == '\'')) {
+						quote = *found;
+					} else if (*found == '>') {
+						break;
+					}
+				}
+				if (found == end) found = 0;
+			}
+
+			if (complete && found) {
+				*unit_end = found;
+				return 1;
+			}
+		} else {
+			*type = SIMC_XML_UNIT_TEXT;
+			found = (char*)memchr(pos,'<',available);
+			if (found) {
+				*unit_end = found;
+				return 1;
+			}
+			if (parser->eof) {
+				*unit_end = end;
+				return 1;
+			}
+		}
+
+		//Unit is not complete yet
+		result = SIMC_XML_Parser_Refill(parser);
+		if (result < 0) return parser->error ? 0 : SIMC_XML_Parser_Error(parser,"Error reading input",0);
+		if ((result == 0) && ((*parser->pos == '<') || (parser->lt_pending))) {
+			return SIMC_XML_Parser_Error(parser,"Unexpected end of file",0);
+		}
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Write a unicode code point as UTF-8.
+////////////////////////////////////////////////////////////////////////////////
+char* SIMC_XML_Parser_WriteUTF8(char* out, unsigned int code) {
+	if (code < 0x80) {
+		*out++ = (char)code;
+	} else if (code < 0x800) {
+		*out++ = (char)(0xC0 | (code >> 6));
+		*out++ = (char)(0x80 | (code & 0x3F));
+	} else if (code < 0x10000) {
+		*out++ = (char)(0xE0 | (code >> 12));
+		*out++ = (char)(0x80 | ((code >> 6) & 0x3F));
+		*out++ = (char)(0x80 | (code & 0x3F));
+	} else {
+		*out++ = (char)(0xF0 | (code >> 18));
+		*out++ = (char)(0x80 | ((code >> 12) & 0x3F));
+		*out++ = (char)(0x80 | ((code >> 6) & 0x3F));
+		*out++ = (char)(0x80 | (code & 0x3F));
+	}
+	return out;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Decode a single entity at in (points to '&').
+///
+/// Unknown entities are kept as is. Decoded text is never longer than the entity,
+/// so decoding is done in place.
+///
+/// @returns Pointer after the entity in input
+////////////////////////////////////////////////////////////////////////////////
+char* SIMC_XML_Parser_DecodeEntity(char* in, char* end, char** p_out) {
+	char* out = *p_out;
+	char* semicolon = (char*)memchr(in,';',(end - in > 12) ? 12 : end - in);
+	if (semicolon) {
+		size_t length = semicolon - in - 1;
+		char* name = in + 1;
+		int known = 1;
+
+		if ((length == 3) && (memcmp(name,"amp",3) == 0))		*out++ = '&';
+		else if ((length == 2) && (memcmp(name,"lt",2) == 0))	*out++ = '<';
+		else if ((length == 2) && (memcmp(name,"gt",2) == 0))	*out++ = '>';
+		else if ((length == 4) && (memcmp(name,"quot",4) == 0))	*out++ = '"';
+		else if ((length == 4) && (memcmp(name,"apos",4) == 0))	*out++ = '\'';
+		else if ((length > 1) && (name[0] == '#')) {
+			unsigned int code = 0;
+			char* digit = name+1;
+			if ((*digit == 'x') || (*digit == 'X')) {
+				for (digit++; digit < semicolon; digit++) {
+					if ((*digit >= '0') && (*digit <= '9'))			code = code*16 + (*digit - '0');
+					else if ((*digit >= 'a') && (*digit <= 'f'))	code = code*16 + (*digit - 'a' + 10);
+					else if ((*digit >= 'A') && (*digit <= 'F'))	code = code*16 + (*digit - 'A' + 10);
+					else break;
+				}
+			} else {
+				for (; digit < semicolon; digit++) {
+					if ((*digit >= '0') && (*digit <= '9'))			code = code*10 + (*digit - '0');
+					else break;
+				}
+			}
+			if ((digit == semicolon) && (code > 0) && (code <= 0x10FFFF)) {
+				out = SIMC_XML_Parser_WriteUTF8(out,code);
+			} else {
+				known = 0;
+			}
+		} else {
+			known = 0;
+		}
+
+		if (known) {
+			*p_out = out;
+			return semicolon+1;
+		}
+	}
+
+	*out++ = *in;
+	*p_out = out;
+	return in+1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Decode entities in place.
+/// @returns New end of string
+////////////////////////////////////////////////////////////////////////////////
+char* SIMC_XML_Parser_Decode(char* start, char* end) {
+	char* in = (char*)memchr(start,'&',end-start);
+	char* out;
+	if (!in) return end;
+
+	out = in;
+	while (in < end) {
+		if (*in == '&') {
+			in = SIMC_XML_Parser_DecodeEntity(in,end,&out);
+		} else {
+			*out++ = *in++;
+		}
+	}
+	return out;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Condense whitespace and decode entities in place (same rules as TinyXML).
+/// @returns New end of string
+////////////////////////////////////////////////////////////////////////////////
+char* SIMC_XML_Parser_DecodeText(char* start, char* end) {
+	char* in = start;
+	char* out = start;
+	int space = 0;
+
+	while ((in < end) && SIMC_XML_IS_SPACE(*in)) in++;
+	while (in < end) {
+		if (SIMC_XML_IS_SPACE(*in)) {
+			space = 1;
+			in++;
+		} else {
+			if (space) *out++ = ' ';
+			space = 0;
+			if (*in == '&') {
+				in = SIMC_XML_Parser_DecodeEntity(in,end,&out);
+			} else {
+				*out++ = *in++;
+			}
+		}
+	}
+	return out;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Push name of an open element.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Parser_Push(SIMC_XML_PARSER* parser, const char* name, size_t length) {
+	if (parser->depth == parser->max_depth) {
+		size_t* new_offsets = (size_t*)SIMC_Allocate(SIMC_Userdata,sizeof(size_t)*parser->max_depth*2);
+		if (!new_offsets) return SIMC_ERROR_INTERNAL;
+		memcpy(new_offsets,parser->stack_offsets,sizeof(size_t)*parser->max_depth);
+		SIMC_Free(SIMC_Userdata,parser->stack_offsets);
+		parser->stack_offsets = new_offsets;
+		parser->max_depth *= 2;
+	}
+	while (parser->stack_used + length + 1 > parser->stack_size) {
+		char* new_stack = (char*)SIMC_Allocate(SIMC_Userdata,parser->stack_size*2);
+		if (!new_stack) return SIMC_ERROR_INTERNAL;
+		memcpy(new_stack,parser->stack,parser->stack_used);
+		SIMC_Free(SIMC_Userdata,parser->stack);
+		parser->stack = new_stack;
+		parser->stack_size *= 2;
+	}
+
+	parser->stack_offsets[parser->depth++] = parser->stack_used;
+	memcpy(parser->stack + parser->stack_used,name,length);
+	parser->stack_used += length;
+	parser->stack[parser->stack_used++] = 0;
+	return SIMC_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Parse element start tag (unit from pos to '>' at unit_end).
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Parser_Element(SIMC_XML_PARSER* parser, char* unit_end) {
+	SIMC_XML_STREAM_CALLBACKS* callbacks = parser->callbacks;
+	char* limit = unit_end;
+	char* name = parser->pos+1;
+	char* p = name;
+	size_t name_length;
+	int self_closing = 0;
+	int result;
+
+	//Check for empty element
+	if (unit_end[-1] == '/') {
+		self_closing = 1;
+		limit = unit_end-1;
+	}
+
+	//Element name
+	while ((p < limit) && (!SIMC_XML_IS_SPACE(*p)) && (*p != '/')) p++;
+	name_length = p - name;
+	if (name_length == 0) return SIMC_XML_Parser_Error(parser,"Error reading element name",0);
+	if (p < limit) p++; //Skip first whitespace
+	name[name_length] = 0;
+
+	if (!self_closing) {
+		result = SIMC_XML_Parser_Push(parser,name,name_length);
+		if (result != SIMC_OK) return result;
+	}
+	if (callbacks->OnStartElement) {
+		result = callbacks->OnStartElement(parser->userdata,name,name_length);
+		if (result != SIMC_OK) return result;
+	}
+
+	//Attributes
+	while (1) {
+		char *attr_name, *attr_value, *value_end;
+		size_t attr_name_length;
+		char quote;
+
+		while ((p < limit) && SIMC_XML_IS_SPACE(*p)) p++;
+		if (p >= limit) break;
+
+		attr_name = p;
+		while ((p < limit) && (!SIMC_XML_IS_SPACE(*p)) && (*p != '=')) p++;
+		attr_name_length = p - attr_name;
+		while ((p < limit) && SIMC_XML_IS_SPACE(*p)) p++;
+		if ((p >= limit) || (*p != '=') || (attr_name_length == 0)) {
+			return SIMC_XML_Parser_Error(parser,"Error reading attributes in <",name);
+		}
+		p++;
+		while ((p < limit) && SIMC_XML_IS_SPACE(*p)) p++;
+		if ((p >= limit) || ((*p != '"') && (*p != '\''))) {
+			return SIMC_XML_Parser_Error(parser,"Error reading attributes in <",name);
+		}
+		quote = *p++;
+		attr_value = p;
+		value_end = (char*)memchr(p,quote,limit-p);
+		if (!value_end) return SIMC_XML_Parser_Error(parser,"Error reading attributes in <",name);
+		p = value_end+1;
+
+		attr_name[attr_name_length] = 0;
+		value_end = SIMC_XML_Parser_Decode(attr_value,value_end);
+		*value_end = 0;
+		if (callbacks->OnAttribute) {
+			result = callbacks->OnAttribute(parser->userdata,attr_name,attr_name_length,attr_value,value_end-attr_value);
+			if (result != SIMC_OK) return result;
+		}
+	}
+
+	if (self_closing && callbacks->OnEndElement) {
+		result = callbacks->OnEndElement(parser->userdata,name,name_length);
+		if (result != SIMC_OK) return result;
+	}
+	return SIMC_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Parse element end tag (unit from pos to '>' at unit_end).
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Parser_EndElement(SIMC_XML_PARSER* parser, char* unit_end) {
+	char* name = parser->pos+2;
+	char* p = name;
+	char* open_name;
+	size_t name_length;
+
+	while ((p < unit_end) && (!SIMC_XML_IS_SPACE(*p))) p++;
+	name_length = p - name;
+	*p = 0;
+
+	if (parser->depth == 0) return SIMC_XML_Parser_Error(parser,"Unexpected end tag </",name);
+	open_name = parser->stack + parser->stack_offsets[parser->depth-1];
+	if ((strlen(open_name) != name_length) || (memcmp(open_name,name,name_length) != 0)) {
+		return SIMC_XML_Parser_Error(parser,"Mismatched end tag </",name);
+	}
+	parser->depth--;
+	parser->stack_used = parser->stack_offsets[parser->depth];
+
+	if (parser->callbacks->OnEndElement) {
+		return parser->callbacks->OnEndElement(parser->userdata,name,name_length);
+	}
+	return SIMC_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Parse XML.
+///
+/// If reader function is not specified, the buffer is parsed in place: all names,
+/// values and text passed to the callbacks point into the buffer, are null-terminated
+/// and remain valid as long as the buffer exists. The buffer is modified during
+/// parsing.
+///
+/// If reader function is specified, the data is read through a sliding window. All
+/// strings passed into callbacks are only valid until the callback returns.
+///
+/// @param[in] buffer Data to parse in place (ignored when reading from a reader)
+/// @param[in] size Size of the data
+/// @param[in] read Function that reads next chunk of data (may be null)
+/// @param[in] source Reader state
+/// @param[in] filename Name used in syntax error messages
+/// @param[in] callbacks Parser event callbacks
+/// @param[in] userdata Userdata passed into every callback
+///
+/// @returns Error code, or first non-zero value returned by a callback
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Internal_Parse(char* buffer, size_t size, SIMC_XML_READ_FUNCTION* read, void* source,
+							const char* filename, SIMC_XML_STREAM_CALLBACKS* callbacks, void* userdata) {
+	SIMC_XML_PARSER parser = { 0 };
+	int result = SIMC_OK;
+
+	parser.line = 1;
+	parser.read = read;
+	parser.source = source;
+	parser.filename = filename;
+	parser.callbacks = callbacks;
+	parser.userdata = userdata;
+	if (read) {
+		parser.size = SIMC_XML_STREAM_WINDOW;
+		parser.buffer = (char*)SIMC_Allocate(SIMC_Userdata,parser.size+1);
+		parser.pos = parser.buffer;
+		parser.end = parser.buffer;
+	} else {
+		parser.buffer = buffer;
+		parser.pos = buffer;
+		parser.end = buffer + size;
+		parser.eof = 1;
+	}
+
+	parser.stack_size = 1024;
+	parser.stack = (char*)SIMC_Allocate(SIMC_Userdata,parser.stack_size);
+	parser.max_depth = 64;
+	parser.stack_offsets = (size_t*)SIMC_Allocate(SIMC_Userdata,sizeof(size_t)*parser.max_depth);
+	if ((read && (!parser.buffer)) || (!parser.stack) || (!parser.stack_offsets)) {
+		if (read && parser.buffer) SIMC_Free(SIMC_Userdata,parser.buffer);
+		if (parser.stack) SIMC_Free(SIMC_Userdata,parser.stack);
+		if (parser.stack_offsets) SIMC_Free(SIMC_Userdata,parser.stack_offsets);
+		return SIMC_ERROR_INTERNAL;
+	}
+
+	while (result == SIMC_OK) {
+		char* unit_end;
+		char* p;
+		int type;
+
+		//Get next markup unit
+		result = SIMC_XML_Parser_NextUnit(&parser,&type,&unit_end);
+		if (result == 0) {
+			result = parser.error;
+			break;
+		} else if (result != 1) {
+			break;
+		}
+		result = SIMC_OK;
+
+		//Count lines for error messages
+		for (p = parser.pos; (p = (char*)memchr(p,'\n',unit_end-p)) != 0; p++) parser.line++;
+
+		//Parse the unit
+		switch (type) {
+			case SIMC_XML_UNIT_TEXT:
+			case SIMC_XML_UNIT_CDATA: {
+				char* text = parser.pos;
+				char* text_end;
+				if (parser.depth == 0) break; //Ignore text outside of elements
+
+				if (type == SIMC_XML_UNIT_CDATA) {
+					text += 9;
+					text_end = unit_end-2;
+				} else {
+					text_end = SIMC_XML_Parser_DecodeText(text,unit_end);
+				}
+				if (text_end == text) break;
+				if (text_end == parser.end) {
+					result = SIMC_XML_Parser_Error(&parser,"Unexpected end of file",0);
+					break;
+				}
+
+				*text_end = 0;
+				if ((type == SIMC_XML_UNIT_TEXT) && (text_end == unit_end)) {
+					parser.lt_pending = 1;
+					parser.pos = unit_end;
+					if (callbacks->OnText) result = callbacks->OnText(userdata,text,text_end-text);
+					continue;
+				}
+				if (callbacks->OnText) result = callbacks->OnText(userdata,text,text_end-text);
+			} break;
+			case SIMC_XML_UNIT_ELEMENT:
+				result = SIMC_XML_Parser_Element(&parser,unit_end);
+				break;
+			case SIMC_XML_UNIT_END:
+				result = SIMC_XML_Parser_EndElement(&parser,unit_end);
+				break;
+			default: //Comments, declarations, processing instructions
+				break;
+		}
+
+		parser.pos = (type == SIMC_XML_UNIT_TEXT) ? unit_end : unit_end+1;
+		parser.lt_pending = 0;
+	}
+
+	//Check if all elements were closed
+	if ((result == SIMC_OK) && (parser.depth > 0)) {
+		result = SIMC_XML_Parser_Error(&parser,"Missing end tag for <",
+			parser.stack + parser.stack_offsets[parser.depth-1]);
+	}
+
+	if (read) SIMC_Free(SIMC_Userdata,parser.buffer);
+	SIMC_Free(SIMC_Userdata,parser.stack);
+	SIMC_Free(SIMC_Userdata,parser.stack_offsets);
+	return result;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Read next chunk from a file.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Internal_ReadFile(void* source, char* buffer, int size) {
+	size_t count = fread(buffer,1,size,(FILE*)source);
+	if ((count == 0) && ferror((FILE*)source)) return -1;
+	return (int)count;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Read next chunk from a string.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Internal_ReadString(void* source, char* buffer, int size) {
+	SIMC_XML_STRING_SOURCE* string = (SIMC_XML_STRING_SOURCE*)source;
+	size_t count = string->left < (size_t)size ? string->left : (size_t)size;
+	memcpy(buffer,string->data,count);
+	string->data += count;
+	string->left -= count;
+	return (int)count;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Parse XML file through a sliding window.
+///
+/// Compressed files are decompressed while they are parsed.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Internal_ParseFile(const char* filename, SIMC_XML_STREAM_CALLBACKS* callbacks, void* userdata) {
+	SIMC_XML_INFLATE* inflate;
+	FILE* f;
+	int result;
+
+	f = fopen(filename,"rb");
+	if (!f) return SIMC_ERROR_FILE;
+	switch (SIMC_XML_Internal_DetectCompression(f)) {
+		case SIMC_XML_COMPRESSION_GZIP:
+			inflate = SIMC_XML_Inflate_Create(f);
+			if (!inflate) {
+				result = SIMC_ERROR_INTERNAL;
+				break;
+			}
+			result = SIMC_XML_Internal_Parse(0,0,SIMC_XML_Inflate_Read,inflate,filename,callbacks,userdata);
+			SIMC_XML_Inflate_Destroy(inflate);
+			break;
+		case SIMC_XML_COMPRESSION_ZSTD:
+			if (callbacks->OnSyntaxError) {
+				char errorText[8192];
+				snprintf(errorText,8191,"%s:%d %s",filename,1,"Zstandard-compressed files are not supported");
+				errorText[8191] = 0;
+				callbacks->OnSyntaxError(userdata,errorText);
+			}
+			result = SIMC_ERROR_SYNTAX;
+			break;
+		default:
+			result = SIMC_XML_Internal_Parse(0,0,SIMC_XML_Internal_ReadFile,f,filename,callbacks,userdata);
+			break;
+	}
+	fclose(f);
+	return result;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Parse XML file without building a document.
+///
+/// The file is read in chunks through a small window, so memory use does not
+/// depend on the file size (only on the size of the largest single tag or text run
+/// and on the nesting depth). Callbacks are called in document order:
+/// ~~~{.c}
+///		int OnStartElement(void* userdata, const char* name, size_t length) {
+///			if (strcmp(name,"engine") == 0) ...
+///			return SIMC_OK;
+///		}
+///
+///		SIMC_XML_STREAM_CALLBACKS callbacks = { 0 };
+///		callbacks.OnStartElement = OnStartElement;
+///		SIMC_XML_Stream("vessel.xml",&callbacks,userdata);
+/// ~~~
+///
+/// All strings passed into the callbacks are null-terminated, but are only valid
+/// until the callback returns. Attributes are reported right after the start of the
+/// element they belong to. Text is reported with whitespace condensed and entities
+/// decoded (same as SIMC_XML_GetText()). Comments and declarations are skipped.
+///
+/// Files compressed with gzip are detected by their magic bytes and decompressed
+/// on the fly, chunk by chunk (the decompressed text is never stored anywhere).
+///
+/// If any callback returns a value other than SIMC_OK, parsing stops and that
+/// value is returned.
+///
+/// @param[in] filename Name of the file to parse
+/// @param[in] callbacks Parser callbacks
+/// @param[in] userdata Userdata passed into every callback
+///
+/// @returns Error code
+/// @retval SIMC_OK File successfully parsed
+/// @retval SIMC_ERROR_FILE File could not be opened
+/// @retval SIMC_ERROR_SYNTAX Syntax error in file (reported through OnSyntaxError)
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Stream(const char* filename, SIMC_XML_STREAM_CALLBACKS* callbacks, void* userdata) {
+	if (!filename) return SIMC_ERROR_INTERNAL;
+	if (!callbacks) return SIMC_ERROR_INTERNAL;
+
+	return SIMC_XML_Internal_ParseFile(filename,callbacks,userdata);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Parse XML string without building a document.
+///
+/// See SIMC_XML_Stream(). The string is not modified.
+///
+/// @param[in] string XML string
+/// @param[in] callbacks Parser callbacks
+/// @param[in] userdata Userdata passed into every callback
+///
+/// @returns Error code
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_StreamString(const char* string, SIMC_XML_STREAM_CALLBACKS* callbacks, void* userdata) {
+	SIMC_XML_STRING_SOURCE source;
+	if (!string) return SIMC_ERROR_INTERNAL;
+	if (!callbacks) return SIMC_ERROR_INTERNAL;
+
+	source.data = string;
+	source.left = strlen(string);
+	return SIMC_XML_Internal_Parse(0,0,SIMC_XML_Internal_ReadString,&source,"[string]",callbacks,userdata);
+}
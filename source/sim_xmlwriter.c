@@ -0,0 +1,625 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file
+////////////////////////////////////////////////////////////////////////////////
+/// Copyright (C) 2012-2015, Black Phoenix
+///
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the GNU Lesser General Public License as published by the Free Software
+/// Foundation; either version 2 of the License, or (at your option) any later
+/// version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+/// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+/// details.
+///
+/// You should have received a copy of the GNU Lesser General Public License along with
+/// this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+/// Place - Suite 330, Boston, MA  02111-1307, USA.
+///
+/// Further information about the GNU Lesser General Public License can also be found on
+/// the world wide web at http://www.gnu.org.
+////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#	include <windows.h>
+#	include <process.h>
+#else
+#	include <unistd.h>
+#endif
+#include "sim_core.h"
+#include "sim_xml.h"
+
+//Size of the output buffer (file output is flushed when it is full)
+#define SIMC_XML_WRITER_BUFFER		65536
+
+//Element states
+#define SIMC_XML_WRITER_TAG_OPEN	1	//Start tag not yet closed (attributes may follow)
+#define SIMC_XML_WRITER_HAS_TEXT	2	//Element has text written right after the start tag
+#define SIMC_XML_WRITER_HAS_CHILD	4	//Element has nested elements
+
+//Largest integer exactly representable in a double
+#define SIMC_XML_MAX_EXACT_INTEGER	9007199254740992.0
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Internal data structures
+////////////////////////////////////////////////////////////////////////////////
+#ifndef DOXYGEN_INTERNAL_STRUCTS
+typedef struct SIMC_XML_WRITER_STATE_TAG {
+	FILE* file;							//Output file (null if writing into memory)
+	char* filename;						//File which is replaced by the output on close
+	char* temporary_filename;			//File the output is actually written into
+	char* buffer;
+	size_t size;
+	size_t used;
+	int error;							//First error which happened while writing
+
+	char* stack;						//Names of all open elements
+	size_t stack_size;
+	size_t stack_used;
+	size_t* stack_offsets;				//Offset of each name in stack
+	int* stack_flags;					//State of each open element
+	int depth;
+	int max_depth;
+} SIMC_XML_WRITER_STATE;
+#endif
+
+//Powers of ten exactly representable in a double
+static const double SIMC_XML_Writer_Pow10[] = {
+	1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Make room for at least size more bytes in the buffer.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Writer_Reserve(SIMC_XML_WRITER_STATE* writer, size_t size) {
+	if (writer->used + size <= writer->size) return SIMC_OK;
+
+	//Flush file output
+	if (writer->file) {
+		if (writer->used && (fwrite(writer->buffer,1,writer->used,writer->file) != writer->used)) {
+			writer->error = SIMC_ERROR_FILE;
+		}
+		writer->used = 0;
+		if (size <= writer->size) return writer->error;
+	}
+
+	//Grow buffer
+	{
+		size_t new_size = writer->size;
+		char* new_buffer;
+		while (writer->used + size > new_size) new_size *= 2;
+		new_buffer = (char*)SIMC_Allocate(SIMC_Userdata,new_size);
+		if (!new_buffer) {
+			writer->error = SIMC_ERROR_INTERNAL;
+			return SIMC_ERROR_INTERNAL;
+		}
+		memcpy(new_buffer,writer->buffer,writer->used);
+		SIMC_Free(SIMC_Userdata,writer->buffer);
+		writer->buffer = new_buffer;
+		writer->size = new_size;
+	}
+	return writer->error;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Append raw bytes.
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_XML_Writer_Put(SIMC_XML_WRITER_STATE* writer, const char* data, size_t length) {
+	if (SIMC_XML_Writer_Reserve(writer,length) != SIMC_OK) return;
+	memcpy(writer->buffer + writer->used,data,length);
+	writer->used += length;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Append indentation for the current depth.
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_XML_Writer_Indent(SIMC_XML_WRITER_STATE* writer, int depth) {
+	if (SIMC_XML_Writer_Reserve(writer,depth) != SIMC_OK) return;
+	memset(writer->buffer + writer->used,'\t',depth);
+	writer->used += depth;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Append string with XML special characters replaced by entities.
+///
+/// Control characters other than tab, newline and carriage return are not allowed
+/// in XML 1.0 (not even as character references), so they are dropped. Inside
+/// attribute values tab, newline and carriage return are written as character
+/// references, since a parser replaces them with spaces when they appear literally.
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_XML_Writer_PutEscaped(SIMC_XML_WRITER_STATE* writer, const char* text, int attribute) {
+	const char* run = text;
+	while (1) {
+		const char* entity = 0;
+		unsigned char c = (unsigned char)*text;
+		switch (c) {
+			case 0: break;
+			case '&': entity = "&amp;"; break;
+			case '<': entity = "&lt;"; break;
+			case '>': entity = "&gt;"; break;
+			case '"': entity = "&quot;"; break;
+			case '\'': entity = "&apos;"; break;
+			case '\t': if (attribute) entity = "&#x9;"; break;
+			case '\n': if (attribute) entity = "&#xA;"; break;
+			case '\r': if (attribute) entity = "&#xD;"; break;
+			default:
+				if ((c < 32) && (c != '\t') && (c != '\n') && (c != '\r')) entity = "";
+				break;
+		}
+		if ((c == 0) || entity) {
+			SIMC_XML_Writer_Put(writer,run,text - run);
+			if (c == 0) return;
+			SIMC_XML_Writer_Put(writer,entity,strlen(entity));
+			run = text+1;
+		}
+		text++;
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Format double as the shortest string which reads back as the same value.
+///
+/// Numbers which can be written with at most 15 significant digits in plain
+/// decimal notation (which covers most values in simulation state) are formatted
+/// with integer arithmetic: the value is scaled by increasing powers of ten until
+/// the scaled integer divided back gives exactly the same double. Since that
+/// division is correctly rounded, reading the result with strtod() reproduces the
+/// value exactly. Other numbers are printed with the lowest precision for which
+/// the result reads back correctly.
+///
+/// @returns Length of the string written into buffer (at least 32 bytes long)
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Internal_FormatDouble(char* buffer, double value) {
+	double magnitude = value < 0 ? -value : value;
+	int length = 0;
+	int precision, low, high;
+
+	if (value != value) return sprintf(buffer,"nan");
+	if (value == 0.0) {
+		buffer[0] = '0';
+		buffer[1] = 0;
+		return 1;
+	}
+
+	//Fast path
+	if ((magnitude >= 1e-7) && (magnitude < 1e15)) {
+		int decimals;
+		for (decimals = 0; decimals <= 22; decimals++) {
+			double scaled = magnitude * SIMC_XML_Writer_Pow10[decimals];
+			double rounded;
+			if (scaled >= SIMC_XML_MAX_EXACT_INTEGER) break;
+			rounded = (double)(uint64_t)(scaled + 0.5);
+			if (rounded / SIMC_XML_Writer_Pow10[decimals] == magnitude) {
+				char digits[24];
+				uint64_t integer = (uint64_t)rounded;
+				int count = 0;
+
+				if ((decimals > 0) && (integer % 10 == 0)) break; //Scaling was not exact, let printf handle it
+				do {
+					digits[count++] = '0' + (char)(integer % 10);
+					integer /= 10;
+				} while (integer);
+				if (count > 15) break;
+
+				if (value < 0) buffer[length++] = '-';
+				if (count <= decimals) {
+					int zeros = decimals - count;
+					buffer[length++] = '0';
+					buffer[length++] = '.';
+					while (zeros-- > 0) buffer[length++] = '0';
+					while (count > 0) buffer[length++] = digits[--count];
+				} else {
+					while (count > decimals) buffer[length++] = digits[--count];
+					if (decimals > 0) {
+						buffer[length++] = '.';
+						while (count > 0) buffer[length++] = digits[--count];
+					}
+				}
+				buffer[length] = 0;
+				return length;
+			}
+		}
+	}
+
+	//Slow path (if some precision reads back exactly, so does every higher one)
+	low = 1;
+	high = 17;
+	while (low < high) {
+		precision = (low + high) / 2;
+		sprintf(buffer,"%.*g",precision,value);
+		if (strtod(buffer,0) == value) {
+			high = precision;
+		} else {
+			low = precision+1;
+		}
+	}
+	return sprintf(buffer,"%.*g",low,value);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Close start tag of the current element (before content is written).
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_XML_Writer_CloseTag(SIMC_XML_WRITER_STATE* writer, int content_flag) {
+	int* flags;
+	if (writer->depth == 0) return;
+
+	flags = &writer->stack_flags[writer->depth-1];
+	if (*flags & SIMC_XML_WRITER_TAG_OPEN) {
+		SIMC_XML_Writer_Put(writer,">",1);
+		if (content_flag == SIMC_XML_WRITER_HAS_CHILD) SIMC_XML_Writer_Put(writer,"\n",1);
+		*flags &= ~SIMC_XML_WRITER_TAG_OPEN;
+	} else if ((content_flag == SIMC_XML_WRITER_HAS_CHILD) && (*flags & SIMC_XML_WRITER_HAS_TEXT) &&
+			   (!(*flags & SIMC_XML_WRITER_HAS_CHILD))) {
+		SIMC_XML_Writer_Put(writer,"\n",1);
+	}
+	*flags |= content_flag;
+}
+
+
+//Counter which makes temporary file names unique within the process
+volatile long SIMC_XML_TemporaryCounter = 0;
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Get name of a temporary file next to the given file.
+///
+/// The name is unique for the process and call, so several threads and processes
+/// may write the same file at once.
+////////////////////////////////////////////////////////////////////////////////
+void SIMC_XML_Internal_TemporaryName(const char* filename, char* buffer, size_t size) {
+#ifdef _WIN32
+	long counter = InterlockedIncrement(&SIMC_XML_TemporaryCounter);
+	unsigned long pid = (unsigned long)_getpid();
+#else
+	long counter = __sync_add_and_fetch(&SIMC_XML_TemporaryCounter,1);
+	unsigned long pid = (unsigned long)getpid();
+#endif
+	snprintf(buffer,size,"%s.%lu.%ld.tmp",filename,pid,counter);
+	buffer[size-1] = 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Replace file with a completely written temporary file.
+///
+/// Documents which still map the old file keep seeing its old contents. The
+/// temporary file is removed if it could not be renamed.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Internal_ReplaceFile(const char* temporary_filename, const char* filename) {
+#ifdef _WIN32
+	if (MoveFileExA(temporary_filename,filename,MOVEFILE_REPLACE_EXISTING)) return SIMC_OK;
+#else
+	if (rename(temporary_filename,filename) == 0) return SIMC_OK;
+#endif
+	remove(temporary_filename);
+	return SIMC_ERROR_FILE;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Create streaming XML writer.
+///
+/// Unlike SIMC_XML_Create() and SIMC_XML_Save(), no document is built in memory:
+/// elements are written out as soon as they are added, through a fixed-size
+/// buffer (for files) or a growing buffer (for strings). The output is formatted
+/// the same way SIMC_XML_SaveString() formats documents. For example:
+/// ~~~{.c}
+///		SIMC_XML_WRITER* writer;
+///		SIMC_XML_Writer_Create("state.xml",&writer);
+///		SIMC_XML_Writer_BeginElement(writer,"state");
+///		for (i = 0; i < count; i++) {
+///			SIMC_XML_Writer_BeginElement(writer,"vessel");
+///			SIMC_XML_Writer_AttributeDouble(writer,"mass",vessels[i].mass);
+///			SIMC_XML_Writer_EndElement(writer);
+///		}
+///		SIMC_XML_Writer_EndElement(writer);
+///		SIMC_XML_Writer_Close(writer,0);
+/// ~~~
+///
+/// The output is written into a temporary file next to filename, which replaces
+/// filename only when SIMC_XML_Writer_Close() succeeds. This way a document which
+/// was opened with SIMC_XML_OpenMapped() can be saved over its own file.
+///
+/// @param[in] filename File to write (null to write into a string returned by SIMC_XML_Writer_Close())
+/// @param[out] xmlwriter Writer handle
+///
+/// @returns Error code
+/// @retval SIMC_OK Writer created
+/// @retval SIMC_ERROR_FILE File could not be created
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Writer_Create(const char* filename, SIMC_XML_WRITER** xmlwriter) {
+	SIMC_XML_WRITER_STATE* writer;
+	if (!xmlwriter) return SIMC_ERROR_INTERNAL;
+	*xmlwriter = 0;
+
+	writer = (SIMC_XML_WRITER_STATE*)SIMC_Allocate(SIMC_Userdata,sizeof(SIMC_XML_WRITER_STATE));
+	if (!writer) return SIMC_ERROR_INTERNAL;
+	memset(writer,0,sizeof(SIMC_XML_WRITER_STATE));
+
+	if (filename) {
+		size_t length = strlen(filename);
+		writer->filename = (char*)SIMC_Allocate(SIMC_Userdata,length+1);
+		writer->temporary_filename = (char*)SIMC_Allocate(SIMC_Userdata,length+64);
+		if ((!writer->filename) || (!writer->temporary_filename)) {
+			if (writer->filename) SIMC_Free(SIMC_Userdata,writer->filename);
+			if (writer->temporary_filename) SIMC_Free(SIMC_Userdata,writer->temporary_filename);
+			SIMC_Free(SIMC_Userdata,writer);
+			return SIMC_ERROR_INTERNAL;
+		}
+		strcpy(writer->filename,filename);
+		SIMC_XML_Internal_TemporaryName(filename,writer->temporary_filename,length+64);
+
+		writer->file = fopen(writer->temporary_filename,"wb");
+		if (!writer->file) {
+			SIMC_Free(SIMC_Userdata,writer->filename);
+			SIMC_Free(SIMC_Userdata,writer->temporary_filename);
+			SIMC_Free(SIMC_Userdata,writer);
+			return SIMC_ERROR_FILE;
+		}
+	}
+
+	writer->size = SIMC_XML_WRITER_BUFFER;
+	writer->buffer = (char*)SIMC_Allocate(SIMC_Userdata,writer->size);
+	writer->stack_size = 1024;
+	writer->stack = (char*)SIMC_Allocate(SIMC_Userdata,writer->stack_size);
+	writer->max_depth = 64;
+	writer->stack_offsets = (size_t*)SIMC_Allocate(SIMC_Userdata,sizeof(size_t)*writer->max_depth);
+	writer->stack_flags = (int*)SIMC_Allocate(SIMC_Userdata,sizeof(int)*writer->max_depth);
+	if ((!writer->buffer) || (!writer->stack) || (!writer->stack_offsets) || (!writer->stack_flags)) {
+		writer->error = SIMC_ERROR_INTERNAL;
+		SIMC_XML_Writer_Close((SIMC_XML_WRITER*)writer,0);
+		return SIMC_ERROR_INTERNAL;
+	}
+
+	*xmlwriter = (SIMC_XML_WRITER*)writer;
+	return SIMC_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Start new element (nested in the current one).
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Writer_BeginElement(SIMC_XML_WRITER* xmlwriter, const char* name) {
+	SIMC_XML_WRITER_STATE* writer = (SIMC_XML_WRITER_STATE*)xmlwriter;
+	size_t length;
+	if (!writer) return SIMC_ERROR_INTERNAL;
+	if (!name) return SIMC_ERROR_INTERNAL;
+	if (writer->error) return writer->error;
+
+	//Remember element name
+	length = strlen(name);
+	if (writer->depth == writer->max_depth) {
+		size_t* new_offsets = (size_t*)SIMC_Allocate(SIMC_Userdata,sizeof(size_t)*writer->max_depth*2);
+		int* new_flags = (int*)SIMC_Allocate(SIMC_Userdata,sizeof(int)*writer->max_depth*2);
+		if ((!new_offsets) || (!new_flags)) {
+			if (new_offsets) SIMC_Free(SIMC_Userdata,new_offsets);
+			if (new_flags) SIMC_Free(SIMC_Userdata,new_flags);
+			writer->error = SIMC_ERROR_INTERNAL;
+			return writer->error;
+		}
+		memcpy(new_offsets,writer->stack_offsets,sizeof(size_t)*writer->max_depth);
+		memcpy(new_flags,writer->stack_flags,sizeof(int)*writer->max_depth);
+		SIMC_Free(SIMC_Userdata,writer->stack_offsets);
+		SIMC_Free(SIMC_Userdata,writer->stack_flags);
+		writer->stack_offsets = new_offsets;
+		writer->stack_flags = new_flags;
+		writer->max_depth *= 2;
+	}
+	while (writer->stack_used + length + 1 > writer->stack_size) {
+		char* new_stack = (char*)SIMC_Allocate(SIMC_Userdata,writer->stack_size*2);
+		if (!new_stack) {
+			writer->error = SIMC_ERROR_INTERNAL;
+			return writer->error;
+		}
+		memcpy(new_stack,writer->stack,writer->stack_used);
+		SIMC_Free(SIMC_Userdata,writer->stack);
+		writer->stack = new_stack;
+		writer->stack_size *= 2;
+	}
+
+	//Write start of the tag
+	SIMC_XML_Writer_CloseTag(writer,SIMC_XML_WRITER_HAS_CHILD);
+	SIMC_XML_Writer_Indent(writer,writer->depth);
+	SIMC_XML_Writer_Put(writer,"<",1);
+	SIMC_XML_Writer_Put(writer,name,length);
+
+	memcpy(writer->stack + writer->stack_used,name,length+1);
+	writer->stack_offsets[writer->depth] = writer->stack_used;
+	writer->stack_flags[writer->depth] = SIMC_XML_WRITER_TAG_OPEN;
+	writer->stack_used += length+1;
+	writer->depth++;
+	return writer->error;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Add attribute to the element which was just started.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Writer_Attribute(SIMC_XML_WRITER* xmlwriter, const char* name, const char* value) {
+	SIMC_XML_WRITER_STATE* writer = (SIMC_XML_WRITER_STATE*)xmlwriter;
+	if (!writer) return SIMC_ERROR_INTERNAL;
+	if (!name) return SIMC_ERROR_INTERNAL;
+	if (!value) return SIMC_ERROR_INTERNAL;
+	if (writer->error) return writer->error;
+	if ((writer->depth == 0) || (!(writer->stack_flags[writer->depth-1] & SIMC_XML_WRITER_TAG_OPEN))) {
+		return SIMC_ERROR_INTERNAL;
+	}
+
+	SIMC_XML_Writer_Put(writer," ",1);
+	SIMC_XML_Writer_Put(writer,name,strlen(name));
+	SIMC_XML_Writer_Put(writer,"=\"",2);
+	SIMC_XML_Writer_PutEscaped(writer,value,1);
+	SIMC_XML_Writer_Put(writer,"\"",1);
+	return writer->error;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Add numeric attribute (written in the shortest form which reads back exactly).
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Writer_AttributeDouble(SIMC_XML_WRITER* xmlwriter, const char* name, double value) {
+	char buffer[64];
+	SIMC_XML_Internal_FormatDouble(buffer,value);
+	return SIMC_XML_Writer_Attribute(xmlwriter,name,buffer);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Add integer attribute.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Writer_AttributeInt(SIMC_XML_WRITER* xmlwriter, const char* name, int value) {
+	char buffer[16];
+	char* p = buffer + sizeof(buffer) - 1;
+	unsigned int magnitude = value < 0 ? 0U - (unsigned int)value : (unsigned int)value;
+
+	*p = 0;
+	do {
+		*--p = '0' + (char)(magnitude % 10);
+		magnitude /= 10;
+	} while (magnitude);
+	if (value < 0) *--p = '-';
+	return SIMC_XML_Writer_Attribute(xmlwriter,name,p);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Add text to the current element.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Writer_Text(SIMC_XML_WRITER* xmlwriter, const char* text) {
+	SIMC_XML_WRITER_STATE* writer = (SIMC_XML_WRITER_STATE*)xmlwriter;
+	if (!writer) return SIMC_ERROR_INTERNAL;
+	if (!text) return SIMC_ERROR_INTERNAL;
+	if (writer->error) return writer->error;
+	if (writer->depth == 0) return SIMC_ERROR_INTERNAL;
+
+	//Text after nested elements goes on its own line
+	if (writer->stack_flags[writer->depth-1] & SIMC_XML_WRITER_HAS_CHILD) {
+		SIMC_XML_Writer_Indent(writer,writer->depth);
+		SIMC_XML_Writer_PutEscaped(writer,text,0);
+		SIMC_XML_Writer_Put(writer,"\n",1);
+	} else {
+		SIMC_XML_Writer_CloseTag(writer,SIMC_XML_WRITER_HAS_TEXT);
+		SIMC_XML_Writer_PutEscaped(writer,text,0);
+	}
+	return writer->error;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Finish the current element.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Writer_EndElement(SIMC_XML_WRITER* xmlwriter) {
+	SIMC_XML_WRITER_STATE* writer = (SIMC_XML_WRITER_STATE*)xmlwriter;
+	const char* name;
+	int flags;
+	if (!writer) return SIMC_ERROR_INTERNAL;
+	if (writer->error) return writer->error;
+	if (writer->depth == 0) return SIMC_ERROR_INTERNAL;
+
+	writer->depth--;
+	flags = writer->stack_flags[writer->depth];
+	name = writer->stack + writer->stack_offsets[writer->depth];
+	if (flags & SIMC_XML_WRITER_TAG_OPEN) {
+		SIMC_XML_Writer_Put(writer," />\n",4);
+	} else {
+		if (flags & SIMC_XML_WRITER_HAS_CHILD) SIMC_XML_Writer_Indent(writer,writer->depth);
+		SIMC_XML_Writer_Put(writer,"</",2);
+		SIMC_XML_Writer_Put(writer,name,strlen(name));
+		SIMC_XML_Writer_Put(writer,">\n",2);
+	}
+	writer->stack_used = writer->stack_offsets[writer->depth];
+	return writer->error;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Finish writing and free the writer.
+///
+/// All elements which are still open are closed. If the writer was writing into
+/// memory, the output is returned in description (allocated with SIMC_Allocate(),
+/// same as SIMC_XML_SaveString()); otherwise description may be null. If writing
+/// to file failed, the original file is left untouched.
+///
+/// @returns Error code
+/// @retval SIMC_OK All output written successfully
+/// @retval SIMC_ERROR_FILE Writing to file failed
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Writer_Close(SIMC_XML_WRITER* xmlwriter, char** description) {
+	SIMC_XML_WRITER_STATE* writer = (SIMC_XML_WRITER_STATE*)xmlwriter;
+	int result;
+	if (!writer) return SIMC_ERROR_INTERNAL;
+	if (description) *description = 0;
+
+	while ((!writer->error) && (writer->depth > 0)) SIMC_XML_Writer_EndElement(xmlwriter);
+	if (writer->file) {
+		if ((!writer->error) && writer->used &&
+			(fwrite(writer->buffer,1,writer->used,writer->file) != writer->used)) {
+			writer->error = SIMC_ERROR_FILE;
+		}
+		if (fclose(writer->file) != 0) writer->error = SIMC_ERROR_FILE;
+		if (!writer->error) {
+			writer->error = SIMC_XML_Internal_ReplaceFile(writer->temporary_filename,writer->filename);
+		} else {
+			remove(writer->temporary_filename);
+		}
+	} else if (description && (!writer->error)) {
+		//Return buffer to the caller
+		if (SIMC_XML_Writer_Reserve(writer,1) == SIMC_OK) {
+			writer->buffer[writer->used] = 0;
+			*description = writer->buffer;
+			writer->buffer = 0;
+		}
+	}
+	result = writer->error;
+
+	if (writer->buffer) SIMC_Free(SIMC_Userdata,writer->buffer);
+	if (writer->stack) SIMC_Free(SIMC_Userdata,writer->stack);
+	if (writer->stack_offsets) SIMC_Free(SIMC_Userdata,writer->stack_offsets);
+	if (writer->stack_flags) SIMC_Free(SIMC_Userdata,writer->stack_flags);
+	if (writer->filename) SIMC_Free(SIMC_Userdata,writer->filename);
+	if (writer->temporary_filename) SIMC_Free(SIMC_Userdata,writer->temporary_filename);
+	SIMC_Free(SIMC_Userdata,writer);
+	return result;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Write natively parsed document through a writer.
+////////////////////////////////////////////////////////////////////////////////
+int SIMC_XML_Native_Write(SIMC_XML_DOC* doc, SIMC_XML_WRITER* xmlwriter) {
+	SIMC_XML_NATIVE_ELEMENT* element = doc->root.first_child;
+	while (element) {
+		SIMC_XML_NATIVE_ATTRIBUTE* attribute;
+		int error = SIMC_XML_Writer_BeginElement(xmlwriter,element->name.data);
+		for (attribute = element->first_attribute; attribute; attribute = attribute->next) {
+			if (!error) error = SIMC_XML_Writer_Attribute(xmlwriter,attribute->name.data,attribute->value.data);
+		}
+		if (element->text.data && (!error)) error = SIMC_XML_Writer_Text(xmlwriter,element->text.data);
+		if (error) return error;
+
+		//Next element in document order
+		if (element->first_child) {
+			element = element->first_child;
+		} else {
+			while (element && (element != &doc->root) && (!element->next)) {
+				SIMC_XML_Writer_EndElement(xmlwriter);
+				element = element->parent;
+			}
+			if (element == &doc->root) break;
+			SIMC_XML_Writer_EndElement(xmlwriter);
+			element = element->next;
+		}
+	}
+	return SIMC_OK;
+}
@@ -1,3 +1,9 @@
+-- Lock contention profiling
+newoption {
+	trigger = "simc-lock-profiling",
+	description = "Collect lock contention statistics in SIMC locks"
+}
+
 -- Create standalone solution
 if SIMC_STANDALONE ~= false then
 	solution "simc"
@@ -21,4 +27,82 @@ project "simc"
 		"../include/**",
 		"../external/tinyxml/tiny*.cpp",
 	}
-	defines { "SIMC_LIBRARY" }
\ No newline at end of file
+	defines { "SIMC_LIBRARY" }
+	if _OPTIONS["simc-lock-profiling"] then
+		defines { "SIMC_LOCK_PROFILING" }
+	end
+
+--------------------------------------------------------------------------------
+-- Benchmarks (standalone solution only)
+--------------------------------------------------------------------------------
+if SIMC_STANDALONE ~= false then
+	project "simc_bench"
+		uuid "56F0956C-1074-4820-A2CE-5320FEA1F6E7"
+		kind "ConsoleApp"
+		language "C"
+		includedirs {
+			"../include",
+			"../bench"
+		}
+		files {
+			"../bench/sim_bench.h",
+			"../bench/sim_bench.c",
+			"../bench/sim_bench_core.c"
+		}
+		links { "simc" }
+		defines { "SIMC_LIBRARY" } -- Queue, list and storage array API is internal
+		configuration "windows"
+			links { "psapi" } -- Peak working set
+		configuration {}
+
+	project "simc_bench_xml"
+		uuid "0B7F3C52-9E1A-4D6B-8C27-3A5E1F94D820"
+		kind "ConsoleApp"
+		language "C"
+		includedirs {
+			"../include",
+			"../bench"
+		}
+		files {
+			"../bench/sim_bench.h",
+			"../bench/sim_bench.c",
+			"../bench/sim_bench_xml.c"
+		}
+		links { "simc" }
+		defines { "SIMC_LIBRARY" }
+		configuration "windows"
+			links { "psapi" } -- Peak working set
+		configuration {}
+
+	project "simc_stress_list"
+		uuid "E4A19D7B-62C8-4F3E-A915-7D0B3C58E2F6"
+		kind "ConsoleApp"
+		language "C"
+		includedirs {
+			"../include",
+			"../bench"
+		}
+		files {
+			"../bench/sim_bench.h",
+			"../bench/sim_bench.c",
+			"../bench/sim_stress_list.c"
+		}
+		links { "simc" }
+		defines { "SIMC_LIBRARY" } -- Validates internal list structure
+		configuration "windows"
+			links { "psapi" }
+		configuration {}
+
+	project "simc_test_xml"
+		uuid "9C2E5B71-4D08-4A6F-B3E1-62F7A0D85C19"
+		kind "ConsoleApp"
+		language "C"
+		includedirs {
+			"../include"
+		}
+		files {
+			"../bench/sim_test_xml.c"
+		}
+		links { "simc" }
+		defines { "SIMC_LIBRARY" }
+end
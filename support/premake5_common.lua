@@ -76,7 +76,7 @@ configuration { "windows", "x64" }
 
 -- Linux specific
 configuration { "not windows" }
-	links { "m", "pthread" }
+	links { "m", "pthread", "dl" }
 	linkoptions { "-lstdc++" }
 	
 -- Configuration specific